@@ -8,6 +8,16 @@
 
 namespace cardlib {
 
+namespace {
+
+// Each set of card images loaded gets a serial of its own
+uint64_t nextImageSerial() {
+  static uint64_t serial = 0;
+  return ++serial;
+}
+
+} // namespace
+
 std::string Card::toString() const {
   if (rank == Rank::JOKER) {
     return suit == Suit::HEARTS ? "Red Joker" : "Black Joker";
@@ -20,12 +30,15 @@ std::string Card::toString() const {
   return result;
 }
 
-Deck::Deck() : include_jokers_(false), use_alternate_art_(false) {
+Deck::Deck()
+    : image_serial_(0), include_jokers_(false), use_alternate_art_(false) {
+  image_index_.fill(-1);
   initializeStandardDeck();
 }
 
 Deck::Deck(const std::string &zip_path)
-    : include_jokers_(false), use_alternate_art_(false) {
+    : image_serial_(0), include_jokers_(false), use_alternate_art_(false) {
+  image_index_.fill(-1);
   loadCardsFromZip(zip_path);
 }
 
@@ -75,18 +88,35 @@ std::optional<Card> Deck::peekBottomCard() const {
   return cards_.front();
 }
 
-std::optional<CardImage> Deck::getCardImage(const Card &card) const {
-  auto it = std::find_if(
-      card_images_.begin(), card_images_.end(), [&card](const CardImage &img) {
-        return img.card_info && img.card_info->suit == card.suit &&
-               img.card_info->rank == card.rank &&
-               img.card_info->is_alternate_art == card.is_alternate_art;
-      });
+size_t Deck::imageSlot(const Card &card) {
+  size_t suit = static_cast<size_t>(card.suit);
+  size_t rank = static_cast<size_t>(card.rank);
+  if (suit > 4 || rank > 14) {
+    return IMAGE_SLOT_COUNT;
+  }
+  return (suit * 15 + rank) * 2 + (card.is_alternate_art ? 1 : 0);
+}
+
+void Deck::rebuildImageIndex() {
+  image_index_.fill(-1);
+  for (size_t i = 0; i < card_images_.size(); i++) {
+    const auto &info = card_images_[i].card_info;
+    if (!info)
+      continue;
+    size_t slot = imageSlot(*info);
+    // Keep the first match, same as the old linear search
+    if (slot < IMAGE_SLOT_COUNT && image_index_[slot] < 0) {
+      image_index_[slot] = static_cast<int>(i);
+    }
+  }
+}
 
-  if (it != card_images_.end()) {
-    return *it;
+const CardImage *Deck::getCardImage(const Card &card) const {
+  size_t slot = imageSlot(card);
+  if (slot >= IMAGE_SLOT_COUNT || image_index_[slot] < 0) {
+    return nullptr;
   }
-  return std::nullopt;
+  return &card_images_[image_index_[slot]];
 }
 
 void Deck::includeJokers(bool include) {
@@ -172,6 +202,8 @@ void Deck::loadCardsFromZip(const std::string &zip_path) {
   }
 
   zip_close(archive);
+  rebuildImageIndex();
+  image_serial_ = nextImageSerial();
 
   // Initialize deck based on available card images
   cards_.clear();
@@ -205,6 +237,7 @@ void Deck::replaceCardBackImage(const std::string &image_path) {
   back_img.data = std::move(buffer);
   back_img.card_info = std::nullopt;
   card_back_image_ = std::move(back_img);
+  image_serial_ = nextImageSerial();
 }
 
 std::optional<Card> Deck::parseFilename(const std::string &filename) {
@@ -402,8 +435,8 @@ std::optional<Card> parseCardString(const std::string &card_str) {
   return card;
 }
 
-std::optional<CardImage> Deck::getCardBackImage() const {
-  return card_back_image_;
+const CardImage *Deck::getCardBackImage() const {
+  return card_back_image_ ? &*card_back_image_ : nullptr;
 }
 
 MultiDeck::MultiDeck(size_t num_decks) 
@@ -550,23 +583,22 @@ void MultiDeck::setAlternateArtInAllDecks(bool use_alternate) {
     }
 }
 
-std::optional<CardImage> MultiDeck::getCardImage(const Card &card) const {
+const CardImage *MultiDeck::getCardImage(const Card &card) const {
     // Try to get the image from the first deck with images
     for (const auto &deck : decks_) {
-        auto image = deck.getCardImage(card);
-        if (image) {
+        if (const CardImage *image = deck.getCardImage(card)) {
             return image;
         }
     }
-    return std::nullopt;
+    return nullptr;
 }
 
-std::optional<CardImage> MultiDeck::getCardBackImage() const {
+const CardImage *MultiDeck::getCardBackImage() const {
     // Try to get the card back image from the first deck
     if (!decks_.empty()) {
         return decks_[0].getCardBackImage();
     }
-    return std::nullopt;
+    return nullptr;
 }
 
 } // namespace cardlib
@@ -1,6 +1,9 @@
 #ifndef CARDLIB_H
 #define CARDLIB_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <optional>
@@ -75,9 +78,9 @@ public:
     void includeJokersInAllDecks(bool include = true);
     void setAlternateArtInAllDecks(bool use_alternate = true);
 
-    // Image operations
-    std::optional<CardImage> getCardImage(const Card &card) const;
-    std::optional<CardImage> getCardBackImage() const;
+    // Image operations (non-owning views, valid until the decks are modified)
+    const CardImage *getCardImage(const Card &card) const;
+    const CardImage *getCardBackImage() const;
 
     // New methods for derived classes to access decks
     size_t getDeckCount() const { return decks_.size(); }
@@ -112,11 +115,18 @@ public:
   std::vector<Card> getAllCards() const;
   std::optional<Card> peekTopCard() const;
   std::optional<Card> peekBottomCard() const;
-  std::optional<CardImage> getCardBackImage() const;
+  const CardImage *getCardBackImage() const;
 
   void removeJokers();
-  // Image operations
-  std::optional<CardImage> getCardImage(const Card &card) const;
+  // Image operations. These return a view into the deck's image store (or
+  // nullptr) instead of copying the PNG bytes; the pointer stays valid until
+  // the deck is reassigned or reloaded.
+  const CardImage *getCardImage(const Card &card) const;
+  // Every card image the deck holds, whether or not the card is in it
+  const std::vector<CardImage> &getCardImages() const { return card_images_; }
+  // Changes whenever the images are loaded or replaced; copies of a deck
+  // share it. 0 before any are loaded.
+  uint64_t imageSerial() const { return image_serial_; }
 
   // Deck customization
   void includeJokers(bool include = true);
@@ -138,17 +148,178 @@ public:
   }
 
 private:
+  // Dense lookup table: one slot per suit/rank/alt-art combination holding an
+  // index into card_images_ (or -1). Indices rather than pointers so copying
+  // a Deck keeps the table valid.
+  static constexpr size_t IMAGE_SLOT_COUNT = 5 * 15 * 2;
+  static size_t imageSlot(const Card &card);
+
   std::vector<Card> cards_;
   std::vector<CardImage> card_images_;
+  std::array<int, IMAGE_SLOT_COUNT> image_index_;
   std::optional<CardImage> card_back_image_;
+  uint64_t image_serial_;
   bool include_jokers_;
   bool use_alternate_art_;
 
   void initializeStandardDeck();
+  void rebuildImageIndex();
   void loadCardsFromZip(const std::string &zip_path);
   static std::optional<Card> parseFilename(const std::string &filename);
 };
 
+// ============================================================================
+// COMPACT CARD / PILE REPRESENTATION
+// ============================================================================
+//
+// PackedCard squeezes a card into one byte: bits 0-3 hold the rank (1-14),
+// bits 4-6 the suit and bit 7 the face-up flag. Alternate art is a rendering
+// detail and is not stored. A value of 0 is "no card".
+//
+// FixedPile is an allocation-free pile with a compile-time capacity, meant
+// for rule checks, solvers and undo where board states are copied a lot.
+// The GTK front-ends keep their std::vector piles and convert at the edges.
+
+struct PackedCard {
+  uint8_t bits;
+
+  static constexpr uint8_t RANK_MASK = 0x0F;
+  static constexpr uint8_t SUIT_MASK = 0x70;
+  static constexpr uint8_t SUIT_SHIFT = 4;
+  static constexpr uint8_t FACE_UP_BIT = 0x80;
+
+  constexpr PackedCard() : bits(0) {}
+  constexpr explicit PackedCard(uint8_t raw) : bits(raw) {}
+  constexpr PackedCard(Suit s, Rank r, bool face_up = true)
+      : bits(static_cast<uint8_t>(
+            (static_cast<uint8_t>(r) & RANK_MASK) |
+            ((static_cast<uint8_t>(s) << SUIT_SHIFT) & SUIT_MASK) |
+            (face_up ? FACE_UP_BIT : 0))) {}
+  explicit PackedCard(const Card &card, bool face_up = true)
+      : PackedCard(card.suit, card.rank, face_up) {}
+
+  constexpr bool isValid() const { return (bits & RANK_MASK) != 0; }
+  constexpr int rankValue() const { return bits & RANK_MASK; }
+  constexpr Rank rank() const { return static_cast<Rank>(bits & RANK_MASK); }
+  constexpr Suit suit() const {
+    return static_cast<Suit>((bits & SUIT_MASK) >> SUIT_SHIFT);
+  }
+  constexpr bool faceUp() const { return (bits & FACE_UP_BIT) != 0; }
+  constexpr bool isRed() const {
+    return suit() == Suit::DIAMONDS || suit() == Suit::HEARTS;
+  }
+
+  // Identity without the face-up flag (0-63), handy for table lookups
+  constexpr uint8_t id() const {
+    return static_cast<uint8_t>(bits & (RANK_MASK | SUIT_MASK));
+  }
+
+  constexpr PackedCard withFaceUp(bool face_up) const {
+    return PackedCard(static_cast<uint8_t>(
+        (bits & ~FACE_UP_BIT) | (face_up ? FACE_UP_BIT : 0)));
+  }
+
+  Card toCard() const { return Card(suit(), rank()); }
+
+  constexpr bool operator==(PackedCard other) const {
+    return bits == other.bits;
+  }
+  constexpr bool operator!=(PackedCard other) const {
+    return bits != other.bits;
+  }
+};
+
+static_assert(sizeof(PackedCard) == 1, "PackedCard must stay one byte");
+
+// Rule helpers shared by the games
+constexpr bool isOppositeColor(PackedCard a, PackedCard b) {
+  return a.isRed() != b.isRed();
+}
+
+// card can go on top of target in a descending tableau build
+constexpr bool isOneRankBelow(PackedCard card, PackedCard target) {
+  return card.rankValue() + 1 == target.rankValue();
+}
+
+// card can go on top of target on an ascending same-suit foundation
+constexpr bool buildsOnFoundation(PackedCard card, PackedCard top) {
+  return card.suit() == top.suit() && card.rankValue() == top.rankValue() + 1;
+}
+
+template <size_t Capacity> class FixedPile {
+  static_assert(Capacity > 0 && Capacity < 256,
+                "FixedPile size is stored in one byte");
+
+public:
+  constexpr FixedPile() : cards_{}, size_(0) {}
+
+  constexpr size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+  constexpr bool full() const { return size_ == Capacity; }
+  static constexpr size_t capacity() { return Capacity; }
+
+  PackedCard &operator[](size_t i) { return cards_[i]; }
+  constexpr PackedCard operator[](size_t i) const { return cards_[i]; }
+  PackedCard &back() { return cards_[size_ - 1]; }
+  constexpr PackedCard back() const { return cards_[size_ - 1]; }
+  const PackedCard *begin() const { return cards_.data(); }
+  const PackedCard *end() const { return cards_.data() + size_; }
+
+  void clear() { size_ = 0; }
+
+  bool push(PackedCard card) {
+    if (size_ == Capacity)
+      return false;
+    cards_[size_++] = card;
+    return true;
+  }
+
+  PackedCard pop() { return size_ ? cards_[--size_] : PackedCard(); }
+
+  // Moves the top count cards onto dest, preserving their order
+  template <size_t N> bool moveTopTo(FixedPile<N> &dest, size_t count) {
+    if (count > size_ || dest.size() + count > N)
+      return false;
+    for (size_t i = size_ - count; i < size_; i++) {
+      dest.push(cards_[i]);
+    }
+    size_ = static_cast<uint8_t>(size_ - count);
+    return true;
+  }
+
+  bool operator==(const FixedPile &other) const {
+    return size_ == other.size_ &&
+           std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const FixedPile &other) const { return !(*this == other); }
+
+private:
+  std::array<PackedCard, Capacity> cards_;
+  uint8_t size_;
+};
+
+// Conversion helpers between the front-end piles and FixedPile. Cards that
+// don't fit in the pile are dropped (the return value says whether all fit).
+template <size_t N>
+bool packPile(const std::vector<Card> &cards, FixedPile<N> &out,
+              bool face_up = true) {
+  out.clear();
+  for (const auto &card : cards) {
+    if (!out.push(PackedCard(card, face_up)))
+      return false;
+  }
+  return true;
+}
+
+template <size_t N> std::vector<Card> unpackPile(const FixedPile<N> &pile) {
+  std::vector<Card> cards;
+  cards.reserve(pile.size());
+  for (PackedCard card : pile) {
+    cards.push_back(card.toCard());
+  }
+  return cards;
+}
+
 // Utility functions
 std::string suitToString(Suit suit);
 std::string rankToString(Rank rank);
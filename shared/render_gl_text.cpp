@@ -84,6 +84,7 @@ void gl_init(void) {
     fprintf(stderr, "[GL] Initializing text renderer\n");
     
     gl_state.program = create_program(vertex_shader, fragment_shader);
+    gl_state.projection_location = glGetUniformLocation(gl_state.program, "projection");
     
     glGenVertexArrays(1, &gl_state.vao);
     glGenBuffers(1, &gl_state.vbo);
@@ -221,8 +222,7 @@ void gl_draw_text_simple(const char *text, int x, int y, int font_size) {
 static void draw_vertices(Vertex *verts, int count, GLenum mode) {
     glUseProgram(gl_state.program);
     
-    GLint proj_loc = glGetUniformLocation(gl_state.program, "projection");
-    glUniformMatrix4fv(proj_loc, 1, GL_FALSE, gl_state.projection.m);
+    glUniformMatrix4fv(gl_state.projection_location, 1, GL_FALSE, gl_state.projection.m);
     
     glBindBuffer(GL_ARRAY_BUFFER, gl_state.vbo);
     glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Vertex), verts);
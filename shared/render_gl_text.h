@@ -14,6 +14,7 @@ typedef struct {
 
 typedef struct {
     GLuint program;
+    GLint projection_location;  // Looked up once, in gl_init()
     GLuint vao;
     GLuint vbo;
     Mat4 projection;
@@ -4,6 +4,7 @@
 #define GRAVITY 0.3
 #define EXPLOSION_THRESHOLD_MIN 0.35
 #define EXPLOSION_THRESHOLD_MAX 0.7
+
 gboolean FreecellGame::onAnimationTick(gpointer data) {
   FreecellGame *game = static_cast<FreecellGame *>(data);
   game->updateWinAnimation();
@@ -80,26 +81,21 @@ void FreecellGame::updateWinAnimation() {
       } else {
         all_cards_finished = false;
       }
-    } else {
-      // Update explosion fragments
-      updateCardFragments(card);
-
-      // Check if all fragments are inactive
-      bool all_fragments_inactive = true;
-      for (const auto &fragment : card.fragments) {
-        if (fragment.active) {
-          all_fragments_inactive = false;
-          all_cards_finished = false;
-          break;
-        }
-      }
-
-      if (all_fragments_inactive) {
-        card.active = false;
-      }
     }
   }
 
+  // Exploded cards' fragments, until the last leaves the window
+  updateCardFragments();
+  if (!fragments_.empty())
+    all_cards_finished = false;
+
+#ifdef USEOPENGL
+  // Exploded cards' fragments, on the GPU until the last leaves the window
+  explosions_gl_.tick();
+  if (explosions_gl_.active())
+    all_cards_finished = false;
+#endif
+
   // Clear inactive cards periodically to prevent memory bloat
   if (animated_cards_.size() > 200) {
     // Manual removal of inactive cards without using std::remove_if
@@ -196,34 +192,30 @@ void FreecellGame::explodeCard(AnimatedCard &card) {
     return;
   }
 
-  // Mark the card as exploded
+  // Mark the card as exploded; its fragments are drawn from here on
   card.exploded = true;
+  card.active = false;
 
   playSound(GameSoundEvent::Firework);
 
-  // Create fragments
-  card.fragments.clear();
-
   // Split the card into smaller fragments for more dramatic effect (4x4 grid)
-  const int grid_size = 4;
-  const int fragment_width = current_card_width_ / grid_size;
-  const int fragment_height = current_card_height_ / grid_size;
+  const int grid_size = FRAGMENT_GRID;
+  const int card_id = render::cardId(card.card);
+  // Fractional, so the cells cover the whole card
+  const double fragment_width = double(current_card_width_) / grid_size;
+  const double fragment_height = double(current_card_height_) / grid_size;
 
   for (int row = 0; row < grid_size; row++) {
     for (int col = 0; col < grid_size; col++) {
-      CardFragment fragment;
-
       // Initial position
-      fragment.x = card.x + col * fragment_width;
-      fragment.y = card.y + row * fragment_height;
-      fragment.width = fragment_width;
-      fragment.height = fragment_height;
+      double x = card.x + col * fragment_width;
+      double y = card.y + row * fragment_height;
 
       // Calculate distance from center of the card
       double center_x = card.x + current_card_width_ / 2;
       double center_y = card.y + current_card_height_ / 2;
-      double fragment_center_x = fragment.x + fragment_width / 2;
-      double fragment_center_y = fragment.y + fragment_height / 2;
+      double fragment_center_x = x + fragment_width / 2;
+      double fragment_center_y = y + fragment_height / 2;
 
       // Direction vector from center of card
       double dir_x = fragment_center_x - center_x;
@@ -245,52 +237,16 @@ void FreecellGame::explodeCard(AnimatedCard &card) {
       double speed = 18.0 + (rand() % 12);
       double upward_bias = -20.0 - (rand() % 15);
 
-      fragment.velocity_x = dir_x * speed + (rand() % 15 - 7);
-      fragment.velocity_y = dir_y * speed + upward_bias * 1.5;
+      double velocity_x = dir_x * speed + (rand() % 15 - 7);
+      double velocity_y = dir_y * speed + upward_bias * 1.5;
 
       // Rotation
-      fragment.rotation = card.rotation;
-      fragment.rotation_velocity = (rand() % 60 - 30) / 5.0;
-
-      // Create a new image surface
-      fragment.surface = cairo_image_surface_create(
-          CAIRO_FORMAT_ARGB32, fragment_width, fragment_height);
+      double spin = (rand() % 60 - 30) / 5.0;
 
-      if (cairo_surface_status(fragment.surface) != CAIRO_STATUS_SUCCESS) {
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-        continue;
-      }
-
-      // Create a context for drawing on the new surface
-      cairo_t *cr = cairo_create(fragment.surface);
-      if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
-        cairo_destroy(cr);
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-        continue;
-      }
-
-      // Draw white background (for transparency)
-      cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.0);
-      cairo_rectangle(cr, 0, 0, fragment_width, fragment_height);
-      cairo_fill(cr);
-
-      // Draw the fragment of the card
-      cairo_set_source_surface(cr, card_surface, -col * fragment_width,
-                               -row * fragment_height);
-
-      if (cairo_status(cr) == CAIRO_STATUS_SUCCESS) {
-        cairo_rectangle(cr, 0, 0, fragment_width, fragment_height);
-        cairo_fill(cr);
-      }
-
-      // Clean up the drawing context
-      cairo_destroy(cr);
-
-      // Set the fragment as active
-      fragment.active = true;
-      card.fragments.push_back(fragment);
+      // Set it flying; it is drawn from its cell of the card's surface
+      fragments_.add(x, y, fragment_width, fragment_height, velocity_x,
+                     velocity_y, card.rotation, spin,
+                     uint32_t((card_id * grid_size + row) * grid_size + col));
     }
   }
 
@@ -298,90 +254,61 @@ void FreecellGame::explodeCard(AnimatedCard &card) {
   // cairo_surface_destroy(card_surface);
 }
 
-void FreecellGame::updateCardFragments(AnimatedCard &card) {
-  if (!card.exploded)
-    return;
-
+void FreecellGame::updateCardFragments() {
   GtkAllocation allocation;
   gtk_widget_get_allocation(game_area_, &allocation);
 
-  // Simple approach: just update existing fragments without creating new ones
-  for (auto &fragment : card.fragments) {
-    if (!fragment.active)
-      continue;
-
-    // Update position
-    fragment.x += fragment.velocity_x;
-    fragment.y += fragment.velocity_y;
-    fragment.velocity_y += GRAVITY;
-
-    // Update rotation
-    fragment.rotation += fragment.rotation_velocity;
-
-    // Check if fragment is in the lower part of the screen for potential "bounce" effect
-    const double min_height = allocation.height * 0.5;
-    if (fragment.y > min_height && fragment.y < allocation.height - fragment.height &&
-        fragment.velocity_y > 0 && // Only when moving downward
-        (rand() % 1000 < 5)) { // 0.5% chance per frame
-      
-      // Instead of creating new fragments, just give this one an upward boost
-      // and maybe change its direction slightly
-      fragment.velocity_y = -fragment.velocity_y * 0.8; // Reverse with reduced energy
-      
-      // Add a slight horizontal randomization
-      fragment.velocity_x += (rand() % 11 - 5); // -5 to +5 adjustment
-      
-      // Increase rotation for visual effect
-      fragment.rotation_velocity *= 1.5;
-      
-      // Play a sound for the "bounce"
-      playSound(GameSoundEvent::Firework);
-    }
-    
-    // Check if fragment is off screen
-    if (fragment.x < -fragment.width || fragment.x > allocation.width ||
-        fragment.y > allocation.height + fragment.height) {
-      // Free the surface if it exists
-      if (fragment.surface) {
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-      }
-      fragment.active = false;
-    }
-  }
+  // One firework for however many fragments bounced this tick
+  if (fragments_.update(GRAVITY, allocation.width, allocation.height) > 0)
+    playSound(GameSoundEvent::Firework);
 }
 
-void FreecellGame::drawCardFragment(cairo_t *cr, const CardFragment &fragment) {
-  // Skip inactive fragments or those without a surface
-  if (!fragment.active) {
+void FreecellGame::drawCardFragment(cairo_t *cr, size_t index) {
+  // The tag is the card's id and which of its cells the fragment is
+  const uint32_t cells = FRAGMENT_GRID * FRAGMENT_GRID;
+  uint32_t tag = fragments_.tag(index);
+  cairo_surface_t *surface = card_surface_cache_.get(int(tag / cells));
+  if (!surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
     return;
-  }
-
-  if (!fragment.surface) {
+  int cell = int(tag % cells);
+
+  double x = fragments_.x(index);
+  double y = fragments_.y(index);
+  double width = fragments_.width(index);
+  double height = fragments_.height(index);
+  double rotation = fragments_.rotation(index);
+  render::Rect bounds = render::rotatedBounds(x, y, width, height, rotation);
+  render::DrawKey key;
+  key.add(int(ITEM_FRAGMENT)).add(static_cast<const void *>(surface)).add(cell);
+  key.add(x).add(y).add(rotation);
+  if (!damage_.item(bounds, key))
     return;
-  }
-
-  // Check surface status before using it
-  if (cairo_surface_status(fragment.surface) != CAIRO_STATUS_SUCCESS) {
-    return;
-  }
 
   // Save the current transformation state
   cairo_save(cr);
 
   // Move to the center of the fragment for rotation
-  cairo_translate(cr, fragment.x + fragment.width / 2,
-                  fragment.y + fragment.height / 2);
-  cairo_rotate(cr, fragment.rotation);
-
-  // Draw the fragment
-  cairo_set_source_surface(cr, fragment.surface, -fragment.width / 2,
-                           -fragment.height / 2);
+  cairo_translate(cr, x + width / 2, y + height / 2);
+  cairo_rotate(cr, rotation);
+
+  // Draw the fragment's cell of the card, the card placed so the cell
+  // lies under the rectangle filled. While a rescale is pending the cached
+  // surface is not the card's current size, so the cell is scaled to the
+  // fragment as paintCard() scales a whole card.
+  double cell_width =
+      double(cairo_image_surface_get_width(surface)) / FRAGMENT_GRID;
+  double cell_height =
+      double(cairo_image_surface_get_height(surface)) / FRAGMENT_GRID;
+  cairo_scale(cr, width / cell_width, height / cell_height);
+  cairo_set_source_surface(cr, surface,
+                           -cell_width / 2 - cell % FRAGMENT_GRID * cell_width,
+                           -cell_height / 2 -
+                               cell / FRAGMENT_GRID * cell_height);
 
   // Only proceed if setting the source was successful
   if (cairo_status(cr) == CAIRO_STATUS_SUCCESS) {
-    cairo_rectangle(cr, -fragment.width / 2, -fragment.height / 2,
-                    fragment.width, fragment.height);
+    cairo_rectangle(cr, -cell_width / 2, -cell_height / 2, cell_width,
+                    cell_height);
     cairo_fill(cr);
   }
 
@@ -401,7 +328,12 @@ void FreecellGame::stopWinAnimation() {
     animation_timer_id_ = 0;
   }
 
+  fragments_.clear();
+
   animated_cards_.clear();
+#ifdef USEOPENGL
+  explosions_gl_.clear();
+#endif
   freecell_animation_cards_.clear();
   cards_launched_ = 0;
   launch_timer_ = 0;
@@ -673,16 +605,8 @@ gboolean FreecellGame::onAutoFinishTick(gpointer data) {
 }
 
 cairo_surface_t* FreecellGame::getCardSurface(const cardlib::Card& card) {
-  std::string key = std::to_string(static_cast<int>(card.suit)) +
-                    std::to_string(static_cast<int>(card.rank));
-  auto it = card_surface_cache_.find(key);
-  
-  if (it != card_surface_cache_.end()) {
-    return it->second;
-  }
-  
-  // Return nullptr if not found
-  return nullptr;
+  // Null if not found
+  return card_surface_cache_.get(render::cardId(card));
 }
 
 void FreecellGame::startWinAnimation() {
@@ -771,6 +695,7 @@ void FreecellGame::startWinAnimation() {
 // Main drawing callback function
 gboolean FreecellGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
   FreecellGame *game = static_cast<FreecellGame *>(data);
+  game->frame_stats_.begin();
 
   // Get the widget dimensions
   GtkAllocation allocation;
@@ -778,49 +703,149 @@ gboolean FreecellGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
   
   // Store allocation for use in highlighting
   game->allocation = allocation;
-
-  // Initialize or resize the buffer surface if needed
-  game->initializeDrawBuffer(allocation.width, allocation.height);
-  
-  // Clear buffer with green background
-  cairo_set_source_rgb(game->buffer_cr_, 0.0, 0.5, 0.0);
-  cairo_paint(game->buffer_cr_);
-
-  // Draw all game elements to the buffer
-  game->drawFreecells();
-  game->drawFoundationPiles();
-  game->drawTableau();
-  game->drawDraggedCards();
-  game->drawAnimations();
-  
-  // Draw keyboard navigation highlights if active
-  if (game->keyboard_navigation_active_ || game->keyboard_selection_active_) {
-    game->highlightSelectedCard(game->buffer_cr_);
+  int width = allocation.width;
+  int height = allocation.height;
+
+  // Only what GTK asks for is repainted, the damage queued since the last
+  // frame; the buffer keeps the rest. A new buffer is painted whole.
+  std::vector<render::Rect> clip;
+  if (game->initializeDrawBuffer(width, height) ||
+      game->damage_.fullRedraw()) {
+    game->damage_.invalidate();
+    clip.emplace_back(0, 0, width, height);
+  } else {
+    clip = render::clipRects(cr);
   }
 
+  game->updateStaticLayer(width, height);
+  cairo_save(game->buffer_cr_);
+  render::clipTo(game->buffer_cr_, clip);
+  game->damage_.paintOverLayer(width, height, clip);
+  game->drawBoard();
+  cairo_restore(game->buffer_cr_);
+  // Changes made without a refreshDisplay() show up next frame
+  render::queueDamage(widget, game->damage_.finish());
+
   // Copy buffer to window
   cairo_set_source_surface(cr, game->buffer_surface_, 0, 0);
   cairo_paint(cr);
 
+  game->frame_stats_.end(render::totalArea(clip), (long long)width * height);
   return TRUE;
 }
 
-// Initialize or resize the drawing buffer
-void FreecellGame::initializeDrawBuffer(int width, int height) {
-  // Create or resize buffer surface if needed
-  if (!buffer_surface_ ||
-      cairo_image_surface_get_width(buffer_surface_) != width ||
-      cairo_image_surface_get_height(buffer_surface_) != height) {
-    
-    if (buffer_surface_) {
-      cairo_surface_destroy(buffer_surface_);
-      cairo_destroy(buffer_cr_);
+// Everything the Cairo view shows, in drawing order. onDraw() runs it to
+// paint and queueRedraw() to record what changed, so every piece goes
+// through damage_.item() and is painted only if that says so.
+void FreecellGame::drawBoard() {
+  drawStaticLayer();
+  // A painted frame takes the settled board from its cached layer
+  if (damage_.painting()) {
+    static_layer_.blit(buffer_cr_);
+  }
+
+  // Draw the moving cards over it
+  drawDraggedCards();
+  drawAnimations();
+  
+  // Draw keyboard navigation highlights if active
+  if (keyboard_navigation_active_ || keyboard_selection_active_) {
+    highlightSelectedCard(buffer_cr_);
+  }
+}
+
+// The static layer: the felt, cells and piles, without the cards being
+// dragged or animated
+void FreecellGame::drawStaticLayer() {
+  int width = cairo_image_surface_get_width(buffer_surface_);
+  int height = cairo_image_surface_get_height(buffer_surface_);
+  damage_.beginLayer();
+
+  // Clear buffer with green background
+  if (damage_.item(render::Rect(0, 0, width, height),
+                   render::DrawKey().add(int(ITEM_BACKGROUND)))) {
+    cairo_set_source_rgb(buffer_cr_, 0.0, 0.5, 0.0);
+    cairo_paint(buffer_cr_);
+  }
+
+  // Draw all game elements to the buffer
+  drawFreecells();
+  drawFoundationPiles();
+  drawTableau();
+
+  damage_.endLayer();
+}
+
+// Repaints what changed in the cached static layer since it was last
+// painted, made anew after a resize. While cards are dragged or animated
+// over a settled board this finds nothing to do.
+void FreecellGame::updateStaticLayer(int width, int height) {
+  if (static_layer_.resize(width, height)) {
+    damage_.invalidateLayer();
+  }
+  damage_.recordLayer(width, height);
+  drawStaticLayer();
+  std::vector<render::Rect> stale = damage_.finish();
+  if (stale.empty()) {
+    return;
+  }
+
+  // The pile drawing paints into buffer_cr_
+  cairo_t *frame_cr = buffer_cr_;
+  buffer_cr_ = static_layer_.cr();
+  cairo_save(buffer_cr_);
+  render::clipTo(buffer_cr_, stale);
+  damage_.paintLayer(width, height, stale);
+  drawStaticLayer();
+  damage_.finish();
+  cairo_restore(buffer_cr_);
+  buffer_cr_ = frame_cr;
+}
+
+// Queues a redraw of what changed since the last frame
+void FreecellGame::queueRedraw() {
+  if (rendering_engine_ == RenderingEngine::OPENGL) {
+    if (gl_area_) {
+      gtk_widget_queue_draw(gl_area_);
     }
+    return;
+  }
+  if (!game_area_) {
+    return;
+  }
 
-    buffer_surface_ = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height);
-    buffer_cr_ = cairo_create(buffer_surface_);
+  // Until the buffer matches the window the next frame paints it whole
+  gtk_widget_get_allocation(game_area_, &allocation);
+  if (!buffer_surface_ ||
+      cairo_image_surface_get_width(buffer_surface_) != allocation.width ||
+      cairo_image_surface_get_height(buffer_surface_) != allocation.height) {
+    gtk_widget_queue_draw(game_area_);
+    return;
   }
+
+  damage_.record(allocation.width, allocation.height);
+  drawBoard();
+  render::queueDamage(game_area_, damage_.finish());
+}
+
+// Initialize or resize the drawing buffer. True if it was (re)created, and
+// so holds nothing yet.
+bool FreecellGame::initializeDrawBuffer(int width, int height) {
+  if (buffer_surface_ &&
+      cairo_image_surface_get_width(buffer_surface_) == width &&
+      cairo_image_surface_get_height(buffer_surface_) == height) {
+    return false;
+  }
+
+  if (buffer_surface_) {
+    cairo_surface_destroy(buffer_surface_);
+    cairo_destroy(buffer_cr_);
+  }
+
+  buffer_surface_ = cairo_image_surface_create(
+      CAIRO_FORMAT_ARGB32, width, height);
+  buffer_cr_ = cairo_create(buffer_surface_);
+  return true;
 }
 
 // Draw the freecells (4 cells at the top-left)
@@ -1153,6 +1178,11 @@ void FreecellGame::drawAnimations() {
       drawAnimatedCard(buffer_cr_, foundation_move_card_);
 #endif    
   }
+
+  // Draw the cards of a solution move in flight
+  for (const auto &anim_card : solution_cards_) {
+    drawAnimatedCard(buffer_cr_, anim_card);
+  }
   
   // Draw win animation if active
   if (win_animation_active_) {
@@ -1163,38 +1193,25 @@ void FreecellGame::drawAnimations() {
 // Draw the win animation (exploding cards)
 void FreecellGame::drawWinAnimation() {
   for (const auto &anim_card : animated_cards_) {
-    if (!anim_card.active) {
+    if (!anim_card.active || anim_card.exploded) {
       continue;
     }
 
-    if (!anim_card.exploded) {
-      // Draw the whole card with rotation
+    // Draw the whole card with rotation
 #ifdef USEOPENGL
-      if (rendering_engine_ == RenderingEngine::OPENGL) {
-        drawAnimatedCard_gl(anim_card, cardShaderProgram_gl_, cardQuadVAO_gl_);
-      } else {
-        drawAnimatedCard(buffer_cr_, anim_card);
-      }
-#else
-        drawAnimatedCard(buffer_cr_, anim_card);
-#endif      
+    if (rendering_engine_ == RenderingEngine::OPENGL) {
+      drawAnimatedCard_gl(anim_card, cardShaderProgram_gl_, cardQuadVAO_gl_);
     } else {
-      // Draw all the fragments for this card
-      for (const auto &fragment : anim_card.fragments) {
-        if (fragment.active) {
-#ifdef USEOPENGL
-          if (rendering_engine_ == RenderingEngine::OPENGL) {
-            drawCardFragment_gl(fragment, anim_card, cardShaderProgram_gl_, cardQuadVAO_gl_);
-          } else {
-            drawCardFragment(buffer_cr_, fragment);
-          }
-#else          
-            drawCardFragment(buffer_cr_, fragment);
-#endif
-        }
-      }
+      drawAnimatedCard(buffer_cr_, anim_card);
     }
+#else
+    drawAnimatedCard(buffer_cr_, anim_card);
+#endif
   }
+
+  // Then the fragments of those that exploded
+  for (size_t i = 0; i < fragments_.size(); i++)
+    drawCardFragment(buffer_cr_, i);
 }
 
 void FreecellGame::launchCardFromFreecell() {
@@ -17,44 +17,6 @@
 #define EXPLOSION_THRESHOLD_MAX 0.7
 
 // OpenGL 3.4 Shader sources
-static const char *VERTEX_SHADER_GL = R"(
-    #version 330 core
-    layout(location = 0) in vec2 position;
-    layout(location = 1) in vec2 texCoord;
-    
-    uniform mat4 projection;
-    uniform mat4 view;
-    uniform mat4 model;
-    
-    out VS_OUT {
-        vec2 texCoord;
-    } vs_out;
-    
-    void main()
-    {
-        gl_Position = projection * view * model * vec4(position, 0.0, 1.0);
-        vs_out.texCoord = texCoord;
-    }
-)";
-
-static const char *FRAGMENT_SHADER_GL = R"(
-    #version 330 core
-    in VS_OUT {
-        vec2 texCoord;
-    } fs_in;
-    
-    uniform sampler2D cardTexture;
-    uniform float alpha;
-    
-    out vec4 FragColor;
-    
-    void main()
-    {
-        vec4 texColor = texture(cardTexture, fs_in.texCoord);
-        FragColor = vec4(texColor.rgb, texColor.a * alpha);
-    }
-)";
-
 static const char *FRAGMENT_SHADER_SIMPLE_GL = R"(
     #version 330 core
     
@@ -281,72 +243,18 @@ void FreecellGame::launchNextCard_gl() {
 void FreecellGame::explodeCard_gl(AnimatedCard &card) {
     card.exploded = true;
     playSound(GameSoundEvent::Firework);
-    card.fragments.clear();
-    const int grid_size = 4;
-    const int fragment_width = current_card_width_ / grid_size;
-    const int fragment_height = current_card_height_ / grid_size;
-    for (int row = 0; row < grid_size; row++) {
-        for (int col = 0; col < grid_size; col++) {
-            CardFragment fragment;
-            fragment.x = card.x + col * fragment_width;
-            fragment.y = card.y + row * fragment_height;
-            fragment.width = fragment_width;
-            fragment.height = fragment_height;
-            double center_x = card.x + current_card_width_ / 2;
-            double center_y = card.y + current_card_height_ / 2;
-            double fragment_center_x = fragment.x + fragment_width / 2;
-            double fragment_center_y = fragment.y + fragment_height / 2;
-            double dir_x = fragment_center_x - center_x;
-            double dir_y = fragment_center_y - center_y;
-            double magnitude = sqrt(dir_x * dir_x + dir_y * dir_y);
-            if (magnitude > 0.001) {
-                dir_x /= magnitude;
-                dir_y /= magnitude;
-            } else {
-                double rand_angle = 2.0 * G_PI * (rand() % 1000) / 1000.0;
-                dir_x = cos(rand_angle);
-                dir_y = sin(rand_angle);
-            }
-            double speed = 12.0 + (rand() % 8);
-            double upward_bias = -15.0 - (rand() % 10);
-            fragment.velocity_x = dir_x * speed + (rand() % 10 - 5);
-            fragment.velocity_y = dir_y * speed + upward_bias;
-            fragment.rotation = card.rotation;
-            fragment.rotation_velocity = (rand() % 60 - 30) / 5.0;
-            fragment.surface = nullptr;
-            fragment.active = true;
-            
-            // Store grid position in target_x and target_y for texture coordinate calculation
-            fragment.target_x = col / (double)grid_size;
-            fragment.target_y = row / (double)grid_size;
-            
-            card.fragments.push_back(fragment);
-        }
-    }
-}
-
-void FreecellGame::updateCardFragments_gl(AnimatedCard &card) {
-  for (auto &fragment : card.fragments) {
-    if (!fragment.active)
-      continue;
 
-    // Update position
-    fragment.x += fragment.velocity_x;
-    fragment.y += fragment.velocity_y;
-    fragment.velocity_y += GRAVITY;
-
-    // Update rotation
-    fragment.rotation += fragment.rotation_velocity;
-
-    // Check if fragment is off screen
+    // The GPU works the fragments out from here on (see gl_explosions.h);
+    // the card itself takes no more updates
     GtkAllocation allocation;
-    gtk_widget_get_allocation(gl_area_, &allocation);
-    
-    if (fragment.x < -50 || fragment.x > allocation.width + 50 ||
-        fragment.y > allocation.height + 50) {
-      fragment.active = false;
-    }
-  }
+    gtk_widget_get_allocation(game_area_, &allocation);
+    int id = card.face_up ? render::cardId(card.card)
+                          : card_batch_gl_.backId();
+    explosions_gl_.launch(card_batch_gl_.layer(id), card.x, card.y,
+                          current_card_width_, current_card_height_,
+                          card.rotation, GRAVITY, 1.0f, allocation.width,
+                          allocation.height);
+    card.active = false;
 }
 
 // ============================================================================
@@ -573,133 +481,25 @@ void FreecellGame::processNextAutoFinishMove_gl() {
 // DRAWING FUNCTIONS - OpenGL 3.4 Version
 // ============================================================================
 
-void FreecellGame::drawAnimatedCard_gl(const AnimatedCard &anim_card, GLuint shaderProgram, GLuint VAO) {
+void FreecellGame::drawAnimatedCard_gl(const AnimatedCard &anim_card,
+                                       GLuint, GLuint) {
   if (!anim_card.active) {
     return;
   }
 
-  glUseProgram(shaderProgram);
-
-  // Apply the same rotation logic as Cairo's drawAnimatedCard()
-  glm::mat4 model = glm::mat4(1.0f);
-  
-  // Move to card center for rotation
-  model = glm::translate(model, glm::vec3(anim_card.x + current_card_width_ / 2.0f,
-                                          anim_card.y + current_card_height_ / 2.0f, 0.0f));
-  // Rotate around center
-  model = glm::rotate(model, static_cast<float>(anim_card.rotation), glm::vec3(0.0f, 0.0f, 1.0f));
-  // Translate back
-  model = glm::translate(model, glm::vec3(-current_card_width_ / 2.0f,
-                                          -current_card_height_ / 2.0f, 0.0f));
-  // Scale for card size
-  model = glm::scale(model, glm::vec3((float)current_card_width_, (float)current_card_height_, 1.0f));
-
-  GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-  glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-  // Get texture (reuse logic from drawCard_gl)
-  GLuint texture = cardBackTexture_gl_;
-  if (anim_card.face_up) {
-    auto card_image = deck_.getCardImage(anim_card.card);
-    if (card_image && !card_image->data.empty()) {
-      std::string card_key = std::to_string((int)anim_card.card.suit) + "_" + std::to_string((int)anim_card.card.rank);
-      auto it = cardTextures_gl_.find(card_key);
-      
-      if (it != cardTextures_gl_.end()) {
-        texture = it->second;
-      } else {
-        texture = loadTextureFromMemory(card_image->data);
-        if (texture != 0) {
-          cardTextures_gl_[card_key] = texture;
-        } else {
-          texture = cardBackTexture_gl_;
-        }
-      }
-    }
-  }
-
-  // Set texture and alpha
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture);
-  GLint texLoc = glGetUniformLocation(shaderProgram, "cardTexture");
-  glUniform1i(texLoc, 0);
-  
-  GLint alphaLoc = glGetUniformLocation(shaderProgram, "alpha");
-  glUniform1f(alphaLoc, 1.0f);
-
-  // Draw the card
-  glBindVertexArray(VAO);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-}
-
-void FreecellGame::drawCardFragment_gl(const CardFragment &fragment, const AnimatedCard &card, GLuint shaderProgram, GLuint VAO) {
-  if (!fragment.active) {
-    return;
-  }
-
-  glUseProgram(shaderProgram);
-
-  // Get the card texture (same as the original card)
-  GLuint texture = cardBackTexture_gl_;
-  if (card.face_up) {
-    auto card_image = deck_.getCardImage(card.card);
-    if (card_image && !card_image->data.empty()) {
-      std::string card_key = std::to_string((int)card.card.suit) + "_" + std::to_string((int)card.card.rank);
-      auto it = cardTextures_gl_.find(card_key);
-      
-      if (it != cardTextures_gl_.end()) {
-        texture = it->second;
-      } else {
-        texture = loadTextureFromMemory(card_image->data);
-        if (texture != 0) {
-          cardTextures_gl_[card_key] = texture;
-        } else {
-          texture = cardBackTexture_gl_;
-        }
-      }
-    }
-  }
-
-  // Bind texture
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture);
-  GLint texLoc = glGetUniformLocation(shaderProgram, "cardTexture");
-  glUniform1i(texLoc, 0);
-
-  // Set up model matrix with position, rotation, and size
-  glm::mat4 model = glm::mat4(1.0f);
-  model = glm::translate(model, glm::vec3(fragment.x, fragment.y, 0.0f));
-  model = glm::rotate(model, static_cast<float>(fragment.rotation), glm::vec3(0.0f, 0.0f, 1.0f));
-  model = glm::scale(model, glm::vec3(fragment.width, fragment.height, 1.0f));
-
-  GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-  glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-  // Set alpha to full opacity
-  GLint alphaLoc = glGetUniformLocation(shaderProgram, "alpha");
-  glUniform1f(alphaLoc, 1.0f);
-
-  // Draw fragment quad
-  glBindVertexArray(VAO);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  // Queued for the frame's one draw (see renderFrame_gl()), turned about
+  // its centre as Cairo's drawAnimatedCard() turns it
+  int id = anim_card.face_up ? render::cardId(anim_card.card)
+                             : card_batch_gl_.backId();
+  card_batch_gl_.add(id, anim_card.x, anim_card.y, current_card_width_,
+                     current_card_height_, anim_card.rotation);
 }
 
 void FreecellGame::drawWinAnimation_gl(GLuint shaderProgram, GLuint VAO) {
+  // Exploded cards are explosions_gl_'s, drawn after the batch
   for (const auto &anim_card : animated_cards_) {
-    if (!anim_card.active) {
-      continue;
-    }
-
-    if (!anim_card.exploded) {
-      // Draw the whole card with rotation
+    if (anim_card.active && !anim_card.exploded) {
       drawAnimatedCard_gl(anim_card, shaderProgram, VAO);
-    } else {
-      // Draw all the fragments for this card
-      for (const auto &fragment : anim_card.fragments) {
-        if (fragment.active) {
-          drawCardFragment_gl(fragment, anim_card, shaderProgram, VAO);
-        }
-      }
     }
   }
 }
@@ -933,15 +733,20 @@ GLuint FreecellGame::setupShaders_gl() {
         return 0;
     }
     
-    GLuint program = createShaderProgram_gl(VERTEX_SHADER_GL, FRAGMENT_SHADER_GL);
-    
-    if (program == 0) {
+    // The card program is the batch's (see gl_card_batch.h)
+    if (!card_batch_gl_.create()) {
         std::cerr << "✗ Failed to create shader program" << std::endl;
         return 0;
     }
     
+    // The win animation's explosions (see gl_explosions.h)
+    if (!explosions_gl_.create()) {
+        std::cerr << "✗ Failed to create explosion shader program" << std::endl;
+        return 0;
+    }
+    
     std::cout << "✓ Shaders setup complete" << std::endl;
-    return program;
+    return card_batch_gl_.program();
 }
 
 static GLuint compileShader_gl_static(const char *source, GLenum shaderType) {
@@ -1039,47 +844,6 @@ GLuint FreecellGame::createShaderProgram_gl(const char *vertexSrc, const char *f
     return program;
 }
 
-GLuint FreecellGame::loadTextureFromMemory(const std::vector<unsigned char> &data) {
-    if (data.empty()) {
-        std::cerr << "  ✗ Error: Empty image data provided to loadTextureFromMemory" << std::endl;
-        return 0;
-    }
-    
-    int width, height, channels;
-    unsigned char *img_data = stbi_load_from_memory(
-        data.data(), 
-        data.size(), 
-        &width, &height, &channels, 
-        STBI_rgb_alpha
-    );
-    
-    if (!img_data) {
-        std::cerr << "  ✗ Error: Failed to load image from memory: " << stbi_failure_reason() << std::endl;
-        return 0;
-    }
-    
-    //std::cout << "  ✓ Image loaded from memory: " << width << "x" << height << " (" << channels << " channels)" << std::endl;
-    
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    // Upload texture data
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img_data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    
-    stbi_image_free(img_data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    
-    return texture;
-}
-
 GLuint FreecellGame::setupCardQuadVAO_gl() {
     std::cout << "\nSetting up card quad VAO..." << std::endl;
     
@@ -1093,81 +857,11 @@ GLuint FreecellGame::setupCardQuadVAO_gl() {
         return 0;
     }
     
-    static const float quadVertices[] = {
-         0.0f,  0.0f,  0.0f, 0.0f,
-         1.0f,  0.0f,  1.0f, 0.0f,
-         1.0f,  1.0f,  1.0f, 1.0f,
-         0.0f,  1.0f,  0.0f, 1.0f
-    };
-    
-    static const unsigned int indices[] = {
-        0, 1, 2,
-        2, 3, 0
-    };
-    
-    GLuint VAO = 0, VBO = 0, EBO = 0;
-    
-    GLenum err = glGetError();
-    while (err != GL_NO_ERROR) {
-        std::cout << "  Clearing pre-existing GL error: " << err << std::endl;
-        err = glGetError();
-    }
-    
-    std::cout << "  Generating VAO..." << std::endl;
-    glGenVertexArrays(1, &VAO);
-    err = glGetError();
-    if (err != GL_NO_ERROR) {
-        std::cerr << "  ✗ glGenVertexArrays failed with error: " << err << std::endl;
-        return 0;
-    }
+    // The batch's, made with its program in setupShaders_gl(): the quad's
+    // corners come from gl_VertexID, the cards from its instance buffer
+    GLuint VAO = card_batch_gl_.vertexArray();
     if (VAO == 0) {
-        std::cerr << "  ✗ glGenVertexArrays returned invalid VAO (0)" << std::endl;
-        return 0;
-    }
-    std::cout << "    ✓ VAO generated (ID: " << VAO << ")" << std::endl;
-    
-    std::cout << "  Generating VBO..." << std::endl;
-    glGenBuffers(1, &VBO);
-    err = glGetError();
-    if (err != GL_NO_ERROR || VBO == 0) {
-        std::cerr << "  ✗ glGenBuffers(VBO) failed with error: " << err << std::endl;
-        glDeleteVertexArrays(1, &VAO);
-        return 0;
-    }
-    std::cout << "    ✓ VBO generated (ID: " << VBO << ")" << std::endl;
-    
-    std::cout << "  Generating EBO..." << std::endl;
-    glGenBuffers(1, &EBO);
-    err = glGetError();
-    if (err != GL_NO_ERROR || EBO == 0) {
-        std::cerr << "  ✗ glGenBuffers(EBO) failed with error: " << err << std::endl;
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
-        return 0;
-    }
-    std::cout << "    ✓ EBO generated (ID: " << EBO << ")" << std::endl;
-    
-    std::cout << "  Configuring VAO..." << std::endl;
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    
-    err = glGetError();
-    if (err != GL_NO_ERROR) {
-        std::cerr << "  ✗ OpenGL error during VAO configuration: " << err << std::endl;
-        glDeleteBuffers(1, &EBO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+        std::cerr << "✗ Card batch has no VAO - shaders not set up" << std::endl;
         return 0;
     }
     
@@ -1184,70 +878,23 @@ bool FreecellGame::initializeCardTextures_gl() {
     }
     
     try {
-        // CRITICAL FIX: Load the actual card back image from the deck
-        if (auto back_img = deck_.getCardBackImage()) {
-            if (!back_img->data.empty()) {
-                std::cout << "  Loading actual card back image from deck..." << std::endl;
-                cardBackTexture_gl_ = loadTextureFromMemory(back_img->data);
-                if (cardBackTexture_gl_ != 0) {
-                    std::cout << "✓ Card back texture loaded successfully (Texture ID: " 
-                              << cardBackTexture_gl_ << ")" << std::endl;
-                    return true;
-                } else {
-                    std::cerr << "  ⚠ Failed to load card back from memory, creating fallback..." << std::endl;
-                }
-            }
-        }
-        
-        // Fallback: Create a placeholder texture if real card back failed to load
-        const int TEX_WIDTH = 32;
-        const int TEX_HEIGHT = 48;
-        const int TEX_CHANNELS = 4;
-        
-        std::cout << "  Creating fallback placeholder texture (" << TEX_WIDTH << "x" << TEX_HEIGHT << ")..." << std::endl;
-        
-        // Create a nice gray placeholder instead of pure white
-        unsigned char textureData[TEX_WIDTH * TEX_HEIGHT * TEX_CHANNELS];
-        memset(textureData, 200, sizeof(textureData)); // Gray color instead of white
-        
-        GLuint texture = 0;
-        glGenTextures(1, &texture);
-        
-        if (texture == 0) {
-            std::cerr << "  ✗ ERROR: Failed to generate texture object" << std::endl;
-            std::cerr << "    GL Error: " << glGetError() << std::endl;
+        // Every image of the deck, into a layer each of the batch's texture
+        if (!card_batch_gl_.load(*cardAtlas())) {
+            std::cerr << "✗ ERROR: Failed to upload card textures" << std::endl;
             return false;
         }
-        std::cout << "    ✓ Texture object created (ID: " << texture << ")" << std::endl;
         
-        glBindTexture(GL_TEXTURE_2D, texture);
-        
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "  ✗ ERROR: Failed to bind texture: " << err << std::endl;
-            glDeleteTextures(1, &texture);
-            return false;
+        // Fallback: a gray placeholder if the deck has no card back
+        if (!card_batch_gl_.has(render::BACK_ID)) {
+            std::cerr << "  ⚠ No card back in the deck, using a placeholder" << std::endl;
+            card_batch_gl_.fill(render::BACK_ID, 200, 200, 200, 200);
         }
         
-        std::cout << "  Setting texture parameters..." << std::endl;
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        std::cout << "  Uploading texture data..." << std::endl;
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEX_WIDTH, TEX_HEIGHT, 0, 
-                     GL_RGBA, GL_UNSIGNED_BYTE, textureData);
-        
-        err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "  ✗ ERROR: Failed to upload texture data: " << err << std::endl;
-            glDeleteTextures(1, &texture);
-            return false;
-        }
+        // Empty piles: light gray at half opacity, matching Cairo's
+        // RGBA(0.85, 0.85, 0.85, 0.5)
+        card_batch_gl_.fill(render::GLCardBatch::EMPTY_PILE_ID, 216, 216, 216, 127);
         
-        cardBackTexture_gl_ = texture;
-        std::cout << "✓ Card textures initialized successfully (Texture ID: " << texture << ")" << std::endl;
+        std::cout << "✓ Card textures initialized successfully" << std::endl;
         return true;
         
     } catch (const std::exception &e) {
@@ -1268,108 +915,17 @@ void FreecellGame::drawCard_gl(const cardlib::Card &card, int x, int y, bool fac
         return;
     }
     
-    // Default to card back texture
-    GLuint texture = cardBackTexture_gl_;
-    
-    if (face_up) {
-        // Try to get the face-up card image
-        auto card_image = deck_.getCardImage(card);
-        if (card_image && !card_image->data.empty()) {
-            std::string card_key = std::to_string((int)card.suit) + "_" + std::to_string((int)card.rank);
-            auto it = cardTextures_gl_.find(card_key);
-            
-            if (it != cardTextures_gl_.end()) {
-                // Use cached texture
-                texture = it->second;
-            } else {
-                // Load texture and cache it
-                texture = loadTextureFromMemory(card_image->data);
-                if (texture != 0) {
-                    cardTextures_gl_[card_key] = texture;
-                } else {
-                    // Fallback to card back if loading failed
-                    texture = cardBackTexture_gl_;
-                }
-            }
-        }
-    }
-    // For face_down cards, use the default cardBackTexture_gl_ already set above
-    
-    // Draw card at position
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3((float)x, (float)y, 0.0f));
-    model = glm::scale(model, glm::vec3((float)current_card_width_, (float)current_card_height_, 1.0f));
-    
-    GLint modelLoc = glGetUniformLocation(cardShaderProgram_gl_, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    
-    // Set alpha uniform to fully opaque
-    GLint alphaLoc = glGetUniformLocation(cardShaderProgram_gl_, "alpha");
-    glUniform1f(alphaLoc, 1.0f);
-    
-    // Set texture uniform
-    GLint texLoc = glGetUniformLocation(cardShaderProgram_gl_, "cardTexture");
-    glUniform1i(texLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    
-    if (texture != 0) {
-        glBindTexture(GL_TEXTURE_2D, texture);
-    }
-    
-    glBindVertexArray(cardQuadVAO_gl_);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // Queued for the frame's one draw (see renderFrame_gl()). A face the
+    // deck has no image for shows the card back.
+    int id = face_up ? render::cardId(card) : card_batch_gl_.backId();
+    card_batch_gl_.add(id, x, y, current_card_width_, current_card_height_);
 }
 
 void FreecellGame::drawEmptyPile_gl(int x, int y) {
-    // Draw light gray rectangle placeholder for empty pile
-    // This matches Cairo's appearance exactly: RGBA(0.85, 0.85, 0.85, 0.5)
-    
-    // Create light gray texture on first use (static, cached)
-    static GLuint emptyPileTexture = 0;
-    
-    if (emptyPileTexture == 0) {
-        const int WIDTH = 32;
-        const int HEIGHT = 48;
-        
-        unsigned char data[WIDTH * HEIGHT * 4];
-        for (int i = 0; i < WIDTH * HEIGHT * 4; i += 4) {
-            data[i] = (unsigned char)(0.85f * 255);     // R: 0.85
-            data[i + 1] = (unsigned char)(0.85f * 255); // G: 0.85
-            data[i + 2] = (unsigned char)(0.85f * 255); // B: 0.85
-            data[i + 3] = (unsigned char)(0.5f * 255);  // A: 0.5 (50% opacity)
-        }
-        
-        glGenTextures(1, &emptyPileTexture);
-        glBindTexture(GL_TEXTURE_2D, emptyPileTexture);
-        
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WIDTH, HEIGHT, 0,
-                     GL_RGBA, GL_UNSIGNED_BYTE, data);
-    }
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3((float)x, (float)y, 0.0f));
-    model = glm::scale(model, glm::vec3((float)current_card_width_, (float)current_card_height_, 1.0f));
-    
-    GLint modelLoc = glGetUniformLocation(cardShaderProgram_gl_, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    
-    // Set full alpha (transparency handled by texture)
-    GLint alphaLoc = glGetUniformLocation(cardShaderProgram_gl_, "alpha");
-    glUniform1f(alphaLoc, 1.0f);
-    
-    // Draw with light gray placeholder texture
-    GLint texLoc = glGetUniformLocation(cardShaderProgram_gl_, "cardTexture");
-    glUniform1i(texLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    
-    glBindTexture(GL_TEXTURE_2D, emptyPileTexture);
-    glBindVertexArray(cardQuadVAO_gl_);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // Light gray placeholder matching Cairo's, a layer of the card texture
+    // (see initializeCardTextures_gl())
+    card_batch_gl_.add(render::GLCardBatch::EMPTY_PILE_ID, x, y,
+                       current_card_width_, current_card_height_);
 }
 
 // ============================================================================
@@ -1392,6 +948,9 @@ void FreecellGame::renderFrame_gl() {
     gtk_widget_get_allocation(gl_area_, &allocation);
     this->allocation = allocation;  // Save to member variable for drawing functions
     
+    // GTK's GL area may have bound anything since the last frame
+    render_state_gl_.beginFrame();
+    
     // Clear screen
     glClearColor(0.0f, 0.5f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1399,28 +958,15 @@ void FreecellGame::renderFrame_gl() {
     // Set viewport to match actual window size
     glViewport(0, 0, allocation.width, allocation.height);
     
-    // Setup matrices
-    glUseProgram(cardShaderProgram_gl_);
-    
-    glm::mat4 projection = glm::ortho(0.0f, (float)allocation.width, 
-                                      (float)allocation.height, 0.0f, -1.0f, 1.0f);
-    GLint projLoc = glGetUniformLocation(cardShaderProgram_gl_, "projection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-    
-    glm::mat4 view = glm::mat4(1.0f);
-    GLint viewLoc = glGetUniformLocation(cardShaderProgram_gl_, "view");
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    
-    // Enable blending for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // The cards below are only queued in card_batch_gl_, in the order
+    // they stack: piles, animations, then dragged cards
     
     // Draw all game piles (foundation, freecells, tableau, etc.)
     drawFreecells_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
     drawFoundationPiles_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
     drawTableau_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
     
-    // Draw animations if active (these are drawn on top with blending still enabled)
+    // Draw animations if active (these are drawn on top)
     if (win_animation_active_) {
         drawWinAnimation_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
     }
@@ -1430,10 +976,20 @@ void FreecellGame::renderFrame_gl() {
     if (foundation_move_animation_active_) {
         drawFoundationAnimation_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
     }
+    for (const auto &anim_card : solution_cards_) {
+        drawAnimatedCard_gl(anim_card, cardShaderProgram_gl_, cardQuadVAO_gl_);
+    }
     
     // Draw dragged cards overlay
     drawDraggedCards_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
     
+    // One instanced draw for all of them, over the actual window size
+    card_batch_gl_.draw(render_state_gl_, allocation.width, allocation.height);
+    
+    // The win animation's exploded cards, worked out on the GPU
+    explosions_gl_.draw(render_state_gl_, card_batch_gl_.texture(),
+                        allocation.width, allocation.height);
+    
     // Draw keyboard navigation highlight if active
     if (keyboard_navigation_active_ && !dragging_ &&
         !deal_animation_active_ && !win_animation_active_ &&
@@ -1441,8 +997,9 @@ void FreecellGame::renderFrame_gl() {
         highlightSelectedCard_gl();
     }
     
-    // Disable blending after drawing
-    glDisable(GL_BLEND);
+    // Blending off and the vertex array unbound for GTK; with
+    // SOLITAIRE_FRAME_STATS set, the state changes are counted in
+    render_state_gl_.endFrame();
 }
 
 // ============================================================================
@@ -1450,21 +1007,17 @@ void FreecellGame::renderFrame_gl() {
 // ============================================================================
 
 void FreecellGame::cleanupOpenGLResources_gl() {
-    if (cardShaderProgram_gl_ != 0) {
-        glDeleteProgram(cardShaderProgram_gl_);
-        cardShaderProgram_gl_ = 0;
-    }
+    // The card program, VAO and textures are all the batch's
+    card_batch_gl_.destroy();
+    explosions_gl_.destroy();
+    cardShaderProgram_gl_ = 0;
+    cardQuadVAO_gl_ = 0;
     
     if (simpleShaderProgram_gl_ != 0) {
         glDeleteProgram(simpleShaderProgram_gl_);
         simpleShaderProgram_gl_ = 0;
     }
     
-    if (cardQuadVAO_gl_ != 0) {
-        glDeleteVertexArrays(1, &cardQuadVAO_gl_);
-        cardQuadVAO_gl_ = 0;
-    }
-    
     if (cardQuadVBO_gl_ != 0) {
         glDeleteBuffers(1, &cardQuadVBO_gl_);
         cardQuadVBO_gl_ = 0;
@@ -1475,15 +1028,5 @@ void FreecellGame::cleanupOpenGLResources_gl() {
         cardQuadEBO_gl_ = 0;
     }
     
-    if (cardBackTexture_gl_ != 0) {
-        glDeleteTextures(1, &cardBackTexture_gl_);
-        cardBackTexture_gl_ = 0;
-    }
-    
-    for (auto &pair : cardTextures_gl_) {
-        glDeleteTextures(1, &pair.second);
-    }
-    cardTextures_gl_.clear();
-    
     std::cout << "OpenGL resources cleaned up" << std::endl;
 }
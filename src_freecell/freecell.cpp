@@ -18,6 +18,18 @@ std::string getExecutableDir() {
 }
 #endif
 
+namespace {
+
+// A damage tracker key for a card; faces are told apart by suit and rank
+render::DrawKey cardKey(int item, const cardlib::Card &card) {
+  render::DrawKey key;
+  key.add(item);
+  key.add(static_cast<int>(card.suit)).add(static_cast<int>(card.rank));
+  return key;
+}
+
+} // namespace
+
 FreecellGame::FreecellGame()
     : dragging_(false), drag_source_pile_(-1),
       window_(nullptr), game_area_(nullptr), gl_area_(nullptr),
@@ -49,6 +61,20 @@ FreecellGame::FreecellGame()
       requested_engine_(RenderingEngine::CAIRO) {
   srand(time(NULL));  // Seed the random number generator with current time
   current_seed_ = rand();  // Generate random seed
+#ifdef _WIN32
+  seed_index_.open(getExecutableDir() + "\\" + rules::SEED_INDEX_FILENAME);
+#else
+  seed_index_.open(rules::SEED_INDEX_FILENAME);
+#endif
+
+  // One search thread, so hints never compete with the game for the CPU
+  rules::SolverLimits hint_limits;
+  hint_limits.max_nodes = 0;
+  hint_limits.max_seconds = HINT_SOLVE_SECONDS;
+  hint_engine_ = std::make_unique<
+      rules::HintEngine<rules::FreecellState, rules::FreecellSolver>>(
+      hint_limits, 1u, HINT_TABLE_BITS);
+  undo_history_.attachReplay(&replay_);
   initializeSettingsDir();
   
   // Load engine preference and initialize rendering
@@ -61,6 +87,12 @@ FreecellGame::FreecellGame()
 }
 
 FreecellGame::~FreecellGame() {
+  // A search still running posts its result to the main loop when done
+  if (solve_thread_.joinable()) {
+    solve_cancel_ = true;
+    solve_thread_.join();
+    g_idle_remove_by_data(this);
+  }
   cleanupRenderingEngine();
   if (buffer_cr_) {
     cairo_destroy(buffer_cr_);
@@ -74,7 +106,7 @@ FreecellGame::~FreecellGame() {
 void FreecellGame::run(int argc, char **argv) {
   gtk_init(&argc, &argv);
   setupWindow();
-  initializeGame();  // Initialize game after GTK is ready and window exists
+  resumeSavedGame();  // Initialize game after GTK is ready and window exists
   setupGameArea();
   
   // Show all widgets AFTER game is fully initialized
@@ -99,6 +131,13 @@ void FreecellGame::run(int argc, char **argv) {
 }
 
 void FreecellGame::initializeGame() {
+  if (replay_playback_active_) {
+    stopReplayPlayback();
+  }
+  // A solution's cards in flight belong to the old deal
+  solution_cards_.clear();
+  stopSolutionPlayback();
+
   try {
     // Try to find cards.zip in several common locations
     std::vector<std::string> paths;
@@ -383,70 +422,44 @@ void FreecellGame::completeDeal() {
 }
 
 void FreecellGame::drawCard(cairo_t *cr, int x, int y, const cardlib::Card *card) {
-  if (card) {
-    std::string key = std::to_string(static_cast<int>(card->suit)) +
-                    std::to_string(static_cast<int>(card->rank));
-    auto it = card_surface_cache_.find(key);
-
-    if (it == card_surface_cache_.end()) {
-      if (auto img = deck_.getCardImage(*card)) {
-        GError *error = nullptr;
-        GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-
-        if (!gdk_pixbuf_loader_write(loader, img->data.data(), img->data.size(),
-                                   &error)) {
-          if (error)
-            g_error_free(error);
-          g_object_unref(loader);
-          return;
-        }
-
-        if (!gdk_pixbuf_loader_close(loader, &error)) {
-          if (error)
-            g_error_free(error);
-          g_object_unref(loader);
-          return;
-        }
-
-        GdkPixbuf *original_pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-        if (original_pixbuf) {
-          GdkPixbuf *scaled_pixbuf = gdk_pixbuf_scale_simple(
-              original_pixbuf,
-              current_card_width_, // Use current dimensions
-              current_card_height_, GDK_INTERP_BILINEAR);
-
-          if (scaled_pixbuf) {
-            cairo_surface_t *surface = cairo_image_surface_create(
-                CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-            cairo_t *surface_cr = cairo_create(surface);
-
-            gdk_cairo_set_source_pixbuf(surface_cr, scaled_pixbuf, 0, 0);
-            cairo_paint(surface_cr);
-            cairo_destroy(surface_cr);
-
-            card_surface_cache_[key] = surface;
-
-            g_object_unref(scaled_pixbuf);
-          }
-        }
-        g_object_unref(loader);
+  if (!card) {
+    // Draw an empty placeholder
+    drawEmptyPile(cr, x, y);
+    return;
+  }
+  if (damage_.item(
+          render::Rect(x, y, current_card_width_, current_card_height_),
+          cardKey(ITEM_CARD, *card))) {
+    paintCard(cr, x, y, card);
+  }
+}
 
-        it = card_surface_cache_.find(key);
+// drawCard() without the damage tracking, for cards drawn transformed
+void FreecellGame::paintCard(cairo_t *cr, int x, int y, const cardlib::Card *card) {
+  if (card) {
+    int id = render::cardId(*card);
+    cairo_surface_t *surface = card_surface_cache_.get(id);
+
+    if (!surface) {
+      const render::CardAtlas &atlas = *cardAtlas();
+      if (const render::Rect *region = atlas.find(id)) {
+        surface = card_surface_cache_[id] = render::CardScaler::scale(
+            atlas, *region, current_card_width_, current_card_height_);
       }
     }
 
-    if (it != card_surface_cache_.end()) {
+    if (surface) {
       // Scale the surface to the current card dimensions
       cairo_save(cr);
       cairo_scale(cr,
                   (double)current_card_width_ /
-                      cairo_image_surface_get_width(it->second),
+                      cairo_image_surface_get_width(surface),
                   (double)current_card_height_ /
-                      cairo_image_surface_get_height(it->second));
-      cairo_set_source_surface(cr, it->second,
-                               x * cairo_image_surface_get_width(it->second) /
+                      cairo_image_surface_get_height(surface));
+      cairo_set_source_surface(cr, surface,
+                               x * cairo_image_surface_get_width(surface) /
                                    current_card_width_,
-                               y * cairo_image_surface_get_height(it->second) /
+                               y * cairo_image_surface_get_height(surface) /
                                    current_card_height_);
       cairo_paint(cr);
       cairo_restore(cr);
@@ -458,6 +471,12 @@ void FreecellGame::drawCard(cairo_t *cr, int x, int y, const cardlib::Card *card
 }
 
 void FreecellGame::drawEmptyPile(cairo_t *cr, int x, int y) {
+  if (!damage_.item(render::pixelBounds(x, y, current_card_width_,
+                                        current_card_height_, 1),
+                    render::DrawKey().add(int(ITEM_EMPTY_PILE)))) {
+    return;
+  }
+
   // Draw a placeholder for an empty pile (cell or foundation)
   cairo_save(cr);
   
@@ -488,6 +507,15 @@ void FreecellGame::drawAnimatedCard(cairo_t *cr, const AnimatedCard &anim_card)
   if (!anim_card.active)
     return;
 
+  // Between whole pixels a card looks different too
+  render::Rect bounds =
+      render::rotatedBounds(anim_card.x, anim_card.y, current_card_width_,
+                            current_card_height_, anim_card.rotation);
+  render::DrawKey key = cardKey(ITEM_ANIMATED_CARD, anim_card.card);
+  key.add(anim_card.x).add(anim_card.y).add(anim_card.rotation);
+  if (!damage_.item(bounds, key))
+    return;
+
   // Draw the card with rotation
   cairo_save(cr);
 
@@ -498,7 +526,7 @@ void FreecellGame::drawAnimatedCard(cairo_t *cr, const AnimatedCard &anim_card)
   cairo_translate(cr, -current_card_width_ / 2, -current_card_height_ / 2);
 
   // Draw the card
-  drawCard(cr, 0, 0, &anim_card.card);
+  paintCard(cr, 0, 0, &anim_card.card);
 
   cairo_restore(cr);
 }
@@ -593,6 +621,7 @@ void FreecellGame::setupCairoArea() {
           CAIRO_FORMAT_ARGB32, allocation->width, allocation->height);
       game->buffer_cr_ = cairo_create(game->buffer_surface_);
 
+      game->damage_.invalidate();
       gtk_widget_queue_draw(widget);
     }),
     this);
@@ -702,6 +731,58 @@ void FreecellGame::setupMenuBar() {
                   this);
   gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), autoFinishItem);
 
+  // Solve option
+  GtkWidget *solveItem = gtk_menu_item_new_with_mnemonic("_Solve from Current Position");
+  g_signal_connect(G_OBJECT(solveItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<FreecellGame *>(data)->solveFromCurrentPosition();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), solveItem);
+
+  // Hint option
+  GtkWidget *hintItem = gtk_menu_item_new_with_mnemonic("_Hint (H)");
+  g_signal_connect(G_OBJECT(hintItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<FreecellGame *>(data)->showHint();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), hintItem);
+
+  // Undo and redo options
+  GtkWidget *undoItem = gtk_menu_item_new_with_mnemonic("_Undo (Ctrl+Z)");
+  g_signal_connect(G_OBJECT(undoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<FreecellGame *>(data)->undoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), undoItem);
+
+  GtkWidget *redoItem = gtk_menu_item_new_with_mnemonic("_Redo (Ctrl+Y)");
+  g_signal_connect(G_OBJECT(redoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<FreecellGame *>(data)->redoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), redoItem);
+
+  // Replay options
+  GtkWidget *saveReplayItem = gtk_menu_item_new_with_mnemonic("Save Re_play...");
+  g_signal_connect(G_OBJECT(saveReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<FreecellGame *>(data)->saveReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), saveReplayItem);
+
+  GtkWidget *openReplayItem = gtk_menu_item_new_with_mnemonic("_Open Replay...");
+  g_signal_connect(G_OBJECT(openReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<FreecellGame *>(data)->openReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), openReplayItem);
+
   // Enter Seed option
   GtkWidget *seedItem = gtk_menu_item_new_with_label("Enter Seed...");
   g_signal_connect(G_OBJECT(seedItem), "activate", 
@@ -924,7 +1005,11 @@ const char *markup =
     "- Right-click or Spacebar to auto-move cards to foundations\n"
     "- Arrow keys to navigate between piles\n"
     "- Enter to select/place cards\n"
-    "- 'F' to auto-finish the game\n\n"
+    "- 'F' to auto-finish the game\n"
+    "- 'H' for a hint; Enter plays the suggested move\n"
+    "- Ctrl+Z to undo a move, Ctrl+Y to redo it\n"
+    "- While a replay plays: Space pauses, Left and Right step, Home and End "
+    "jump to the start and the end, Escape stops and lets you play on\n\n"
     "STRATEGY TIPS:\n"
     "1. Create empty columns early in the game\n"
     "2. Move Aces and low cards to foundations when safe\n"
@@ -966,13 +1051,21 @@ const char *markup =
                         "<b>F11</b> - Toggle Fullscreen\n"
                         "<b>Ctrl+N</b> - New Game\n"
                         "<b>Ctrl+R</b> - Restart Game\n"
+                        "<b>Ctrl+Z</b> - Undo\n"
+                        "<b>Ctrl+Y</b> - Redo\n"
                         "<b>Ctrl+L</b> - Load Custom Deck\n"
                         "<b>Ctrl+Q</b> - Quit\n"
                         "<b>Ctrl+H</b> - Help\n"
                         "<b>Arrow Keys</b> - Navigate piles\n"
                         "<b>Enter</b> - Select or place cards\n"
                         "<b>Esc</b> - Cancel selection\n"
-                        "<b>F</b> - Auto-Finish (find best moves)";
+                        "<b>F</b> - Auto-Finish (find best moves)\n"
+                        "<b>H</b> - Hint (Enter plays the suggested move)\n\n"
+                        "<b>While a replay plays</b>\n"
+                        "<b>Space</b> - Pause or resume\n"
+                        "<b>Left / Right</b> - Step back or forward one move\n"
+                        "<b>Home / End</b> - Jump to the deal or the last move\n"
+                        "<b>Esc</b> - Stop and play on from the move shown";
                     
                     gtk_label_set_markup(GTK_LABEL(label), markup);
                     gtk_container_add(GTK_CONTAINER(content_area), label);
@@ -1315,7 +1408,8 @@ void FreecellGame::clearAndRebuildCaches() {
     initializeCardCache();
   } else {
     #ifdef USEOPENGL
-    // OpenGL texture initialization happens in renderFrame_gl
+    // Rebuild OpenGL textures: the deck's images replace every layer
+    initializeCardTextures_gl();
     #endif
   }
   
@@ -1375,8 +1469,15 @@ void FreecellGame::onNewGame(GtkWidget *widget, gpointer data) {
   if (game->win_animation_active_) {
     game->stopWinAnimation();
   }
+  game->stopSolutionPlayback();
 
-  game->current_seed_ = rand();
+  // Deal a known-winnable seed when the shipped index covers this mode
+  rules::DealVariant variant = game->current_game_mode_ == GameMode::DOUBLE_FREECELL
+                                   ? rules::DealVariant::DOUBLE_FREECELL
+                                   : rules::DealVariant::FREECELL;
+  if (!game->seed_index_.pickSeed(variant, game->current_seed_)) {
+    game->current_seed_ = rand();
+  }
   game->initializeGame();
   game->refreshDisplay();
 }
@@ -1386,6 +1487,7 @@ void FreecellGame::restartGame() {
   if (win_animation_active_) {
     stopWinAnimation();
   }
+  stopSolutionPlayback();
 
   // Keep the current seed and restart the game
   initializeGame();
@@ -1580,8 +1682,11 @@ void FreecellGame::updateCardDimensions(int window_width, int window_height) {
     current_vert_spacing_ = current_card_height_ / 4;
   }
 
-  // Reinitialize card cache with new dimensions
-  initializeCardCache();
+  // Rescale the card cache in the background, drawing from the old
+  // surfaces until it is done
+  rescaleCardCache();
+  // The cached board is drawn again, at the new size, when next needed
+  static_layer_.release();
 }
 
 double FreecellGame::getScaleFactor(int window_width, int window_height) const {
@@ -1615,8 +1720,7 @@ double FreecellGame::getScaleFactor(int window_width, int window_height) const {
   return std::min(width_scale, height_scale);
 }
 
-void FreecellGame::initializeCardCache() {
-  // Get display scale factor
+double FreecellGame::cardDisplayScale() const {
   double display_scale = 1.0;
   if (window_) {
     GdkWindow *gdk_window = gtk_widget_get_window(window_);
@@ -1633,43 +1737,75 @@ void FreecellGame::initializeCardCache() {
       }
     }
   }
+  return display_scale;
+}
+
+void FreecellGame::initializeCardCache() {
+  // Get display scale factor
+  double display_scale = cardDisplayScale();
   
   // Calculate actual pixel dimensions needed for the surface
   // (Cairo surfaces need physical pixels, not logical pixels)
   int surface_width = static_cast<int>(current_card_width_ * display_scale);
   int surface_height = static_cast<int>(current_card_height_ * display_scale);
   
-  // Pre-load all card images into cairo surfaces with current dimensions
+  // Scale every card image out of the atlas with current dimensions
   cleanupCardCache();
-  for (const auto &card : deck_.getAllCards()) {
-    if (auto img = deck_.getCardImage(card)) {
-      GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-      gdk_pixbuf_loader_write(loader, img->data.data(), img->data.size(), nullptr);
-      gdk_pixbuf_loader_close(loader, nullptr);
-      GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-      GdkPixbuf *scaled = gdk_pixbuf_scale_simple(
-          pixbuf, surface_width, surface_height, GDK_INTERP_BILINEAR);
-      cairo_surface_t *surface = cairo_image_surface_create(
-          CAIRO_FORMAT_ARGB32, surface_width, surface_height);
-      
-      // Set the device scale on the surface so Cairo knows about the scaling
-      cairo_surface_set_device_scale(surface, display_scale, display_scale);
-      
-      cairo_t *cr = cairo_create(surface);
-      gdk_cairo_set_source_pixbuf(cr, scaled, 0, 0);
-      cairo_paint(cr);
-      cairo_destroy(cr);
-      std::string key = std::to_string(static_cast<int>(card.suit)) +
-                        std::to_string(static_cast<int>(card.rank));
-      card_surface_cache_[key] = surface;
-      g_object_unref(scaled);
-      g_object_unref(loader);
+  const render::CardAtlas &atlas = *cardAtlas();
+  for (const auto &[id, region] : atlas.regions()) {
+    card_surface_cache_[id] = render::CardScaler::scale(
+        atlas, region, surface_width, surface_height, display_scale);
+  }
+
+  card_scaler_.built(surface_width, surface_height, display_scale);
+}
+
+void FreecellGame::rescaleCardCache() {
+  // Nothing to draw from in the meantime
+  if (card_surface_cache_.empty()) {
+    initializeCardCache();
+    return;
+  }
+  double display_scale = cardDisplayScale();
+  int surface_width = static_cast<int>(current_card_width_ * display_scale);
+  int surface_height = static_cast<int>(current_card_height_ * display_scale);
+  if (!card_scaler_.needs(surface_width, surface_height, display_scale))
+    return;
+
+  card_scaler_.start(cardAtlas(), surface_width, surface_height,
+                     display_scale, card_surface_cache_, [this] {
+                       // Every card on screen is redrawn with the new
+                       // surfaces
+                       damage_.invalidate();
+                       queueRedraw();
+                     });
+}
+
+const std::shared_ptr<const render::CardAtlas> &FreecellGame::cardAtlas() {
+  // Decoded again only when the deck's images change, never for a new
+  // size or rendering engine
+  if (!card_atlas_ || card_atlas_->source() != deck_.imageSerial()) {
+    std::vector<render::EncodedImage> images;
+    for (const auto &image : deck_.getCardImages()) {
+      if (!image.card_info || image.card_info->is_alternate_art)
+        continue;
+      const cardlib::Card &card = *image.card_info;
+      images.push_back({render::cardId(card), &image.data});
+    }
+    if (auto back_img = deck_.getCardBackImage()) {
+      images.push_back({render::BACK_ID, &back_img->data});
     }
+    card_atlas_ = render::decodeCardAtlas(images, deck_.imageSerial());
   }
+  return card_atlas_;
 }
 
 void FreecellGame::cleanupCardCache() {
-  for (auto &[key, surface] : card_surface_cache_) {
+  // Every card on screen is redrawn with the new images
+  damage_.invalidate();
+  // A rescale still in flight would bring the old images back
+  card_scaler_.cancel();
+  for (cairo_surface_t *surface : card_surface_cache_) {
     if (surface) {
       cairo_surface_destroy(surface);
     }
@@ -1748,9 +1884,10 @@ void FreecellGame::saveSettings() {
 }
 
 void FreecellGame::refreshDisplay() {
-  if (game_area_) {
-    gtk_widget_queue_draw(game_area_);
-  }
+  // Let the hint search start on the new position straight away
+  postHintPosition();
+  trackUndoPosition();
+  queueRedraw();
 }
 
 void FreecellGame::setupEasyGame() {
@@ -2,9 +2,19 @@
 #define FREECELL_H
 
 #include "cardlib.h"
+#include "../src_rules/autosave.h"
+#include "../src_rules/freecell_solver.h"
+#include "../src_rules/hint_engine.h"
+#include "../src_rules/seed_index.h"
+#include "../src_rules/undo_journal.h"
+#include "../src_render/gtk_card_scaler.h"
+#include "../src_render/gtk_damage.h"
+#include "../src_render/particles.h"
+#include <atomic>
 #include <gtk/gtk.h>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #ifndef _WIN32
@@ -14,6 +24,10 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #endif
+#ifdef USEOPENGL
+#include "../src_render/gl_card_batch.h"
+#include "../src_render/gl_explosions.h"
+#endif
 
 // Reusing GameSoundEvent from existing code
 enum class GameSoundEvent {
@@ -31,22 +45,6 @@ enum class GameMode {
   DOUBLE_FREECELL
 };
 
-// Reusing CardFragment struct
-struct CardFragment {
-  double x;
-  double y;
-  double width;
-  double height;
-  double velocity_x;
-  double velocity_y;
-  double rotation;
-  double rotation_velocity;
-  double target_x;  // Texture coordinate X for explosion fragments (grid column)
-  double target_y;  // Texture coordinate Y for explosion fragments (grid row)
-  cairo_surface_t *surface;
-  bool active;
-};
-
 // Reusing AnimatedCard struct
 struct AnimatedCard {
   cardlib::Card card;
@@ -59,7 +57,6 @@ struct AnimatedCard {
   bool active;
   bool exploded;
   bool face_up;
-  std::vector<CardFragment> fragments;
   int source_pile;
 
   // For deal animation
@@ -117,6 +114,83 @@ private:
   void autoFinishGame();
   void processNextAutoFinishMove();
   static gboolean onAutoFinishTick(gpointer data);
+
+  // Solver: searches from the current position on a worker thread, then
+  // plays the solution back, flying the cards of each move into place
+  static constexpr uint64_t SOLVE_MAX_STATES = 1000000;
+  static constexpr double SOLVE_MAX_SECONDS = 10.0;
+  static constexpr int SOLUTION_STEP_INTERVAL = 250; // ms each move takes
+  std::thread solve_thread_;          // joinable until onSolveFinished() runs
+  std::atomic<bool> solve_cancel_{false};
+  rules::FreecellState solve_position_; // the board being solved
+  rules::SolveResult solve_result_;     // the worker's, read once it is done
+  bool solution_playback_active_ = false;
+  guint solution_timer_id_ = 0;
+  std::vector<rules::Move> solution_moves_;
+  size_t solution_step_ = 0;
+  std::vector<AnimatedCard> solution_cards_; // the current move's, in flight
+  int solution_ticks_left_ = 0;              // until they land
+
+  bool buildRulesState(rules::FreecellState &state) const;
+  bool solverBusy() const;
+  void solveFromCurrentPosition();
+  static gboolean onSolveFinished(gpointer data);
+  void solutionCardPosition(uint8_t pile, size_t index, double &x,
+                            double &y) const;
+  void startSolutionMove();
+  void landSolutionMove();
+  bool playNextSolutionMove();
+  void stopSolutionPlayback();
+  static gboolean onSolutionTick(gpointer data);
+
+  // Hints: the best move is searched for on a worker thread as the board
+  // changes, so H can show it at once
+  static constexpr double HINT_SOLVE_SECONDS = 2.0;  // Hint search budget per position
+  static constexpr unsigned HINT_TABLE_BITS = 20;    // 8 MB transposition table
+  static constexpr int HINT_POLL_INTERVAL = 50;      // ms between checks while a hint is pending
+  static constexpr int REPLAY_STEP_INTERVAL = 400;   // ms between moves in replay playback
+  std::unique_ptr<rules::HintEngine<rules::FreecellState, rules::FreecellSolver>> hint_engine_;
+  guint hint_poll_timer_id_ = 0;
+
+  bool isBoardSettled() const;
+  void postHintPosition();
+  void showHint();
+  bool showHintIfReady();
+  static gboolean onHintPoll(gpointer data);
+
+  // Undo and redo: moves played are kept as reversible deltas
+  rules::UndoHistory<rules::FreecellState> undo_history_;
+
+  // The game as it is played, for Save Replay, and one opened for playback
+  rules::Replay replay_;
+  rules::ReplayPlayer<rules::FreecellState> replay_player_;
+  bool replay_playback_active_ = false;
+  bool replay_paused_ = false;
+  size_t replay_position_ = 0;
+  guint replay_timer_id_ = 0;
+
+  // Keeps replay_ on disk, so the game resumes after a restart or a crash
+  std::unique_ptr<rules::AutosaveLog> autosave_;
+
+  void applyRulesState(const rules::FreecellState &state);
+  bool trackUndoPosition();
+  void undoLastMove();
+  void redoLastMove();
+  void showUndoPosition(const rules::FreecellState &state);
+
+  // Replays: recorded as the game is played, saved and played back
+  rules::ReplayHeader replayHeader() const;
+  void startReplayRecording(const rules::FreecellState &state);
+  void saveReplay();
+  void openReplay();
+  void startReplayPlayback();
+  void stopReplayPlayback();
+  void pauseReplayPlayback(bool paused);
+  void showReplayPosition(size_t position);
+  bool handleReplayKey(GdkEventKey *event);
+  static gboolean onReplayTick(gpointer data);
+  std::string autosavePath() const;
+  void resumeSavedGame();
   
   // Foundation move animation methods
   void startFoundationMoveAnimation(const cardlib::Card &card, int source_pile, int source_index, int target_pile);
@@ -147,10 +221,13 @@ private:
   std::vector<AnimatedCard> animated_cards_;
   guint animation_timer_id_ = 0;
   static constexpr double GRAVITY = 0.8;
+  static constexpr int FRAGMENT_GRID = 4; // An exploded card's rows and columns
   static constexpr double BOUNCE_FACTOR = -0.7;
   static constexpr int ANIMATION_INTERVAL = 16; // ~60 FPS
   int cards_launched_ = 0;
   double launch_timer_ = 0;
+  render::ParticlePool fragments_; // Exploded cards' pieces, by card and cell
+
   void stopWinAnimation();
   void startWinAnimation();
   void updateWinAnimation();
@@ -180,6 +257,7 @@ private:
   std::vector<std::vector<cardlib::Card>> freecell_animation_cards_;
   // Drawing methods
   void drawCard(cairo_t *cr, int x, int y, const cardlib::Card *card);
+  void paintCard(cairo_t *cr, int x, int y, const cardlib::Card *card);
   void drawEmptyPile(cairo_t *cr, int x, int y);
   void drawAnimatedCard(cairo_t *cr, const AnimatedCard &anim_card);
   void highlightSelectedCard(cairo_t *cr); // Added for keyboard navigation
@@ -239,13 +317,34 @@ private:
   void refreshDisplay();
   
   // Card image caching
-  std::unordered_map<std::string, cairo_surface_t *> card_surface_cache_;
+  render::CardScaler::Cache card_surface_cache_;
   void initializeCardCache();
+  void rescaleCardCache();
+  // The deck's images, decoded when they were loaded
+  const std::shared_ptr<const render::CardAtlas> &cardAtlas();
   void cleanupCardCache();
+  // The window's scale factor, which the card surfaces are drawn at
+  double cardDisplayScale() const;
   
   // Double buffering
   cairo_surface_t *buffer_surface_;
   cairo_t *buffer_cr_;
+
+  // Damage tracking: what a tracker item is, the first part of every key
+  enum DrawItem {
+    ITEM_BACKGROUND,
+    ITEM_CARD,
+    ITEM_EMPTY_PILE,
+    ITEM_ANIMATED_CARD,
+    ITEM_FRAGMENT,
+    ITEM_HIGHLIGHT,
+    ITEM_STACK_HIGHLIGHT
+  };
+  render::DamageTracker damage_;           // What changed since the last frame
+  render::StaticLayer static_layer_;       // The settled board, cached
+  render::CardScaler card_scaler_;         // Rescales the card cache
+  std::shared_ptr<const render::CardAtlas> card_atlas_; // Decoded deck
+  render::FrameStats frame_stats_{"freecell"};
   
   // Settings and customization
   std::string settings_dir_;
@@ -307,19 +406,24 @@ private:
                          std::vector<uint8_t> &fileData);
 
   unsigned int current_seed_;
+  rules::SeedIndex seed_index_;  // Precomputed winnable seeds, if shipped
 
   void promptForSeed();
   void restartGame();
 
 
   void explodeCard(AnimatedCard&);
-  void updateCardFragments(AnimatedCard &card);
-  void drawCardFragment(cairo_t *cr, const CardFragment &fragment);                   
+  void updateCardFragments();
+  void drawCardFragment(cairo_t *cr, size_t index);
   cairo_surface_t* getCardSurface(const cardlib::Card& card);
 
   void launchCardFromFreecell();
 
-  void initializeDrawBuffer(int width, int height);
+  bool initializeDrawBuffer(int width, int height);
+  void drawBoard();
+  void drawStaticLayer();
+  void updateStaticLayer(int width, int height);
+  void queueRedraw();
   void drawFreecells();
   void drawFoundationPiles();
   void drawTableau();
@@ -350,8 +454,9 @@ private:
   GLuint cardQuadVBO_gl_             = 0;  // Vertex Buffer Object
   GLuint cardQuadEBO_gl_             = 0;  // Element Buffer Object
   
-  std::unordered_map<std::string, GLuint> cardTextures_gl_;  // Texture cache
-  GLuint cardBackTexture_gl_         = 0;  // Card back texture
+  render::GLCardBatch card_batch_gl_;     // Card textures; a frame's cards
+  render::GLExplosions explosions_gl_;    // The win animation's fragments
+  render::GLState render_state_gl_{"freecell gl"}; // What a frame has bound
 #endif
 
   // ============================================================================
@@ -364,7 +469,6 @@ private:
   void stopWinAnimation_gl();
   void launchNextCard_gl();
   void explodeCard_gl(AnimatedCard &card);
-  void updateCardFragments_gl(AnimatedCard &card);
 
   // Deal Animation - OpenGL 3.4 Versions
   void startDealAnimation_gl();
@@ -396,7 +500,6 @@ private:
   void drawFoundationPiles_gl(GLuint shaderProgram, GLuint VAO);
   void drawNormalTableauColumn_gl(int column_index, int x, int tableau_y);
   void drawTableauDuringDealAnimation_gl(int column_index, int x, int tableau_y);
-  GLuint loadTextureFromMemory(const std::vector<unsigned char> &data);
 #endif
 
   // GL Context Callbacks
@@ -434,7 +537,6 @@ private:
 
 #ifdef USEOPENGL  
   void drawAnimatedCard_gl(const AnimatedCard &anim_card, GLuint shaderProgram, GLuint VAO);
-  void drawCardFragment_gl(const CardFragment &fragment, const AnimatedCard &card, GLuint shaderProgram, GLuint VAO);
   void drawWinAnimation_gl(GLuint shaderProgram, GLuint VAO);
   void drawDealAnimation_gl(GLuint shaderProgram, GLuint VAO);
   void drawFoundationAnimation_gl(GLuint shaderProgram, GLuint VAO);
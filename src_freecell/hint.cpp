@@ -0,0 +1,116 @@
+#include "freecell.h"
+#include <gtk/gtk.h>
+#include <iostream>
+
+// No cards in flight: the piles hold the whole board
+bool FreecellGame::isBoardSettled() const {
+  return !(dragging_ || win_animation_active_ ||
+           deal_animation_active_ || foundation_move_animation_active_ ||
+           auto_finish_active_ || !solution_cards_.empty());
+}
+
+// Called on every redraw; the engine ignores positions it already has
+void FreecellGame::postHintPosition() {
+  if (!hint_engine_ || !isBoardSettled()) {
+    return;
+  }
+
+  rules::FreecellState state;
+  if (!buildRulesState(state)) {
+    return;
+  }
+
+  // A hint still being waited for belongs to the old position
+  if (hint_engine_->update(state) && hint_poll_timer_id_ > 0) {
+    g_source_remove(hint_poll_timer_id_);
+    hint_poll_timer_id_ = 0;
+  }
+}
+
+void FreecellGame::showHint() {
+  rules::FreecellState state;
+  if (!hint_engine_ || solverBusy() || !buildRulesState(state) ||
+      state.isWon()) {
+    return;
+  }
+  postHintPosition();
+
+  // Usually the worker has finished long before the player asks; if not,
+  // check back until it has
+  if (!showHintIfReady() && hint_poll_timer_id_ == 0) {
+    hint_poll_timer_id_ = g_timeout_add(HINT_POLL_INTERVAL, onHintPoll, this);
+  }
+}
+
+bool FreecellGame::showHintIfReady() {
+  rules::Hint hint = hint_engine_->current();
+
+  switch (hint.status) {
+  case rules::HintStatus::THINKING:
+    return false;
+
+  case rules::HintStatus::LOST:
+  case rules::HintStatus::NO_MOVES: {
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(window_), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
+        "%s", hint.status == rules::HintStatus::LOST
+                  ? "This game can no longer be won."
+                  : "There are no moves left.");
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    return true;
+  }
+
+  case rules::HintStatus::WINNING:
+  case rules::HintStatus::GUESS:
+    break;
+  }
+
+  // The game numbers its piles free cells, foundations, tableau, with as
+  // many free cells as the mode has; the rules' numbering is fixed
+  const int num_freecells = static_cast<int>(freecells_.size());
+  auto gamePile = [num_freecells](uint8_t pile) {
+    if (pile < rules::FREECELL_FOUNDATION) {
+      return static_cast<int>(pile);
+    }
+    if (pile < rules::FREECELL_TABLEAU) {
+      return num_freecells + pile - rules::FREECELL_FOUNDATION;
+    }
+    return num_freecells + 4 + pile - rules::FREECELL_TABLEAU;
+  };
+  auto topIndex = [this](uint8_t pile) {
+    if (pile < rules::FREECELL_FOUNDATION) {
+      return 0;
+    }
+    if (pile < rules::FREECELL_TABLEAU) {
+      return static_cast<int>(foundation_[pile - rules::FREECELL_FOUNDATION].size()) - 1;
+    }
+    return static_cast<int>(tableau_[pile - rules::FREECELL_TABLEAU].size()) - 1;
+  };
+
+  // Pick up the cards to move and put the cursor on their destination,
+  // exactly as if the player had done it from the keyboard
+  const rules::Move &move = hint.move;
+  keyboard_navigation_active_ = true;
+  keyboard_selection_active_ = true;
+  source_pile_ = gamePile(move.from);
+  source_card_idx_ = topIndex(move.from) - move.count + 1;
+  selected_pile_ = gamePile(move.to);
+  selected_card_idx_ = topIndex(move.to);
+
+  if (hint.status == rules::HintStatus::GUESS) {
+    std::cerr << "Hint: no winning line found, showing the most promising move"
+              << std::endl;
+  }
+  refreshDisplay();
+  return true;
+}
+
+gboolean FreecellGame::onHintPoll(gpointer data) {
+  FreecellGame *game = static_cast<FreecellGame *>(data);
+  if (!game->showHintIfReady()) {
+    return TRUE;
+  }
+  game->hint_poll_timer_id_ = 0;
+  return FALSE;
+}
@@ -10,6 +10,19 @@ gboolean FreecellGame::onKeyPress(GtkWidget *widget, GdkEventKey *event, gpointe
     return TRUE;
   }
 
+  if (game->replay_playback_active_ && game->handleReplayKey(event)) {
+    return TRUE;
+  }
+
+  // While the solver has the board only Escape, which stops it, is taken
+  if (game->solverBusy()) {
+    if (event->keyval == GDK_KEY_Escape) {
+      game->stopSolutionPlayback();
+      game->refreshDisplay();
+    }
+    return TRUE;
+  }
+
   // Check for control key modifier
   bool ctrl_pressed = (event->state & GDK_CONTROL_MASK);
 
@@ -52,6 +65,22 @@ gboolean FreecellGame::onKeyPress(GtkWidget *widget, GdkEventKey *event, gpointe
     }
     break;
 
+  case GDK_KEY_z:
+  case GDK_KEY_Z:
+    if (ctrl_pressed) {
+      game->undoLastMove();
+      return TRUE;
+    }
+    break;
+
+  case GDK_KEY_y:
+  case GDK_KEY_Y:
+    if (ctrl_pressed) {
+      game->redoLastMove();
+      return TRUE;
+    }
+    break;
+
   case GDK_KEY_q:
   case GDK_KEY_Q:
     if (ctrl_pressed) {
@@ -103,7 +132,8 @@ gboolean FreecellGame::onKeyPress(GtkWidget *widget, GdkEventKey *event, gpointe
       onAbout(nullptr, game);
       return TRUE;
     }
-    break;
+    game->showHint();
+    return TRUE;
 
   case GDK_KEY_F1:
     // F1 for Help/About (common standard)
@@ -937,18 +967,23 @@ void FreecellGame::highlightSelectedCard(cairo_t *cr) {
   }
   
   // Choose highlight color based on whether we're selecting a card to move
-  if (keyboard_selection_active_ && source_pile_ == selected_pile_) {
-    // Source card/pile is highlighted in blue
-    cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.5); // Semi-transparent blue
-  } else {
-    // Regular selection is highlighted in yellow
-    cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 0.5); // Semi-transparent yellow
+  bool is_source = keyboard_selection_active_ && source_pile_ == selected_pile_;
+  if (damage_.item(render::pixelBounds(x - 2, y - 2, current_card_width_ + 4,
+                                       current_card_height_ + 4, 2),
+                   render::DrawKey().add(int(ITEM_HIGHLIGHT)).add(is_source))) {
+    if (is_source) {
+      // Source card/pile is highlighted in blue
+      cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.5); // Semi-transparent blue
+    } else {
+      // Regular selection is highlighted in yellow
+      cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 0.5); // Semi-transparent yellow
+    }
+    
+    cairo_set_line_width(cr, 3.0);
+    cairo_rectangle(cr, x - 2, y - 2, current_card_width_ + 4, current_card_height_ + 4);
+    cairo_stroke(cr);
   }
   
-  cairo_set_line_width(cr, 3.0);
-  cairo_rectangle(cr, x - 2, y - 2, current_card_width_ + 4, current_card_height_ + 4);
-  cairo_stroke(cr);
-  
   // If we have a card selected for movement in tableau, highlight all cards below it
   if (keyboard_selection_active_ && source_pile_ >= tableau_start && source_card_idx_ >= 0) {
     int tableau_idx = source_pile_ - tableau_start;
@@ -956,9 +991,6 @@ void FreecellGame::highlightSelectedCard(cairo_t *cr) {
     if (tableau_idx >= 0 && tableau_idx < tableau_.size() && !tableau_[tableau_idx].empty() && 
         source_card_idx_ < tableau_[tableau_idx].size()) {
         
-      // Highlight all cards from the selected one to the bottom
-      cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.3); // Lighter blue for stack
-      
       x = current_card_spacing_ + tableau_idx * (current_card_width_ + current_card_spacing_);
       y = 2 * current_card_spacing_ + current_card_height_ + source_card_idx_ * current_vert_spacing_;
       
@@ -966,7 +998,14 @@ void FreecellGame::highlightSelectedCard(cairo_t *cr) {
       int stack_height = (tableau_[tableau_idx].size() - source_card_idx_ - 1) * 
                           current_vert_spacing_ + current_card_height_;
       
-      if (stack_height > 0) {
+      if (stack_height > 0 &&
+          damage_.item(render::pixelBounds(x - 2, y - 2,
+                                           current_card_width_ + 4,
+                                           stack_height + 4, 2),
+                       render::DrawKey().add(int(ITEM_STACK_HIGHLIGHT)))) {
+        // Highlight all cards from the selected one to the bottom
+        cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.3); // Lighter blue for stack
+        cairo_set_line_width(cr, 3.0);
         cairo_rectangle(cr, x - 2, y - 2, current_card_width_ + 4, stack_height + 4);
         cairo_stroke(cr);
       }
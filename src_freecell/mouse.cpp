@@ -16,7 +16,8 @@ gboolean FreecellGame::onButtonPress(GtkWidget *widget, GdkEventButton *event, g
     game->stopWinAnimation();
     return TRUE;
   }
-  if (game->foundation_move_animation_active_ || game->deal_animation_active_) {
+  if (game->foundation_move_animation_active_ || game->deal_animation_active_ ||
+      game->solverBusy() || game->replay_playback_active_) {
     return TRUE;
   }
 
@@ -533,7 +534,7 @@ gboolean FreecellGame::onMotionNotify(GtkWidget *widget, GdkEventMotion *event,
   if (game->dragging_) {
     game->drag_start_x_ = event->x;
     game->drag_start_y_ = event->y;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
@@ -0,0 +1,276 @@
+#include "freecell.h"
+#include <algorithm>
+#include <gtk/gtk.h>
+#include <iostream>
+
+// Copies the board into the headless rules representation. Game pile
+// indices are shifted by the number of free cells; the rules' are fixed.
+bool FreecellGame::buildRulesState(rules::FreecellState &state) const {
+  if (freecells_.size() > 6 || foundation_.size() != 4 || tableau_.size() > 10) {
+    return false;
+  }
+
+  state.double_deck = current_game_mode_ == GameMode::DOUBLE_FREECELL;
+  state.num_cells = static_cast<uint8_t>(freecells_.size());
+  state.num_columns = static_cast<uint8_t>(tableau_.size());
+
+  state.cells.fill(cardlib::PackedCard());
+  for (size_t i = 0; i < freecells_.size(); i++) {
+    if (freecells_[i].has_value()) {
+      state.cells[i] = cardlib::PackedCard(freecells_[i].value());
+    }
+  }
+
+  for (size_t f = 0; f < foundation_.size(); f++) {
+    state.foundation[f].clear();
+    for (const auto &card : foundation_[f]) {
+      if (!state.foundation[f].push(cardlib::PackedCard(card))) {
+        return false;
+      }
+    }
+  }
+
+  for (auto &pile : state.tableau) {
+    pile.clear();
+  }
+  for (size_t t = 0; t < tableau_.size(); t++) {
+    for (const auto &card : tableau_[t]) {
+      if (!state.tableau[t].push(cardlib::PackedCard(card))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// A search is running, or a solution being played back; the board is the
+// solver's until it finishes or Escape stops it
+bool FreecellGame::solverBusy() const {
+  return solve_thread_.joinable() || solution_playback_active_;
+}
+
+void FreecellGame::solveFromCurrentPosition() {
+  if (win_animation_active_ || deal_animation_active_ || auto_finish_active_ ||
+      foundation_move_animation_active_ || replay_playback_active_ ||
+      solverBusy()) {
+    return;
+  }
+
+  if (!buildRulesState(solve_position_) || solve_position_.isWon()) {
+    return;
+  }
+
+  keyboard_navigation_active_ = false;
+  keyboard_selection_active_ = false;
+  refreshDisplay();
+
+  // Show a busy cursor while the solver runs
+  GdkWindow *gdk_window = gtk_widget_get_window(window_);
+  if (gdk_window) {
+    GdkCursor *watch =
+        gdk_cursor_new_for_display(gdk_display_get_default(), GDK_WATCH);
+    gdk_window_set_cursor(gdk_window, watch);
+    g_object_unref(watch);
+  }
+
+  // The search runs on its own thread, so the window keeps drawing; the
+  // result comes back to the GTK thread through onSolveFinished()
+  solve_cancel_ = false;
+  solve_thread_ = std::thread([this]() {
+    rules::FreecellSolver solver;
+    rules::SolverLimits limits;
+    limits.max_nodes = SOLVE_MAX_STATES;
+    limits.max_seconds = SOLVE_MAX_SECONDS;
+    limits.cancel = &solve_cancel_;
+    solve_result_ = solver.solve(solve_position_, limits);
+    g_idle_add(onSolveFinished, this);
+  });
+}
+
+gboolean FreecellGame::onSolveFinished(gpointer data) {
+  FreecellGame *game = static_cast<FreecellGame *>(data);
+  game->solve_thread_.join();
+
+  GdkWindow *gdk_window = gtk_widget_get_window(game->window_);
+  if (gdk_window) {
+    gdk_window_set_cursor(gdk_window, nullptr);
+  }
+
+  // Stopped by the player, or by a new game
+  if (game->solve_cancel_) {
+    return FALSE;
+  }
+
+  rules::SolveResult &result = game->solve_result_;
+  std::cerr << "Solver: " << rules::solveStatusName(result.status) << ", "
+            << result.moves.size() << " moves, " << result.nodes
+            << " states in " << result.seconds << " s" << std::endl;
+
+  // Only a solution for the board as it still is can be played
+  rules::FreecellState state;
+  if (!game->buildRulesState(state) || !(state == game->solve_position_)) {
+    std::cerr << "Solver: the board changed during the search" << std::endl;
+    return FALSE;
+  }
+
+  if (result.status != rules::SolveStatus::SOLVED) {
+    const char *message =
+        result.status == rules::SolveStatus::EXHAUSTED
+            ? "No solution exists from the current position."
+            : "The solver could not find a solution in time.";
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(game->window_), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO,
+        GTK_BUTTONS_OK, "%s", message);
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    return FALSE;
+  }
+
+  game->solution_moves_ = std::move(result.moves);
+  game->solution_step_ = 0;
+  game->solution_playback_active_ = true;
+  game->solution_timer_id_ =
+      g_timeout_add(ANIMATION_INTERVAL, onSolutionTick, game);
+  return FALSE;
+}
+
+// Where the card at index in a rules pile is drawn
+void FreecellGame::solutionCardPosition(uint8_t pile, size_t index, double &x,
+                                        double &y) const {
+  const double column = current_card_width_ + current_card_spacing_;
+  if (pile < rules::FREECELL_FOUNDATION) {
+    x = current_card_spacing_ + pile * column;
+    y = current_card_spacing_;
+  } else if (pile < rules::FREECELL_TABLEAU) {
+    x = allocation.width - (4 - (pile - rules::FREECELL_FOUNDATION)) * column;
+    y = current_card_spacing_;
+  } else {
+    x = current_card_spacing_ + (pile - rules::FREECELL_TABLEAU) * column;
+    y = 2 * current_card_spacing_ + current_card_height_ +
+        index * current_vert_spacing_;
+  }
+}
+
+// Lifts the next move's cards off their pile and sets them flying to
+// where they land
+void FreecellGame::startSolutionMove() {
+  const rules::Move &move = solution_moves_[solution_step_];
+
+  // Take the cards off the source pile
+  std::vector<cardlib::Card> moving;
+  size_t first = 0;
+  if (move.from < rules::FREECELL_FOUNDATION) {
+    moving.push_back(freecells_[move.from].value());
+    freecells_[move.from] = std::nullopt;
+  } else if (move.from < rules::FREECELL_TABLEAU) {
+    auto &pile = foundation_[move.from - rules::FREECELL_FOUNDATION];
+    first = pile.size() - 1;
+    moving.push_back(pile.back());
+    pile.pop_back();
+  } else {
+    auto &pile = tableau_[move.from - rules::FREECELL_TABLEAU];
+    first = pile.size() - move.count;
+    moving.assign(pile.end() - move.count, pile.end());
+    pile.erase(pile.end() - move.count, pile.end());
+  }
+
+  // Cards join the top of the destination
+  size_t landing = 0;
+  if (move.to >= rules::FREECELL_TABLEAU) {
+    landing = tableau_[move.to - rules::FREECELL_TABLEAU].size();
+  }
+
+  solution_ticks_left_ = std::max(1, SOLUTION_STEP_INTERVAL / ANIMATION_INTERVAL);
+  solution_cards_.clear();
+  for (size_t i = 0; i < moving.size(); i++) {
+    AnimatedCard card = {};
+    card.card = moving[i];
+    card.face_up = true;
+    card.active = true;
+    solutionCardPosition(move.from, first + i, card.x, card.y);
+    solutionCardPosition(move.to, landing + i, card.target_x, card.target_y);
+    card.velocity_x = (card.target_x - card.x) / solution_ticks_left_;
+    card.velocity_y = (card.target_y - card.y) / solution_ticks_left_;
+    solution_cards_.push_back(card);
+  }
+}
+
+// Puts the cards in flight down on their destination
+void FreecellGame::landSolutionMove() {
+  const rules::Move &move = solution_moves_[solution_step_++];
+  if (move.to < rules::FREECELL_FOUNDATION) {
+    freecells_[move.to] = solution_cards_.front().card;
+  } else if (move.to < rules::FREECELL_TABLEAU) {
+    foundation_[move.to - rules::FREECELL_FOUNDATION].push_back(
+        solution_cards_.front().card);
+  } else {
+    auto &pile = tableau_[move.to - rules::FREECELL_TABLEAU];
+    for (const AnimatedCard &card : solution_cards_) {
+      pile.push_back(card.card);
+    }
+  }
+  solution_cards_.clear();
+  playSound(GameSoundEvent::CardPlace);
+}
+
+bool FreecellGame::playNextSolutionMove() {
+  if (!solution_playback_active_) {
+    return false;
+  }
+
+  // Move the cards in flight; they land on the last tick
+  if (!solution_cards_.empty()) {
+    if (--solution_ticks_left_ > 0) {
+      for (AnimatedCard &card : solution_cards_) {
+        card.x += card.velocity_x;
+        card.y += card.velocity_y;
+      }
+    } else {
+      landSolutionMove();
+    }
+    refreshDisplay();
+    if (!solution_cards_.empty() || solution_step_ < solution_moves_.size()) {
+      return true;
+    }
+  }
+
+  // Stop at the end, or if the board no longer matches the solution
+  rules::FreecellState state;
+  if (solution_step_ >= solution_moves_.size() || !buildRulesState(state) ||
+      !state.isLegal(solution_moves_[solution_step_])) {
+    solution_playback_active_ = false;
+    solution_timer_id_ = 0;
+    refreshDisplay();
+    if (checkWinCondition()) {
+      startWinAnimation();
+    }
+    return false;
+  }
+
+  startSolutionMove();
+  refreshDisplay();
+  return true;
+}
+
+// Stops a search or a playback, landing any cards in flight so the board
+// is whole again
+void FreecellGame::stopSolutionPlayback() {
+  if (solve_thread_.joinable()) {
+    solve_cancel_ = true;
+  }
+  if (solution_timer_id_ > 0) {
+    g_source_remove(solution_timer_id_);
+    solution_timer_id_ = 0;
+  }
+  if (!solution_cards_.empty()) {
+    landSolutionMove();
+  }
+  solution_playback_active_ = false;
+  solution_moves_.clear();
+  solution_step_ = 0;
+}
+
+gboolean FreecellGame::onSolutionTick(gpointer data) {
+  FreecellGame *game = static_cast<FreecellGame *>(data);
+  return game->playNextSolutionMove() ? TRUE : FALSE;
+}
@@ -0,0 +1,88 @@
+#include "freecell.h"
+#include <array>
+#include <gtk/gtk.h>
+
+// Puts a rules position back on the board. The Card objects are reused
+// from the piles so each card keeps its art.
+void FreecellGame::applyRulesState(const rules::FreecellState &state) {
+  std::array<cardlib::Card, 64> cards;
+  for (const auto &cell : freecells_) {
+    if (cell.has_value()) {
+      cards[cardlib::PackedCard(cell.value()).id()] = cell.value();
+    }
+  }
+  for (const auto &pile : foundation_) {
+    for (const auto &card : pile) {
+      cards[cardlib::PackedCard(card).id()] = card;
+    }
+  }
+  for (const auto &pile : tableau_) {
+    for (const auto &card : pile) {
+      cards[cardlib::PackedCard(card).id()] = card;
+    }
+  }
+
+  for (size_t i = 0; i < freecells_.size(); i++) {
+    if (state.cells[i].isValid()) {
+      freecells_[i] = cards[state.cells[i].id()];
+    } else {
+      freecells_[i].reset();
+    }
+  }
+  for (size_t f = 0; f < foundation_.size(); f++) {
+    foundation_[f].clear();
+    for (cardlib::PackedCard card : state.foundation[f]) {
+      foundation_[f].push_back(cards[card.id()]);
+    }
+  }
+  for (size_t t = 0; t < tableau_.size(); t++) {
+    tableau_[t].clear();
+    for (cardlib::PackedCard card : state.tableau[t]) {
+      tableau_[t].push_back(cards[card.id()]);
+    }
+  }
+}
+
+// Called on every redraw; works out the move since the last position.
+// False if the board can't be followed right now.
+bool FreecellGame::trackUndoPosition() {
+  rules::FreecellState state;
+  if (replay_playback_active_ || !isBoardSettled() ||
+      !buildRulesState(state)) {
+    return false;
+  }
+  if (undo_history_.track(state)) {
+    startReplayRecording(state);
+  }
+  if (autosave_) {
+    autosave_->update(replay_);
+  }
+  return true;
+}
+
+void FreecellGame::undoLastMove() {
+  rules::FreecellState state;
+  if (trackUndoPosition() && undo_history_.undo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void FreecellGame::redoLastMove() {
+  rules::FreecellState state;
+  if (trackUndoPosition() && undo_history_.redo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void FreecellGame::showUndoPosition(const rules::FreecellState &state) {
+  // A solution being played back no longer fits the board
+  if (solverBusy()) {
+    stopSolutionPlayback();
+  }
+  applyRulesState(state);
+  keyboard_selection_active_ = false;
+  source_pile_ = -1;
+  source_card_idx_ = -1;
+  playSound(GameSoundEvent::CardPlace);
+  refreshDisplay();
+}
@@ -13,57 +13,13 @@ gboolean SolitaireGame::onAnimationTick(gpointer data) {
   return game->win_animation_active_ ? TRUE : FALSE;
 }
 
-void SolitaireGame::updateCardFragments(AnimatedCard &card) {
-  if (!card.exploded)
-    return;
-
+void SolitaireGame::updateCardFragments() {
   GtkAllocation allocation;
   gtk_widget_get_allocation(game_area_, &allocation);
 
-  // Simple approach: just update existing fragments without creating new ones
-  for (auto &fragment : card.fragments) {
-    if (!fragment.active)
-      continue;
-
-    // Update position
-    fragment.x += fragment.velocity_x;
-    fragment.y += fragment.velocity_y;
-    fragment.velocity_y += GRAVITY;
-
-    // Update rotation
-    fragment.rotation += fragment.rotation_velocity;
-
-    // Check if fragment is in the lower part of the screen for potential "bounce" effect
-    const double min_height = allocation.height * 0.5;
-    if (fragment.y > min_height && fragment.y < allocation.height - fragment.height &&
-        fragment.velocity_y > 0 && // Only when moving downward
-        (rand() % 1000 < 5)) { // 0.5% chance per frame
-      
-      // Instead of creating new fragments, just give this one an upward boost
-      // and maybe change its direction slightly
-      fragment.velocity_y = -fragment.velocity_y * 0.8; // Reverse with reduced energy
-      
-      // Add a slight horizontal randomization
-      fragment.velocity_x += (rand() % 11 - 5); // -5 to +5 adjustment
-      
-      // Increase rotation for visual effect
-      fragment.rotation_velocity *= 1.5;
-      
-      // Play a sound for the "bounce"
-      playSound(GameSoundEvent::Firework);
-    }
-    
-    // Check if fragment is off screen
-    if (fragment.x < -fragment.width || fragment.x > allocation.width ||
-        fragment.y > allocation.height + fragment.height) {
-      // Free the surface if it exists
-      if (fragment.surface) {
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-      }
-      fragment.active = false;
-    }
-  }
+  // One firework for however many fragments bounced this tick
+  if (fragments_.update(GRAVITY, allocation.width, allocation.height) > 0)
+    playSound(GameSoundEvent::Firework);
 }
 
 void SolitaireGame::updateWinAnimation() {
@@ -130,25 +86,20 @@ void SolitaireGame::updateWinAnimation() {
       } else {
         all_cards_finished = false;
       }
-    } else {
-      // Update explosion fragments
-      updateCardFragments(card);
-
-      // Check if all fragments are inactive
-      bool all_fragments_inactive = true;
-      for (const auto &fragment : card.fragments) {
-        if (fragment.active) {
-          all_fragments_inactive = false;
-          all_cards_finished = false;
-          break;
-        }
-      }
-
-      if (all_fragments_inactive) {
-        card.active = false;
-      }
     }
   }
+
+  // Exploded cards' fragments, until the last leaves the window
+  updateCardFragments();
+  if (!fragments_.empty())
+    all_cards_finished = false;
+
+#ifdef USEOPENGL
+  // Exploded cards' fragments, on the GPU until the last leaves the window
+  explosions_gl_.tick();
+  if (explosions_gl_.active())
+    all_cards_finished = false;
+#endif
   
   if (all_cards_finished) {
   // Reset tracking for animated cards to allow reusing the piles
@@ -375,21 +326,12 @@ void SolitaireGame::stopWinAnimation() {
     animation_timer_id_ = 0;
   }
 
-  // Clean up fragment surfaces to prevent memory leaks
-  for (auto &card : animated_cards_) {
-    for (auto &fragment : card.fragments) {
-      if (fragment.surface) {
-        // Only destroy if the surface is valid
-        if (cairo_surface_status(fragment.surface) == CAIRO_STATUS_SUCCESS) {
-          cairo_surface_destroy(fragment.surface);
-        }
-        fragment.surface = nullptr;
-      }
-    }
-    card.fragments.clear();
-  }
+  fragments_.clear();
 
   animated_cards_.clear();
+#ifdef USEOPENGL
+  explosions_gl_.clear();
+#endif
   animated_foundation_cards_.clear();
   cards_launched_ = 0;
   launch_timer_ = 0;
@@ -0,0 +1,156 @@
+#include "solitaire.h"
+#include <gtk/gtk.h>
+#include <iostream>
+
+// Copies the board into the headless rules representation. Pile numbers
+// are the same in both.
+bool SolitaireGame::buildRulesState(rules::KlondikeState &state) const {
+  if (current_game_mode_ != GameMode::STANDARD_KLONDIKE ||
+      foundation_.size() != 4 || tableau_.size() != 7 ||
+      stock_.size() > 24 || waste_.size() > 24) {
+    return false;
+  }
+
+  state.draw_three = draw_three_mode_;
+
+  state.stock.clear();
+  for (const auto &card : stock_) {
+    state.stock.push(cardlib::PackedCard(card, false));
+  }
+  state.waste.clear();
+  for (const auto &card : waste_) {
+    state.waste.push(cardlib::PackedCard(card));
+  }
+
+  for (size_t f = 0; f < foundation_.size(); f++) {
+    state.foundation[f].clear();
+    for (const auto &card : foundation_[f]) {
+      if (!state.foundation[f].push(cardlib::PackedCard(card))) {
+        return false;
+      }
+    }
+  }
+
+  for (size_t t = 0; t < tableau_.size(); t++) {
+    state.tableau[t].clear();
+    for (const auto &tableau_card : tableau_[t]) {
+      if (!state.tableau[t].push(
+              cardlib::PackedCard(tableau_card.card, tableau_card.face_up))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// No cards in flight: the piles hold the whole board
+bool SolitaireGame::isBoardSettled() const {
+  return !(dragging_ || win_animation_active_ ||
+           deal_animation_active_ || foundation_move_animation_active_ ||
+           stock_to_waste_animation_active_ || auto_finish_active_);
+}
+
+// Called on every redraw; the engine ignores positions it already has
+void SolitaireGame::postHintPosition() {
+  if (!hint_engine_ || !isBoardSettled()) {
+    return;
+  }
+
+  rules::KlondikeState state;
+  if (!buildRulesState(state)) {
+    return;
+  }
+
+  // A hint still being waited for belongs to the old position
+  if (hint_engine_->update(state) && hint_poll_timer_id_ > 0) {
+    g_source_remove(hint_poll_timer_id_);
+    hint_poll_timer_id_ = 0;
+  }
+}
+
+void SolitaireGame::showHint() {
+  rules::KlondikeState state;
+  if (!hint_engine_ || !buildRulesState(state) || state.isWon()) {
+    return;
+  }
+  postHintPosition();
+
+  // Usually the worker has finished long before the player asks; if not,
+  // check back until it has
+  if (!showHintIfReady() && hint_poll_timer_id_ == 0) {
+    hint_poll_timer_id_ = g_timeout_add(HINT_POLL_INTERVAL, onHintPoll, this);
+  }
+}
+
+bool SolitaireGame::showHintIfReady() {
+  rules::Hint hint = hint_engine_->current();
+
+  switch (hint.status) {
+  case rules::HintStatus::THINKING:
+    return false;
+
+  case rules::HintStatus::NO_MOVES: {
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(window_), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
+        "There are no moves left.");
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    return true;
+  }
+
+  // The Klondike solver skips moves it judges useless, so finding no win
+  // is not proof there is none: show its best guess instead
+  case rules::HintStatus::LOST:
+  case rules::HintStatus::WINNING:
+  case rules::HintStatus::GUESS:
+    break;
+  }
+
+  const rules::Move &move = hint.move;
+  keyboard_navigation_active_ = true;
+
+  if (move.from == rules::KLONDIKE_STOCK || move.to == rules::KLONDIKE_STOCK) {
+    // Turning the stock or the waste: point at the stock, Enter plays it
+    keyboard_selection_active_ = false;
+    source_pile_ = -1;
+    source_card_idx_ = -1;
+    selected_pile_ = 0;
+    selected_card_idx_ = stock_.empty() ? -1 : static_cast<int>(stock_.size()) - 1;
+  } else {
+    // Pick up the cards to move and put the cursor on their destination,
+    // exactly as if the player had done it from the keyboard
+    int source_size;
+    if (move.from == rules::KLONDIKE_WASTE) {
+      source_size = static_cast<int>(waste_.size());
+    } else if (move.from < rules::KLONDIKE_TABLEAU) {
+      source_size = static_cast<int>(foundation_[move.from - rules::KLONDIKE_FOUNDATION].size());
+    } else {
+      source_size = static_cast<int>(tableau_[move.from - rules::KLONDIKE_TABLEAU].size());
+    }
+    keyboard_selection_active_ = true;
+    source_pile_ = move.from;
+    source_card_idx_ = source_size - move.count;
+
+    int target_size = move.to < rules::KLONDIKE_TABLEAU
+                          ? static_cast<int>(foundation_[move.to - rules::KLONDIKE_FOUNDATION].size())
+                          : static_cast<int>(tableau_[move.to - rules::KLONDIKE_TABLEAU].size());
+    selected_pile_ = move.to;
+    selected_card_idx_ = target_size - 1;
+  }
+
+  if (hint.status == rules::HintStatus::GUESS) {
+    std::cerr << "Hint: no winning line found, showing the most promising move"
+              << std::endl;
+  }
+  refreshDisplay();
+  return true;
+}
+
+gboolean SolitaireGame::onHintPoll(gpointer data) {
+  SolitaireGame *game = static_cast<SolitaireGame *>(data);
+  if (!game->showHintIfReady()) {
+    return TRUE;
+  }
+  game->hint_poll_timer_id_ = 0;
+  return FALSE;
+}
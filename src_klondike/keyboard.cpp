@@ -11,6 +11,10 @@ if (game->win_animation_active_) {
   return TRUE;
 }
 
+  if (game->replay_playback_active_ && game->handleReplayKey(event)) {
+    return TRUE;
+  }
+
   // Check for control key modifier
   bool ctrl_pressed = (event->state & GDK_CONTROL_MASK);
 
@@ -82,6 +86,22 @@ if (game->win_animation_active_) {
   }
   break;
 
+  case GDK_KEY_z:
+  case GDK_KEY_Z:
+    if (ctrl_pressed) {
+      game->undoLastMove();
+      return TRUE;
+    }
+    break;
+
+  case GDK_KEY_y:
+  case GDK_KEY_Y:
+    if (ctrl_pressed) {
+      game->redoLastMove();
+      return TRUE;
+    }
+    break;
+
   case GDK_KEY_q:
   case GDK_KEY_Q:
     if (ctrl_pressed) {
@@ -138,7 +158,8 @@ if (game->win_animation_active_) {
       onAbout(nullptr, game);
       return TRUE;
     }
-    break;
+    game->showHint();
+    return TRUE;
 
   case GDK_KEY_1:
     if (game->draw_three_mode_) {
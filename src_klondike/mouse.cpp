@@ -14,9 +14,10 @@ gboolean SolitaireGame::onButtonPress(GtkWidget *widget, GdkEventButton *event,
     return TRUE;
   }
 
-  // If any animation is active, block all interactions
+  // If any animation or a replay is playing, block all interactions
   if (game->foundation_move_animation_active_ ||
-      game->stock_to_waste_animation_active_) {
+      game->stock_to_waste_animation_active_ ||
+      game->replay_playback_active_) {
     return TRUE;
   }
 
@@ -172,14 +173,14 @@ gboolean SolitaireGame::onButtonRelease(GtkWidget *widget,
         if (game->checkWinCondition()) {
           game->startWinAnimation(); // Start animation instead of showing dialog
         }
-        gtk_widget_queue_draw(game->game_area_);
+        game->queueRedraw();
       }
     }
 
     game->dragging_ = false;
     game->drag_cards_.clear();
     game->drag_source_pile_ = -1;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
@@ -223,7 +224,7 @@ gboolean SolitaireGame::onMotionNotify(GtkWidget *widget, GdkEventMotion *event,
   if (game->dragging_) {
     game->drag_start_x_ = event->x;
     game->drag_start_y_ = event->y;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
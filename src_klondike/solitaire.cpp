@@ -106,6 +106,20 @@ SolitaireGame::SolitaireGame()
       current_seed_(0) {
   srand(time(NULL));
   current_seed_ = rand();
+#ifdef _WIN32
+  seed_index_.open(getExecutableDir() + "\\" + rules::SEED_INDEX_FILENAME);
+#else
+  seed_index_.open(rules::SEED_INDEX_FILENAME);
+#endif
+
+  rules::SolverLimits hint_limits;
+  hint_limits.max_nodes = 0;
+  hint_limits.max_seconds = HINT_SOLVE_SECONDS;
+  hint_engine_ = std::make_unique<
+      rules::HintEngine<rules::KlondikeState, rules::KlondikeSolver>>(
+      hint_limits, HINT_TABLE_BITS);
+  undo_history_.attachReplay(&replay_);
+
   initializeSettingsDir();
   
   // Load engine preference and initialize rendering
@@ -437,6 +451,7 @@ void SolitaireGame::setupCairoArea() {
                 CAIRO_FORMAT_ARGB32, allocation->width, allocation->height);
             game->buffer_cr_ = cairo_create(game->buffer_surface_);
 
+            game->damage_.invalidate();
             gtk_widget_queue_draw(widget);
           }),
       this);
@@ -640,7 +655,7 @@ void SolitaireGame::checkAndInitializeSound() {
 void SolitaireGame::run(int argc, char **argv) {
   gtk_init(&argc, &argv);
   setupWindow();
-  initializeGame();  // Initialize game after GTK is ready and window exists
+  resumeSavedGame();  // Initialize game after GTK is ready and window exists
   setupGameArea();
   
   // Show all widgets AFTER game is fully initialized
@@ -664,6 +679,10 @@ void SolitaireGame::run(int argc, char **argv) {
 }
 
 void SolitaireGame::initializeGame() {
+  if (replay_playback_active_) {
+    stopReplayPlayback();
+  }
+
   // Check for engine switch request
   if (engine_switch_requested_) {
     switchRenderingEngine(requested_engine_);
@@ -696,6 +715,7 @@ void SolitaireGame::initializeGame() {
         try {
           deck_ = cardlib::Deck(path);
           deck_.removeJokers();
+          deal_order_ = deck_.getAllCards();
           loaded = true;
           break;
         } catch (const std::exception &e) {
@@ -1169,16 +1189,10 @@ bool SolitaireGame::checkWinCondition() const {
 
 // Function to refresh the display
 void SolitaireGame::refreshDisplay() {
-  // FIX: Refresh the correct widget based on the active rendering engine
-  if (rendering_engine_ == RenderingEngine::OPENGL) {
-    if (gl_area_) {
-      gtk_widget_queue_draw(gl_area_);
-    }
-  } else {
-    if (game_area_) {
-      gtk_widget_queue_draw(game_area_);
-    }
-  }
+  // Let the hint search start on the new position straight away
+  postHintPosition();
+  trackUndoPosition();
+  queueRedraw();
 }
 
 int main(int argc, char **argv) {
@@ -1289,6 +1303,49 @@ void SolitaireGame::setupMenuBar() {
                   this);
   gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), autoFinishItem);
 
+  // Hint
+  GtkWidget *hintItem = gtk_menu_item_new_with_mnemonic("_Hint (H)");
+  g_signal_connect(G_OBJECT(hintItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->showHint();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), hintItem);
+
+  // Undo / Redo
+  GtkWidget *undoItem = gtk_menu_item_new_with_mnemonic("_Undo (Ctrl+Z)");
+  g_signal_connect(G_OBJECT(undoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->undoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), undoItem);
+
+  GtkWidget *redoItem = gtk_menu_item_new_with_mnemonic("_Redo (Ctrl+Y)");
+  g_signal_connect(G_OBJECT(redoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->redoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), redoItem);
+
+  // Replays
+  GtkWidget *saveReplayItem = gtk_menu_item_new_with_mnemonic("Save Re_play...");
+  g_signal_connect(G_OBJECT(saveReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->saveReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), saveReplayItem);
+
+  GtkWidget *openReplayItem = gtk_menu_item_new_with_mnemonic("_Open Replay...");
+  g_signal_connect(G_OBJECT(openReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->openReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), openReplayItem);
+
 GtkWidget *gameModeItem = gtk_menu_item_new_with_mnemonic("_Game Mode");
 GtkWidget *gameModeMenu = gtk_menu_new();
 gtk_menu_item_set_submenu(GTK_MENU_ITEM(gameModeItem), gameModeMenu);
@@ -1397,6 +1454,22 @@ gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), gameModeItem);
 
   gtk_menu_shell_append(GTK_MENU_SHELL(optionsMenu), drawModeItem);
 
+  // Winnable deals only
+  GtkWidget *winnableItem =
+      gtk_check_menu_item_new_with_mnemonic("_Winnable Deals Only");
+  gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(winnableItem),
+                                 winnable_deals_only_);
+  g_signal_connect(
+      G_OBJECT(winnableItem), "toggled",
+      G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+        SolitaireGame *game = static_cast<SolitaireGame *>(data);
+        game->winnable_deals_only_ =
+            gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(widget));
+        game->saveSettings();
+      }),
+      this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(optionsMenu), winnableItem);
+
   // Card Back menu
   GtkWidget *cardBackMenu = gtk_menu_new();
   GtkWidget *cardBackItem = gtk_menu_item_new_with_mnemonic("_Card Back");
@@ -1555,16 +1628,122 @@ gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), gameModeItem);
 
 void SolitaireGame::onNewGame(GtkWidget *widget, gpointer data) {
   SolitaireGame *game = static_cast<SolitaireGame *>(data);
-    
+
+  // A winnable deal is already being searched for
+  if (game->seed_search_thread_.joinable()) {
+    return;
+  }
+
   // Check if win animation is active
   if (game->win_animation_active_) {
     game->stopWinAnimation();
   }
 
-  game->current_seed_ = rand();
-  game->initializeGame();
-  game->updateWindowTitle();
-  game->refreshDisplay();
+  if (game->winnable_deals_only_ &&
+      game->current_game_mode_ == GameMode::STANDARD_KLONDIKE) {
+    game->dealWinnableGame();
+  } else {
+    game->dealNewGame(rand());
+  }
+}
+
+void SolitaireGame::dealNewGame(unsigned int seed) {
+  current_seed_ = seed;
+  initializeGame();
+  updateWindowTitle();
+  refreshDisplay();
+}
+
+void SolitaireGame::dealWinnableGame() {
+  const std::vector<cardlib::Card> order =
+      deal_order_.empty() ? rules::zipDeckOrder() : deal_order_;
+
+  // The shipped index answers instantly, but only for the deck order it
+  // was built with
+  unsigned int seed = 0;
+  if (rules::sameDeckOrder(order, rules::zipDeckOrder()) &&
+      seed_index_.pickSeed(draw_three_mode_ ? rules::DealVariant::KLONDIKE_DRAW3
+                                            : rules::DealVariant::KLONDIKE_DRAW1,
+                           seed)) {
+    dealNewGame(seed);
+    return;
+  }
+
+  // Otherwise deal candidate seeds headlessly, in the same deck order
+  // initializeGame() will use, until the solver finds a win within its
+  // time budget. That can take seconds, so it runs on a worker thread and
+  // the current game stays on screen until onSeedSearchFinished().
+  std::vector<unsigned int> candidates(WINNABLE_SEED_ATTEMPTS);
+  for (unsigned int &candidate : candidates) {
+    candidate = rand();
+  }
+
+  GdkWindow *gdk_window = gtk_widget_get_window(window_);
+  if (gdk_window) {
+    GdkCursor *watch =
+        gdk_cursor_new_for_display(gdk_display_get_default(), GDK_WATCH);
+    gdk_window_set_cursor(gdk_window, watch);
+    g_object_unref(watch);
+  }
+
+  seed_search_cancel_ = false;
+  seed_search_draw_three_ = draw_three_mode_;
+  seed_search_thread_ = std::thread([this, candidates, order]() {
+    rules::KlondikeSolver solver;
+    rules::SolverLimits limits;
+    limits.max_nodes = 0;
+    limits.max_seconds = WINNABLE_SOLVE_SECONDS;
+    limits.cancel = &seed_search_cancel_;
+
+    seed_search_found_ = false;
+    for (unsigned int candidate : candidates) {
+      if (seed_search_cancel_) {
+        break;
+      }
+      seed_search_seed_ = candidate;
+      rules::KlondikeState state;
+      state.deal(candidate, seed_search_draw_three_, order);
+      if (solver.solve(state, limits).status == rules::SolveStatus::SOLVED) {
+        seed_search_found_ = true;
+        break;
+      }
+    }
+    g_idle_add(onSeedSearchFinished, this);
+  });
+}
+
+gboolean SolitaireGame::onSeedSearchFinished(gpointer data) {
+  SolitaireGame *game = static_cast<SolitaireGame *>(data);
+  game->seed_search_thread_.join();
+
+  GdkWindow *gdk_window = gtk_widget_get_window(game->window_);
+  if (gdk_window) {
+    gdk_window_set_cursor(gdk_window, nullptr);
+  }
+
+  // The deal searched for no longer fits the options
+  if (game->seed_search_cancel_ ||
+      game->current_game_mode_ != GameMode::STANDARD_KLONDIKE ||
+      game->draw_three_mode_ != game->seed_search_draw_three_) {
+    return FALSE;
+  }
+
+  if (!game->seed_search_found_) {
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(game->window_), GTK_DIALOG_MODAL, GTK_MESSAGE_QUESTION,
+        GTK_BUTTONS_YES_NO,
+        "No deal the solver could win was found in %d tries.\n\n"
+        "Deal one that may not be winnable?",
+        WINNABLE_SEED_ATTEMPTS);
+    gint response = gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    if (response != GTK_RESPONSE_YES) {
+      return FALSE;
+    }
+  }
+
+  game->dealNewGame(game->seed_search_seed_);
+  return FALSE;
 }
 
 void SolitaireGame::restartGame() {
@@ -1661,11 +1840,20 @@ void SolitaireGame::onAbout(GtkWidget * /* widget */, gpointer data) {
       "- Escape to cancel a selection\n"
       "- Space to draw cards from the stock pile\n"
       "- F to automatically move all possible cards to the foundation piles\n"
+      "- H for a hint; Enter plays the suggested move\n"
       "- 1 or 3 to toggle between Draw One and Draw Three modes\n"
       "- F11 to toggle fullscreen mode\n"
       "- Ctrl+N for a new game\n"
+      "- Ctrl+Z to undo a move, Ctrl+Y to redo it\n"
       "- Ctrl+Q to quit\n"
       "- Ctrl+H for help\n\n"
+      "Replays:\n"
+      "- Game > Save Replay keeps every move of the game in a small file\n"
+      "- Game > Open Replay plays one back: Space pauses, Left and Right "
+      "step, Home and End jump to the start and the end, Escape stops and "
+      "lets you play on from the move shown\n"
+      "- The game in progress is saved as you play, and picks up where you "
+      "left off next time\n\n"
       "Written by Jason Hall\n"
       "Licensed under the MIT License\n"
       "https://github.com/jasonbrianhall/solitaire";
@@ -1803,6 +1991,8 @@ bool SolitaireGame::loadSettings() {
     if (line.substr(0, 10) == "card_back=") {
       custom_back_path_ = line.substr(10);
       std::cerr << "Loaded custom back path: " << custom_back_path_ << std::endl;
+    } else if (line.substr(0, 15) == "winnable_deals=") {
+      winnable_deals_only_ = line.substr(15) == "1";
     }
   }
 
@@ -1831,6 +2021,7 @@ void SolitaireGame::saveSettings() {
   if (!custom_back_path_.empty()) {
     file << "card_back=" << custom_back_path_ << std::endl;
   }
+  file << "winnable_deals=" << (winnable_deals_only_ ? 1 : 0) << std::endl;
 }
 
 bool SolitaireGame::setCustomCardBack(const std::string &path) {
@@ -1948,8 +2139,11 @@ void SolitaireGame::updateCardDimensions(int window_width, int window_height) {
     current_vert_spacing_ = current_card_height_ / 4;
   }
 
-  // Reinitialize card cache with new dimensions
-  initializeCardCache();
+  // Rescale the card cache in the background, drawing from the old
+  // surfaces until it is done
+  rescaleCardCache();
+  // The cached board is drawn again, at the new size, when next needed
+  static_layer_.release();
 }
 
 double SolitaireGame::getScaleFactor(int window_width, int window_height) const {
@@ -2297,15 +2491,22 @@ void SolitaireGame::showKeyboardShortcuts() {
       {"Escape", "Cancel a selection or exit fullscreen"},
       {"Space", "Draw cards from the stock pile"},
       {"F", "Auto-finish (automatically move all possible cards to foundation)"},
+      {"H", "Hint (pick up the suggested cards; Enter plays the move)"},
       {"1", "Switch to Draw One mode"},
       {"3", "Switch to Draw Three mode"},
       {"F11", "Toggle fullscreen mode"},
       {"Ctrl+N", "New game"},
+      {"Ctrl+Z", "Undo the last move"},
+      {"Ctrl+Y", "Redo the move just undone"},
       {"Ctrl+L", "Load custom deck"},
       {"Ctrl+S", "Toggle sound on/off"},
       {"Ctrl+H", "Show About dialog"},
       {"Ctrl+Q", "Quit the game"},
-      {"F1", "Show How To Play / About dialog"}
+      {"F1", "Show How To Play / About dialog"},
+      {"Space (replay)", "Pause or resume the replay"},
+      {"Left / Right (replay)", "Step back or forward one move"},
+      {"Home / End (replay)", "Jump to the deal or the last move"},
+      {"Escape (replay)", "Stop and play on from the move shown"}
   };
 
   // Add shortcut rows
@@ -4,13 +4,23 @@
 // ============================================================================
 // INCLUDES - System and External Libraries
 // ============================================================================
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include <gtk/gtk.h>
 #include "cardlib.h"
+#include "../src_rules/autosave.h"
+#include "../src_rules/hint_engine.h"
+#include "../src_rules/klondike_solver.h"
+#include "../src_rules/seed_index.h"
+#include "../src_rules/undo_journal.h"
+#include "../src_render/gtk_card_scaler.h"
+#include "../src_render/gtk_damage.h"
+#include "../src_render/particles.h"
 
 #ifdef USEOPENGL
 #include <glm/glm.hpp>
@@ -18,27 +28,15 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include "../src_render/gl_card_batch.h"
+#include "../src_render/gl_explosions.h"
+#include "../src_render/gl_overlay.h"
 #endif
 
 // ============================================================================
 // STRUCTURES
 // ============================================================================
 
-struct CardFragment {
-  double x;
-  double y;
-  double width;
-  double height;
-  double velocity_x;
-  double velocity_y;
-  double rotation;
-  double rotation_velocity;
-  double target_x;  // Texture coordinate X for explosion fragments (grid column)
-  double target_y;  // Texture coordinate Y for explosion fragments (grid row)
-  cairo_surface_t *surface;
-  bool active;
-};
-
 struct AnimatedCard {
   cardlib::Card card;
   double x;
@@ -52,7 +50,6 @@ struct AnimatedCard {
   double target_x;  // For deal animation
   double target_y;  // For deal animation
   bool face_up;
-  std::vector<CardFragment> fragments;
 };
 
 struct TableauCard {
@@ -132,6 +129,7 @@ private:
   static constexpr int VERT_SPACING = 30;
 
   static constexpr double GRAVITY = 0.8;
+  static constexpr int FRAGMENT_GRID = 4; // An exploded card's rows and columns
   static constexpr double BOUNCE_FACTOR = -0.7;
   static constexpr int ANIMATION_INTERVAL = 16; // ~60 FPS
 
@@ -139,6 +137,14 @@ private:
   static constexpr double DEAL_INTERVAL = 30;   // Time between dealing cards (ms)
   static constexpr double DEAL_SPEED = 1.3;     // Speed multiplier for dealing
 
+  static constexpr int WINNABLE_SEED_ATTEMPTS = 40;       // Seeds tried per new game
+  static constexpr double WINNABLE_SOLVE_SECONDS = 0.25;  // Solver budget per seed
+
+  static constexpr double HINT_SOLVE_SECONDS = 2.0;  // Hint search budget per position
+  static constexpr unsigned HINT_TABLE_BITS = 20;    // 8 MB transposition table
+  static constexpr int HINT_POLL_INTERVAL = 50;      // ms between checks while a hint is pending
+  static constexpr int REPLAY_STEP_INTERVAL = 400;   // ms between moves in replay playback
+
   static constexpr double EXPLOSION_THRESHOLD_MIN = 0.3; // Minimum distance threshold (as percentage of screen height)
   static constexpr double EXPLOSION_THRESHOLD_MAX = 0.7; // Maximum distance threshold (as percentage of screen height)
 
@@ -149,6 +155,33 @@ private:
   cardlib::MultiDeck multi_deck_;
   GameMode current_game_mode_ = GameMode::STANDARD_KLONDIKE;
   unsigned int current_seed_;
+  std::vector<cardlib::Card> deal_order_;  // Deck order before the shuffle, for the solver
+  rules::SeedIndex seed_index_;            // Precomputed winnable seeds, if shipped
+
+  // Without the index, winnable deals are searched for on a worker thread
+  std::thread seed_search_thread_;         // Joinable until onSeedSearchFinished() runs
+  std::atomic<bool> seed_search_cancel_{false};
+  bool seed_search_draw_three_ = false;    // The draw mode searched for
+  bool seed_search_found_ = false;         // The worker's answer...
+  unsigned int seed_search_seed_ = 0;      // ...and its seed, else the last one tried
+
+  // Searches for the best move on a worker thread as the board changes
+  std::unique_ptr<rules::HintEngine<rules::KlondikeState, rules::KlondikeSolver>> hint_engine_;
+  guint hint_poll_timer_id_ = 0;
+
+  // Moves played, as reversible deltas, for undo and redo
+  rules::UndoHistory<rules::KlondikeState> undo_history_;
+
+  // The game as it is played, for Save Replay, and one opened for playback
+  rules::Replay replay_;
+  rules::ReplayPlayer<rules::KlondikeState> replay_player_;
+  bool replay_playback_active_ = false;
+  bool replay_paused_ = false;
+  size_t replay_position_ = 0;
+  guint replay_timer_id_ = 0;
+
+  // Keeps replay_ on disk, so the game resumes after a restart or a crash
+  std::unique_ptr<rules::AutosaveLog> autosave_;
 
   std::vector<cardlib::Card> stock_;                       // Draw pile
   std::vector<cardlib::Card> waste_;                       // Faced-up cards from stock
@@ -176,6 +209,7 @@ private:
   int cards_launched_ = 0;
   double launch_timer_ = 0;
   guint animation_timer_id_ = 0;
+  render::ParticlePool fragments_; // Exploded cards' pieces, by card and cell
 
   // Deal animation fields
   bool deal_animation_active_ = false;
@@ -237,15 +271,21 @@ private:
   bool sound_enabled_ = false;
   bool is_fullscreen_ = false;
   bool draw_three_mode_ = false;       // True for draw 3, false for draw 1
+  bool winnable_deals_only_ = false;   // New games only use seeds the solver can win
   bool cache_dirty_ = false;           // Flag to indicate caches need to be cleared and rebuilt
   bool game_fully_initialized_ = false; // Track if game is fully initialized
 
   // ========================================================================
   // GAME STATE - CACHING AND BUFFERS
   // ========================================================================
-  std::unordered_map<std::string, cairo_surface_t *> card_surface_cache_;
+  render::CardScaler::Cache card_surface_cache_;
   cairo_surface_t *buffer_surface_ = nullptr;
   cairo_t *buffer_cr_ = nullptr;
+  render::DamageTracker damage_;           // What changed since the last frame
+  render::StaticLayer static_layer_;       // The settled board, cached
+  render::CardScaler card_scaler_;         // Rescales the card cache
+  std::shared_ptr<const render::CardAtlas> card_atlas_; // Decoded deck
+  render::FrameStats frame_stats_{"klondike"};
 
   // ========================================================================
   // GTK WIDGETS
@@ -261,6 +301,9 @@ private:
   // INITIALIZATION AND SETUP METHODS
   // ========================================================================
   void initializeGame();
+  void dealNewGame(unsigned int seed);
+  void dealWinnableGame();
+  static gboolean onSeedSearchFinished(gpointer data);
   void deal();
   void dealMultiDeck();
   void setupWindow();
@@ -269,6 +312,9 @@ private:
   void setupCairoArea();
   void initializeSettingsDir();
   void initializeCardCache();
+  void rescaleCardCache();
+  // The deck's images, decoded when they were loaded
+  const std::shared_ptr<const render::CardAtlas> &cardAtlas();
   void clearAndRebuildCaches();
   void initializeMultiDeckGame();
 
@@ -297,13 +343,18 @@ private:
   // CARD DRAWING METHODS - CAIRO
   // ========================================================================
   void drawCard(cairo_t *cr, int x, int y, const cardlib::Card *card, bool face_up);
+  void paintCard(cairo_t *cr, int x, int y, const cardlib::Card *card, bool face_up);
   void drawEmptyPile(cairo_t *cr, int x, int y);
   void drawAnimatedCard(cairo_t *cr, const AnimatedCard &anim_card);
-  void drawCardFragment(cairo_t *cr, const CardFragment &fragment);
+  void drawCardFragment(cairo_t *cr, size_t index);
 
   cairo_surface_t *getCardSurface(const cardlib::Card &card);
   cairo_surface_t *getCardBackSurface();
-  void initializeOrResizeBuffer(int width, int height);
+  bool initializeOrResizeBuffer(int width, int height);
+  void drawBoard();
+  void drawStaticLayer();
+  void updateStaticLayer(int width, int height);
+  void queueRedraw();
 
   // ========================================================================
   // GAME PILE DRAWING METHODS - CAIRO
@@ -328,7 +379,6 @@ private:
   void drawCard_gl(const cardlib::Card &card, int x, int y, bool face_up);
   void drawEmptyPile_gl(int x, int y);
   void drawAnimatedCard_gl(const AnimatedCard &anim_card, GLuint shaderProgram, GLuint VAO);
-  void drawCardFragment_gl(const CardFragment &fragment, const AnimatedCard &card, GLuint shaderProgram, GLuint VAO);
 
   // Game pile drawing functions - OpenGL versions
   void drawStockPile_gl();
@@ -350,7 +400,7 @@ private:
   void stopWinAnimation();
   void launchNextCard();
   void explodeCard(AnimatedCard &card);
-  void updateCardFragments(AnimatedCard &card);
+  void updateCardFragments();
   static gboolean onAnimationTick(gpointer data);
 
   // ========================================================================
@@ -432,6 +482,41 @@ private:
   void processNextAutoFinishMove();
   static gboolean onAutoFinishTick(gpointer data);
 
+  // ========================================================================
+  // HINTS
+  // ========================================================================
+  bool buildRulesState(rules::KlondikeState &state) const;
+  bool isBoardSettled() const;
+  void postHintPosition();
+  void showHint();
+  bool showHintIfReady();
+  static gboolean onHintPoll(gpointer data);
+
+  // ========================================================================
+  // UNDO AND REDO
+  // ========================================================================
+  void applyRulesState(const rules::KlondikeState &state);
+  bool trackUndoPosition();
+  void undoLastMove();
+  void redoLastMove();
+  void showUndoPosition(const rules::KlondikeState &state);
+
+  // ========================================================================
+  // REPLAYS
+  // ========================================================================
+  rules::ReplayHeader replayHeader() const;
+  void startReplayRecording(const rules::KlondikeState &state);
+  void saveReplay();
+  void openReplay();
+  void startReplayPlayback();
+  void stopReplayPlayback();
+  void pauseReplayPlayback(bool paused);
+  void showReplayPosition(size_t position);
+  bool handleReplayKey(GdkEventKey *event);
+  static gboolean onReplayTick(gpointer data);
+  std::string autosavePath() const;
+  void resumeSavedGame();
+
 #ifdef USEOPENGL
   void processNextAutoFinishMove_gl();
   static gboolean onAutoFinishTick_gl(gpointer data);
@@ -541,7 +626,6 @@ private:
   void cleanupOpenGLResources_gl();
   bool validateOpenGLContext();
   bool reloadCustomCardBackTexture_gl();
-  GLuint loadTextureFromMemory(const std::vector<unsigned char> &data);
 
   // OpenGL 3.4 Rendering Components
   GLuint cardShaderProgram_gl_ = 0;      // Main card rendering shader
@@ -550,8 +634,10 @@ private:
   GLuint cardQuadVBO_gl_ = 0;            // Vertex Buffer Object
   GLuint cardQuadEBO_gl_ = 0;            // Element Buffer Object
 
-  std::unordered_map<std::string, GLuint> cardTextures_gl_;  // Texture cache
-  GLuint cardBackTexture_gl_ = 0;                             // Card back texture
+  render::GLCardBatch card_batch_gl_;    // Card textures; a frame's cards
+  render::GLExplosions explosions_gl_;   // The win animation's fragments
+  render::GLOverlay overlay_gl_;         // Highlight outlines
+  render::GLState render_state_gl_{"klondike gl"}; // What a frame has bound
 #endif
 
   // Test/Debug methods
@@ -0,0 +1,86 @@
+#include "solitaire.h"
+#include <array>
+#include <gtk/gtk.h>
+
+// Puts a rules position back on the board. The Card objects are reused
+// from the piles so each card keeps its art.
+void SolitaireGame::applyRulesState(const rules::KlondikeState &state) {
+  std::array<cardlib::Card, 64> cards;
+  for (const auto &card : stock_) {
+    cards[cardlib::PackedCard(card).id()] = card;
+  }
+  for (const auto &card : waste_) {
+    cards[cardlib::PackedCard(card).id()] = card;
+  }
+  for (const auto &pile : foundation_) {
+    for (const auto &card : pile) {
+      cards[cardlib::PackedCard(card).id()] = card;
+    }
+  }
+  for (const auto &pile : tableau_) {
+    for (const auto &tableau_card : pile) {
+      cards[cardlib::PackedCard(tableau_card.card).id()] = tableau_card.card;
+    }
+  }
+
+  stock_.clear();
+  for (cardlib::PackedCard card : state.stock) {
+    stock_.push_back(cards[card.id()]);
+  }
+  waste_.clear();
+  for (cardlib::PackedCard card : state.waste) {
+    waste_.push_back(cards[card.id()]);
+  }
+  for (size_t f = 0; f < foundation_.size(); f++) {
+    foundation_[f].clear();
+    for (cardlib::PackedCard card : state.foundation[f]) {
+      foundation_[f].push_back(cards[card.id()]);
+    }
+  }
+  for (size_t t = 0; t < tableau_.size(); t++) {
+    tableau_[t].clear();
+    for (cardlib::PackedCard card : state.tableau[t]) {
+      tableau_[t].emplace_back(cards[card.id()], card.faceUp());
+    }
+  }
+}
+
+// Called on every redraw; works out the move since the last position.
+// False if the board can't be followed right now.
+bool SolitaireGame::trackUndoPosition() {
+  rules::KlondikeState state;
+  if (replay_playback_active_ || !isBoardSettled() ||
+      !buildRulesState(state)) {
+    return false;
+  }
+  if (undo_history_.track(state)) {
+    startReplayRecording(state);
+  }
+  if (autosave_) {
+    autosave_->update(replay_);
+  }
+  return true;
+}
+
+void SolitaireGame::undoLastMove() {
+  rules::KlondikeState state;
+  if (trackUndoPosition() && undo_history_.undo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void SolitaireGame::redoLastMove() {
+  rules::KlondikeState state;
+  if (trackUndoPosition() && undo_history_.redo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void SolitaireGame::showUndoPosition(const rules::KlondikeState &state) {
+  applyRulesState(state);
+  keyboard_selection_active_ = false;
+  source_pile_ = -1;
+  source_card_idx_ = -1;
+  playSound(GameSoundEvent::CardPlace);
+  refreshDisplay();
+}
@@ -41,32 +41,80 @@ static double cairo_get_text_width(cairo_t *cr, const char *text, double font_si
 // DRAWING FUNCTIONS
 // ============================================================================
 
-void PyramidGame::drawCardFragment(cairo_t *cr,
-                                     const CardFragment &fragment) {
-  // Skip inactive fragments or those without a surface
-  if (!fragment.active || !fragment.surface)
-    return;
+namespace {
+
+// What a damage tracker item is, the first part of every key
+enum DrawItem {
+  ITEM_BACKGROUND,
+  ITEM_CARD,
+  ITEM_EMPTY_PILE,
+  ITEM_ANIMATED_CARD,
+  ITEM_FRAGMENT,
+  ITEM_HIGHLIGHT,
+  ITEM_DEAL_MARKER,
+  ITEM_RULES_TEXT
+};
+
+// Card faces are told apart by suit and rank; every back looks the same
+render::DrawKey cardKey(DrawItem item, const cardlib::Card *card,
+                        bool face_up) {
+  render::DrawKey key;
+  key.add(int(item));
+  if (face_up && card)
+    key.add(static_cast<int>(card->suit)).add(static_cast<int>(card->rank));
+  else
+    key.add(-1);
+  return key;
+}
+
+} // namespace
 
-  // Check surface status before using it
-  if (cairo_surface_status(fragment.surface) != CAIRO_STATUS_SUCCESS)
+void PyramidGame::drawCardFragment(cairo_t *cr, size_t index) {
+  // The tag is the card's id and which of its cells the fragment is
+  const uint32_t cells = FRAGMENT_GRID * FRAGMENT_GRID;
+  uint32_t tag = fragments_.tag(index);
+  cairo_surface_t *surface = card_surface_cache_.get(int(tag / cells));
+  if (!surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    return;
+  int cell = int(tag % cells);
+
+  double x = fragments_.x(index);
+  double y = fragments_.y(index);
+  double width = fragments_.width(index);
+  double height = fragments_.height(index);
+  double rotation = fragments_.rotation(index);
+  render::Rect bounds = render::rotatedBounds(x, y, width, height, rotation);
+  render::DrawKey key;
+  key.add(int(ITEM_FRAGMENT)).add(static_cast<const void *>(surface)).add(cell);
+  key.add(x).add(y).add(rotation);
+  if (!damage_.item(bounds, key))
     return;
 
   // Save the current transformation state
   cairo_save(cr);
 
   // Move to the center of the fragment for rotation
-  cairo_translate(cr, fragment.x + fragment.width / 2,
-                  fragment.y + fragment.height / 2);
-  cairo_rotate(cr, fragment.rotation);
-
-  // Draw the fragment
-  cairo_set_source_surface(cr, fragment.surface, -fragment.width / 2,
-                           -fragment.height / 2);
+  cairo_translate(cr, x + width / 2, y + height / 2);
+  cairo_rotate(cr, rotation);
+
+  // Draw the fragment's cell of the card, the card placed so the cell
+  // lies under the rectangle filled. While a rescale is pending the cached
+  // surface is not the card's current size, so the cell is scaled to the
+  // fragment as paintCard() scales a whole card.
+  double cell_width =
+      double(cairo_image_surface_get_width(surface)) / FRAGMENT_GRID;
+  double cell_height =
+      double(cairo_image_surface_get_height(surface)) / FRAGMENT_GRID;
+  cairo_scale(cr, width / cell_width, height / cell_height);
+  cairo_set_source_surface(cr, surface,
+                           -cell_width / 2 - cell % FRAGMENT_GRID * cell_width,
+                           -cell_height / 2 -
+                               cell / FRAGMENT_GRID * cell_height);
 
   // Only proceed if setting the source was successful
   if (cairo_status(cr) == CAIRO_STATUS_SUCCESS) {
-    cairo_rectangle(cr, -fragment.width / 2, -fragment.height / 2,
-                    fragment.width, fragment.height);
+    cairo_rectangle(cr, -cell_width / 2, -cell_height / 2, cell_width,
+                    cell_height);
     cairo_fill(cr);
   }
 
@@ -76,34 +124,62 @@ void PyramidGame::drawCardFragment(cairo_t *cr,
 
 gboolean PyramidGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
   PyramidGame *game = static_cast<PyramidGame *>(data);
+  game->frame_stats_.begin();
 
   // Get the widget dimensions
   GtkAllocation allocation;
   gtk_widget_get_allocation(widget, &allocation);
+  int width = allocation.width;
+  int height = allocation.height;
+
+  // Only what GTK asks for is repainted, the damage queued since the last
+  // frame; the buffer keeps the rest. A new buffer is painted whole.
+  std::vector<render::Rect> clip;
+  if (game->initializeOrResizeBuffer(width, height) ||
+      game->damage_.fullRedraw()) {
+    game->damage_.invalidate();
+    clip.emplace_back(0, 0, width, height);
+  } else {
+    clip = render::clipRects(cr);
+  }
 
-  // Create or resize buffer surface if needed
-  game->initializeOrResizeBuffer(allocation.width, allocation.height);
+  game->updateStaticLayer(width, height);
+  cairo_save(game->buffer_cr_);
+  render::clipTo(game->buffer_cr_, clip);
+  game->damage_.paintOverLayer(width, height, clip);
+  game->drawBoard();
+  cairo_restore(game->buffer_cr_);
+  // Changes made without a refreshDisplay() show up next frame
+  render::queueDamage(widget, game->damage_.finish());
 
-  // Clear buffer with background color
-  cairo_set_source_rgb(game->buffer_cr_, 0.0, 0.6, 0.0);
-  cairo_paint(game->buffer_cr_);
+  // Copy buffer to window
+  cairo_set_source_surface(cr, game->buffer_surface_, 0, 0);
+  cairo_paint(cr);
+
+  game->frame_stats_.end(render::totalArea(clip), (long long)width * height);
+  return TRUE;
+}
+
+// Everything the Cairo view shows, in drawing order. onDraw() runs it to
+// paint and queueRedraw() to record what changed, so every piece goes
+// through damage_.item() and is painted only if that says so.
+void PyramidGame::drawBoard() {
+  int width = cairo_image_surface_get_width(buffer_surface_);
+
+  drawStaticLayer();
+  // A painted frame takes the settled board from its cached layer
+  if (damage_.painting()) {
+    static_layer_.blit(buffer_cr_);
+  }
 
-  // Draw main game components in order
-  game->drawStockPile();
-  game->drawWastePile();
-  game->drawDiscardPile();  // Discard pile for matched cards
-  game->drawFoundationPiles();
-  game->drawTableauPiles();
-  
   // Draw animations and dragged cards
-  game->drawAllAnimations();
-  
+  drawAllAnimations();
+
   // Draw keyboard navigation highlight if active
-  if (game->keyboard_navigation_active_ && !game->dragging_ &&
-      !game->deal_animation_active_ && !game->win_animation_active_ &&
-      !game->foundation_move_animation_active_ &&
-      !game->stock_to_waste_animation_active_) {
-    game->highlightSelectedCard(game->buffer_cr_);
+  if (keyboard_navigation_active_ && !dragging_ && !deal_animation_active_ &&
+      !win_animation_active_ && !foundation_move_animation_active_ &&
+      !stock_to_waste_animation_active_) {
+    highlightSelectedCard(buffer_cr_);
   }
 
   // ========================================================================
@@ -115,8 +191,8 @@ gboolean PyramidGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
       // Make font sizes responsive based on window width
       // Title: scales from ~16px (small screen) to ~32px (large screen)
       // Rules: scales from ~10px (small screen) to ~18px (large screen)
-      int title_font_size = std::max(16, std::min(32, allocation.width / 60));
-      int rules_font_size = std::max(10, std::min(18, allocation.width / 100));
+      int title_font_size = std::max(16, std::min(32, width / 60));
+      int rules_font_size = std::max(10, std::min(18, width / 100));
       
       const int shadow_offset_x = 2;
       const int shadow_offset_y = 2;
@@ -134,18 +210,10 @@ gboolean PyramidGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
       const char *title_text = "Pyramid Solitaire Rules";
       
       // Get text dimensions
-      double title_width = cairo_get_text_width(game->buffer_cr_, title_text, title_font_size);
-      double title_x = allocation.width - title_width - margin;
+      double title_width = cairo_get_text_width(buffer_cr_, title_text, title_font_size);
+      double title_x = width - title_width - margin;
       double title_y = margin + title_font_size;
       
-      // Draw title shadow in black
-      cairo_draw_text(game->buffer_cr_, title_text, title_x + shadow_offset_x, title_y + shadow_offset_y, 
-                     title_font_size, 0.0, 0.0, 0.0);
-      
-      // Draw the main title in gold
-      cairo_draw_text(game->buffer_cr_, title_text, title_x, title_y, 
-                     title_font_size, gold_r, gold_g, gold_b);
-      
       // Draw rules below title
       double rules_y = title_y + 30.0;
       double rules_line_height = rules_font_size + 2;
@@ -155,44 +223,138 @@ gboolean PyramidGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
           "Match pairs that sum to 13:",
           "A+Q=13  2+J=13  3+10=13  4+9=13  5+8=13  6+7=13  K=13"
       };
+      double rule_widths[3];
+      double text_width = title_width;
+      for (int i = 0; i < 3; i++) {
+          rule_widths[i] = cairo_get_text_width(buffer_cr_, rules[i], rules_font_size);
+          text_width = std::max(text_width, rule_widths[i]);
+      }
+      
+      // The text hangs below its last baseline by less than a font size
+      double text_bottom = rules_y + 2 * rules_line_height +
+                           2 * rules_font_size + shadow_offset_y;
+      if (!damage_.item(render::pixelBounds(width - text_width - margin, 0,
+                                            text_width + margin, text_bottom, 2),
+                        render::DrawKey().add(int(ITEM_RULES_TEXT)))) {
+          return;
+      }
+      
+      // Draw title shadow in black
+      cairo_draw_text(buffer_cr_, title_text, title_x + shadow_offset_x, title_y + shadow_offset_y, 
+                     title_font_size, 0.0, 0.0, 0.0);
+      
+      // Draw the main title in gold
+      cairo_draw_text(buffer_cr_, title_text, title_x, title_y, 
+                     title_font_size, gold_r, gold_g, gold_b);
       
       for (int i = 0; i < 3; i++) {
-          double rule_width = cairo_get_text_width(game->buffer_cr_, rules[i], rules_font_size);
-          double rule_x = allocation.width - rule_width - margin;
+          double rule_x = width - rule_widths[i] - margin;
           
           // Draw shadow for rules
-          cairo_draw_text(game->buffer_cr_, rules[i], rule_x + shadow_offset_x, 
+          cairo_draw_text(buffer_cr_, rules[i], rule_x + shadow_offset_x, 
                          rules_y + (i * rules_line_height) + shadow_offset_y,
                          rules_font_size, 0.0, 0.0, 0.0);
           
           // Draw rules text in slightly dimmer gold
-          cairo_draw_text(game->buffer_cr_, rules[i], rule_x, rules_y + (i * rules_line_height),
+          cairo_draw_text(buffer_cr_, rules[i], rule_x, rules_y + (i * rules_line_height),
                          rules_font_size, rules_gold_r, rules_gold_g, rules_gold_b);
       }
   }
+}
 
-  // Copy buffer to window
-  cairo_set_source_surface(cr, game->buffer_surface_, 0, 0);
-  cairo_paint(cr);
+// The static layer: the felt and the piles, without the cards being
+// dragged or animated. The rules text is drawn over the moving cards, so
+// it stays out of it.
+void PyramidGame::drawStaticLayer() {
+  int width = cairo_image_surface_get_width(buffer_surface_);
+  int height = cairo_image_surface_get_height(buffer_surface_);
+  damage_.beginLayer();
 
-  return TRUE;
+  // Clear buffer with background color
+  if (damage_.item(render::Rect(0, 0, width, height),
+                   render::DrawKey().add(int(ITEM_BACKGROUND)))) {
+    cairo_set_source_rgb(buffer_cr_, 0.0, 0.6, 0.0);
+    cairo_paint(buffer_cr_);
+  }
+
+  // Draw main game components in order
+  drawStockPile();
+  drawWastePile();
+  drawDiscardPile();  // Discard pile for matched cards
+  drawFoundationPiles();
+  drawTableauPiles();
+
+  damage_.endLayer();
+}
+
+// Repaints what changed in the cached static layer since it was last
+// painted, made anew after a resize. While cards are dragged or animated
+// over a settled board this finds nothing to do.
+void PyramidGame::updateStaticLayer(int width, int height) {
+  if (static_layer_.resize(width, height)) {
+    damage_.invalidateLayer();
+  }
+  damage_.recordLayer(width, height);
+  drawStaticLayer();
+  std::vector<render::Rect> stale = damage_.finish();
+  if (stale.empty())
+    return;
+
+  // The pile drawing paints into buffer_cr_
+  cairo_t *frame_cr = buffer_cr_;
+  buffer_cr_ = static_layer_.cr();
+  cairo_save(buffer_cr_);
+  render::clipTo(buffer_cr_, stale);
+  damage_.paintLayer(width, height, stale);
+  drawStaticLayer();
+  damage_.finish();
+  cairo_restore(buffer_cr_);
+  buffer_cr_ = frame_cr;
 }
 
-// Initialize or resize the drawing buffer as needed
-void PyramidGame::initializeOrResizeBuffer(int width, int height) {
+// Queues a redraw of what changed since the last frame
+void PyramidGame::queueRedraw() {
+  if (rendering_engine_ == RenderingEngine::OPENGL) {
+    if (gl_area_) {
+      gtk_widget_queue_draw(gl_area_);
+    }
+    return;
+  }
+  if (!game_area_)
+    return;
+
+  // Until the buffer matches the window the next frame paints it whole
+  int width = gtk_widget_get_allocated_width(game_area_);
+  int height = gtk_widget_get_allocated_height(game_area_);
   if (!buffer_surface_ ||
       cairo_image_surface_get_width(buffer_surface_) != width ||
       cairo_image_surface_get_height(buffer_surface_) != height) {
+    gtk_widget_queue_draw(game_area_);
+    return;
+  }
 
-    if (buffer_surface_) {
-      cairo_surface_destroy(buffer_surface_);
-      cairo_destroy(buffer_cr_);
-    }
+  damage_.record(width, height);
+  drawBoard();
+  render::queueDamage(game_area_, damage_.finish());
+}
 
-    buffer_surface_ = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, width, height);
-    buffer_cr_ = cairo_create(buffer_surface_);
+// Initialize or resize the drawing buffer as needed. True if it was
+// (re)created, and so holds nothing yet.
+bool PyramidGame::initializeOrResizeBuffer(int width, int height) {
+  if (buffer_surface_ &&
+      cairo_image_surface_get_width(buffer_surface_) == width &&
+      cairo_image_surface_get_height(buffer_surface_) == height)
+    return false;
+
+  if (buffer_surface_) {
+    cairo_surface_destroy(buffer_surface_);
+    cairo_destroy(buffer_cr_);
   }
+
+  buffer_surface_ = cairo_image_surface_create(
+      CAIRO_FORMAT_ARGB32, width, height);
+  buffer_cr_ = cairo_create(buffer_surface_);
+  return true;
 }
 
 // Draw foundation pile during win animation
@@ -290,30 +452,26 @@ void PyramidGame::drawDraggedCards() {
 
 // Draw the win animation effects
 void PyramidGame::drawWinAnimation() {
+  // The cards still whole, with rotation
   for (const auto &anim_card : animated_cards_) {
-    if (!anim_card.active)
-      continue;
-
-    if (!anim_card.exploded) {
-      // Draw the whole card with rotation
+    if (anim_card.active && !anim_card.exploded)
       drawAnimatedCard(buffer_cr_, anim_card);
-    } else {
-      // Draw all the fragments for this card
-      for (const auto &fragment : anim_card.fragments) {
-        if (fragment.active) {
-          drawCardFragment(buffer_cr_, fragment);
-        }
-      }
-    }
   }
+
+  // Then the fragments of those that exploded
+  for (size_t i = 0; i < fragments_.size(); i++)
+    drawCardFragment(buffer_cr_, i);
 }
 
 // Draw the deal animation
 void PyramidGame::drawDealAnimation() {
   // Debug indicator - small red square to indicate deal animation is active
-  cairo_set_source_rgb(buffer_cr_, 1.0, 0.0, 0.0);
-  cairo_rectangle(buffer_cr_, 10, 10, 10, 10);
-  cairo_fill(buffer_cr_);
+  if (damage_.item(render::Rect(10, 10, 10, 10),
+                   render::DrawKey().add(int(ITEM_DEAL_MARKER)))) {
+    cairo_set_source_rgb(buffer_cr_, 1.0, 0.0, 0.0);
+    cairo_rectangle(buffer_cr_, 10, 10, 10, 10);
+    cairo_fill(buffer_cr_);
+  }
 
   for (const auto &anim_card : deal_cards_) {
     if (anim_card.active) {
@@ -323,8 +481,9 @@ void PyramidGame::drawDealAnimation() {
 }
 
 void PyramidGame::explodeCard(AnimatedCard &card) {
-  // Mark the card as exploded
+  // Mark the card as exploded; its fragments are drawn from here on
   card.exploded = true;
+  card.active = false;
 
   playSound(GameSoundEvent::Firework);
 
@@ -333,29 +492,24 @@ void PyramidGame::explodeCard(AnimatedCard &card) {
   if (!card_surface)
     return;
 
-  // Create fragments
-  card.fragments.clear();
-
   // Split the card into smaller fragments for more dramatic effect (4x4 grid)
-  const int grid_size = 4;
-  const int fragment_width = current_card_width_ / grid_size;
-  const int fragment_height = current_card_height_ / grid_size;
+  const int grid_size = FRAGMENT_GRID;
+  const int card_id = render::cardId(card.card);
+  // Fractional, so the cells cover the whole card
+  const double fragment_width = double(current_card_width_) / grid_size;
+  const double fragment_height = double(current_card_height_) / grid_size;
 
   for (int row = 0; row < grid_size; row++) {
     for (int col = 0; col < grid_size; col++) {
-      CardFragment fragment;
-
       // Initial position
-      fragment.x = card.x + col * fragment_width;
-      fragment.y = card.y + row * fragment_height;
-      fragment.width = fragment_width;
-      fragment.height = fragment_height;
+      double x = card.x + col * fragment_width;
+      double y = card.y + row * fragment_height;
 
       // Calculate distance from center of the card
       double center_x = card.x + current_card_width_ / 2;
       double center_y = card.y + current_card_height_ / 2;
-      double fragment_center_x = fragment.x + fragment_width / 2;
-      double fragment_center_y = fragment.y + fragment_height / 2;
+      double fragment_center_x = x + fragment_width / 2;
+      double fragment_center_y = y + fragment_height / 2;
 
       // Direction vector from center of card
       double dir_x = fragment_center_x - center_x;
@@ -377,54 +531,16 @@ void PyramidGame::explodeCard(AnimatedCard &card) {
       double speed = 12.0 + (rand() % 8);
       double upward_bias = -15.0 - (rand() % 10);
 
-      fragment.velocity_x = dir_x * speed + (rand() % 10 - 5);
-      fragment.velocity_y = dir_y * speed + upward_bias;
+      double velocity_x = dir_x * speed + (rand() % 10 - 5);
+      double velocity_y = dir_y * speed + upward_bias;
 
       // Rotation
-      fragment.rotation = card.rotation;
-      fragment.rotation_velocity = (rand() % 60 - 30) / 5.0;
-
-      // Create a new image surface
-      fragment.surface = cairo_image_surface_create(
-          CAIRO_FORMAT_ARGB32, fragment_width, fragment_height);
-
-      if (cairo_surface_status(fragment.surface) != CAIRO_STATUS_SUCCESS) {
-        // Clean up and skip this fragment if we couldn't create the surface
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-        continue;
-      }
-
-      // Create a context for drawing on the new surface
-      cairo_t *cr = cairo_create(fragment.surface);
-      if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
-        // Clean up and skip this fragment if we couldn't create the context
-        cairo_destroy(cr);
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-        continue;
-      }
-
-      // Draw white background (for transparency)
-      cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.0);
-      cairo_rectangle(cr, 0, 0, fragment_width, fragment_height);
-      cairo_fill(cr);
-
-      // Draw the fragment of the card
-      cairo_set_source_surface(cr, card_surface, -col * fragment_width,
-                               -row * fragment_height);
-
-      if (cairo_status(cr) == CAIRO_STATUS_SUCCESS) {
-        cairo_rectangle(cr, 0, 0, fragment_width, fragment_height);
-        cairo_fill(cr);
-      }
+      double spin = (rand() % 60 - 30) / 5.0;
 
-      // Clean up the drawing context
-      cairo_destroy(cr);
-
-      // Set the fragment as active
-      fragment.active = true;
-      card.fragments.push_back(fragment);
+      // Set it flying; it is drawn from its cell of the card's surface
+      fragments_.add(x, y, fragment_width, fragment_height, velocity_x,
+                     velocity_y, card.rotation, spin,
+                     uint32_t((card_id * grid_size + row) * grid_size + col));
     }
   }
 
@@ -771,6 +887,16 @@ void PyramidGame::drawAnimatedCard(cairo_t *cr,
   if (!anim_card.active)
     return;
 
+  // Between whole pixels a card looks different too
+  render::Rect bounds =
+      render::rotatedBounds(anim_card.x, anim_card.y, current_card_width_,
+                            current_card_height_, anim_card.rotation);
+  render::DrawKey key =
+      cardKey(ITEM_ANIMATED_CARD, &anim_card.card, anim_card.face_up);
+  key.add(anim_card.x).add(anim_card.y).add(anim_card.rotation);
+  if (!damage_.item(bounds, key))
+    return;
+
   // Draw the card with rotation
   cairo_save(cr);
 
@@ -781,7 +907,7 @@ void PyramidGame::drawAnimatedCard(cairo_t *cr,
   cairo_translate(cr, -current_card_width_ / 2, -current_card_height_ / 2);
 
   // Draw the card with its actual face-up status
-  drawCard(cr, 0, 0, &anim_card.card, anim_card.face_up);
+  paintCard(cr, 0, 0, &anim_card.card, anim_card.face_up);
 
   cairo_restore(cr);
 }
@@ -1009,8 +1135,15 @@ void PyramidGame::highlightSelectedCard(cairo_t *cr) {
   }
 
   // Choose highlight color based on whether we're selecting a card to move
-  if (keyboard_selection_active_ && source_pile_ == selected_pile_ &&
-      (source_card_idx_ == selected_card_idx_ || selected_card_idx_ == -1)) {
+  bool is_source =
+      keyboard_selection_active_ && source_pile_ == selected_pile_ &&
+      (source_card_idx_ == selected_card_idx_ || selected_card_idx_ == -1);
+  if (!damage_.item(render::pixelBounds(x - 2, y - 2, current_card_width_ + 4,
+                                        current_card_height_ + 4, 2),
+                    render::DrawKey().add(int(ITEM_HIGHLIGHT)).add(is_source)))
+    return;
+
+  if (is_source) {
     // Source card/pile is highlighted in blue
     cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.5); // Semi-transparent blue
   } else {
@@ -1025,6 +1158,12 @@ void PyramidGame::highlightSelectedCard(cairo_t *cr) {
 }
 
 PyramidGame::~PyramidGame() {
+  // A rating still running posts its result to the main loop when done
+  if (difficulty_thread_.joinable()) {
+    difficulty_cancel_ = true;
+    difficulty_thread_.join();
+    g_idle_remove_by_data(this);
+  }
   if (buffer_cr_) {
     cairo_destroy(buffer_cr_);
   }
@@ -1036,85 +1175,51 @@ PyramidGame::~PyramidGame() {
 
 void PyramidGame::drawCard(cairo_t *cr, int x, int y,
                              const cardlib::Card *card, bool face_up) {
-  if (face_up && card) {
-
-    std::string key = std::to_string(static_cast<int>(card->suit)) +
-                      std::to_string(static_cast<int>(card->rank));
-    auto it = card_surface_cache_.find(key);
-
-    if (it == card_surface_cache_.end()) {
-      if (auto img = deck_.getCardImage(*card)) {
-        GError *error = nullptr;
-        GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-
-        if (!gdk_pixbuf_loader_write(loader, img->data.data(), img->data.size(),
-                                     &error)) {
-          if (error)
-            g_error_free(error);
-          g_object_unref(loader);
-          return;
-        }
-
-        if (!gdk_pixbuf_loader_close(loader, &error)) {
-          if (error)
-            g_error_free(error);
-          g_object_unref(loader);
-          return;
-        }
-
-        GdkPixbuf *original_pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-        if (original_pixbuf) {
-          GdkPixbuf *scaled_pixbuf = gdk_pixbuf_scale_simple(
-              original_pixbuf,
-              current_card_width_, // Use current dimensions
-              current_card_height_, GDK_INTERP_BILINEAR);
-
-          if (scaled_pixbuf) {
-            cairo_surface_t *surface = cairo_image_surface_create(
-                CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-            cairo_t *surface_cr = cairo_create(surface);
-
-            gdk_cairo_set_source_pixbuf(surface_cr, scaled_pixbuf, 0, 0);
-            cairo_paint(surface_cr);
-            cairo_destroy(surface_cr);
+  if (damage_.item(
+          render::Rect(x, y, current_card_width_, current_card_height_),
+          cardKey(ITEM_CARD, card, face_up))) {
+    paintCard(cr, x, y, card, face_up);
+  }
+}
 
-            card_surface_cache_[key] = surface;
+// drawCard() without the damage tracking, for cards drawn transformed
+void PyramidGame::paintCard(cairo_t *cr, int x, int y,
+                            const cardlib::Card *card, bool face_up) {
+  if (face_up && card) {
 
-            g_object_unref(scaled_pixbuf);
-          }
-        }
-        g_object_unref(loader);
+    int id = render::cardId(*card);
+    cairo_surface_t *surface = card_surface_cache_.get(id);
 
-        it = card_surface_cache_.find(key);
+    if (!surface) {
+      const render::CardAtlas &atlas = *cardAtlas();
+      if (const render::Rect *region = atlas.find(id)) {
+        surface = card_surface_cache_[id] = render::CardScaler::scale(
+            atlas, *region, current_card_width_, current_card_height_);
       }
     }
 
-    if (it != card_surface_cache_.end()) {
+    if (surface) {
       // Scale the surface to the current card dimensions
       cairo_save(cr);
       cairo_scale(cr,
                   (double)current_card_width_ /
-                      cairo_image_surface_get_width(it->second),
+                      cairo_image_surface_get_width(surface),
                   (double)current_card_height_ /
-                      cairo_image_surface_get_height(it->second));
-      cairo_set_source_surface(cr, it->second,
-                               x * cairo_image_surface_get_width(it->second) /
+                      cairo_image_surface_get_height(surface));
+      cairo_set_source_surface(cr, surface,
+                               x * cairo_image_surface_get_width(surface) /
                                    current_card_width_,
-                               y * cairo_image_surface_get_height(it->second) /
+                               y * cairo_image_surface_get_height(surface) /
                                    current_card_height_);
       cairo_paint(cr);
       cairo_restore(cr);
     }
   } else {
-    auto custom_it = card_surface_cache_.find("custom_back");
-    auto default_it = card_surface_cache_.find("back");
     cairo_surface_t *back_surface = nullptr;
-
-    if (!custom_back_path_.empty() && custom_it != card_surface_cache_.end()) {
-      back_surface = custom_it->second;
-    } else if (default_it != card_surface_cache_.end()) {
-      back_surface = default_it->second;
-    }
+    if (!custom_back_path_.empty())
+      back_surface = card_surface_cache_.get(render::CUSTOM_BACK_ID);
+    if (!back_surface)
+      back_surface = card_surface_cache_.get(render::BACK_ID);
 
     if (back_surface) {
       // Scale the surface to the current card dimensions
@@ -1141,79 +1246,73 @@ void PyramidGame::drawCard(cairo_t *cr, int x, int y,
 }
 
 void PyramidGame::initializeCardCache() {
-  // Pre-load all card images into cairo surfaces with current dimensions
+  // Scale every card image out of the atlas with current dimensions
   cleanupCardCache();
 
-  for (const auto &card : deck_.getAllCards()) {
-    if (auto img = deck_.getCardImage(card)) {
-      GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-      gdk_pixbuf_loader_write(loader, img->data.data(), img->data.size(),
-                              nullptr);
-      gdk_pixbuf_loader_close(loader, nullptr);
-
-      GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-      GdkPixbuf *scaled =
-          gdk_pixbuf_scale_simple(pixbuf, current_card_width_,
-                                  current_card_height_, GDK_INTERP_BILINEAR);
-
-      cairo_surface_t *surface = cairo_image_surface_create(
-          CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-      cairo_t *cr = cairo_create(surface);
-      gdk_cairo_set_source_pixbuf(cr, scaled, 0, 0);
-      cairo_paint(cr);
-      cairo_destroy(cr);
-
-      std::string key = std::to_string(static_cast<int>(card.suit)) +
-                        std::to_string(static_cast<int>(card.rank));
-      card_surface_cache_[key] = surface;
-
-      g_object_unref(scaled);
-      g_object_unref(loader);
-    }
+  const render::CardAtlas &atlas = *cardAtlas();
+  for (const auto &[id, region] : atlas.regions()) {
+    card_surface_cache_[id] = render::CardScaler::scale(
+        atlas, region, current_card_width_, current_card_height_);
   }
 
-  // Cache card back
-  if (auto back_img = deck_.getCardBackImage()) {
-    GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-    gdk_pixbuf_loader_write(loader, back_img->data.data(),
-                            back_img->data.size(), nullptr);
-    gdk_pixbuf_loader_close(loader, nullptr);
-
-    GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-    GdkPixbuf *scaled = gdk_pixbuf_scale_simple(
-        pixbuf, current_card_width_, current_card_height_, GDK_INTERP_BILINEAR);
+  card_scaler_.built(current_card_width_, current_card_height_);
+}
 
-    cairo_surface_t *surface = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-    cairo_t *cr = cairo_create(surface);
-    gdk_cairo_set_source_pixbuf(cr, scaled, 0, 0);
-    cairo_paint(cr);
-    cairo_destroy(cr);
+void PyramidGame::rescaleCardCache() {
+  // Nothing to draw from in the meantime
+  if (card_surface_cache_.empty()) {
+    initializeCardCache();
+    return;
+  }
+  if (!card_scaler_.needs(current_card_width_, current_card_height_))
+    return;
 
-    card_surface_cache_["back"] = surface;
+  card_scaler_.start(cardAtlas(), current_card_width_,
+                     current_card_height_, 1, card_surface_cache_, [this] {
+                       // Every card on screen is redrawn with the new
+                       // surfaces
+                       damage_.invalidate();
+                       queueRedraw();
+                     });
+}
 
-    g_object_unref(scaled);
-    g_object_unref(loader);
+const std::shared_ptr<const render::CardAtlas> &PyramidGame::cardAtlas() {
+  // Decoded again only when the deck's images change, never for a new
+  // size or rendering engine
+  if (!card_atlas_ || card_atlas_->source() != deck_.imageSerial()) {
+    std::vector<render::EncodedImage> images;
+    for (const auto &image : deck_.getCardImages()) {
+      if (!image.card_info || image.card_info->is_alternate_art)
+        continue;
+      const cardlib::Card &card = *image.card_info;
+      images.push_back({render::cardId(card), &image.data});
+    }
+    if (auto back_img = deck_.getCardBackImage()) {
+      images.push_back({render::BACK_ID, &back_img->data});
+    }
+    card_atlas_ = render::decodeCardAtlas(images, deck_.imageSerial());
   }
+  return card_atlas_;
 }
 
 void PyramidGame::cleanupCardCache() {
-  for (auto &[key, surface] : card_surface_cache_) {
-    cairo_surface_destroy(surface);
+  // Every card on screen is redrawn with the new images
+  damage_.invalidate();
+  // A rescale still in flight would bring the old images back
+  card_scaler_.cancel();
+  for (cairo_surface_t *surface : card_surface_cache_) {
+    if (surface)
+      cairo_surface_destroy(surface);
   }
   card_surface_cache_.clear();
 }
 
 cairo_surface_t *PyramidGame::getCardSurface(const cardlib::Card &card) {
-  std::string key = std::to_string(static_cast<int>(card.suit)) +
-                    std::to_string(static_cast<int>(card.rank));
-  auto it = card_surface_cache_.find(key);
-  return it != card_surface_cache_.end() ? it->second : nullptr;
+  return card_surface_cache_.get(render::cardId(card));
 }
 
 cairo_surface_t *PyramidGame::getCardBackSurface() {
-  auto it = card_surface_cache_.find("back");
-  return it != card_surface_cache_.end() ? it->second : nullptr;
+  return card_surface_cache_.get(render::BACK_ID);
 }
 
 void PyramidGame::cleanupResources() {
@@ -1235,10 +1334,10 @@ void PyramidGame::clearCustomBack() {
   custom_back_path_.clear();
 
   // Remove the custom back from cache if it exists
-  auto it = card_surface_cache_.find("custom_back");
-  if (it != card_surface_cache_.end()) {
-    cairo_surface_destroy(it->second);
-    card_surface_cache_.erase(it);
+  if (cairo_surface_t *surface =
+          card_surface_cache_.take(render::CUSTOM_BACK_ID)) {
+    cairo_surface_destroy(surface);
+    damage_.invalidate();
   }
 
   // Update settings file
@@ -1246,6 +1345,11 @@ void PyramidGame::clearCustomBack() {
 }
 
 void PyramidGame::drawEmptyPile(cairo_t *cr, int x, int y) {
+  if (!damage_.item(render::pixelBounds(x, y, current_card_width_,
+                                        current_card_height_, 1),
+                    render::DrawKey().add(int(ITEM_EMPTY_PILE))))
+    return;
+
   // Draw a placeholder for an empty pile (cell or foundation)
   cairo_save(cr);
   
@@ -1310,7 +1414,7 @@ void PyramidGame::refreshCardCache() {
               cairo_paint(surface_cr);
               cairo_destroy(surface_cr);
 
-              card_surface_cache_["custom_back"] = surface;
+              card_surface_cache_[render::CUSTOM_BACK_ID] = surface;
 
               g_object_unref(scaled);
             }
@@ -1336,23 +1440,7 @@ void PyramidGame::clearAndRebuildCaches() {
   cleanupCardCache();
 
 #ifdef USEOPENGL
-  // Clear and rebuild OpenGL card texture cache
-  if (cardTextures_gl_.size() > 0) {
-    for (auto &[key, texture] : cardTextures_gl_) {
-      if (texture != 0) {
-        glDeleteTextures(1, &texture);
-      }
-    }
-    cardTextures_gl_.clear();
-  }
-  
-  // Clear OpenGL card back texture
-  if (cardBackTexture_gl_ != 0) {
-    glDeleteTextures(1, &cardBackTexture_gl_);
-    cardBackTexture_gl_ = 0;
-  }
-  
-  // Rebuild OpenGL textures
+  // Rebuild OpenGL textures: the deck's images replace every layer
   initializeCardTextures_gl();
 #endif
   
@@ -15,44 +15,6 @@
 #include "render_gl_text.h"
 
 // OpenGL 3.4 Shader sources
-static const char *VERTEX_SHADER_GL = R"(
-    #version 330 core
-    layout(location = 0) in vec2 position;
-    layout(location = 1) in vec2 texCoord;
-    
-    uniform mat4 projection;
-    uniform mat4 view;
-    uniform mat4 model;
-    
-    out VS_OUT {
-        vec2 texCoord;
-    } vs_out;
-    
-    void main()
-    {
-        gl_Position = projection * view * model * vec4(position, 0.0, 1.0);
-        vs_out.texCoord = texCoord;
-    }
-)";
-
-static const char *FRAGMENT_SHADER_GL = R"(
-    #version 330 core
-    in VS_OUT {
-        vec2 texCoord;
-    } fs_in;
-    
-    uniform sampler2D cardTexture;
-    uniform float alpha;
-    
-    out vec4 FragColor;
-    
-    void main()
-    {
-        vec4 texColor = texture(cardTexture, fs_in.texCoord);
-        FragColor = vec4(texColor.rgb, texColor.a * alpha);
-    }
-)";
-
 static const char *FRAGMENT_SHADER_SIMPLE_GL = R"(
     #version 330 core
     
@@ -320,61 +282,16 @@ void PyramidGame::explodeCard_gl(AnimatedCard &card) {
     card.exploded = true;
     playSound(GameSoundEvent::Firework);
 
-    card.fragments.clear();
-
-    const int grid_size = 4;
-    const int fragment_width = current_card_width_ / grid_size;
-    const int fragment_height = current_card_height_ / grid_size;
-
-    for (int row = 0; row < grid_size; row++) {
-        for (int col = 0; col < grid_size; col++) {
-            CardFragment fragment;
-
-            fragment.x = card.x + col * fragment_width;
-            fragment.y = card.y + row * fragment_height;
-            fragment.width = fragment_width;
-            fragment.height = fragment_height;
-
-            double center_x = card.x + current_card_width_ / 2;
-            double center_y = card.y + current_card_height_ / 2;
-            double fragment_center_x = fragment.x + fragment_width / 2;
-            double fragment_center_y = fragment.y + fragment_height / 2;
-
-            double dir_x = fragment_center_x - center_x;
-            double dir_y = fragment_center_y - center_y;
-
-            double magnitude = sqrt(dir_x * dir_x + dir_y * dir_y);
-            if (magnitude > 0.001) {
-                dir_x /= magnitude;
-                dir_y /= magnitude;
-            } else {
-                double rand_angle = 2.0 * M_PI * (rand() % 1000) / 1000.0;
-                dir_x = cos(rand_angle);
-                dir_y = sin(rand_angle);
-            }
-
-            double speed = 12.0 + (rand() % 8);
-            double upward_bias = -15.0 - (rand() % 10);
-
-            fragment.velocity_x = dir_x * speed + (rand() % 10 - 5);
-            fragment.velocity_y = dir_y * speed + upward_bias;
-
-            fragment.rotation = card.rotation;
-            fragment.rotation_velocity = (rand() % 60 - 30) / 5.0;
-            fragment.surface = nullptr;
-            fragment.active = true;
-            
-            // Store grid position in target_x and target_y for texture coordinate calculation
-            // These fields are not used during explosion animation
-            fragment.target_x = col / (double)grid_size;  // UV start X (0.0, 0.25, 0.5, 0.75)
-            fragment.target_y = row / (double)grid_size;  // UV start Y
-            
-            // Store card info for drawing - encode as "card_suit_rank" in face_up (as bool, so just use flag)
-            // Actually, we'll rely on finding the card through the animated_cards_ iteration
-
-            card.fragments.push_back(fragment);
-        }
-    }
+    // The GPU works the fragments out from here on (see gl_explosions.h);
+    // the card itself takes no more updates
+    GtkAllocation allocation;
+    gtk_widget_get_allocation(game_area_, &allocation);
+    int id = render::cardId(card.card);
+    explosions_gl_.launch(card_batch_gl_.layer(id), card.x, card.y,
+                          current_card_width_, current_card_height_,
+                          card.rotation, GRAVITY, 0.9f, allocation.width,
+                          allocation.height);
+    card.active = false;
 }
 
 // ============================================================================
@@ -382,137 +299,21 @@ void PyramidGame::explodeCard_gl(AnimatedCard &card) {
 // ============================================================================
 
 void PyramidGame::drawAnimatedCard_gl(const AnimatedCard &anim_card,
-                                        GLuint shaderProgram,
-                                        GLuint VAO) {
+                                        GLuint, GLuint) {
     if (!anim_card.active)
         return;
 
-    glm::mat4 model = glm::mat4(1.0f);
-    
-    // With 0-1 vertex coordinates, center is at (0.5, 0.5) in local space
-    model = glm::translate(model, glm::vec3(anim_card.x, anim_card.y, 0.0f));
-    model = glm::translate(model, glm::vec3(current_card_width_ * 0.5f, 
-                                             current_card_height_ * 0.5f, 0.0f));
-    model = glm::rotate(model, static_cast<float>(anim_card.rotation), 
-                        glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::translate(model, glm::vec3(-current_card_width_ * 0.5f, 
-                                             -current_card_height_ * 0.5f, 0.0f));
-    model = glm::scale(model, glm::vec3(current_card_width_, current_card_height_, 1.0f));
-
-    glUseProgram(shaderProgram);
-    
-    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    
-    // Bind the card texture
-    GLint texLoc = glGetUniformLocation(shaderProgram, "cardTexture");
-    glUniform1i(texLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    
-    // Get the card image and bind it
-    GLuint texture = cardBackTexture_gl_;
-    auto card_image = deck_.getCardImage(anim_card.card);
-    if (card_image && !card_image->data.empty()) {
-        std::string card_key = std::to_string((int)anim_card.card.suit) + "_" + 
-                               std::to_string((int)anim_card.card.rank);
-        auto it = cardTextures_gl_.find(card_key);
-        
-        if (it != cardTextures_gl_.end()) {
-            texture = it->second;
-        } else {
-            texture = loadTextureFromMemory(card_image->data);
-            if (texture != 0) {
-                cardTextures_gl_[card_key] = texture;
-            }
-        }
-    }
-    
-    glBindTexture(GL_TEXTURE_2D, texture);
-    
-    // Set alpha
-    GLint alphaLoc = glGetUniformLocation(shaderProgram, "alpha");
-    glUniform1f(alphaLoc, 1.0f);
-    
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-}
-
-void PyramidGame::drawCardFragment_gl(const CardFragment &fragment,
-                                        const AnimatedCard &card,
-                                        GLuint shaderProgram,
-                                        GLuint VAO) {
-    if (!fragment.active)
-        return;
-
-    // Get the card texture for this fragment
-    GLuint cardTexture = cardBackTexture_gl_;
-    auto card_image = deck_.getCardImage(card.card);
-    if (card_image && !card_image->data.empty()) {
-        std::string card_key = std::to_string((int)card.card.suit) + "_" + 
-                               std::to_string((int)card.card.rank);
-        auto it = cardTextures_gl_.find(card_key);
-        
-        if (it != cardTextures_gl_.end()) {
-            cardTexture = it->second;
-        } else {
-            cardTexture = loadTextureFromMemory(card_image->data);
-            if (cardTexture != 0) {
-                cardTextures_gl_[card_key] = cardTexture;
-            }
-        }
-    }
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    
-    model = glm::translate(model, glm::vec3(fragment.x, fragment.y, 0.0f));
-    model = glm::translate(model, glm::vec3(fragment.width * 0.5f, 
-                                             fragment.height * 0.5f, 0.0f));
-    model = glm::rotate(model, static_cast<float>(fragment.rotation), 
-                        glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::translate(model, glm::vec3(-fragment.width * 0.5f, 
-                                             -fragment.height * 0.5f, 0.0f));
-    model = glm::scale(model, glm::vec3(fragment.width, fragment.height, 1.0f));
-
-    glUseProgram(shaderProgram);
-    
-    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    
-    // Bind the card front texture (not the back!)
-    GLint texLoc = glGetUniformLocation(shaderProgram, "cardTexture");
-    glUniform1i(texLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, cardTexture);
-    
-    // Use the texture coordinates from the fragment (stored in target_x/target_y)
-    // These are normalized coordinates for the grid position (0-0.25, 0.25-0.5, etc.)
-    GLint texCoordLoc = glGetUniformLocation(shaderProgram, "texCoordOffset");
-    if (texCoordLoc != -1) {
-        glUniform2f(texCoordLoc, static_cast<float>(fragment.target_x), 
-                                 static_cast<float>(fragment.target_y));
-    }
-    
-    // Fragment of card is slightly transparent to show explosion effect
-    GLint alphaLoc = glGetUniformLocation(shaderProgram, "alpha");
-    glUniform1f(alphaLoc, 0.9f);
-    
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // Queued for the frame's one draw (see renderFrame_gl())
+    card_batch_gl_.add(render::cardId(anim_card.card), anim_card.x,
+                       anim_card.y, current_card_width_, current_card_height_,
+                       anim_card.rotation);
 }
 
 void PyramidGame::drawWinAnimation_gl(GLuint shaderProgram, GLuint VAO) {
+    // Exploded cards are explosions_gl_'s, drawn after the batch
     for (const auto &anim_card : animated_cards_) {
-        if (!anim_card.active)
-            continue;
-
-        if (!anim_card.exploded) {
+        if (anim_card.active && !anim_card.exploded) {
             drawAnimatedCard_gl(anim_card, shaderProgram, VAO);
-        } else {
-            for (const auto &fragment : anim_card.fragments) {
-                if (fragment.active) {
-                    drawCardFragment_gl(fragment, anim_card, shaderProgram, VAO);
-                }
-            }
         }
     }
 }
@@ -566,86 +367,11 @@ GLuint PyramidGame::setupCardQuadVAO_gl() {
         return 0;
     }
     
-    if (!is_glew_initialized_) {
-        std::cerr << "✗ Cannot setup VAO - GLEW not initialized" << std::endl;
-        return 0;
-    }
-    
-    static const float quadVertices[] = {
-         0.0f,  0.0f,  0.0f, 0.0f,
-         1.0f,  0.0f,  1.0f, 0.0f,
-         1.0f,  1.0f,  1.0f, 1.0f,
-         0.0f,  1.0f,  0.0f, 1.0f
-    };
-    
-    static const unsigned int indices[] = {
-        0, 1, 2,
-        2, 3, 0
-    };
-    
-    GLuint VAO = 0, VBO = 0, EBO = 0;
-    
-    GLenum err = glGetError();
-    while (err != GL_NO_ERROR) {
-        std::cout << "  Clearing pre-existing GL error: " << err << std::endl;
-        err = glGetError();
-    }
-    
-    std::cout << "  Generating VAO..." << std::endl;
-    glGenVertexArrays(1, &VAO);
-    err = glGetError();
-    if (err != GL_NO_ERROR) {
-        std::cerr << "  ✗ glGenVertexArrays failed with error: " << err << std::endl;
-        return 0;
-    }
+    // The batch's, made with its program in setupShaders_gl(): the quad's
+    // corners come from gl_VertexID, the cards from its instance buffer
+    GLuint VAO = card_batch_gl_.vertexArray();
     if (VAO == 0) {
-        std::cerr << "  ✗ glGenVertexArrays returned invalid VAO (0)" << std::endl;
-        return 0;
-    }
-    std::cout << "    ✓ VAO generated (ID: " << VAO << ")" << std::endl;
-    
-    std::cout << "  Generating VBO..." << std::endl;
-    glGenBuffers(1, &VBO);
-    err = glGetError();
-    if (err != GL_NO_ERROR || VBO == 0) {
-        std::cerr << "  ✗ glGenBuffers(VBO) failed with error: " << err << std::endl;
-        glDeleteVertexArrays(1, &VAO);
-        return 0;
-    }
-    std::cout << "    ✓ VBO generated (ID: " << VBO << ")" << std::endl;
-    
-    std::cout << "  Generating EBO..." << std::endl;
-    glGenBuffers(1, &EBO);
-    err = glGetError();
-    if (err != GL_NO_ERROR || EBO == 0) {
-        std::cerr << "  ✗ glGenBuffers(EBO) failed with error: " << err << std::endl;
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
-        return 0;
-    }
-    std::cout << "    ✓ EBO generated (ID: " << EBO << ")" << std::endl;
-    
-    std::cout << "  Configuring VAO..." << std::endl;
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    
-    err = glGetError();
-    if (err != GL_NO_ERROR) {
-        std::cerr << "  ✗ OpenGL error during VAO configuration: " << err << std::endl;
-        glDeleteBuffers(1, &EBO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+        std::cerr << "✗ Card batch has no VAO - shaders not set up" << std::endl;
         return 0;
     }
     
@@ -661,15 +387,26 @@ GLuint PyramidGame::setupShaders_gl() {
         return 0;
     }
     
-    GLuint program = createShaderProgram_gl(VERTEX_SHADER_GL, FRAGMENT_SHADER_GL);
-    
-    if (program == 0) {
+    // The card program is the batch's (see gl_card_batch.h)
+    if (!card_batch_gl_.create()) {
         std::cerr << "✗ Failed to create shader program" << std::endl;
         return 0;
     }
     
+    // Highlight outlines (see gl_overlay.h)
+    if (!overlay_gl_.create()) {
+        std::cerr << "✗ Failed to create overlay shader program" << std::endl;
+        return 0;
+    }
+    
+    // The win animation's explosions (see gl_explosions.h)
+    if (!explosions_gl_.create()) {
+        std::cerr << "✗ Failed to create explosion shader program" << std::endl;
+        return 0;
+    }
+    
     std::cout << "✓ Shaders setup complete" << std::endl;
-    return program;
+    return card_batch_gl_.program();
 }
 
 bool PyramidGame::reloadCustomCardBackTexture_gl() {
@@ -701,19 +438,20 @@ bool PyramidGame::reloadCustomCardBackTexture_gl() {
         }
         file.close();
 
-        // Delete old texture if it exists
-        if (cardBackTexture_gl_ != 0) {
-            glDeleteTextures(1, &cardBackTexture_gl_);
-            cardBackTexture_gl_ = 0;
-        }
-
-        // Load custom back image and create new texture
+        // Decode it into the custom back's layer of the card texture,
+        // which face-down cards show from then on
         std::cout << "Loading custom card back texture from: " << custom_back_path_ << std::endl;
-        cardBackTexture_gl_ = loadTextureFromMemory(imageData);
-        
-        if (cardBackTexture_gl_ != 0) {
-            std::cout << "✓ Custom card back texture loaded successfully (Texture ID: " 
-                      << cardBackTexture_gl_ << ")" << std::endl;
+        int width, height, channels;
+        unsigned char *pixels = stbi_load_from_memory(
+            imageData.data(), imageData.size(),
+            &width, &height, &channels, STBI_rgb_alpha
+        );
+        bool uploaded = pixels && card_batch_gl_.upload(
+            render::CUSTOM_BACK_ID, width, height, pixels);
+        stbi_image_free(pixels);
+        
+        if (uploaded) {
+            std::cout << "✓ Custom card back texture loaded successfully" << std::endl;
             return true;
         } else {
             std::cerr << "ERROR: Failed to create texture from custom back image" << std::endl;
@@ -735,70 +473,29 @@ bool PyramidGame::initializeCardTextures_gl() {
     }
     
     try {
-        // CRITICAL FIX: Load the actual card back image from the deck
-        if (auto back_img = deck_.getCardBackImage()) {
-            if (!back_img->data.empty()) {
-                std::cout << "  Loading actual card back image from deck..." << std::endl;
-                cardBackTexture_gl_ = loadTextureFromMemory(back_img->data);
-                if (cardBackTexture_gl_ != 0) {
-                    std::cout << "✓ Card back texture loaded successfully (Texture ID: " 
-                              << cardBackTexture_gl_ << ")" << std::endl;
-                    return true;
-                } else {
-                    std::cerr << "  ⚠ Failed to load card back from memory, creating fallback..." << std::endl;
-                }
-            }
-        }
-        
-        // Fallback: Create a placeholder texture if real card back failed to load
-        const int TEX_WIDTH = 32;
-        const int TEX_HEIGHT = 48;
-        const int TEX_CHANNELS = 4;
-        
-        std::cout << "  Creating fallback placeholder texture (" << TEX_WIDTH << "x" << TEX_HEIGHT << ")..." << std::endl;
-        
-        // Create a nice gray placeholder instead of pure white
-        unsigned char textureData[TEX_WIDTH * TEX_HEIGHT * TEX_CHANNELS];
-        memset(textureData, 200, sizeof(textureData)); // Gray color instead of white
-        
-        GLuint texture = 0;
-        glGenTextures(1, &texture);
-        
-        if (texture == 0) {
-            std::cerr << "  ✗ ERROR: Failed to generate texture object" << std::endl;
+        // Every image of the deck, into a layer each of the batch's texture
+        if (!card_batch_gl_.load(*cardAtlas())) {
+            std::cerr << "✗ ERROR: Failed to upload card textures" << std::endl;
             std::cerr << "    GL Error: " << glGetError() << std::endl;
             return false;
         }
-        std::cout << "    ✓ Texture object created (ID: " << texture << ")" << std::endl;
         
-        glBindTexture(GL_TEXTURE_2D, texture);
-        
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "  ✗ ERROR: Failed to bind texture: " << err << std::endl;
-            glDeleteTextures(1, &texture);
-            return false;
+        // Fallback: a gray placeholder if the deck has no card back
+        if (!card_batch_gl_.has(render::BACK_ID)) {
+            std::cerr << "  ⚠ No card back in the deck, using a placeholder" << std::endl;
+            card_batch_gl_.fill(render::BACK_ID, 200, 200, 200, 200);
         }
         
-        std::cout << "  Setting texture parameters..." << std::endl;
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        std::cout << "  Uploading texture data..." << std::endl;
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, TEX_WIDTH, TEX_HEIGHT, 0, 
-                     GL_RGBA, GL_UNSIGNED_BYTE, textureData);
+        // Empty piles: light gray at half opacity, matching Cairo's
+        // RGBA(0.85, 0.85, 0.85, 0.5)
+        card_batch_gl_.fill(render::GLCardBatch::EMPTY_PILE_ID, 216, 216, 216, 127);
         
-        err = glGetError();
-        if (err != GL_NO_ERROR) {
-            std::cerr << "  ✗ ERROR: Failed to upload texture data: " << err << std::endl;
-            glDeleteTextures(1, &texture);
-            return false;
+        // Loading the deck emptied the custom back's layer
+        if (!custom_back_path_.empty()) {
+            reloadCustomCardBackTexture_gl();
         }
         
-        cardBackTexture_gl_ = texture;
-        std::cout << "✓ Card textures initialized successfully (Texture ID: " << texture << ")" << std::endl;
+        std::cout << "✓ Card textures initialized successfully" << std::endl;
         return true;
         
     } catch (const std::exception &e) {
@@ -897,96 +594,14 @@ bool PyramidGame::initializeRenderingEngine_gl() {
 // GL DRAWING FUNCTIONS FOR GAME PILES
 // ============================================================================
 
-GLuint PyramidGame::loadTextureFromMemory(const std::vector<unsigned char> &data) {
-    if (data.empty()) return 0;
-    
-    // Decode PNG from memory
-    int width, height, channels;
-    unsigned char *pixels = stbi_load_from_memory(
-        data.data(), data.size(), 
-        &width, &height, &channels, STBI_rgb_alpha
-    );
-    
-    if (!pixels) {
-        fprintf(stderr, "[GL] ERROR: Failed to decode PNG from memory\n");
-        return 0;
-    }
-    
-    // Create texture
-    GLuint texture = 0;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, 
-                 GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-    
-    stbi_image_free(pixels);
-    return texture;
-}
-
 void PyramidGame::drawCard_gl(const cardlib::Card &card, int x, int y, bool face_up) {
     static int count = 0;
     if (count++ == 0) fprintf(stderr, "[GL] DRAWING CARDS NOW\n");
     
-    if (cardShaderProgram_gl_ == 0 || cardQuadVAO_gl_ == 0) {
-        return;
-    }
-    
-    // Default to card back texture
-    GLuint texture = cardBackTexture_gl_;
-    
-    if (face_up) {
-        // Try to get the face-up card image
-        auto card_image = deck_.getCardImage(card);
-        if (card_image && !card_image->data.empty()) {
-            std::string card_key = std::to_string((int)card.suit) + "_" + std::to_string((int)card.rank);
-            auto it = cardTextures_gl_.find(card_key);
-            
-            if (it != cardTextures_gl_.end()) {
-                // Use cached texture
-                texture = it->second;
-            } else {
-                // Load texture and cache it
-                texture = loadTextureFromMemory(card_image->data);
-                if (texture != 0) {
-                    cardTextures_gl_[card_key] = texture;
-                } else {
-                    // Fallback to card back if loading failed
-                    texture = cardBackTexture_gl_;
-                }
-            }
-        }
-    }
-    // For face_down cards, use the default cardBackTexture_gl_ already set above
-    
-    // Draw card at position
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3((float)x, (float)y, 0.0f));
-    model = glm::scale(model, glm::vec3((float)current_card_width_, (float)current_card_height_, 1.0f));
-    
-    GLint modelLoc = glGetUniformLocation(cardShaderProgram_gl_, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    
-    // Set alpha uniform to fully opaque
-    GLint alphaLoc = glGetUniformLocation(cardShaderProgram_gl_, "alpha");
-    glUniform1f(alphaLoc, 1.0f);
-    
-    // Set texture uniform
-    GLint texLoc = glGetUniformLocation(cardShaderProgram_gl_, "cardTexture");
-    glUniform1i(texLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    
-    if (texture != 0) {
-        glBindTexture(GL_TEXTURE_2D, texture);
-    }
-    
-    glBindVertexArray(cardQuadVAO_gl_);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // Queued for the frame's one draw (see renderFrame_gl()). A face the
+    // deck has no image for shows the card back.
+    int id = face_up ? render::cardId(card) : card_batch_gl_.backId();
+    card_batch_gl_.add(id, x, y, current_card_width_, current_card_height_);
 }
 
 // Draw foundation pile during win animation
@@ -1021,55 +636,10 @@ void PyramidGame::drawNormalFoundationPile_gl(size_t pile_index, const std::vect
 
 // Helper function to draw empty pile placeholders (light gray rectangle like Cairo)
 void PyramidGame::drawEmptyPile_gl(int x, int y) {
-    // Draw light gray rectangle placeholder for empty pile
-    // This matches Cairo's appearance exactly: RGBA(0.85, 0.85, 0.85, 0.5)
-    
-    // Create light gray texture on first use (static, cached)
-    static GLuint emptyPileTexture = 0;
-    
-    if (emptyPileTexture == 0) {
-        const int WIDTH = 32;
-        const int HEIGHT = 48;
-        
-        unsigned char data[WIDTH * HEIGHT * 4];
-        for (int i = 0; i < WIDTH * HEIGHT * 4; i += 4) {
-            data[i] = (unsigned char)(0.85f * 255);     // R: 0.85
-            data[i + 1] = (unsigned char)(0.85f * 255); // G: 0.85
-            data[i + 2] = (unsigned char)(0.85f * 255); // B: 0.85
-            data[i + 3] = (unsigned char)(0.5f * 255);  // A: 0.5 (50% opacity)
-        }
-        
-        glGenTextures(1, &emptyPileTexture);
-        glBindTexture(GL_TEXTURE_2D, emptyPileTexture);
-        
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WIDTH, HEIGHT, 0,
-                     GL_RGBA, GL_UNSIGNED_BYTE, data);
-    }
-    
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3((float)x, (float)y, 0.0f));
-    model = glm::scale(model, glm::vec3((float)current_card_width_, (float)current_card_height_, 1.0f));
-    
-    GLint modelLoc = glGetUniformLocation(cardShaderProgram_gl_, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    
-    // Set full alpha (transparency handled by texture)
-    GLint alphaLoc = glGetUniformLocation(cardShaderProgram_gl_, "alpha");
-    glUniform1f(alphaLoc, 1.0f);
-    
-    // Draw with light gray placeholder texture
-    GLint texLoc = glGetUniformLocation(cardShaderProgram_gl_, "cardTexture");
-    glUniform1i(texLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    
-    glBindTexture(GL_TEXTURE_2D, emptyPileTexture);
-    glBindVertexArray(cardQuadVAO_gl_);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    // Light gray placeholder matching Cairo's, a layer of the card texture
+    // (see initializeCardTextures_gl())
+    card_batch_gl_.add(render::GLCardBatch::EMPTY_PILE_ID, x, y,
+                       current_card_width_, current_card_height_);
 }
 
 // Helper function to draw a highlighted rectangle around selected cards
@@ -1163,131 +733,9 @@ void PyramidGame::highlightSelectedCard_gl() {
     r = 1.0f; g = 1.0f; b = 0.0f; a = 0.5f;
   }
     
-    // Enable blending for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    // Draw filled rectangle outline (4 line segments forming a box outline)
-    // Create the 4 corners of the rectangle
-    float positions[] = {
-        (float)(x - 2), (float)(y - 2), 0.0f,
-        (float)(x + current_card_width_ + 2), (float)(y - 2), 0.0f,
-        (float)(x + current_card_width_ + 2), (float)(y + current_card_height_ + 2), 0.0f,
-        (float)(x - 2), (float)(y + current_card_height_ + 2), 0.0f
-    };
-    
-    // Create color array for all 4 corners (all same color)
-    float colors[] = {
-        r, g, b, a,
-        r, g, b, a,
-        r, g, b, a,
-        r, g, b, a
-    };
-    
-    // Create VAO/VBO for the rectangle
-    GLuint VAO = 0, VBO_pos = 0, VBO_color = 0;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO_pos);
-    glGenBuffers(1, &VBO_color);
-    
-    glBindVertexArray(VAO);
-    
-    // Position buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_pos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Color buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_color);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(1);
-    
-    // Get window dimensions for projection
-    GtkAllocation allocation;
-    gtk_widget_get_allocation(gl_area_, &allocation);
-    
-    // Use simple fixed pipeline approach: disable texturing and use color directly
-    // Save current state
-    GLint oldProgram = 0;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &oldProgram);
-    
-    // Create minimal shader for colored geometry
-    static GLuint colorShaderProgram = 0;
-    if (colorShaderProgram == 0) {
-        const char *vertShader = R"(
-            #version 330 core
-            layout(location = 0) in vec3 position;
-            layout(location = 1) in vec4 color;
-            
-            uniform mat4 projection;
-            uniform mat4 view;
-            
-            out VS_OUT {
-                vec4 color;
-            } vs_out;
-            
-            void main() {
-                gl_Position = projection * view * vec4(position, 1.0);
-                vs_out.color = color;
-            }
-        )";
-        
-        const char *fragShader = R"(
-            #version 330 core
-            in VS_OUT {
-                vec4 color;
-            } fs_in;
-            
-            out vec4 FragColor;
-            
-            void main() {
-                FragColor = fs_in.color;
-            }
-        )";
-        
-        // Compile vertex shader
-        GLuint vShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vShader, 1, &vertShader, NULL);
-        glCompileShader(vShader);
-        
-        // Compile fragment shader
-        GLuint fShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fShader, 1, &fragShader, NULL);
-        glCompileShader(fShader);
-        
-        // Create program
-        colorShaderProgram = glCreateProgram();
-        glAttachShader(colorShaderProgram, vShader);
-        glAttachShader(colorShaderProgram, fShader);
-        glLinkProgram(colorShaderProgram);
-        
-        glDeleteShader(vShader);
-        glDeleteShader(fShader);
-    }
-    
-    // Use the color shader program
-    glUseProgram(colorShaderProgram);
-    
-    // Set up matrices
-    glm::mat4 projection = glm::ortho(0.0f, (float)allocation.width, 
-                                      (float)allocation.height, 0.0f, -1.0f, 1.0f);
-    glm::mat4 view = glm::mat4(1.0f);
-    
-    GLint projLoc = glGetUniformLocation(colorShaderProgram, "projection");
-    GLint viewLoc = glGetUniformLocation(colorShaderProgram, "view");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    
-    // Draw the rectangle outline as line loop with increased line width
-    glLineWidth(3.0f);
-    glDrawArrays(GL_LINE_LOOP, 0, 4);
-    glLineWidth(1.0f);
-    
-    glDeleteBuffers(1, &VBO_pos);
-    glDeleteBuffers(1, &VBO_color);
-    glDeleteVertexArrays(1, &VAO);
+    // Queued for the overlay's draw, after the cards (see renderFrame_gl())
+    overlay_gl_.outline(x - 2, y - 2, current_card_width_ + 4,
+                        current_card_height_ + 4, r, g, b, a, 3.0f);
     
     // If we have a card selected for movement, also highlight all cards below it in tableau
     if (keyboard_selection_active_ && source_pile_ >= first_tableau_index && source_card_idx_ >= 0) {
@@ -1307,54 +755,12 @@ void PyramidGame::highlightSelectedCard_gl() {
                 
                 if (stack_height > 0) {
                     // Lighter alpha for multi-card selection (still blue)
-                    float positions2[] = {
-                        (float)(x2 - 2), (float)(y2 - 2), 0.0f,
-                        (float)(x2 + current_card_width_ + 2), (float)(y2 - 2), 0.0f,
-                        (float)(x2 + current_card_width_ + 2), (float)(y2 + stack_height + 2), 0.0f,
-                        (float)(x2 - 2), (float)(y2 + stack_height + 2), 0.0f
-                    };
-                    
-                    float colors2[] = {
-                        r, g, b, 0.3f,  // Lighter blue for stack
-                        r, g, b, 0.3f,
-                        r, g, b, 0.3f,
-                        r, g, b, 0.3f
-                    };
-                    
-                    GLuint VAO2 = 0, VBO2_pos = 0, VBO2_color = 0;
-                    glGenVertexArrays(1, &VAO2);
-                    glGenBuffers(1, &VBO2_pos);
-                    glGenBuffers(1, &VBO2_color);
-                    
-                    glBindVertexArray(VAO2);
-                    
-                    glBindBuffer(GL_ARRAY_BUFFER, VBO2_pos);
-                    glBufferData(GL_ARRAY_BUFFER, sizeof(positions2), positions2, GL_STATIC_DRAW);
-                    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-                    glEnableVertexAttribArray(0);
-                    
-                    glBindBuffer(GL_ARRAY_BUFFER, VBO2_color);
-                    glBufferData(GL_ARRAY_BUFFER, sizeof(colors2), colors2, GL_STATIC_DRAW);
-                    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-                    glEnableVertexAttribArray(1);
-                    
-                    // Use the same color shader program as the main highlight
-                    glUseProgram(colorShaderProgram);
-                    
-                    glLineWidth(3.0f);
-                    glDrawArrays(GL_LINE_LOOP, 0, 4);
-                    glLineWidth(1.0f);
-                    
-                    glDeleteBuffers(1, &VBO2_pos);
-                    glDeleteBuffers(1, &VBO2_color);
-                    glDeleteVertexArrays(1, &VAO2);
+                    overlay_gl_.outline(x2 - 2, y2 - 2, current_card_width_ + 4,
+                                        stack_height + 4, r, g, b, 0.3f, 3.0f);
                 }
             }
         }
     }
-    
-    // Disable blending
-    glDisable(GL_BLEND);
 }
 
 void PyramidGame::renderFrame_gl() {
@@ -1389,6 +795,9 @@ void PyramidGame::renderFrame_gl() {
         first = false;
     }
     
+    // GTK's GL area may have bound anything since the last frame
+    render_state_gl_.beginFrame();
+    
     // Clear screen
     glClearColor(0.0f, 0.5f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1396,23 +805,8 @@ void PyramidGame::renderFrame_gl() {
     // CRITICAL FIX: Set viewport to match actual window size
     glViewport(0, 0, allocation.width, allocation.height);
     
-    // Setup matrices
-    glUseProgram(cardShaderProgram_gl_);
-    
-    // CRITICAL FIX: Use actual window dimensions instead of hardcoded 1920x1080
-    // This is the key fix for card sizing and positioning!
-    glm::mat4 projection = glm::ortho(0.0f, (float)allocation.width, 
-                                      (float)allocation.height, 0.0f, -1.0f, 1.0f);
-    GLint projLoc = glGetUniformLocation(cardShaderProgram_gl_, "projection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-    
-    glm::mat4 view = glm::mat4(1.0f);
-    GLint viewLoc = glGetUniformLocation(cardShaderProgram_gl_, "view");
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    
-    // Enable blending for transparency (used for empty pile indicators)
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // The cards below are only queued in card_batch_gl_, in the order
+    // they stack: piles, animations, then dragged cards
     
     // Draw all game piles
     drawStockPile();
@@ -1421,9 +815,6 @@ void PyramidGame::renderFrame_gl() {
     drawFoundationPiles();
     drawTableauPiles();
     
-    // Disable blending after drawing
-    glDisable(GL_BLEND);
-    
     // Draw animations if active
     if (win_animation_active_) {
         drawWinAnimation_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
@@ -1440,6 +831,13 @@ void PyramidGame::renderFrame_gl() {
     
     // Draw dragged cards overlay - CRITICAL FIX FOR DRAG VISUALIZATION
     drawDraggedCards_gl(cardShaderProgram_gl_, cardQuadVAO_gl_);
+
+    // One instanced draw for all of them, over the actual window size
+    card_batch_gl_.draw(render_state_gl_, allocation.width, allocation.height);
+    
+    // The win animation's exploded cards, worked out on the GPU
+    explosions_gl_.draw(render_state_gl_, card_batch_gl_.texture(),
+                        allocation.width, allocation.height);
     
     // Draw keyboard navigation highlight if active (matching Cairo behavior)
     if (keyboard_navigation_active_ && !dragging_ &&
@@ -1448,6 +846,7 @@ void PyramidGame::renderFrame_gl() {
         !stock_to_waste_animation_active_) {
         highlightSelectedCard_gl();
     }
+    overlay_gl_.draw(render_state_gl_, allocation.width, allocation.height);
     
     // ========================================================================
     // Draw "Pyramid Solitaire Rules" title with drop shadow in top right corner
@@ -1506,6 +905,13 @@ void PyramidGame::renderFrame_gl() {
             gl_draw_text_simple(rules[i], rule_x, rules_y + (i * rules_line_height), rules_font_size);
         }
     }
+    
+    // The text above bound its own program, vertex array and blending
+    render_state_gl_.invalidate();
+    
+    // Blending off and the vertex array unbound for GTK; with
+    // SOLITAIRE_FRAME_STATS set, the state changes are counted in
+    render_state_gl_.endFrame();
 }
 
 // ============================================================================
@@ -1549,25 +955,12 @@ void PyramidGame::onGLAreaSizeAllocate(GtkWidget *widget, GtkAllocation *allocat
 }
 
 void PyramidGame::cleanupOpenGLResources_gl() {
-    if (cardShaderProgram_gl_ != 0) {
-        glDeleteProgram(cardShaderProgram_gl_);
-        cardShaderProgram_gl_ = 0;
-    }
-    
-    if (cardQuadVAO_gl_ != 0) {
-        glDeleteVertexArrays(1, &cardQuadVAO_gl_);
-        cardQuadVAO_gl_ = 0;
-    }
-    
-    if (cardBackTexture_gl_ != 0) {
-        glDeleteTextures(1, &cardBackTexture_gl_);
-        cardBackTexture_gl_ = 0;
-    }
-    
-    for (auto &pair : cardTextures_gl_) {
-        glDeleteTextures(1, &pair.second);
-    }
-    cardTextures_gl_.clear();
+    // The card program, VAO and textures are all the batch's
+    card_batch_gl_.destroy();
+    overlay_gl_.destroy();
+    explosions_gl_.destroy();
+    cardShaderProgram_gl_ = 0;
+    cardQuadVAO_gl_ = 0;
     
     std::cout << "OpenGL resources cleaned up" << std::endl;
 }
@@ -0,0 +1,218 @@
+#include "pyramid.h"
+#include <chrono>
+#include <cstdio>
+#include <gtk/gtk.h>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Deals the seed headlessly, in the deck order initializeGame() uses, and
+// rates it
+rules::PyramidDifficulty rateDeal(rules::PyramidSolver &solver,
+                                  unsigned int seed,
+                                  const std::vector<cardlib::Card> &order,
+                                  const rules::SolverLimits &limits) {
+  rules::PyramidState state;
+  state.deal(seed, order);
+  return solver.rate(state, limits);
+}
+
+std::string describeDeal(unsigned int seed,
+                         const rules::PyramidDifficulty &difficulty) {
+  std::string summary =
+      "Current deal (seed " + std::to_string(seed) + "): " +
+      rules::pyramidRatingName(rules::pyramidRating(difficulty));
+  if (difficulty.status == rules::SolveStatus::SOLVED) {
+    char details[128];
+    snprintf(details, sizeof(details),
+             "\n%u of %u decisions have a losing choice, %.1f moves to choose from on average",
+             difficulty.dead_ends, difficulty.decisions, difficulty.branching);
+    summary += details;
+  }
+  return summary;
+}
+
+} // namespace
+
+// Rates the current deal, or with search looks for a new one of the wanted
+// rating, on the worker thread. The result comes back through
+// onDifficultyJobFinished().
+void PyramidGame::startDifficultyJob(bool search) {
+  std::vector<cardlib::Card> order =
+      deal_order_.empty() ? rules::zipDeckOrder() : deal_order_;
+  std::vector<unsigned int> candidates;
+  if (search) {
+    candidates.resize(DIFFICULTY_SEED_ATTEMPTS);
+    for (unsigned int &candidate : candidates) {
+      candidate = rand();
+    }
+  } else {
+    candidates.push_back(current_seed_);
+  }
+
+  difficulty_cancel_ = false;
+  difficulty_searching_ = search;
+  difficulty_thread_ = std::thread([this, search, candidates, order]() {
+    rules::PyramidSolver solver(DIFFICULTY_TABLE_BITS);
+    rules::SolverLimits limits;
+    limits.max_nodes = DIFFICULTY_SOLVE_NODES;
+    limits.max_seconds = DIFFICULTY_SOLVE_SECONDS;
+    limits.cancel = &difficulty_cancel_;
+    auto start = std::chrono::steady_clock::now();
+
+    difficulty_found_ = false;
+    for (unsigned int candidate : candidates) {
+      if (difficulty_cancel_) {
+        break;
+      }
+      difficulty_seed_ = candidate;
+      difficulty_result_ = rateDeal(solver, candidate, order, limits);
+      if (!search ||
+          rules::pyramidRating(difficulty_result_) == difficulty_wanted_) {
+        difficulty_found_ = true;
+        break;
+      }
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      if (elapsed.count() >= DIFFICULTY_SEARCH_SECONDS) {
+        break;
+      }
+    }
+    g_idle_add(onDifficultyJobFinished, this);
+  });
+}
+
+gboolean PyramidGame::onDifficultyJobFinished(gpointer data) {
+  PyramidGame *game = static_cast<PyramidGame *>(data);
+  game->difficulty_thread_.join();
+
+  if (!game->difficulty_searching_) {
+    // The current deal's rating, for the dialog if it is still open
+    if (game->difficulty_label_ && game->difficulty_found_) {
+      gtk_label_set_text(
+          GTK_LABEL(game->difficulty_label_),
+          describeDeal(game->difficulty_seed_, game->difficulty_result_).c_str());
+    }
+    // The player has already asked for a new deal
+    if (game->difficulty_search_wanted_) {
+      game->difficulty_search_wanted_ = false;
+      game->startDifficultyJob(true);
+    }
+    return FALSE;
+  }
+
+  GdkWindow *gdk_window = gtk_widget_get_window(game->window_);
+  if (gdk_window) {
+    gdk_window_set_cursor(gdk_window, nullptr);
+  }
+  if (game->difficulty_cancel_) {
+    return FALSE;
+  }
+
+  if (!game->difficulty_found_) {
+    std::cerr << "No " << rules::pyramidRatingName(game->difficulty_wanted_)
+              << " deal found in " << DIFFICULTY_SEED_ATTEMPTS << " tries"
+              << std::endl;
+    GtkWidget *message = gtk_message_dialog_new(
+        GTK_WINDOW(game->window_), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
+        "No deal of that difficulty was found. Please try again.");
+    gtk_dialog_run(GTK_DIALOG(message));
+    gtk_widget_destroy(message);
+    return FALSE;
+  }
+
+  if (game->win_animation_active_) {
+    game->stopWinAnimation();
+  }
+  game->current_seed_ = game->difficulty_seed_;
+  game->initializeGame();
+  game->updateWindowTitle();
+  game->refreshDisplay();
+  return FALSE;
+}
+
+void PyramidGame::promptForDifficulty() {
+  if (current_game_mode_ != GameMode::STANDARD_PYRAMID) {
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(window_), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
+        "Difficulty ratings are only available for single-deck Pyramid.");
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    return;
+  }
+
+  // Still looking for the last deal asked for
+  if (difficulty_thread_.joinable()) {
+    return;
+  }
+
+  GtkWidget *dialog = gtk_dialog_new_with_buttons(
+      "New Game by Difficulty", GTK_WINDOW(window_),
+      static_cast<GtkDialogFlags>(GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT),
+      "_Cancel", GTK_RESPONSE_CANCEL,
+      "_Deal", GTK_RESPONSE_ACCEPT,
+      NULL);
+  gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_ACCEPT);
+
+  GtkWidget *content_area = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+  gtk_container_set_border_width(GTK_CONTAINER(content_area), 10);
+  gtk_box_set_spacing(GTK_BOX(content_area), 6);
+
+  // How the deal on the table rates, so players can calibrate; filled in
+  // when the worker has rated it
+  std::string summary = "Current deal (seed " + std::to_string(current_seed_) +
+                        "): rating...";
+  difficulty_label_ = gtk_label_new(summary.c_str());
+  gtk_label_set_xalign(GTK_LABEL(difficulty_label_), 0.0);
+  gtk_container_add(GTK_CONTAINER(content_area), difficulty_label_);
+  startDifficultyJob(false);
+
+  GtkWidget *label = gtk_label_new("Deal a new winnable game that is:");
+  gtk_label_set_xalign(GTK_LABEL(label), 0.0);
+  gtk_container_add(GTK_CONTAINER(content_area), label);
+
+  GtkWidget *easy = gtk_radio_button_new_with_mnemonic(NULL, "_Easy - few wrong moves lose");
+  GtkWidget *medium = gtk_radio_button_new_with_mnemonic_from_widget(
+      GTK_RADIO_BUTTON(easy), "_Medium");
+  GtkWidget *hard = gtk_radio_button_new_with_mnemonic_from_widget(
+      GTK_RADIO_BUTTON(easy), "_Hard - many moves lead to a dead end");
+  gtk_container_add(GTK_CONTAINER(content_area), easy);
+  gtk_container_add(GTK_CONTAINER(content_area), medium);
+  gtk_container_add(GTK_CONTAINER(content_area), hard);
+
+  gtk_widget_show_all(dialog);
+
+  gint response = gtk_dialog_run(GTK_DIALOG(dialog));
+  rules::PyramidRating wanted = rules::PyramidRating::EASY;
+  if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(medium))) {
+    wanted = rules::PyramidRating::MEDIUM;
+  } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(hard))) {
+    wanted = rules::PyramidRating::HARD;
+  }
+  difficulty_label_ = nullptr;
+  gtk_widget_destroy(dialog);
+
+  // The current deal's rating is no longer needed
+  if (difficulty_thread_.joinable()) {
+    difficulty_cancel_ = true;
+  }
+  if (response != GTK_RESPONSE_ACCEPT) {
+    return;
+  }
+
+  // Show a busy cursor while deals are rated
+  GdkWindow *gdk_window = gtk_widget_get_window(window_);
+  if (gdk_window) {
+    GdkCursor *watch = gdk_cursor_new_for_display(gdk_display_get_default(), GDK_WATCH);
+    gdk_window_set_cursor(gdk_window, watch);
+    g_object_unref(watch);
+  }
+
+  difficulty_wanted_ = wanted;
+  if (difficulty_thread_.joinable()) {
+    difficulty_search_wanted_ = true;
+  } else {
+    startDifficultyJob(true);
+  }
+}
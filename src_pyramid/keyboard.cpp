@@ -16,6 +16,10 @@ gboolean PyramidGame::onKeyPress(GtkWidget *widget, GdkEventKey *event,
     return TRUE;
   }
 
+  if (game->replay_playback_active_ && game->handleReplayKey(event)) {
+    return TRUE;
+  }
+
   bool ctrl_pressed = (event->state & GDK_CONTROL_MASK);
 
   // Block keyboard during certain animations
@@ -135,6 +139,22 @@ gboolean PyramidGame::onKeyPress(GtkWidget *widget, GdkEventKey *event,
     }
     break;
 
+  case GDK_KEY_z:
+  case GDK_KEY_Z:
+    if (ctrl_pressed) {
+      game->undoLastMove();
+      return TRUE;
+    }
+    break;
+
+  case GDK_KEY_y:
+  case GDK_KEY_Y:
+    if (ctrl_pressed) {
+      game->redoLastMove();
+      return TRUE;
+    }
+    break;
+
   case GDK_KEY_o:
   case GDK_KEY_O:
     if (ctrl_pressed) {
@@ -517,10 +537,17 @@ void PyramidGame::showKeyboardHelp() {
       "  Escape - Deselect/Cancel\n\n"
       "Game Control:\n"
       "  Ctrl+N - New Game\n"
+      "  Ctrl+Z - Undo\n"
+      "  Ctrl+Y - Redo\n"
       "  Ctrl+S - Toggle Sound\n"
       "  Ctrl+O - Test Layout (One King)\n"
       "  F11 - Toggle Fullscreen\n"
       "  Ctrl+Q - Quit\n\n"
+      "Replay Playback:\n"
+      "  Space - Pause or resume\n"
+      "  Left / Right - Step back or forward one move\n"
+      "  Home / End - Jump to the deal or the last move\n"
+      "  Escape - Stop and play on from the move shown\n\n"
       "How to Play:\n"
       "  1. Select a card (Enter)\n"
       "  2. Navigate to another card\n"
@@ -17,7 +17,8 @@ gboolean PyramidGame::onButtonPress(GtkWidget *widget, GdkEventButton *event,
   }
 
   if (game->foundation_move_animation_active_ ||
-      game->stock_to_waste_animation_active_) {
+      game->stock_to_waste_animation_active_ ||
+      game->replay_playback_active_) {
     return TRUE;
   }
 
@@ -130,7 +131,7 @@ gboolean PyramidGame::onButtonRelease(GtkWidget *widget,
     game->handleStockPileClick();
     game->drag_source_pile_ = -1;
     game->drag_source_card_idx_ = -1;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
     return TRUE;
   }
 
@@ -332,7 +333,7 @@ gboolean PyramidGame::onButtonRelease(GtkWidget *widget,
         if (game->checkWinCondition()) {
           game->startWinAnimation();
         }
-        gtk_widget_queue_draw(game->game_area_);
+        game->queueRedraw();
       }
     }
 
@@ -340,7 +341,7 @@ gboolean PyramidGame::onButtonRelease(GtkWidget *widget,
     game->drag_cards_.clear();
     game->drag_source_pile_ = -1;
     game->drag_source_card_idx_ = -1;  // FIX: Reset the card index
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
@@ -401,7 +402,7 @@ gboolean PyramidGame::onMotionNotify(GtkWidget *widget, GdkEventMotion *event,
   if (game->dragging_) {
     game->drag_start_x_ = event->x;
     game->drag_start_y_ = event->y;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
@@ -107,6 +107,12 @@ PyramidGame::PyramidGame()
       current_seed_(0) {
   srand(time(NULL));
   current_seed_ = rand();
+#ifdef _WIN32
+  seed_index_.open(getExecutableDir() + "\\" + rules::SEED_INDEX_FILENAME);
+#else
+  seed_index_.open(rules::SEED_INDEX_FILENAME);
+#endif
+  undo_history_.attachReplay(&replay_);
   initializeSettingsDir();
   
   // Load engine preference and initialize rendering
@@ -445,6 +451,7 @@ void PyramidGame::setupCairoArea() {
                 CAIRO_FORMAT_ARGB32, allocation->width, allocation->height);
             game->buffer_cr_ = cairo_create(game->buffer_surface_);
 
+            game->damage_.invalidate();
             gtk_widget_queue_draw(widget);
           }),
       this);
@@ -648,7 +655,7 @@ void PyramidGame::checkAndInitializeSound() {
 void PyramidGame::run(int argc, char **argv) {
   gtk_init(&argc, &argv);
   setupWindow();
-  initializeGame();  // Initialize game after GTK is ready and window exists
+  resumeSavedGame();  // Initialize game after GTK is ready and window exists
   setupGameArea();
   
   // Show all widgets AFTER game is fully initialized
@@ -672,6 +679,10 @@ void PyramidGame::run(int argc, char **argv) {
 }
 
 void PyramidGame::initializeGame() {
+  if (replay_playback_active_) {
+    stopReplayPlayback();
+  }
+
   // Check for engine switch request
   if (engine_switch_requested_) {
     switchRenderingEngine(requested_engine_);
@@ -704,6 +715,7 @@ void PyramidGame::initializeGame() {
         try {
           deck_ = cardlib::Deck(path);
           deck_.removeJokers();
+          deal_order_ = deck_.getAllCards();
           loaded = true;
           break;
         } catch (const std::exception &e) {
@@ -1326,16 +1338,9 @@ bool PyramidGame::checkWinCondition() const {
 
 // Function to refresh the display
 void PyramidGame::refreshDisplay() {
-  // FIX: Refresh the correct widget based on the active rendering engine
-  if (rendering_engine_ == RenderingEngine::OPENGL) {
-    if (gl_area_) {
-      gtk_widget_queue_draw(gl_area_);
-    }
-  } else {
-    if (game_area_) {
-      gtk_widget_queue_draw(game_area_);
-    }
-  }
+  // Record the move that led here, if there was one
+  trackUndoPosition();
+  queueRedraw();
 }
 
 int main(int argc, char **argv) {
@@ -1437,6 +1442,49 @@ void PyramidGame::setupMenuBar() {
                   this);
   gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), seedItem);
 
+  // New game of a chosen difficulty
+  GtkWidget *difficultyItem = gtk_menu_item_new_with_label("New Game by Difficulty...");
+  g_signal_connect(G_OBJECT(difficultyItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<PyramidGame *>(data)->promptForDifficulty();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), difficultyItem);
+
+  // Undo / Redo
+  GtkWidget *undoItem = gtk_menu_item_new_with_mnemonic("_Undo (Ctrl+Z)");
+  g_signal_connect(G_OBJECT(undoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<PyramidGame *>(data)->undoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), undoItem);
+
+  GtkWidget *redoItem = gtk_menu_item_new_with_mnemonic("_Redo (Ctrl+Y)");
+  g_signal_connect(G_OBJECT(redoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<PyramidGame *>(data)->redoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), redoItem);
+
+  // Replays
+  GtkWidget *saveReplayItem = gtk_menu_item_new_with_mnemonic("Save Re_play...");
+  g_signal_connect(G_OBJECT(saveReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<PyramidGame *>(data)->saveReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), saveReplayItem);
+
+  GtkWidget *openReplayItem = gtk_menu_item_new_with_mnemonic("_Open Replay...");
+  g_signal_connect(G_OBJECT(openReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<PyramidGame *>(data)->openReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), openReplayItem);
+
   // Add separator before Quit
   GtkWidget *sep = gtk_separator_menu_item_new();
   gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), sep);
@@ -1565,7 +1613,14 @@ void PyramidGame::onNewGame(GtkWidget *widget, gpointer data) {
     game->stopWinAnimation();
   }
 
-  game->current_seed_ = rand();
+  // Deal a known-winnable seed when the shipped index matches this deck
+  bool indexed = game->current_game_mode_ == GameMode::STANDARD_PYRAMID &&
+                 (game->deal_order_.empty() ||
+                  rules::sameDeckOrder(game->deal_order_, rules::zipDeckOrder())) &&
+                 game->seed_index_.pickSeed(rules::DealVariant::PYRAMID, game->current_seed_);
+  if (!indexed) {
+    game->current_seed_ = rand();
+  }
   game->initializeGame();
   game->updateWindowTitle();
   game->refreshDisplay();
@@ -1915,8 +1970,11 @@ void PyramidGame::updateCardDimensions(int window_width, int window_height) {
     current_vert_spacing_ = current_card_height_ / 4;
   }
 
-  // Reinitialize card cache with new dimensions
-  initializeCardCache();
+  // Rescale the card cache in the background, drawing from the old
+  // surfaces until it is done
+  rescaleCardCache();
+  // The cached board is drawn again, at the new size, when next needed
+  static_layer_.release();
 }
 
 double PyramidGame::getScaleFactor(int window_width, int window_height) const {
@@ -2200,8 +2258,16 @@ void PyramidGame::showHowToPlay() {
     "- Enter to select cards\n"
     "- F11 to toggle fullscreen mode\n"
     "- Ctrl+N for a new game\n"
+    "- Ctrl+Z to undo a move, Ctrl+Y to redo it\n"
     "- Ctrl+Q to quit\n"
     "- Ctrl+H for help\n\n"
+    "Replays:\n"
+    "- Game > Save Replay keeps every move of the game in a small file\n"
+    "- Game > Open Replay plays one back: Space pauses, Left and Right "
+    "step, Home and End jump to the start and the end, Escape stops and "
+    "lets you play on from the move shown\n"
+    "- The game in progress is saved as you play, and picks up where you "
+    "left off next time\n\n"
     "Written by Jason Hall\n"
     "Licensed under the MIT License\n"
     "https://github.com/jasonbrianhall/solitaire";
@@ -2271,11 +2337,17 @@ void PyramidGame::showKeyboardShortcuts() {
       {"Space", "Draw cards from the stock pile"},
       {"F11", "Toggle fullscreen mode"},
       {"Ctrl+N", "New game"},
+      {"Ctrl+Z", "Undo the last move"},
+      {"Ctrl+Y", "Redo the move just undone"},
       {"Ctrl+L", "Load custom deck"},
       {"Ctrl+S", "Toggle sound on/off"},
       {"Ctrl+H", "Show About dialog"},
       {"Ctrl+Q", "Quit the game"},
-      {"F1", "Show How To Play / About dialog"}
+      {"F1", "Show How To Play / About dialog"},
+      {"Space (replay)", "Pause or resume the replay"},
+      {"Left / Right (replay)", "Step back or forward one move"},
+      {"Home / End (replay)", "Jump to the deal or the last move"},
+      {"Escape (replay)", "Stop and play on from the move shown"}
   };
 
   // Add shortcut rows
@@ -4,13 +4,22 @@
 // ============================================================================
 // INCLUDES - System and External Libraries
 // ============================================================================
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include <gtk/gtk.h>
 #include "cardlib.h"
+#include "../src_rules/autosave.h"
+#include "../src_rules/pyramid_solver.h"
+#include "../src_rules/seed_index.h"
+#include "../src_rules/undo_journal.h"
+#include "../src_render/gtk_card_scaler.h"
+#include "../src_render/gtk_damage.h"
+#include "../src_render/particles.h"
 
 #ifdef USEOPENGL
 #include <glm/glm.hpp>
@@ -18,27 +27,15 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include "../src_render/gl_card_batch.h"
+#include "../src_render/gl_explosions.h"
+#include "../src_render/gl_overlay.h"
 #endif
 
 // ============================================================================
 // STRUCTURES
 // ============================================================================
 
-struct CardFragment {
-  double x;
-  double y;
-  double width;
-  double height;
-  double velocity_x;
-  double velocity_y;
-  double rotation;
-  double rotation_velocity;
-  double target_x;  // Texture coordinate X for explosion fragments (grid column)
-  double target_y;  // Texture coordinate Y for explosion fragments (grid row)
-  cairo_surface_t *surface;
-  bool active;
-};
-
 struct AnimatedCard {
   cardlib::Card card;
   double x;
@@ -52,7 +49,6 @@ struct AnimatedCard {
   double target_x;  // For deal animation
   double target_y;  // For deal animation
   bool face_up;
-  std::vector<CardFragment> fragments;
 };
 
 struct TableauCard {
@@ -134,6 +130,7 @@ private:
   static constexpr int VERT_SPACING = 25;
 
   static constexpr double GRAVITY = 0.8;
+  static constexpr int FRAGMENT_GRID = 4; // An exploded card's rows and columns
   static constexpr double BOUNCE_FACTOR = -0.7;
   static constexpr int ANIMATION_INTERVAL = 16; // ~60 FPS
 
@@ -144,6 +141,14 @@ private:
   static constexpr double EXPLOSION_THRESHOLD_MIN = 0.3; // Minimum distance threshold (as percentage of screen height)
   static constexpr double EXPLOSION_THRESHOLD_MAX = 0.7; // Maximum distance threshold (as percentage of screen height)
 
+  static constexpr int DIFFICULTY_SEED_ATTEMPTS = 200;       // Seeds tried per difficulty deal
+  static constexpr double DIFFICULTY_SOLVE_SECONDS = 0.05;   // Solver budget per seed
+  static constexpr uint64_t DIFFICULTY_SOLVE_NODES = 100000; // ...and its node cap
+  static constexpr double DIFFICULTY_SEARCH_SECONDS = 3.0;   // Give up looking after this long
+  static constexpr unsigned DIFFICULTY_TABLE_BITS = 20;      // 8 MB transposition table
+
+  static constexpr int REPLAY_STEP_INTERVAL = 400;           // ms between moves in replay playback
+
   // ========================================================================
   // GAME STATE - CORE GAME DATA
   // ========================================================================
@@ -151,6 +156,8 @@ private:
   cardlib::MultiDeck multi_deck_;
   GameMode current_game_mode_ = GameMode::STANDARD_PYRAMID;
   unsigned int current_seed_;
+  std::vector<cardlib::Card> deal_order_;  // Deck order before the shuffle, for the solver
+  rules::SeedIndex seed_index_;            // Precomputed winnable seeds, if shipped
 
   std::vector<cardlib::Card> stock_;                       // Draw pile
   std::vector<cardlib::Card> waste_;                       // Faced-up cards from stock
@@ -159,6 +166,20 @@ private:
   
   int stock_redeals_ = 0;                                  // Track number of waste redeals (max 2)
 
+  // Moves played, as reversible deltas, for undo and redo
+  rules::UndoHistory<rules::PyramidState> undo_history_;
+
+  // The game as it is played, for Save Replay, and one opened for playback
+  rules::Replay replay_;
+  rules::ReplayPlayer<rules::PyramidState> replay_player_;
+  bool replay_playback_active_ = false;
+  bool replay_paused_ = false;
+  size_t replay_position_ = 0;
+  guint replay_timer_id_ = 0;
+
+  // Keeps replay_ on disk, so the game resumes after a restart or a crash
+  std::unique_ptr<rules::AutosaveLog> autosave_;
+
   // ========================================================================
   // GAME STATE - DRAG AND DROP
   // ========================================================================
@@ -180,6 +201,7 @@ private:
   std::vector<AnimatedCard> animated_cards_;
   int cards_launched_ = 0;
   double launch_timer_ = 0;
+  render::ParticlePool fragments_; // Exploded cards' pieces, by card and cell
   guint animation_timer_id_ = 0;
 
   // Deal animation fields
@@ -248,9 +270,14 @@ private:
   // ========================================================================
   // GAME STATE - CACHING AND BUFFERS
   // ========================================================================
-  std::unordered_map<std::string, cairo_surface_t *> card_surface_cache_;
+  render::CardScaler::Cache card_surface_cache_;
   cairo_surface_t *buffer_surface_ = nullptr;
   cairo_t *buffer_cr_ = nullptr;
+  render::DamageTracker damage_;           // What changed since the last frame
+  render::StaticLayer static_layer_;       // The settled board, cached
+  render::CardScaler card_scaler_;         // Rescales the card cache
+  std::shared_ptr<const render::CardAtlas> card_atlas_; // Decoded deck
+  render::FrameStats frame_stats_{"pyramid"};
 
   // ========================================================================
   // GTK WIDGETS
@@ -274,6 +301,9 @@ private:
   void setupCairoArea();
   void initializeSettingsDir();
   void initializeCardCache();
+  void rescaleCardCache();
+  // The deck's images, decoded when they were loaded
+  const std::shared_ptr<const render::CardAtlas> &cardAtlas();
   void clearAndRebuildCaches();
   void initializeMultiDeckGame();
 
@@ -302,13 +332,18 @@ private:
   // CARD DRAWING METHODS - CAIRO
   // ========================================================================
   void drawCard(cairo_t *cr, int x, int y, const cardlib::Card *card, bool face_up);
+  void paintCard(cairo_t *cr, int x, int y, const cardlib::Card *card, bool face_up);
   void drawEmptyPile(cairo_t *cr, int x, int y);
   void drawAnimatedCard(cairo_t *cr, const AnimatedCard &anim_card);
-  void drawCardFragment(cairo_t *cr, const CardFragment &fragment);
+  void drawCardFragment(cairo_t *cr, size_t index);
 
   cairo_surface_t *getCardSurface(const cardlib::Card &card);
   cairo_surface_t *getCardBackSurface();
-  void initializeOrResizeBuffer(int width, int height);
+  bool initializeOrResizeBuffer(int width, int height);
+  void drawBoard();
+  void drawStaticLayer();
+  void updateStaticLayer(int width, int height);
+  void queueRedraw();
 
   // ========================================================================
   // GAME PILE DRAWING METHODS - CAIRO
@@ -335,7 +370,6 @@ private:
   void drawCard_gl(const cardlib::Card &card, int x, int y, bool face_up);
   void drawEmptyPile_gl(int x, int y);
   void drawAnimatedCard_gl(const AnimatedCard &anim_card, GLuint shaderProgram, GLuint VAO);
-  void drawCardFragment_gl(const CardFragment &fragment, const AnimatedCard &card, GLuint shaderProgram, GLuint VAO);
 
   // Game pile drawing functions - OpenGL versions
   void drawStockPile_gl();
@@ -358,7 +392,7 @@ private:
   void stopWinAnimation();
   void launchNextCard();
   void explodeCard(AnimatedCard &card);
-  void updateCardFragments(AnimatedCard &card);
+  void updateCardFragments();
   static gboolean onAnimationTick(gpointer data);
 
   // ========================================================================
@@ -445,6 +479,33 @@ private:
   static gboolean onAutoFinishTick_gl(gpointer data);
 #endif
 
+  // ========================================================================
+  // UNDO AND REDO
+  // ========================================================================
+  bool buildRulesState(rules::PyramidState &state) const;
+  void applyRulesState(const rules::PyramidState &state);
+  bool isBoardSettled() const;
+  bool trackUndoPosition();
+  void undoLastMove();
+  void redoLastMove();
+  void showUndoPosition(const rules::PyramidState &state);
+
+  // ========================================================================
+  // REPLAYS
+  // ========================================================================
+  rules::ReplayHeader replayHeader() const;
+  void startReplayRecording(const rules::PyramidState &state);
+  void saveReplay();
+  void openReplay();
+  void startReplayPlayback();
+  void stopReplayPlayback();
+  void pauseReplayPlayback(bool paused);
+  void showReplayPosition(size_t position);
+  bool handleReplayKey(GdkEventKey *event);
+  static gboolean onReplayTick(gpointer data);
+  std::string autosavePath() const;
+  void resumeSavedGame();
+
   // ========================================================================
   // EVENT HANDLERS - INPUT
   // ========================================================================
@@ -512,6 +573,21 @@ private:
   void toggleFullscreen();
   void restartGame();
   void promptForSeed();
+  void promptForDifficulty();
+  void startDifficultyJob(bool search);
+  static gboolean onDifficultyJobFinished(gpointer data);
+
+  // Deals are rated on a worker thread, one job at a time: the current
+  // deal while the dialog is open, then the search for a new one
+  std::thread difficulty_thread_;               // Joinable until onDifficultyJobFinished() runs
+  std::atomic<bool> difficulty_cancel_{false};
+  bool difficulty_searching_ = false;           // The job is looking for a new deal
+  bool difficulty_search_wanted_ = false;       // Look for one once the rating ends
+  rules::PyramidRating difficulty_wanted_ = rules::PyramidRating::EASY;
+  GtkWidget *difficulty_label_ = nullptr;       // The open dialog's current-deal line
+  unsigned int difficulty_seed_ = 0;            // The deal rated or found...
+  rules::PyramidDifficulty difficulty_result_;  // ...and how it rated
+  bool difficulty_found_ = false;
   std::vector<cardlib::Card> &getPileReference(int pile_index);
   bool isValidDragSource(int pile_index, int card_index) const;
   void updateCardDimensions(int window_width, int window_height);
@@ -557,7 +633,6 @@ private:
   void cleanupOpenGLResources_gl();
   bool validateOpenGLContext();
   bool reloadCustomCardBackTexture_gl();
-  GLuint loadTextureFromMemory(const std::vector<unsigned char> &data);
 
   // OpenGL 3.4 Rendering Components
   GLuint cardShaderProgram_gl_ = 0;      // Main card rendering shader
@@ -566,8 +641,10 @@ private:
   GLuint cardQuadVBO_gl_ = 0;            // Vertex Buffer Object
   GLuint cardQuadEBO_gl_ = 0;            // Element Buffer Object
 
-  std::unordered_map<std::string, GLuint> cardTextures_gl_;  // Texture cache
-  GLuint cardBackTexture_gl_ = 0;                             // Card back texture
+  render::GLCardBatch card_batch_gl_;    // Card textures; a frame's cards
+  render::GLExplosions explosions_gl_;   // The win animation's fragments
+  render::GLOverlay overlay_gl_;         // Highlight outlines
+  render::GLState render_state_gl_{"pyramid gl"}; // What a frame has bound
 #endif
 
   // Test/Debug methods
@@ -0,0 +1,280 @@
+#include "pyramid.h"
+#include <gtk/gtk.h>
+
+namespace {
+
+void showReplayMessage(GtkWidget *window, GtkMessageType type,
+                       const char *text) {
+  GtkWidget *dialog = gtk_message_dialog_new(
+      GTK_WINDOW(window), GTK_DIALOG_DESTROY_WITH_PARENT, type,
+      GTK_BUTTONS_OK, "%s", text);
+  gtk_dialog_run(GTK_DIALOG(dialog));
+  gtk_widget_destroy(dialog);
+}
+
+void addReplayFilter(GtkWidget *dialog) {
+  GtkFileFilter *filter = gtk_file_filter_new();
+  gtk_file_filter_set_name(filter, "Solitaire Replays (*.srpl)");
+  gtk_file_filter_add_pattern(filter, "*.srpl");
+  gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+}
+
+} // namespace
+
+rules::ReplayHeader PyramidGame::replayHeader() const {
+  rules::ReplayHeader header;
+  header.variant = rules::DealVariant::PYRAMID;
+  header.seed = current_seed_;
+  // A custom deck shuffles from its own order, so the replay carries it
+  if (!rules::sameDeckOrder(deal_order_, rules::zipDeckOrder())) {
+    header.deck_order = deal_order_;
+  }
+  return header;
+}
+
+// The undo history started again at state. A replay can only start from
+// the deal, so anything else (such as the board left by a playback)
+// leaves nothing to record.
+void PyramidGame::startReplayRecording(const rules::PyramidState &state) {
+  rules::ReplayHeader header = replayHeader();
+  rules::PyramidState dealt;
+  if (rules::dealReplayStart(header, dealt) && dealt == state) {
+    replay_.start(header);
+  }
+}
+
+void PyramidGame::saveReplay() {
+  trackUndoPosition();
+  if (!replay_.recording()) {
+    showReplayMessage(window_, GTK_MESSAGE_INFO,
+                      "There is no replay of this game to save. Replays are "
+                      "recorded from the deal; start a new game to record "
+                      "one.");
+    return;
+  }
+
+  GtkWidget *dialog = gtk_file_chooser_dialog_new(
+      "Save Replay", GTK_WINDOW(window_), GTK_FILE_CHOOSER_ACTION_SAVE,
+      "_Cancel", GTK_RESPONSE_CANCEL, "_Save", GTK_RESPONSE_ACCEPT, NULL);
+  gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog),
+                                                 TRUE);
+  std::string name = "pyramid-" + std::to_string(current_seed_) + ".srpl";
+  gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), name.c_str());
+  addReplayFilter(dialog);
+
+  if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+    char *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+    if (!replay_.save(filename)) {
+      showReplayMessage(window_, GTK_MESSAGE_ERROR,
+                        "Failed to save the replay");
+    }
+    g_free(filename);
+  }
+  gtk_widget_destroy(dialog);
+}
+
+void PyramidGame::openReplay() {
+  if (!isBoardSettled()) {
+    return;
+  }
+  if (current_game_mode_ != GameMode::STANDARD_PYRAMID) {
+    showReplayMessage(window_, GTK_MESSAGE_INFO,
+                      "Replays can only be played with a single deck.");
+    return;
+  }
+
+  GtkWidget *dialog = gtk_file_chooser_dialog_new(
+      "Open Replay", GTK_WINDOW(window_), GTK_FILE_CHOOSER_ACTION_OPEN,
+      "_Cancel", GTK_RESPONSE_CANCEL, "_Open", GTK_RESPONSE_ACCEPT, NULL);
+  addReplayFilter(dialog);
+
+  rules::Replay replay;
+  bool opened = false;
+  if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+    char *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+    opened = replay.load(filename);
+    g_free(filename);
+    if (!opened) {
+      showReplayMessage(window_, GTK_MESSAGE_ERROR,
+                        "The file is not a replay this version can read.");
+    }
+  }
+  gtk_widget_destroy(dialog);
+  if (!opened) {
+    return;
+  }
+
+  rules::ReplayPlayer<rules::PyramidState> player;
+  if (!player.load(replay)) {
+    showReplayMessage(window_, GTK_MESSAGE_ERROR,
+                      "The replay is not a Pyramid game, or a move in it "
+                      "is not legal.");
+    return;
+  }
+
+  replay_player_ = std::move(player);
+  current_seed_ = replay.header().seed;
+  startReplayPlayback();
+}
+
+// Playback puts each position straight on the board; none of the move
+// animations run, so jumping to any move is as quick as the seek.
+void PyramidGame::startReplayPlayback() {
+  if (replay_playback_active_) {
+    stopReplayPlayback();
+  }
+  replay_playback_active_ = true;
+  replay_paused_ = false;
+  showReplayPosition(0);
+  replay_timer_id_ = g_timeout_add(REPLAY_STEP_INTERVAL, onReplayTick, this);
+}
+
+// Leaves the board as shown; play goes on from there
+void PyramidGame::stopReplayPlayback() {
+  if (replay_timer_id_ > 0) {
+    g_source_remove(replay_timer_id_);
+    replay_timer_id_ = 0;
+  }
+  replay_playback_active_ = false;
+  replay_paused_ = false;
+  updateWindowTitle();
+  refreshDisplay();
+}
+
+void PyramidGame::pauseReplayPlayback(bool paused) {
+  if (paused && replay_timer_id_ > 0) {
+    g_source_remove(replay_timer_id_);
+    replay_timer_id_ = 0;
+  } else if (!paused && replay_timer_id_ == 0) {
+    if (replay_position_ == replay_player_.length()) {
+      replay_position_ = 0;
+    }
+    replay_timer_id_ = g_timeout_add(REPLAY_STEP_INTERVAL, onReplayTick, this);
+  }
+  replay_paused_ = paused;
+  showReplayPosition(replay_position_);
+}
+
+void PyramidGame::showReplayPosition(size_t position) {
+  rules::PyramidState state;
+  if (!replay_player_.seek(position, state)) {
+    return;
+  }
+  replay_position_ = position;
+  applyRulesState(state);
+  keyboard_selection_active_ = false;
+  source_pile_ = -1;
+  source_card_idx_ = -1;
+
+  std::string title =
+      "Pyramid Solitaire - Replay: move " + std::to_string(position);
+  title += " of " + std::to_string(replay_player_.length());
+  if (replay_paused_) {
+    title += " (paused)";
+  }
+  gtk_window_set_title(GTK_WINDOW(window_), title.c_str());
+  refreshDisplay();
+}
+
+// Keys while a replay plays: Space pauses, Left and Right step, Home and
+// End jump to the deal and the last move, Escape leaves playback. Other
+// keys are swallowed so the game can't be played under the replay.
+bool PyramidGame::handleReplayKey(GdkEventKey *event) {
+  bool ctrl_pressed = (event->state & GDK_CONTROL_MASK);
+
+  switch (event->keyval) {
+  case GDK_KEY_space:
+    pauseReplayPlayback(!replay_paused_);
+    return true;
+
+  case GDK_KEY_Left:
+    pauseReplayPlayback(true);
+    if (replay_position_ > 0) {
+      showReplayPosition(replay_position_ - 1);
+    }
+    return true;
+
+  case GDK_KEY_Right:
+    pauseReplayPlayback(true);
+    showReplayPosition(replay_position_ + 1);
+    return true;
+
+  case GDK_KEY_Home:
+    showReplayPosition(0);
+    return true;
+
+  case GDK_KEY_End:
+    showReplayPosition(replay_player_.length());
+    return true;
+
+  case GDK_KEY_Escape:
+    stopReplayPlayback();
+    return true;
+
+  case GDK_KEY_F11:
+    return false;
+
+  case GDK_KEY_q:
+  case GDK_KEY_Q:
+    return !ctrl_pressed;
+
+  default:
+    return true;
+  }
+}
+
+gboolean PyramidGame::onReplayTick(gpointer data) {
+  PyramidGame *game = static_cast<PyramidGame *>(data);
+
+  if (game->replay_position_ >= game->replay_player_.length()) {
+    game->replay_timer_id_ = 0;
+    game->replay_paused_ = true;
+    game->showReplayPosition(game->replay_position_);
+    return FALSE;
+  }
+  game->showReplayPosition(game->replay_position_ + 1);
+  return TRUE;
+}
+
+std::string PyramidGame::autosavePath() const {
+#ifdef _WIN32
+  return settings_dir_ + "\\pyramid-autosave.srpl";
+#else
+  return settings_dir_ + "/pyramid-autosave.srpl";
+#endif
+}
+
+// Deals the game that was in progress when Pyramid last closed, moves and
+// undo history included, or a new one if there is none. Autosaving starts
+// from here.
+void PyramidGame::resumeSavedGame() {
+  rules::Replay saved;
+  bool resumable = current_game_mode_ == GameMode::STANDARD_PYRAMID &&
+                   rules::loadAutosave(autosavePath(), saved) &&
+                   saved.header().variant == rules::DealVariant::PYRAMID;
+  unsigned int new_seed = current_seed_;
+  if (resumable) {
+    current_seed_ = saved.header().seed;
+  }
+  initializeGame();
+
+  rules::PyramidState state;
+  if (resumable) {
+    if (deal_animation_active_) {
+      completeDeal();
+    }
+    resumable = rules::restoreAutosave(saved, undo_history_, replay_, state) &&
+                !state.isWon();
+    if (resumable) {
+      applyRulesState(state);
+    } else {
+      // A finished or unreadable save: start the game that was due instead
+      current_seed_ = new_seed;
+      initializeGame();
+    }
+    updateWindowTitle();
+    refreshDisplay();
+  }
+
+  autosave_ = std::make_unique<rules::AutosaveLog>(autosavePath());
+}
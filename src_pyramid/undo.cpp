@@ -0,0 +1,150 @@
+#include "pyramid.h"
+#include <array>
+#include <gtk/gtk.h>
+
+// Copies the board into the headless rules representation. Pyramid card
+// (row, j) is position row * (row + 1) / 2 + j; removed cards stay in
+// tableau_, as they stay in the rules' pyramid array.
+bool PyramidGame::buildRulesState(rules::PyramidState &state) const {
+  if (current_game_mode_ != GameMode::STANDARD_PYRAMID ||
+      tableau_.size() != rules::PYRAMID_ROWS || stock_.size() > 24 ||
+      waste_.size() > 24) {
+    return false;
+  }
+
+  state.removed = 0;
+  int position = 0;
+  for (size_t row = 0; row < tableau_.size(); row++) {
+    if (tableau_[row].size() != row + 1) {
+      return false;
+    }
+    for (const auto &tableau_card : tableau_[row]) {
+      state.pyramid[position] = cardlib::PackedCard(tableau_card.card);
+      if (tableau_card.removed) {
+        state.removed |= 1u << position;
+      }
+      position++;
+    }
+  }
+
+  state.stock.clear();
+  for (const auto &card : stock_) {
+    state.stock.push(cardlib::PackedCard(card, false));
+  }
+  state.waste.clear();
+  for (const auto &card : waste_) {
+    state.waste.push(cardlib::PackedCard(card));
+  }
+  state.redeals = static_cast<uint8_t>(stock_redeals_);
+  return true;
+}
+
+// Puts a rules position back on the board. Every card is somewhere in
+// tableau_, stock_, waste_ or the foundations, so the Card objects are
+// reused and keep their art. Cards that come back into play leave the
+// foundations; cards taken out of play again go onto the first one.
+void PyramidGame::applyRulesState(const rules::PyramidState &state) {
+  std::array<cardlib::Card, 64> cards;
+  std::array<bool, 64> in_play{};
+  std::array<bool, 64> on_foundation{};
+
+  for (const auto &row : tableau_) {
+    for (const auto &tableau_card : row) {
+      cards[cardlib::PackedCard(tableau_card.card).id()] = tableau_card.card;
+    }
+  }
+  for (const auto &card : stock_) {
+    cards[cardlib::PackedCard(card).id()] = card;
+  }
+  for (const auto &card : waste_) {
+    cards[cardlib::PackedCard(card).id()] = card;
+  }
+
+  int position = 0;
+  for (auto &row : tableau_) {
+    for (auto &tableau_card : row) {
+      tableau_card.removed = (state.removed & (1u << position)) != 0;
+      if (!tableau_card.removed) {
+        in_play[cardlib::PackedCard(tableau_card.card).id()] = true;
+      }
+      position++;
+    }
+  }
+
+  stock_.clear();
+  for (cardlib::PackedCard card : state.stock) {
+    stock_.push_back(cards[card.id()]);
+    in_play[card.id()] = true;
+  }
+  waste_.clear();
+  for (cardlib::PackedCard card : state.waste) {
+    waste_.push_back(cards[card.id()]);
+    in_play[card.id()] = true;
+  }
+  stock_redeals_ = state.redeals;
+
+  for (auto &pile : foundation_) {
+    std::vector<cardlib::Card> kept;
+    for (const auto &card : pile) {
+      uint8_t id = cardlib::PackedCard(card).id();
+      if (!in_play[id]) {
+        kept.push_back(card);
+        on_foundation[id] = true;
+      }
+    }
+    pile = std::move(kept);
+  }
+  for (uint8_t id = 0; id < cards.size(); id++) {
+    if (cardlib::PackedCard(id).isValid() && !in_play[id] &&
+        !on_foundation[id]) {
+      foundation_[0].push_back(cards[id]);
+    }
+  }
+}
+
+// No cards in flight: the piles hold the whole board
+bool PyramidGame::isBoardSettled() const {
+  return !(dragging_ || win_animation_active_ || deal_animation_active_ ||
+           foundation_move_animation_active_ ||
+           stock_to_waste_animation_active_ || auto_finish_active_);
+}
+
+// Called on every redraw; works out the move since the last position.
+// False if the board can't be followed right now.
+bool PyramidGame::trackUndoPosition() {
+  rules::PyramidState state;
+  if (replay_playback_active_ || !isBoardSettled() ||
+      !buildRulesState(state)) {
+    return false;
+  }
+  if (undo_history_.track(state)) {
+    startReplayRecording(state);
+  }
+  if (autosave_) {
+    autosave_->update(replay_);
+  }
+  return true;
+}
+
+void PyramidGame::undoLastMove() {
+  rules::PyramidState state;
+  if (trackUndoPosition() && undo_history_.undo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void PyramidGame::redoLastMove() {
+  rules::PyramidState state;
+  if (trackUndoPosition() && undo_history_.redo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void PyramidGame::showUndoPosition(const rules::PyramidState &state) {
+  applyRulesState(state);
+  keyboard_selection_active_ = false;
+  source_pile_ = -1;
+  source_card_idx_ = -1;
+  playSound(GameSoundEvent::CardPlace);
+  refreshDisplay();
+}
@@ -0,0 +1,144 @@
+#include "card_atlas.h"
+#include <algorithm>
+#include <cmath>
+
+namespace render {
+
+CardAtlas::CardAtlas(uint64_t source)
+    : source_(source), width_(0), height_(0) {}
+
+void CardAtlas::add(int id, int width, int height, int channels, int stride,
+                    const uint8_t *pixels) {
+  Pending image{id, width, height,
+                std::vector<uint32_t>(size_t(width) * height)};
+  for (int y = 0; y < height; y++) {
+    const uint8_t *in = pixels + size_t(y) * stride;
+    uint32_t *row = image.pixels.data() + size_t(y) * width;
+    for (int x = 0; x < width; x++, in += channels) {
+      uint32_t a = channels == 4 ? in[3] : 255;
+      uint32_t r = (in[0] * a + 127) / 255;
+      uint32_t g = (in[1] * a + 127) / 255;
+      uint32_t b = (in[2] * a + 127) / 255;
+      row[x] = a << 24 | r << 16 | g << 8 | b;
+    }
+  }
+  pending_.push_back(std::move(image));
+}
+
+void CardAtlas::pack() {
+  // Shelves about as wide as the atlas is tall; a deck's images are all
+  // one size, so this comes out as a grid
+  long long area = 0;
+  int widest = 0;
+  for (const Pending &image : pending_) {
+    area += (long long)image.width * image.height;
+    widest = std::max(widest, image.width);
+  }
+  int shelf_width = std::max(widest, int(std::ceil(std::sqrt(double(area)))));
+
+  int x = 0;
+  int y = 0;
+  int shelf_height = 0;
+  width_ = 0;
+  regions_.clear();
+  index_.clear();
+  for (const Pending &image : pending_) {
+    if (x + image.width > shelf_width) {
+      x = 0;
+      y += shelf_height;
+      shelf_height = 0;
+    }
+    if (image.id >= int(index_.size()))
+      index_.resize(image.id + 1, -1);
+    Rect region(x, y, image.width, image.height);
+    if (index_[image.id] >= 0) {
+      // Added again: the later image replaces the earlier one
+      regions_[index_[image.id]].second = region;
+    } else {
+      index_[image.id] = int(regions_.size());
+      regions_.emplace_back(image.id, region);
+    }
+    x += image.width;
+    width_ = std::max(width_, x);
+    shelf_height = std::max(shelf_height, image.height);
+  }
+  height_ = y + shelf_height;
+
+  pixels_.assign(size_t(width_) * height_, 0);
+  for (const Pending &image : pending_) {
+    const Rect &region = *find(image.id);
+    for (int row = 0; row < image.height; row++) {
+      std::copy_n(image.pixels.data() + size_t(row) * image.width,
+                  image.width,
+                  pixels_.data() + size_t(region.y + row) * width_ +
+                      region.x);
+    }
+  }
+  pending_.clear();
+  pending_.shrink_to_fit();
+}
+
+const Rect *CardAtlas::find(int id) const {
+  if (id < 0 || id >= int(index_.size()) || index_[id] < 0)
+    return nullptr;
+  return &regions_[index_[id]].second;
+}
+
+void CardAtlas::scale(const Rect &region, int width, int height,
+                      uint8_t *out, int out_stride, ScaleFilter filter) const {
+  if (width <= 0 || height <= 0 || region.empty())
+    return;
+  // Premultiplied pixels filter without dark fringes
+  resample(pixels_.data() + size_t(region.y) * width_ + region.x,
+           region.width, region.height, width_ * int(sizeof(uint32_t)),
+           reinterpret_cast<uint32_t *>(out), width, height, out_stride,
+           filter);
+}
+
+namespace {
+
+// width x height premultiplied ARGB32 pixels, rows stride pixels apart, as
+// straight-alpha RGBA bytes
+std::vector<uint8_t> unpremultiply(const uint32_t *pixels, int width,
+                                   int height, int stride) {
+  std::vector<uint8_t> rgba(size_t(width) * height * 4);
+  uint8_t *out = rgba.data();
+  for (int y = 0; y < height; y++) {
+    const uint32_t *in = pixels + size_t(y) * stride;
+    for (int x = 0; x < width; x++, out += 4) {
+      uint32_t pixel = in[x];
+      uint32_t a = pixel >> 24;
+      if (a == 0) {
+        out[0] = out[1] = out[2] = out[3] = 0;
+        continue;
+      }
+      auto straight = [a](uint32_t channel) {
+        return uint8_t(std::min(255u, (channel * 255 + a / 2) / a));
+      };
+      out[0] = straight((pixel >> 16) & 0xFF);
+      out[1] = straight((pixel >> 8) & 0xFF);
+      out[2] = straight(pixel & 0xFF);
+      out[3] = uint8_t(a);
+    }
+  }
+  return rgba;
+}
+
+} // namespace
+
+std::vector<uint8_t> CardAtlas::straightRGBA(const Rect &region) const {
+  return unpremultiply(pixels_.data() + size_t(region.y) * width_ + region.x,
+                       region.width, region.height, width_);
+}
+
+std::vector<uint8_t> CardAtlas::straightRGBA(const Rect &region, int width,
+                                             int height) const {
+  if (width == region.width && height == region.height)
+    return straightRGBA(region);
+  std::vector<uint32_t> scaled(size_t(width) * height);
+  scale(region, width, height, reinterpret_cast<uint8_t *>(scaled.data()),
+        width * int(sizeof(uint32_t)));
+  return unpremultiply(scaled.data(), width, height, width);
+}
+
+} // namespace render
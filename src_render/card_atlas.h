@@ -0,0 +1,75 @@
+#ifndef CARD_ATLAS_H
+#define CARD_ATLAS_H
+
+// A deck's card images, decoded once into one premultiplied ARGB32 buffer
+// that the Cairo surfaces and OpenGL textures are scaled from.
+
+#include "damage.h"
+#include "resample.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+class CardAtlas {
+public:
+  // source tags the images the atlas was decoded from, so the owner can
+  // tell when they have changed
+  explicit CardAtlas(uint64_t source = 0);
+
+  // Adds a decoded image under id, which is not negative: width x height
+  // pixels of 3 (RGB) or 4 (RGBA, straight alpha) bytes, rows stride bytes
+  // apart. Only before pack().
+  void add(int id, int width, int height, int channels, int stride,
+           const uint8_t *pixels);
+  // Lays the images added out in the atlas buffer
+  void pack();
+
+  uint64_t source() const { return source_; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  const uint32_t *pixels() const { return pixels_.data(); }
+  size_t bytes() const { return pixels_.size() * sizeof(uint32_t); }
+
+  // Where id's image is in the atlas, or null
+  const Rect *find(int id) const;
+  // Every image's id and region, in the order they were added
+  const std::vector<std::pair<int, Rect>> &regions() const {
+    return regions_;
+  }
+
+  // Resamples region into width x height premultiplied ARGB32 pixels at
+  // out, rows out_stride bytes apart, with the widest SIMD the CPU has (see
+  // resample.h)
+  void scale(const Rect &region, int width, int height, uint8_t *out,
+             int out_stride,
+             ScaleFilter filter = ScaleFilter::LANCZOS3) const;
+
+  // region's pixels as straight-alpha RGBA bytes, for the OpenGL textures,
+  // which are blended that way
+  std::vector<uint8_t> straightRGBA(const Rect &region) const;
+  // The same, resampled to width x height
+  std::vector<uint8_t> straightRGBA(const Rect &region, int width,
+                                    int height) const;
+
+private:
+  struct Pending {
+    int id;
+    int width;
+    int height;
+    std::vector<uint32_t> pixels;
+  };
+
+  uint64_t source_;
+  int width_;
+  int height_;
+  std::vector<uint32_t> pixels_;
+  std::vector<std::pair<int, Rect>> regions_;
+  std::vector<int> index_; // into regions_ by id, -1 where there is none
+  std::vector<Pending> pending_;
+};
+
+} // namespace render
+
+#endif // CARD_ATLAS_H
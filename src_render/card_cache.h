@@ -0,0 +1,71 @@
+#ifndef CARD_CACHE_H
+#define CARD_CACHE_H
+
+// The games' per-card caches: a flat array indexed by card id, so a draw
+// looking up a card's surface or texture allocates nothing.
+
+#include <array>
+
+namespace render {
+
+constexpr int CARD_SUITS = 4;
+constexpr int CARD_RANKS = 14; // ace to king, then the joker
+constexpr int BACK_ID = CARD_SUITS * CARD_RANKS;
+constexpr int CUSTOM_BACK_ID = BACK_ID + 1;
+constexpr int CARD_IDS = CUSTOM_BACK_ID + 1;
+
+// The id of the face of suit and rank (cardlib's Suit and Rank as ints),
+// or -1 if there is none
+constexpr int cardId(int suit, int rank) {
+  return suit >= 0 && suit < CARD_SUITS && rank >= 1 && rank <= CARD_RANKS
+             ? suit * CARD_RANKS + rank - 1
+             : -1;
+}
+
+template <class Card> constexpr int cardId(const Card &card) {
+  return cardId(static_cast<int>(card.suit), static_cast<int>(card.rank));
+}
+
+// One T per card id, T() where there is none: a null surface, a texture
+// name of 0
+template <class T> class CardCache {
+public:
+  CardCache() { clear(); }
+
+  // id's entry, or T() if it has none or id is -1
+  T get(int id) const {
+    return id >= 0 && id < CARD_IDS ? slots_[id] : T();
+  }
+  // id's slot, for storing into; id must be a valid one
+  T &operator[](int id) { return slots_[id]; }
+
+  // Empties id's slot, returning what it held for the caller to release
+  T take(int id) {
+    T value = get(id);
+    if (id >= 0 && id < CARD_IDS)
+      slots_[id] = T();
+    return value;
+  }
+
+  bool empty() const {
+    for (const T &slot : slots_) {
+      if (slot != T())
+        return false;
+    }
+    return true;
+  }
+
+  // Empties every slot. The caller releases what they held first.
+  void clear() { slots_.fill(T()); }
+
+  // Every slot, empty ones included
+  typename std::array<T, CARD_IDS>::iterator begin() { return slots_.begin(); }
+  typename std::array<T, CARD_IDS>::iterator end() { return slots_.end(); }
+
+private:
+  std::array<T, CARD_IDS> slots_;
+};
+
+} // namespace render
+
+#endif // CARD_CACHE_H
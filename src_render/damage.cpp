@@ -0,0 +1,264 @@
+#include "damage.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace render {
+
+namespace {
+
+Rect boundingBox(const std::vector<Rect> &rects) {
+  Rect bounds;
+  for (const Rect &rect : rects)
+    bounds = bounds.united(rect);
+  return bounds;
+}
+
+} // namespace
+
+bool Rect::intersects(const Rect &other) const {
+  return !empty() && !other.empty() && x < other.x + other.width &&
+         other.x < x + width && y < other.y + other.height &&
+         other.y < y + height;
+}
+
+bool Rect::contains(const Rect &other) const {
+  return other.x >= x && other.y >= y &&
+         other.x + other.width <= x + width &&
+         other.y + other.height <= y + height;
+}
+
+Rect Rect::united(const Rect &other) const {
+  if (empty())
+    return other;
+  if (other.empty())
+    return *this;
+  int left = std::min(x, other.x);
+  int top = std::min(y, other.y);
+  int right = std::max(x + width, other.x + other.width);
+  int bottom = std::max(y + height, other.y + other.height);
+  return Rect(left, top, right - left, bottom - top);
+}
+
+Rect Rect::intersected(const Rect &other) const {
+  int left = std::max(x, other.x);
+  int top = std::max(y, other.y);
+  int right = std::min(x + width, other.x + other.width);
+  int bottom = std::min(y + height, other.y + other.height);
+  if (right <= left || bottom <= top)
+    return Rect();
+  return Rect(left, top, right - left, bottom - top);
+}
+
+Rect pixelBounds(double x, double y, double width, double height,
+                 double pad) {
+  int left = int(std::floor(x - pad));
+  int top = int(std::floor(y - pad));
+  int right = int(std::ceil(x + width + pad));
+  int bottom = int(std::ceil(y + height + pad));
+  return Rect(left, top, right - left, bottom - top);
+}
+
+Rect rotatedBounds(double x, double y, double width, double height,
+                   double rotation) {
+  double c = std::fabs(std::cos(rotation));
+  double s = std::fabs(std::sin(rotation));
+  double half_width = (width * c + height * s) / 2;
+  double half_height = (width * s + height * c) / 2;
+  double cx = x + width / 2;
+  double cy = y + height / 2;
+  // A pixel more for the antialiased edge
+  return pixelBounds(cx - half_width, cy - half_height, 2 * half_width,
+                     2 * half_height, 1);
+}
+
+DrawKey &DrawKey::add(uint64_t value) {
+  for (int i = 0; i < 8; i++) {
+    hash_ ^= (value >> (8 * i)) & 0xFF;
+    hash_ *= 1099511628211ull;
+  }
+  return *this;
+}
+
+DrawKey &DrawKey::add(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return add(bits);
+}
+
+DamageTracker::DamageTracker()
+    : frame_(nullptr), painting_(false), over_layer_(false), in_layer_(false),
+      full_redraw_(getenv("SOLITAIRE_FULL_REDRAW") != nullptr) {}
+
+void DamageTracker::start(Frame &frame, int width, int height,
+                          bool painting, const std::vector<Rect> &clip) {
+  frame.window = Rect(0, 0, width, height);
+  frame.current.clear();
+  frame_ = &frame;
+  painting_ = painting;
+  over_layer_ = false;
+  clip_ = clip;
+}
+
+void DamageTracker::record(int width, int height) {
+  start(screen_, width, height, false, {});
+}
+
+void DamageTracker::paint(int width, int height,
+                          const std::vector<Rect> &clip) {
+  start(screen_, width, height, true, clip);
+}
+
+void DamageTracker::paintOverLayer(int width, int height,
+                                   const std::vector<Rect> &clip) {
+  start(screen_, width, height, true, clip);
+  over_layer_ = true;
+}
+
+void DamageTracker::recordLayer(int width, int height) {
+  start(layer_, width, height, false, {});
+}
+
+void DamageTracker::paintLayer(int width, int height,
+                               const std::vector<Rect> &clip) {
+  start(layer_, width, height, true, clip);
+}
+
+bool DamageTracker::item(const Rect &bounds, uint64_t key) {
+  if (!frame_)
+    return false;
+  if (frame_ == &layer_ && !in_layer_)
+    return false;
+  frame_->current.push_back(Item{bounds, key});
+  if (!painting_ || (over_layer_ && in_layer_))
+    return false;
+  for (const Rect &rect : clip_) {
+    if (bounds.intersects(rect))
+      return true;
+  }
+  return false;
+}
+
+const std::vector<Rect> &DamageTracker::finish() {
+  damage_.clear();
+  if (!frame_)
+    return damage_;
+  Frame &frame = *frame_;
+  if (frame.invalid || full_redraw_ ||
+      !(frame.window == frame.previous_window)) {
+    damage_.push_back(frame.window);
+  } else {
+    size_t common = std::min(frame.previous.size(), frame.current.size());
+    size_t i = 0;
+    for (; i < common; i++) {
+      const Item &was = frame.previous[i];
+      const Item &now = frame.current[i];
+      if (was.key == now.key && was.bounds == now.bounds)
+        continue;
+      damage_.push_back(was.bounds);
+      damage_.push_back(now.bounds);
+    }
+    for (size_t j = i; j < frame.previous.size(); j++)
+      damage_.push_back(frame.previous[j].bounds);
+    for (size_t j = i; j < frame.current.size(); j++)
+      damage_.push_back(frame.current[j].bounds);
+    mergeDamage();
+  }
+  // A painted frame has already drawn whatever changed inside the clip
+  if (painting_) {
+    damage_.erase(std::remove_if(damage_.begin(), damage_.end(),
+                                 [this](const Rect &rect) {
+                                   for (const Rect &painted : clip_) {
+                                     if (painted.contains(rect))
+                                       return true;
+                                   }
+                                   return false;
+                                 }),
+                  damage_.end());
+  }
+
+  frame_ = nullptr;
+  painting_ = false;
+  over_layer_ = false;
+  in_layer_ = false;
+  frame.invalid = false;
+  frame.previous_window = frame.window;
+  frame.previous.swap(frame.current);
+  frame.current.clear();
+  return damage_;
+}
+
+void DamageTracker::mergeDamage() {
+  for (Rect &rect : damage_)
+    rect = rect.intersected(frame_->window);
+  damage_.erase(std::remove_if(damage_.begin(), damage_.end(),
+                               [](const Rect &rect) { return rect.empty(); }),
+                damage_.end());
+  // The win animation's flying cards damage the whole board anyway
+  if (damage_.size() > 8 * MAX_RECTS) {
+    damage_.assign(1, boundingBox(damage_));
+    return;
+  }
+
+  // Join rectangles while the join repaints little that neither needed:
+  // a moving card's old and new bounds, a column's cards
+  bool merged = true;
+  while (merged && damage_.size() > 1) {
+    merged = false;
+    for (size_t i = 0; i < damage_.size() && !merged; i++) {
+      for (size_t j = i + 1; j < damage_.size(); j++) {
+        Rect joined = damage_[i].united(damage_[j]);
+        if (joined.area() > damage_[i].area() + damage_[j].area())
+          continue;
+        damage_[i] = joined;
+        damage_.erase(damage_.begin() + j);
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (damage_.size() > MAX_RECTS) {
+    damage_.assign(1, boundingBox(damage_));
+  }
+}
+
+FrameStats::FrameStats(const char *name)
+    : name_(name), enabled_(getenv("SOLITAIRE_FRAME_STATS") != nullptr),
+      frames_(0), total_ms_(0), worst_ms_(0), painted_(0), window_(0) {}
+
+void FrameStats::begin() {
+  if (enabled_)
+    started_ = std::chrono::steady_clock::now();
+}
+
+void FrameStats::end(long long painted_pixels, long long window_pixels) {
+  if (!enabled_)
+    return;
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - started_)
+                  .count();
+  frames_++;
+  total_ms_ += ms;
+  worst_ms_ = std::max(worst_ms_, ms);
+  painted_ += painted_pixels;
+  window_ += window_pixels;
+  if (frames_ < REPORT_FRAMES)
+    return;
+
+  printf("[%s] %d frames: %.2f ms mean, %.2f ms worst, %.1f%% of the "
+         "window repainted%s\n",
+         name_, frames_, total_ms_ / frames_, worst_ms_,
+         window_ ? 100.0 * painted_ / window_ : 0.0,
+         getenv("SOLITAIRE_FULL_REDRAW") ? " (full redraw)" : "");
+  fflush(stdout);
+  frames_ = 0;
+  total_ms_ = 0;
+  worst_ms_ = 0;
+  painted_ = 0;
+  window_ = 0;
+}
+
+} // namespace render
@@ -0,0 +1,172 @@
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+// Damage tracking for the Cairo renderers: each frame's drawn items are
+// compared with the last frame's so only what changed is repainted.
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+struct Rect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  Rect() {}
+  Rect(int x, int y, int width, int height)
+      : x(x), y(y), width(width), height(height) {}
+
+  bool empty() const { return width <= 0 || height <= 0; }
+  long long area() const { return empty() ? 0 : (long long)width * height; }
+  bool intersects(const Rect &other) const;
+  bool contains(const Rect &other) const;
+  Rect united(const Rect &other) const;
+  Rect intersected(const Rect &other) const;
+  bool operator==(const Rect &other) const {
+    return x == other.x && y == other.y && width == other.width &&
+           height == other.height;
+  }
+};
+
+// The whole pixels covered by a rectangle with fractional corners, grown
+// by pad on each side for strokes and antialiasing
+Rect pixelBounds(double x, double y, double width, double height,
+                 double pad = 0);
+
+// The pixels covered by a width x height rectangle at (x, y) turned by
+// rotation radians about its centre
+Rect rotatedBounds(double x, double y, double width, double height,
+                   double rotation);
+
+// Builds an item key, FNV-1a over the values added
+class DrawKey {
+public:
+  DrawKey() : hash_(14695981039346656037ull) {}
+  DrawKey &add(uint64_t value);
+  DrawKey &add(int value) { return add(uint64_t(int64_t(value))); }
+  DrawKey &add(bool value) { return add(uint64_t(value)); }
+  DrawKey &add(double value);
+  DrawKey &add(const void *pointer) {
+    return add(uint64_t(uintptr_t(pointer)));
+  }
+  uint64_t value() const { return hash_; }
+
+private:
+  uint64_t hash_;
+};
+
+class DamageTracker {
+public:
+  // More separate rectangles than this and the damage is sent as their
+  // bounding box
+  static constexpr size_t MAX_RECTS = 16;
+
+  DamageTracker();
+
+  // Starts a frame that is only recorded: item() always returns false
+  void record(int width, int height);
+  // Starts a frame painted into clip, the rectangles GTK asked for
+  void paint(int width, int height, const std::vector<Rect> &clip);
+  // As paint(), over a static layer already blitted into clip: the
+  // layer's items are recorded but never painted
+  void paintOverLayer(int width, int height, const std::vector<Rect> &clip);
+  bool painting() const { return painting_; }
+
+  // Items added between beginLayer() and endLayer() make up the static
+  // layer
+  void beginLayer() { in_layer_ = true; }
+  void endLayer() { in_layer_ = false; }
+  // Start passes over the static layer's items alone, compared with what
+  // the layer's surface last had painted into it: recordLayer() to find
+  // what changed, paintLayer() to repaint it. Items outside the layer are
+  // ignored.
+  void recordLayer(int width, int height);
+  void paintLayer(int width, int height, const std::vector<Rect> &clip);
+
+  // Adds an item to the frame. True if it has to be painted: the frame is
+  // being painted, the item meets the clip and the layer blit does not
+  // already supply it. Outside a frame, as when the OpenGL renderer shares
+  // the drawing code, it does nothing.
+  bool item(const Rect &bounds, uint64_t key);
+  bool item(const Rect &bounds, const DrawKey &key) {
+    return item(bounds, key.value());
+  }
+
+  // Ends the frame or layer pass. Returns the damage since the one before,
+  // merged and cut to the window, and keeps this one to compare the next
+  // against.
+  const std::vector<Rect> &finish();
+
+  // Damages the whole window and static layer at the next finish(), e.g.
+  // after the card images are reloaded
+  void invalidate() { screen_.invalid = layer_.invalid = true; }
+  // Damages the whole static layer, e.g. when its surface is new
+  void invalidateLayer() { layer_.invalid = true; }
+
+  // Set from SOLITAIRE_FULL_REDRAW: every frame damages the whole window,
+  // as before damage tracking, for comparing frame times
+  bool fullRedraw() const { return full_redraw_; }
+
+private:
+  struct Item {
+    Rect bounds;
+    uint64_t key;
+  };
+
+  // A sequence of items compared with the one drawn before it: the
+  // window's, or the static layer's
+  struct Frame {
+    std::vector<Item> previous;
+    std::vector<Item> current;
+    Rect window;
+    Rect previous_window;
+    bool invalid = true;
+  };
+
+  void start(Frame &frame, int width, int height, bool painting,
+             const std::vector<Rect> &clip);
+  void mergeDamage();
+
+  Frame screen_;
+  Frame layer_;
+  Frame *frame_;   // The one being drawn, null outside a frame
+  std::vector<Rect> damage_;
+  std::vector<Rect> clip_;
+  bool painting_;
+  bool over_layer_;
+  bool in_layer_;
+  bool full_redraw_;
+};
+
+// Draw-time statistics for comparing damage tracking with full repaints:
+// with SOLITAIRE_FRAME_STATS set, prints the mean time a frame took to
+// paint and the share of the window it repainted every REPORT_FRAMES
+// frames.
+class FrameStats {
+public:
+  static constexpr int REPORT_FRAMES = 120;
+
+  explicit FrameStats(const char *name);
+
+  bool enabled() const { return enabled_; }
+  void begin();
+  void end(long long painted_pixels, long long window_pixels);
+
+private:
+  const char *name_;
+  bool enabled_;
+  std::chrono::steady_clock::time_point started_;
+  int frames_;
+  double total_ms_;
+  double worst_ms_;
+  long long painted_;
+  long long window_;
+};
+
+} // namespace render
+
+#endif // DAMAGE_H
@@ -0,0 +1,319 @@
+#ifndef GL_CARD_BATCH_H
+#define GL_CARD_BATCH_H
+
+// The OpenGL renderers' cards, a frame's worth in one instanced draw call.
+// Header-only; include it after the OpenGL 3.3 declarations.
+
+#include "card_atlas.h"
+#include "card_cache.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <vector>
+
+#ifndef GL_VERSION_3_3
+#error "gl_card_batch.h needs the OpenGL 3.3 declarations included first"
+#endif
+
+namespace render {
+
+class GLCardBatch {
+public:
+  // The layer after the card ids': the placeholder drawn where a pile is
+  // empty, filled with fill()
+  static constexpr int EMPTY_PILE_ID = CARD_IDS;
+  static constexpr int LAYERS = CARD_IDS + 1;
+
+  // Counted since resetStats()
+  struct Stats {
+    long long draws = 0;     // draw calls
+    long long instances = 0; // cards and fragments drawn
+  };
+
+  GLCardBatch() { filled_.fill(false); }
+  GLCardBatch(const GLCardBatch &) = delete;
+  GLCardBatch &operator=(const GLCardBatch &) = delete;
+
+  // Compiles the program and sets up the vertex array; false, with the
+  // log on stderr, if the driver would not have them
+  bool create() {
+    if (program_.id() != 0)
+      return true;
+    if (!program_.link("Card batch", VERTEX_SOURCE, FRAGMENT_SOURCE))
+      return false;
+    viewport_location_ = program_.location("viewport");
+    viewport_width_ = viewport_height_ = 0;
+    glUseProgram(program_.id());
+    glUniform1i(program_.location("cards"), 0);
+
+    // The quad's corners come from gl_VertexID; the buffer holds only the
+    // instances, one Instance each
+    glGenVertexArrays(1, &vertex_array_);
+    glGenBuffers(1, &instance_buffer_);
+    glBindVertexArray(vertex_array_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    for (GLuint attribute = 0; attribute < 3; attribute++) {
+      glEnableVertexAttribArray(attribute);
+      glVertexAttribPointer(
+          attribute, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+          reinterpret_cast<const void *>(attribute * 4 * sizeof(float)));
+      glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return glGetError() == GL_NO_ERROR;
+  }
+
+  // Deletes everything create() and load() made
+  void destroy() {
+    if (texture_ != 0)
+      glDeleteTextures(1, &texture_);
+    if (instance_buffer_ != 0)
+      glDeleteBuffers(1, &instance_buffer_);
+    if (vertex_array_ != 0)
+      glDeleteVertexArrays(1, &vertex_array_);
+    program_.destroy();
+    texture_ = instance_buffer_ = vertex_array_ = 0;
+    buffer_bytes_ = 0;
+    filled_.fill(false);
+    instances_.clear();
+  }
+
+  bool ready() const { return program_.id() != 0 && texture_ != 0; }
+  GLuint program() const { return program_.id(); }
+  GLuint vertexArray() const { return vertex_array_; }
+  // The 2D array texture, a layer an id, for GLExplosions to draw from
+  GLuint texture() const { return texture_; }
+
+  // (Re)allocates the texture at the size of the deck's largest image and
+  // uploads each of its images to its id's layer. Every other layer is
+  // emptied, the custom back's included.
+  bool load(const CardAtlas &deck) {
+    int width = 0, height = 0;
+    for (const auto &[id, region] : deck.regions()) {
+      width = std::max(width, region.width);
+      height = std::max(height, region.height);
+    }
+    if (width == 0 || height == 0) {
+      // No images: the layers only hold fill()s
+      width = 32;
+      height = 48;
+    }
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    if (max_size > 0 && std::max(width, height) > max_size) {
+      double shrink = double(max_size) / std::max(width, height);
+      width = std::max(1, int(width * shrink));
+      height = std::max(1, int(height * shrink));
+    }
+
+    if (texture_ == 0)
+      glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, LAYERS, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    layer_width_ = width;
+    layer_height_ = height;
+    filled_.fill(false);
+
+    for (const auto &[id, region] : deck.regions())
+      upload(id, deck, region);
+    return glGetError() == GL_NO_ERROR;
+  }
+
+  // Uploads region of atlas to id's layer, resampled to the layer size if
+  // it is not that already. Only after load().
+  bool upload(int id, const CardAtlas &atlas, const Rect &region) {
+    if (texture_ == 0 || id < 0 || id >= LAYERS || region.empty())
+      return false;
+    std::vector<uint8_t> pixels =
+        atlas.straightRGBA(region, layer_width_, layer_height_);
+    setLayer(id, pixels.data());
+    return true;
+  }
+
+  // The same for width x height straight-alpha RGBA pixels decoded
+  // elsewhere, the custom back's
+  bool upload(int id, int width, int height, const uint8_t *rgba) {
+    CardAtlas image;
+    image.add(id, width, height, 4, width * 4, rgba);
+    image.pack();
+    const Rect *region = image.find(id);
+    return region && upload(id, image, *region);
+  }
+
+  // Fills id's layer with one straight-alpha colour. Only after load().
+  void fill(int id, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha) {
+    if (texture_ == 0 || id < 0 || id >= LAYERS)
+      return;
+    std::vector<uint8_t> pixels(size_t(layer_width_) * layer_height_ * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+      pixels[i] = red;
+      pixels[i + 1] = green;
+      pixels[i + 2] = blue;
+      pixels[i + 3] = alpha;
+    }
+    setLayer(id, pixels.data());
+  }
+
+  // Empties id's layer: it draws as the back again
+  void unload(int id) {
+    if (id >= 0 && id < LAYERS)
+      filled_[id] = false;
+  }
+
+  bool has(int id) const { return id >= 0 && id < LAYERS && filled_[id]; }
+  // The back face-down cards show: the custom one if there is one
+  int backId() const { return has(CUSTOM_BACK_ID) ? CUSTOM_BACK_ID : BACK_ID; }
+  // The layer id draws from: its own, or the back's if it has no image
+  int layer(int id) const { return has(id) ? id : backId(); }
+
+  // Queues id's image over the width x height rectangle at x, y, turned
+  // rotation radians about its centre. An id without an image draws the
+  // back.
+  void add(int id, float x, float y, float width, float height,
+           float rotation = 0.0f, float alpha = 1.0f) {
+    addPart(id, 0.0f, 0.0f, 1.0f, 1.0f, x, y, width, height, rotation,
+            alpha);
+  }
+
+  // The same for the part of the image at u, v, part_width x part_height
+  // in texture coordinates (0 to 1 across the whole image)
+  void addPart(int id, float u, float v, float part_width, float part_height,
+               float x, float y, float width, float height, float rotation,
+               float alpha) {
+    instances_.push_back({x, y, width, height, u, v, part_width, part_height,
+                          float(layer(id)), alpha, rotation, 0.0f});
+  }
+
+  size_t queued() const { return instances_.size(); }
+
+  // Draws what was queued since the last draw(), in the order queued,
+  // onto a viewport of width x height pixels, y down, and empties the
+  // queue. Binds through state, leaving blending on: state.endFrame()
+  // turns it off.
+  void draw(GLState &state, int width, int height) {
+    if (instances_.empty())
+      return;
+    if (!ready()) {
+      instances_.clear();
+      return;
+    }
+    state.useProgram(program_.id());
+    // The program keeps the uniform's value; it only changes on a resize
+    if (width != viewport_width_ || height != viewport_height_) {
+      glUniform2f(viewport_location_, float(width), float(height));
+      viewport_width_ = width;
+      viewport_height_ = height;
+    }
+    state.bindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    state.bindVertexArray(vertex_array_);
+
+    // Orphaning the buffer lets the driver hand back fresh storage rather
+    // than wait for the last frame's draw to finish with it
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    size_t bytes = instances_.size() * sizeof(Instance);
+    buffer_bytes_ = std::max(buffer_bytes_, bytes);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(buffer_bytes_), nullptr,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(bytes), instances_.data());
+
+    state.blend(true);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+                          GLsizei(instances_.size()));
+
+    stats_.draws++;
+    stats_.instances += (long long)instances_.size();
+    instances_.clear();
+  }
+
+  const Stats &stats() const { return stats_; }
+  void resetStats() { stats_ = Stats(); }
+
+private:
+  // Three vec4 attributes a card
+  struct Instance {
+    float x, y, width, height;
+    float u, v, part_width, part_height;
+    float layer, alpha, rotation, unused;
+  };
+
+  // Binds the texture behind any GLState's back: uploads happen between
+  // frames, and beginFrame() forgets what was bound
+  void setLayer(int id, const uint8_t *pixels) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, id, layer_width_,
+                    layer_height_, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    filled_[id] = true;
+  }
+
+  // The corner, 0 or 1 across and down, comes from the vertex's index in
+  // the strip; the rectangle is turned about its centre like the model
+  // matrices the cards were drawn with one by one
+  static constexpr const char *VERTEX_SOURCE = R"(
+      #version 330 core
+      layout(location = 0) in vec4 rect;   // x, y, width, height
+      layout(location = 1) in vec4 part;   // u, v, width, height
+      layout(location = 2) in vec4 params; // layer, alpha, rotation
+
+      uniform vec2 viewport;
+
+      out vec3 texCoord;
+      out float alpha;
+
+      void main()
+      {
+          vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+          vec2 half_size = rect.zw * 0.5;
+          vec2 offset = corner * rect.zw - half_size;
+          float c = cos(params.z);
+          float s = sin(params.z);
+          vec2 position = rect.xy + half_size +
+                          vec2(c * offset.x - s * offset.y,
+                               s * offset.x + c * offset.y);
+          gl_Position = vec4(position / viewport * vec2(2.0, -2.0) +
+                             vec2(-1.0, 1.0), 0.0, 1.0);
+          texCoord = vec3(part.xy + corner * part.zw, params.x);
+          alpha = params.y;
+      }
+  )";
+  static constexpr const char *FRAGMENT_SOURCE = R"(
+      #version 330 core
+      in vec3 texCoord;
+      in float alpha;
+
+      uniform sampler2DArray cards;
+
+      out vec4 FragColor;
+
+      void main()
+      {
+          vec4 texColor = texture(cards, texCoord);
+          FragColor = vec4(texColor.rgb, texColor.a * alpha);
+      }
+  )";
+
+  GLProgram program_;
+  GLint viewport_location_ = -1;
+  int viewport_width_ = 0;
+  int viewport_height_ = 0;
+  GLuint vertex_array_ = 0;
+  GLuint instance_buffer_ = 0;
+  size_t buffer_bytes_ = 0;
+  GLuint texture_ = 0;
+  int layer_width_ = 0;
+  int layer_height_ = 0;
+  std::array<bool, LAYERS> filled_;
+  std::vector<Instance> instances_;
+  Stats stats_;
+};
+
+} // namespace render
+
+#endif // GL_CARD_BATCH_H
@@ -0,0 +1,473 @@
+#ifndef GL_EXPLOSIONS_H
+#define GL_EXPLOSIONS_H
+
+// The win animation's exploding cards, simulated in the vertex shader.
+// Header-only; include it after the OpenGL 3.3 declarations.
+
+#include "gl_state.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifndef GL_VERSION_3_3
+#error "gl_explosions.h needs the OpenGL 3.3 declarations included first"
+#endif
+
+namespace render {
+
+// One explosion as the GPU gets it: three vec4 attributes
+struct ExplosionLaunch {
+  float x, y, width, height;
+  float layer, rotation, tick, gravity;
+  float seed, alpha, unused[2];
+};
+
+// Where a fragment is, ticks after its card blew up
+struct ExplosionFragment {
+  float x, y, width, height;
+  float u, v; // its part of the card, GRID of it across and down
+  float rotation;
+};
+
+// The vertex shader's physics, line for line
+struct ExplosionPhysics {
+  static uint32_t hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+  }
+
+  // The k'th number in [0, 1) of the fragment's
+  static float random(uint32_t seed, uint32_t fragment, uint32_t k) {
+    return float(hash(seed ^ hash(fragment * 8U + k)) >> 8) / 16777216.0f;
+  }
+
+  // The first tick, from 1, that y + n * vy + gravity * n * (n - 1) / 2
+  // passes limit
+  static float firstTickPast(float y, float vy, float gravity, float limit) {
+    float a = gravity * 0.5f;
+    float b = vy - a;
+    float c = y - limit;
+    float discriminant = b * b - 4.0f * a * c;
+    if (discriminant < 0.0f)
+      return 1.0f;
+    return std::max(1.0f,
+                    std::floor((-b + std::sqrt(discriminant)) / (2.0f * a)) +
+                        1.0f);
+  }
+
+  // The motion a fragment starts with, and the tick it bounces on, if it
+  // does, in a window height pixels high
+  struct Motion {
+    float x, y, vx, vy, spin;
+    float bounce_tick; // 0 if it never does
+    float bounce_vx, bounce_spin;
+  };
+
+  static Motion motion(const ExplosionLaunch &launch, int fragment, int grid,
+                       float width, float height) {
+    uint32_t seed = uint32_t(launch.seed);
+    uint32_t index = uint32_t(fragment);
+    int column = fragment % grid, row = fragment / grid;
+    float part_width = launch.width / grid, part_height = launch.height / grid;
+    float dx = (column + 0.5f) * part_width - launch.width * 0.5f;
+    float dy = (row + 0.5f) * part_height - launch.height * 0.5f;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length > 0.001f) {
+      dx /= length;
+      dy /= length;
+    } else {
+      float angle = 6.2831853f * random(seed, index, 6);
+      dx = std::cos(angle);
+      dy = std::sin(angle);
+    }
+    float speed = 12.0f + std::floor(random(seed, index, 0) * 8.0f);
+    float upward = -15.0f - std::floor(random(seed, index, 1) * 10.0f);
+
+    Motion m;
+    m.x = launch.x + column * part_width;
+    m.y = launch.y + row * part_height;
+    m.vx = dx * speed + std::floor(random(seed, index, 2) * 10.0f) - 5.0f;
+    m.vy = dy * speed + upward;
+    m.spin = (std::floor(random(seed, index, 3) * 60.0f) - 30.0f) / 5.0f;
+    m.bounce_vx = m.vx + std::floor(random(seed, index, 5) * 11.0f) - 5.0f;
+    m.bounce_spin = m.spin * 1.5f;
+
+    // A falling fragment in the lower half that has not reached the
+    // bottom or left the window sideways
+    m.bounce_tick = 0.0f;
+    if (random(seed, index, 4) < 0.25f) {
+      float g = launch.gravity;
+      float tick = std::max(firstTickPast(m.y, m.vy, g, height * 0.5f),
+                            std::max(1.0f, std::floor(-m.vy / g) + 1.0f));
+      float x = m.x + tick * m.vx;
+      float y = m.y + tick * m.vy + g * tick * (tick - 1.0f) * 0.5f;
+      if (y < height - part_height && x > -part_width && x < width)
+        m.bounce_tick = tick;
+    }
+    return m;
+  }
+
+  static ExplosionFragment at(const ExplosionLaunch &launch, int fragment,
+                              int grid, float ticks, float width,
+                              float height) {
+    Motion m = motion(launch, fragment, grid, width, height);
+    float g = launch.gravity;
+    float n = ticks;
+    float x = m.x, y = m.y, vx = m.vx, vy = m.vy, spin = m.spin;
+    float rotation = launch.rotation;
+    if (m.bounce_tick > 0.0f && ticks > m.bounce_tick) {
+      float t = m.bounce_tick;
+      x += t * vx;
+      y += t * vy + g * t * (t - 1.0f) * 0.5f;
+      rotation += t * spin;
+      vy = -(vy + t * g) * 0.8f;
+      vx = m.bounce_vx;
+      spin = m.bounce_spin;
+      n = ticks - t;
+    }
+    int column = fragment % grid, row = fragment / grid;
+    return {x + n * vx,
+            y + n * vy + g * n * (n - 1.0f) * 0.5f,
+            launch.width / grid,
+            launch.height / grid,
+            float(column) / grid,
+            float(row) / grid,
+            rotation + n * spin};
+  }
+
+  // The ticks until every fragment has left a width x height window, the
+  // way the games took them off: past either side or below the bottom
+  static int lifetime(const ExplosionLaunch &launch, int grid, float width,
+                      float height) {
+    float part_width = launch.width / grid, part_height = launch.height / grid;
+    float g = launch.gravity;
+    float longest = 0.0f;
+    for (int fragment = 0; fragment < grid * grid; fragment++) {
+      Motion m = motion(launch, fragment, grid, width, height);
+      float start = 0.0f, x = m.x, y = m.y, vx = m.vx, vy = m.vy;
+      if (m.bounce_tick > 0.0f) {
+        start = m.bounce_tick;
+        x += start * vx;
+        y += start * vy + g * start * (start - 1.0f) * 0.5f;
+        vy = -(vy + start * g) * 0.8f;
+        vx = m.bounce_vx;
+      }
+      float ticks = firstTickPast(y, vy, g, height + part_height);
+      if (vx > 0.0f)
+        ticks = std::min(ticks, std::floor((width - x) / vx) + 1.0f);
+      else if (vx < 0.0f)
+        ticks = std::min(ticks, std::floor((-part_width - x) / vx) + 1.0f);
+      longest = std::max(longest, start + ticks);
+    }
+    return int(longest);
+  }
+};
+
+class GLExplosions {
+public:
+  // Fragments across and down a card
+  static constexpr int GRID = 16;
+  // Ticks an explosion is kept past the one ExplosionPhysics gives, for
+  // the shader's float arithmetic coming out a little differently
+  static constexpr int SPARE_TICKS = 2;
+
+  // Counted since resetStats()
+  struct Stats {
+    long long draws = 0;     // draw calls
+    long long fragments = 0; // fragments drawn
+    long long uploads = 0;   // buffer uploads
+    long long bytes = 0;     // bytes uploaded
+  };
+
+  GLExplosions() = default;
+  GLExplosions(const GLExplosions &) = delete;
+  GLExplosions &operator=(const GLExplosions &) = delete;
+
+  // Compiles the program and sets up the vertex array; false, with the
+  // log on stderr, if the driver would not have them
+  bool create() {
+    if (program_.id() != 0)
+      return true;
+    if (!program_.link("Explosion", VERTEX_SOURCE, FRAGMENT_SOURCE))
+      return false;
+    viewport_location_ = program_.location("viewport");
+    tick_location_ = program_.location("tick");
+    viewport_width_ = viewport_height_ = 0;
+    drawn_tick_ = -1;
+    glUseProgram(program_.id());
+    glUniform1i(program_.location("cards"), 0);
+    glUniform1i(program_.location("grid"), GRID);
+
+    // A record a card, read by each of its GRID * GRID instances
+    glGenVertexArrays(1, &vertex_array_);
+    glGenBuffers(1, &launch_buffer_);
+    glBindVertexArray(vertex_array_);
+    glBindBuffer(GL_ARRAY_BUFFER, launch_buffer_);
+    for (GLuint attribute = 0; attribute < 3; attribute++) {
+      glEnableVertexAttribArray(attribute);
+      glVertexAttribPointer(
+          attribute, 4, GL_FLOAT, GL_FALSE, sizeof(ExplosionLaunch),
+          reinterpret_cast<const void *>(attribute * 4 * sizeof(float)));
+      glVertexAttribDivisor(attribute, GRID * GRID);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploaded_ = buffer_records_ = 0;
+    return glGetError() == GL_NO_ERROR;
+  }
+
+  // Deletes everything create() made
+  void destroy() {
+    if (launch_buffer_ != 0)
+      glDeleteBuffers(1, &launch_buffer_);
+    if (vertex_array_ != 0)
+      glDeleteVertexArrays(1, &vertex_array_);
+    program_.destroy();
+    launch_buffer_ = vertex_array_ = 0;
+    uploaded_ = buffer_records_ = 0;
+  }
+
+  bool ready() const { return program_.id() != 0; }
+
+  // Blows up the card drawn from layer over the width x height rectangle
+  // at x, y, turned rotation radians, in a window_width x window_height
+  // window; its fragments fall under gravity a tick and are drawn with
+  // alpha. Needs no context: the record is uploaded at the next draw().
+  void launch(int layer, float x, float y, float width, float height,
+              float rotation, float gravity, float alpha, int window_width,
+              int window_height) {
+    seed_ = ExplosionPhysics::hash(seed_ + 1);
+    // The seed's top 24 bits, which a float holds exactly
+    ExplosionLaunch record = {x, y, width, height,
+                              float(layer), rotation, float(tick_),
+                              std::max(gravity, 0.01f),
+                              float(seed_ >> 8), alpha, {0.0f, 0.0f}};
+    launches_.push_back(record);
+    int lifetime = ExplosionPhysics::lifetime(
+        record, GRID, float(window_width), float(window_height));
+    last_tick_ = std::max(last_tick_, tick_ + lifetime + SPARE_TICKS);
+  }
+
+  // Moves every explosion on a tick, as the games' animation timer does,
+  // and forgets them all once the last has left the window
+  void tick() {
+    if (launches_.empty())
+      return;
+    if (++tick_ > last_tick_)
+      clear();
+  }
+
+  // Whether any fragment may still be in the window
+  bool active() const { return !launches_.empty(); }
+
+  // Forgets every explosion, as when the win animation stops
+  void clear() {
+    launches_.clear();
+    uploaded_ = 0;
+    tick_ = last_tick_ = 0;
+  }
+
+  // Draws every fragment as it is at the current tick onto a viewport of
+  // width x height pixels, y down, from the card batch's texture (see
+  // GLCardBatch::texture()). Binds through state, leaving blending on.
+  void draw(GLState &state, GLuint cards, int width, int height) {
+    if (launches_.empty() || !ready() || cards == 0)
+      return;
+    state.useProgram(program_.id());
+    if (width != viewport_width_ || height != viewport_height_) {
+      glUniform2f(viewport_location_, float(width), float(height));
+      viewport_width_ = width;
+      viewport_height_ = height;
+    }
+    if (tick_ != drawn_tick_) {
+      glUniform1f(tick_location_, float(tick_));
+      drawn_tick_ = tick_;
+    }
+    state.bindTexture(GL_TEXTURE_2D_ARRAY, cards);
+    state.bindVertexArray(vertex_array_);
+
+    // Only records launched since the last draw go up, after the others;
+    // a buffer too small for them all is made again, and refilled
+    if (uploaded_ < launches_.size()) {
+      glBindBuffer(GL_ARRAY_BUFFER, launch_buffer_);
+      if (launches_.size() > buffer_records_) {
+        buffer_records_ = std::max(launches_.capacity(), size_t(64));
+        glBufferData(GL_ARRAY_BUFFER,
+                     GLsizeiptr(buffer_records_ * sizeof(ExplosionLaunch)),
+                     nullptr, GL_DYNAMIC_DRAW);
+        uploaded_ = 0;
+      }
+      size_t count = launches_.size() - uploaded_;
+      glBufferSubData(GL_ARRAY_BUFFER,
+                      GLintptr(uploaded_ * sizeof(ExplosionLaunch)),
+                      GLsizeiptr(count * sizeof(ExplosionLaunch)),
+                      launches_.data() + uploaded_);
+      uploaded_ = launches_.size();
+      stats_.uploads++;
+      stats_.bytes += (long long)(count * sizeof(ExplosionLaunch));
+    }
+
+    state.blend(true);
+    GLsizei fragments = GLsizei(launches_.size() * GRID * GRID);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, fragments);
+    stats_.draws++;
+    stats_.fragments += fragments;
+  }
+
+  size_t explosions() const { return launches_.size(); }
+  const std::vector<ExplosionLaunch> &launches() const { return launches_; }
+  int currentTick() const { return tick_; }
+
+  const Stats &stats() const { return stats_; }
+  void resetStats() { stats_ = Stats(); }
+
+private:
+  // ExplosionPhysics in GLSL; the fragment's quad is turned about its
+  // centre as GLCardBatch turns a card's
+  static constexpr const char *VERTEX_SOURCE = R"(
+      #version 330 core
+      layout(location = 0) in vec4 rect;   // x, y, width, height
+      layout(location = 1) in vec4 params; // layer, rotation, tick, gravity
+      layout(location = 2) in vec4 extra;  // seed, alpha
+
+      uniform vec2 viewport;
+      uniform float tick;
+      uniform int grid;
+
+      out vec3 texCoord;
+      out float alpha;
+
+      uint hash(uint x)
+      {
+          x ^= x >> 16;
+          x *= 0x7feb352du;
+          x ^= x >> 15;
+          x *= 0x846ca68bu;
+          x ^= x >> 16;
+          return x;
+      }
+
+      float random(uint seed, uint fragment, uint k)
+      {
+          return float(hash(seed ^ hash(fragment * 8u + k)) >> 8) /
+                 16777216.0;
+      }
+
+      float firstTickPast(float y, float vy, float g, float limit)
+      {
+          float a = g * 0.5;
+          float b = vy - a;
+          float c = y - limit;
+          float discriminant = b * b - 4.0 * a * c;
+          if (discriminant < 0.0)
+              return 1.0;
+          return max(1.0, floor((-b + sqrt(discriminant)) / (2.0 * a)) + 1.0);
+      }
+
+      void main()
+      {
+          int fragment = gl_InstanceID % (grid * grid);
+          int column = fragment % grid;
+          int row = fragment / grid;
+          uint seed = uint(extra.x);
+          uint index = uint(fragment);
+          float g = params.w;
+          vec2 part = rect.zw / float(grid);
+
+          vec2 direction = (vec2(column, row) + 0.5) * part - rect.zw * 0.5;
+          float length_ = sqrt(dot(direction, direction));
+          if (length_ > 0.001) {
+              direction /= length_;
+          } else {
+              float angle = 6.2831853 * random(seed, index, 6u);
+              direction = vec2(cos(angle), sin(angle));
+          }
+          float speed = 12.0 + floor(random(seed, index, 0u) * 8.0);
+          float upward = -15.0 - floor(random(seed, index, 1u) * 10.0);
+
+          vec2 position = rect.xy + vec2(column, row) * part;
+          vec2 velocity = vec2(
+              direction.x * speed + floor(random(seed, index, 2u) * 10.0) -
+                  5.0,
+              direction.y * speed + upward);
+          float spin = (floor(random(seed, index, 3u) * 60.0) - 30.0) / 5.0;
+          float rotation = params.y;
+          float n = tick - params.z;
+
+          if (random(seed, index, 4u) < 0.25) {
+              float t = max(firstTickPast(position.y, velocity.y, g,
+                                          viewport.y * 0.5),
+                            max(1.0, floor(-velocity.y / g) + 1.0));
+              float x = position.x + t * velocity.x;
+              float y = position.y + t * velocity.y + g * t * (t - 1.0) * 0.5;
+              if (y < viewport.y - part.y && x > -part.x && x < viewport.x &&
+                  n > t) {
+                  position = vec2(x, y);
+                  rotation += t * spin;
+                  velocity = vec2(
+                      velocity.x + floor(random(seed, index, 5u) * 11.0) -
+                          5.0,
+                      -(velocity.y + t * g) * 0.8);
+                  spin *= 1.5;
+                  n -= t;
+              }
+          }
+          position += n * velocity + vec2(0.0, g * n * (n - 1.0) * 0.5);
+          rotation += n * spin;
+
+          vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+          vec2 half_size = part * 0.5;
+          vec2 offset = corner * part - half_size;
+          float c = cos(rotation);
+          float s = sin(rotation);
+          vec2 point = position + half_size +
+                       vec2(c * offset.x - s * offset.y,
+                            s * offset.x + c * offset.y);
+          gl_Position = vec4(point / viewport * vec2(2.0, -2.0) +
+                             vec2(-1.0, 1.0), 0.0, 1.0);
+          texCoord = vec3((vec2(column, row) + corner) / float(grid),
+                          params.x);
+          alpha = extra.y;
+      }
+  )";
+  static constexpr const char *FRAGMENT_SOURCE = R"(
+      #version 330 core
+      in vec3 texCoord;
+      in float alpha;
+
+      uniform sampler2DArray cards;
+
+      out vec4 FragColor;
+
+      void main()
+      {
+          vec4 texColor = texture(cards, texCoord);
+          FragColor = vec4(texColor.rgb, texColor.a * alpha);
+      }
+  )";
+
+  GLProgram program_;
+  GLint viewport_location_ = -1;
+  GLint tick_location_ = -1;
+  int viewport_width_ = 0;
+  int viewport_height_ = 0;
+  int drawn_tick_ = -1;
+  GLuint vertex_array_ = 0;
+  GLuint launch_buffer_ = 0;
+  size_t buffer_records_ = 0;
+  size_t uploaded_ = 0;
+  std::vector<ExplosionLaunch> launches_;
+  int tick_ = 0;
+  int last_tick_ = 0;
+  uint32_t seed_ = 0;
+  Stats stats_;
+};
+
+} // namespace render
+
+#endif // GL_EXPLOSIONS_H
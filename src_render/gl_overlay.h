@@ -0,0 +1,244 @@
+#ifndef GL_OVERLAY_H
+#define GL_OVERLAY_H
+
+// The OpenGL renderers' outlines and highlights, queued and drawn from one
+// ring buffer. Header-only; include it after the OpenGL 3.3 declarations.
+
+#include "gl_state.h"
+#include <cstring>
+#include <vector>
+
+#ifndef GL_VERSION_3_3
+#error "gl_overlay.h needs the OpenGL 3.3 declarations included first"
+#endif
+
+namespace render {
+
+class GLOverlay {
+public:
+  // The ring's size; a frame with more vertices than fit grows it
+  static constexpr size_t RING_BYTES = 64 * 1024;
+
+  // Counted since resetStats()
+  struct Stats {
+    long long draws = 0;    // draw calls
+    long long vertices = 0; // vertices written to the ring
+    long long orphans = 0;  // times the ring came round and was orphaned
+  };
+
+  GLOverlay() = default;
+  GLOverlay(const GLOverlay &) = delete;
+  GLOverlay &operator=(const GLOverlay &) = delete;
+
+  // Compiles the program and makes the ring and its vertex array; false,
+  // with the log on stderr, if the driver would not have them
+  bool create() {
+    if (program_.id() != 0)
+      return true;
+    if (!program_.link("Overlay", VERTEX_SOURCE, FRAGMENT_SOURCE))
+      return false;
+    viewport_location_ = program_.location("viewport");
+    viewport_width_ = viewport_height_ = 0;
+
+    glGenVertexArrays(1, &vertex_array_);
+    glGenBuffers(1, &ring_);
+    glBindVertexArray(vertex_array_);
+    glBindBuffer(GL_ARRAY_BUFFER, ring_);
+    ring_bytes_ = RING_BYTES - RING_BYTES % sizeof(Vertex);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(ring_bytes_), nullptr,
+                 GL_STREAM_DRAW);
+    ring_offset_ = 0;
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const void *>(2 * sizeof(float)));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return glGetError() == GL_NO_ERROR;
+  }
+
+  // Deletes everything create() made
+  void destroy() {
+    if (ring_ != 0)
+      glDeleteBuffers(1, &ring_);
+    if (vertex_array_ != 0)
+      glDeleteVertexArrays(1, &vertex_array_);
+    program_.destroy();
+    ring_ = vertex_array_ = 0;
+    ring_bytes_ = ring_offset_ = 0;
+    vertices_.clear();
+    runs_.clear();
+  }
+
+  bool ready() const { return program_.id() != 0; }
+
+  // The rectangle's outline, width pixels wide
+  void outline(float x, float y, float width, float height, float r, float g,
+               float b, float a, float line_width = 1.0f) {
+    begin(GL_LINE_LOOP, line_width);
+    vertex(x, y, r, g, b, a);
+    vertex(x + width, y, r, g, b, a);
+    vertex(x + width, y + height, r, g, b, a);
+    vertex(x, y + height, r, g, b, a);
+  }
+
+  // A line from (x0, y0) to (x1, y1)
+  void line(float x0, float y0, float x1, float y1, float r, float g,
+            float b, float a, float line_width = 1.0f) {
+    begin(GL_LINES, line_width);
+    vertex(x0, y0, r, g, b, a);
+    vertex(x1, y1, r, g, b, a);
+  }
+
+  // The rectangle, filled
+  void fill(float x, float y, float width, float height, float r, float g,
+            float b, float a) {
+    begin(GL_TRIANGLES, 1.0f);
+    vertex(x, y, r, g, b, a);
+    vertex(x + width, y, r, g, b, a);
+    vertex(x, y + height, r, g, b, a);
+    vertex(x + width, y, r, g, b, a);
+    vertex(x + width, y + height, r, g, b, a);
+    vertex(x, y + height, r, g, b, a);
+  }
+
+  // Draws what was queued since the last draw(), in the order queued,
+  // onto a viewport of width x height pixels, y down, and empties the
+  // queue. Binds through state, leaving blending on: state.endFrame()
+  // turns it off.
+  void draw(GLState &state, int width, int height) {
+    if (vertices_.empty())
+      return;
+    if (!ready()) {
+      vertices_.clear();
+      runs_.clear();
+      return;
+    }
+    state.useProgram(program_.id());
+    if (width != viewport_width_ || height != viewport_height_) {
+      glUniform2f(viewport_location_, float(width), float(height));
+      viewport_width_ = width;
+      viewport_height_ = height;
+    }
+    state.bindVertexArray(vertex_array_);
+    state.blend(true);
+
+    // A frame that does not fit after the last one's vertices orphans the
+    // ring, grown first if the frame would not fit in all of it, and is
+    // written from the start
+    glBindBuffer(GL_ARRAY_BUFFER, ring_);
+    size_t bytes = vertices_.size() * sizeof(Vertex);
+    if (ring_offset_ + bytes > ring_bytes_) {
+      while (ring_bytes_ < bytes)
+        ring_bytes_ *= 2;
+      glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(ring_bytes_), nullptr,
+                   GL_STREAM_DRAW);
+      ring_offset_ = 0;
+      stats_.orphans++;
+    }
+    void *mapped = glMapBufferRange(
+        GL_ARRAY_BUFFER, GLintptr(ring_offset_), GLsizeiptr(bytes),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+            GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped) {
+      memcpy(mapped, vertices_.data(), bytes);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else {
+      glBufferSubData(GL_ARRAY_BUFFER, GLintptr(ring_offset_),
+                      GLsizeiptr(bytes), vertices_.data());
+    }
+    GLint base = GLint(ring_offset_ / sizeof(Vertex));
+    ring_offset_ += bytes;
+
+    float line_width = 1.0f;
+    for (const Run &run : runs_) {
+      if (run.line_width != line_width) {
+        glLineWidth(run.line_width);
+        line_width = run.line_width;
+      }
+      glDrawArrays(run.mode, base + run.first, run.count);
+      stats_.draws++;
+    }
+    if (line_width != 1.0f)
+      glLineWidth(1.0f);
+
+    stats_.vertices += (long long)vertices_.size();
+    vertices_.clear();
+    runs_.clear();
+  }
+
+  const Stats &stats() const { return stats_; }
+  void resetStats() { stats_ = Stats(); }
+
+private:
+  struct Vertex {
+    float x, y, r, g, b, a;
+  };
+
+  // Vertices queued with one mode and width, drawn with one call
+  struct Run {
+    GLenum mode;
+    GLint first;
+    GLsizei count;
+    float line_width;
+  };
+
+  // Starts a run, or carries on the last one where the mode lets draws
+  // be joined
+  void begin(GLenum mode, float line_width) {
+    if (!runs_.empty() && mode != GL_LINE_LOOP &&
+        runs_.back().mode == mode && runs_.back().line_width == line_width)
+      return;
+    runs_.push_back({mode, GLint(vertices_.size()), 0, line_width});
+  }
+
+  void vertex(float x, float y, float r, float g, float b, float a) {
+    vertices_.push_back({x, y, r, g, b, a});
+    runs_.back().count++;
+  }
+
+  static constexpr const char *VERTEX_SOURCE = R"(
+      #version 330 core
+      layout(location = 0) in vec2 position;
+      layout(location = 1) in vec4 color;
+
+      uniform vec2 viewport;
+
+      out vec4 vertexColor;
+
+      void main()
+      {
+          gl_Position = vec4(position / viewport * vec2(2.0, -2.0) +
+                             vec2(-1.0, 1.0), 0.0, 1.0);
+          vertexColor = color;
+      }
+  )";
+  static constexpr const char *FRAGMENT_SOURCE = R"(
+      #version 330 core
+      in vec4 vertexColor;
+
+      out vec4 FragColor;
+
+      void main()
+      {
+          FragColor = vertexColor;
+      }
+  )";
+
+  GLProgram program_;
+  GLint viewport_location_ = -1;
+  int viewport_width_ = 0;
+  int viewport_height_ = 0;
+  GLuint vertex_array_ = 0;
+  GLuint ring_ = 0;
+  size_t ring_bytes_ = 0;
+  size_t ring_offset_ = 0;
+  std::vector<Vertex> vertices_;
+  std::vector<Run> runs_;
+  Stats stats_;
+};
+
+} // namespace render
+
+#endif // GL_OVERLAY_H
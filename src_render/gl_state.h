@@ -0,0 +1,246 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+// The OpenGL renderers' programs, with their uniform locations looked up
+// once, and the state a frame has bound. Header-only, like gl_card_batch.h.
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef GL_VERSION_3_3
+#error "gl_state.h needs the OpenGL 3.3 declarations included first"
+#endif
+
+namespace render {
+
+class GLProgram {
+public:
+  GLProgram() = default;
+  GLProgram(const GLProgram &) = delete;
+  GLProgram &operator=(const GLProgram &) = delete;
+
+  // Compiles and links the two shaders; false, with the log on stderr
+  // under name, if the driver would not have them
+  bool link(const char *name, const char *vertex_source,
+            const char *fragment_source) {
+    destroy();
+    GLuint vertex = compile(name, GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment = compile(name, GL_FRAGMENT_SHADER, fragment_source);
+    if (vertex == 0 || fragment == 0) {
+      glDeleteShader(vertex);
+      glDeleteShader(fragment);
+      return false;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+      char log[1024] = "";
+      glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+      fprintf(stderr, "[GL] %s program failed to link: %s\n", name, log);
+      glDeleteProgram(program);
+      return false;
+    }
+    id_ = program;
+    return true;
+  }
+
+  void destroy() {
+    if (id_ != 0)
+      glDeleteProgram(id_);
+    id_ = 0;
+  }
+
+  GLuint id() const { return id_; }
+
+  // The uniform's location, -1 if the program has none by that name. A
+  // query of the driver: ask once, after link(), and keep the answer.
+  GLint location(const char *uniform) const {
+    return id_ != 0 ? glGetUniformLocation(id_, uniform) : -1;
+  }
+
+private:
+  static GLuint compile(const char *name, GLenum type, const char *source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+      char log[1024] = "";
+      glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+      fprintf(stderr, "[GL] %s %s shader failed to compile: %s\n", name,
+              type == GL_VERTEX_SHADER ? "vertex" : "fragment", log);
+      glDeleteShader(shader);
+      return 0;
+    }
+    return shader;
+  }
+
+  GLuint id_ = 0;
+};
+
+class GLState {
+public:
+  static constexpr int REPORT_FRAMES = 120;
+
+  // Calls into the driver GLState made, and those it found it need not
+  struct Counts {
+    long long programs = 0;      // glUseProgram
+    long long textures = 0;      // glActiveTexture and glBindTexture
+    long long vertex_arrays = 0; // glBindVertexArray
+    long long blending = 0;      // glEnable, glDisable and glBlendFunc
+    long long skipped = 0;       // any of those, already so
+
+    long long changes() const {
+      return programs + textures + vertex_arrays + blending;
+    }
+    Counts &operator+=(const Counts &other) {
+      programs += other.programs;
+      textures += other.textures;
+      vertex_arrays += other.vertex_arrays;
+      blending += other.blending;
+      skipped += other.skipped;
+      return *this;
+    }
+  };
+
+  // name heads the reports, as FrameStats' does
+  explicit GLState(const char *name)
+      : name_(name), report_(getenv("SOLITAIRE_FRAME_STATS") != nullptr) {}
+  GLState(const GLState &) = delete;
+  GLState &operator=(const GLState &) = delete;
+
+  // Forgets what is bound, as whatever ran since may have bound anything
+  void invalidate() {
+    program_ = UNKNOWN;
+    texture_2d_ = UNKNOWN;
+    texture_2d_array_ = UNKNOWN;
+    vertex_array_ = UNKNOWN;
+    unit_known_ = false;
+    blending_ = -1;
+  }
+
+  // Starts a frame's counts, knowing nothing of what is bound
+  void beginFrame() {
+    invalidate();
+    frame_ = Counts();
+  }
+
+  // Leaves blending off and no vertex array bound, as the renderers did
+  // before GTK composites the frame, then counts the frame in
+  void endFrame() {
+    blend(false);
+    bindVertexArray(0);
+    last_frame_ = frame_;
+    total_ += frame_;
+    if (!report_)
+      return;
+    window_ += frame_;
+    if (++frames_ < REPORT_FRAMES)
+      return;
+    printf("[%s] %d frames: %.1f state changes a frame (%.1f programs, "
+           "%.1f textures, %.1f vertex arrays, %.1f blending), %.1f "
+           "skipped\n",
+           name_, frames_, double(window_.changes()) / frames_,
+           double(window_.programs) / frames_,
+           double(window_.textures) / frames_,
+           double(window_.vertex_arrays) / frames_,
+           double(window_.blending) / frames_,
+           double(window_.skipped) / frames_);
+    fflush(stdout);
+    frames_ = 0;
+    window_ = Counts();
+  }
+
+  void useProgram(GLuint program) {
+    if (program == program_) {
+      frame_.skipped++;
+      return;
+    }
+    glUseProgram(program);
+    program_ = program;
+    frame_.programs++;
+  }
+
+  // Binds texture on unit 0, the only one the renderers sample. Targets
+  // other than 2D and 2D arrays are bound every time.
+  void bindTexture(GLenum target, GLuint texture) {
+    if (!unit_known_) {
+      glActiveTexture(GL_TEXTURE0);
+      unit_known_ = true;
+      frame_.textures++;
+    }
+    GLuint *bound = target == GL_TEXTURE_2D         ? &texture_2d_
+                    : target == GL_TEXTURE_2D_ARRAY ? &texture_2d_array_
+                                                    : nullptr;
+    if (bound && *bound == texture) {
+      frame_.skipped++;
+      return;
+    }
+    glBindTexture(target, texture);
+    if (bound)
+      *bound = texture;
+    frame_.textures++;
+  }
+
+  void bindVertexArray(GLuint vertex_array) {
+    if (vertex_array == vertex_array_) {
+      frame_.skipped++;
+      return;
+    }
+    glBindVertexArray(vertex_array);
+    vertex_array_ = vertex_array;
+    frame_.vertex_arrays++;
+  }
+
+  // Straight-alpha blending, the only kind the renderers use, on or off
+  void blend(bool on) {
+    if (blending_ == int(on)) {
+      frame_.skipped++;
+      return;
+    }
+    if (on) {
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      frame_.blending += 2;
+    } else {
+      glDisable(GL_BLEND);
+      frame_.blending++;
+    }
+    blending_ = int(on);
+  }
+
+  // The frame so far, the last one endFrame() closed, and every frame's
+  const Counts &frame() const { return frame_; }
+  const Counts &lastFrame() const { return last_frame_; }
+  const Counts &total() const { return total_; }
+  void resetTotal() { total_ = Counts(); }
+
+private:
+  // Never a name GL hands out, so never taken for one that is bound
+  static constexpr GLuint UNKNOWN = ~GLuint(0);
+
+  const char *name_;
+  bool report_;
+  GLuint program_ = UNKNOWN;
+  GLuint texture_2d_ = UNKNOWN;
+  GLuint texture_2d_array_ = UNKNOWN;
+  GLuint vertex_array_ = UNKNOWN;
+  bool unit_known_ = false;
+  int blending_ = -1; // 0 off, 1 on, -1 not known
+  Counts frame_;
+  Counts last_frame_;
+  Counts total_;
+  Counts window_;
+  int frames_ = 0;
+};
+
+} // namespace render
+
+#endif // GL_STATE_H
@@ -0,0 +1,258 @@
+#ifndef GTK_CARD_SCALER_H
+#define GTK_CARD_SCALER_H
+
+// Rescaling the Cairo renderers' card surfaces on worker threads, and
+// decoding the deck into the CardAtlas they are scaled from.
+
+#include "card_atlas.h"
+#include "card_cache.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <gtk/gtk.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+class CardScaler {
+public:
+  using Cache = CardCache<cairo_surface_t *>;
+
+  // More workers than this only fight the GTK thread for the cores
+  static constexpr unsigned MAX_WORKERS = 4;
+
+  CardScaler() {}
+
+  ~CardScaler() {
+    cancel();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &worker : workers_)
+      worker.join();
+  }
+
+  CardScaler(const CardScaler &) = delete;
+  CardScaler &operator=(const CardScaler &) = delete;
+
+  // Whether the cache still has to be scaled to width x height pixels:
+  // false if it was built at that size or a batch for it is in flight
+  bool needs(int width, int height, double device_scale = 1) const {
+    return width != width_ || height != height_ ||
+           device_scale != device_scale_;
+  }
+
+  // Tells the scaler the game has just built its cache itself, at
+  // width x height pixels, e.g. for a new deck. A batch still in flight
+  // holds the old images and is dropped.
+  void built(int width, int height, double device_scale = 1) {
+    cancel();
+    width_ = width;
+    height_ = height;
+    device_scale_ = device_scale;
+  }
+
+  // Starts scaling every image in atlas to width x height pixels on the
+  // workers. When they are all done, they replace the surfaces under the
+  // same ids in cache, destroying the old ones, and swapped() is called,
+  // both on the GTK thread. Surfaces under other ids are left as they are.
+  void start(std::shared_ptr<const CardAtlas> atlas, int width, int height,
+             double device_scale, Cache &cache,
+             std::function<void()> swapped) {
+    width_ = width;
+    height_ = height;
+    device_scale_ = device_scale;
+    cache_ = &cache;
+    swapped_ = std::move(swapped);
+
+    auto batch = std::make_shared<Batch>();
+    for (const auto &[id, region] : atlas->regions())
+      batch->images.push_back({id, region});
+    batch->atlas = std::move(atlas);
+    batch->surfaces.assign(batch->images.size(), nullptr);
+    batch->width = width;
+    batch->height = height;
+    batch->device_scale = device_scale;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (workers_.empty()) {
+        unsigned count = std::min(
+            MAX_WORKERS, std::max(1u, std::thread::hardware_concurrency()));
+        for (unsigned i = 0; i < count; i++)
+          workers_.emplace_back(&CardScaler::run, this);
+      }
+      finished_.reset();
+      if (batch->images.empty())
+        finished_ = batch;
+      else
+        batch_ = batch;
+    }
+    wake_.notify_all();
+    if (!timer_)
+      timer_ = g_timeout_add(POLL_MS, &CardScaler::onPoll, this);
+  }
+
+  // Drops the batch in flight, if any, e.g. when the game empties its
+  // cache
+  void cancel() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch_.reset();
+      finished_.reset();
+    }
+    if (timer_)
+      g_source_remove(timer_);
+    timer_ = 0;
+    width_ = height_ = 0;
+  }
+
+  // A Cairo surface of width x height pixels holding region of atlas.
+  // Safe off the GTK thread: the surface is the caller's alone.
+  static cairo_surface_t *scale(const CardAtlas &atlas, const Rect &region,
+                                int width, int height,
+                                double device_scale = 1) {
+    cairo_surface_t *surface =
+        cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_surface_flush(surface);
+    atlas.scale(region, width, height, cairo_image_surface_get_data(surface),
+                cairo_image_surface_get_stride(surface));
+    cairo_surface_mark_dirty(surface);
+    cairo_surface_set_device_scale(surface, device_scale, device_scale);
+    return surface;
+  }
+
+private:
+  static constexpr guint POLL_MS = 16;
+
+  struct Batch {
+    struct Image {
+      int id;
+      Rect region;
+    };
+
+    std::shared_ptr<const CardAtlas> atlas;
+    std::vector<Image> images;
+    std::vector<cairo_surface_t *> surfaces; // null until scaled
+    int width = 0;
+    int height = 0;
+    double device_scale = 1;
+    size_t next = 0; // the next image to hand a worker
+    size_t done = 0;
+
+    ~Batch() {
+      for (cairo_surface_t *surface : surfaces) {
+        if (surface)
+          cairo_surface_destroy(surface);
+      }
+    }
+  };
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      wake_.wait(lock, [this] {
+        return stop_ || (batch_ && batch_->next < batch_->images.size());
+      });
+      if (stop_)
+        return;
+      std::shared_ptr<Batch> batch = batch_;
+      size_t i = batch->next++;
+      lock.unlock();
+
+      cairo_surface_t *surface =
+          scale(*batch->atlas, batch->images[i].region, batch->width,
+                batch->height, batch->device_scale);
+
+      lock.lock();
+      batch->surfaces[i] = surface;
+      // A batch that was overtaken is dropped with its last reference
+      if (++batch->done == batch->images.size() && batch == batch_) {
+        finished_ = std::move(batch_);
+        batch_.reset();
+      }
+    }
+  }
+
+  static gboolean onPoll(gpointer data) {
+    CardScaler *scaler = static_cast<CardScaler *>(data);
+    std::shared_ptr<Batch> batch;
+    {
+      std::lock_guard<std::mutex> lock(scaler->mutex_);
+      batch = std::move(scaler->finished_);
+      scaler->finished_.reset();
+    }
+    if (!batch)
+      return TRUE;
+
+    Cache &cache = *scaler->cache_;
+    for (size_t i = 0; i < batch->images.size(); i++) {
+      if (!batch->surfaces[i])
+        continue; // keep whatever the game had
+      cairo_surface_t *&slot = cache[batch->images[i].id];
+      if (slot)
+        cairo_surface_destroy(slot);
+      slot = batch->surfaces[i];
+      batch->surfaces[i] = nullptr;
+    }
+    scaler->timer_ = 0;
+    if (scaler->swapped_)
+      scaler->swapped_();
+    return FALSE;
+  }
+
+  // The size the cache was last built or asked to be scaled at
+  int width_ = 0;
+  int height_ = 0;
+  double device_scale_ = 1;
+  Cache *cache_ = nullptr;
+  std::function<void()> swapped_;
+  guint timer_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<std::thread> workers_;
+  std::shared_ptr<Batch> batch_;    // being scaled
+  std::shared_ptr<Batch> finished_; // scaled, waiting for the GTK thread
+  bool stop_ = false;
+};
+
+// An encoded card image and the id it goes under in the atlas
+struct EncodedImage {
+  int id;
+  const std::vector<unsigned char> *data;
+};
+
+// Decodes images into a new atlas tagged with source. Images that do not
+// decode are left out.
+inline std::shared_ptr<const CardAtlas>
+decodeCardAtlas(const std::vector<EncodedImage> &images, uint64_t source) {
+  auto atlas = std::make_shared<CardAtlas>(source);
+  for (const EncodedImage &image : images) {
+    GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
+    gdk_pixbuf_loader_write(loader, image.data->data(), image.data->size(),
+                            nullptr);
+    gdk_pixbuf_loader_close(loader, nullptr);
+    GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+    if (pixbuf) {
+      atlas->add(image.id, gdk_pixbuf_get_width(pixbuf),
+                 gdk_pixbuf_get_height(pixbuf),
+                 gdk_pixbuf_get_n_channels(pixbuf),
+                 gdk_pixbuf_get_rowstride(pixbuf),
+                 gdk_pixbuf_get_pixels(pixbuf));
+    }
+    g_object_unref(loader);
+  }
+  atlas->pack();
+  return atlas;
+}
+
+} // namespace render
+
+#endif // GTK_CARD_SCALER_H
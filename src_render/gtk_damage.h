@@ -0,0 +1,101 @@
+#ifndef GTK_DAMAGE_H
+#define GTK_DAMAGE_H
+
+// The GTK side of damage tracking (see damage.h), inline so the headless
+// tools can use damage.h without GTK.
+
+#include "damage.h"
+#include <gtk/gtk.h>
+
+namespace render {
+
+// The rectangles a draw handler has to repaint: the clip GTK set on cr,
+// which is the queued damage
+inline std::vector<Rect> clipRects(cairo_t *cr) {
+  std::vector<Rect> rects;
+  cairo_rectangle_list_t *list = cairo_copy_clip_rectangle_list(cr);
+  if (list->status == CAIRO_STATUS_SUCCESS) {
+    for (int i = 0; i < list->num_rectangles; i++) {
+      const cairo_rectangle_t &rect = list->rectangles[i];
+      rects.push_back(pixelBounds(rect.x, rect.y, rect.width, rect.height));
+    }
+  } else {
+    // Not representable as rectangles: repaint its extents
+    double x1, y1, x2, y2;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    rects.push_back(pixelBounds(x1, y1, x2 - x1, y2 - y1));
+  }
+  cairo_rectangle_list_destroy(list);
+  return rects;
+}
+
+// Limits cr's drawing to rects
+inline void clipTo(cairo_t *cr, const std::vector<Rect> &rects) {
+  for (const Rect &rect : rects)
+    cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+  cairo_clip(cr);
+}
+
+inline void queueDamage(GtkWidget *widget, const std::vector<Rect> &rects) {
+  for (const Rect &rect : rects)
+    gtk_widget_queue_draw_area(widget, rect.x, rect.y, rect.width,
+                               rect.height);
+}
+
+inline long long totalArea(const std::vector<Rect> &rects) {
+  long long area = 0;
+  for (const Rect &rect : rects)
+    area += rect.area();
+  return area;
+}
+
+// The surface holding a game's static layer (see DamageTracker), the size
+// of the window. Dropped when the card size changes and made again by the
+// next frame that needs it.
+class StaticLayer {
+public:
+  StaticLayer() {}
+  ~StaticLayer() { release(); }
+  StaticLayer(const StaticLayer &) = delete;
+  StaticLayer &operator=(const StaticLayer &) = delete;
+
+  // Makes the surface width x height. True if it was (re)created, and so
+  // holds nothing yet.
+  bool resize(int width, int height) {
+    if (surface_ && cairo_image_surface_get_width(surface_) == width &&
+        cairo_image_surface_get_height(surface_) == height)
+      return false;
+    release();
+    surface_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cr_ = cairo_create(surface_);
+    return true;
+  }
+
+  void release() {
+    if (cr_)
+      cairo_destroy(cr_);
+    if (surface_)
+      cairo_surface_destroy(surface_);
+    cr_ = nullptr;
+    surface_ = nullptr;
+  }
+
+  cairo_t *cr() const { return cr_; }
+
+  // Copies the layer into cr, within cr's clip
+  void blit(cairo_t *cr) const {
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_set_source_surface(cr, surface_, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+  }
+
+private:
+  cairo_surface_t *surface_ = nullptr;
+  cairo_t *cr_ = nullptr;
+};
+
+} // namespace render
+
+#endif // GTK_DAMAGE_H
@@ -0,0 +1,358 @@
+#include "particles.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PARTICLES_X86 1
+#include <immintrin.h>
+// Built for the baseline CPU; these compile single functions for more
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace render {
+
+namespace {
+
+// The pool's arrays, as the kernels see them
+struct Lanes {
+  float *x, *y, *velocity_x, *velocity_y, *rotation, *spin;
+  const float *width, *height;
+  uint32_t *random;
+  uint8_t *gone;
+};
+
+struct World {
+  float gravity;
+  float width, height;
+  float lower; // where the lower half, in which particles bounce, starts
+};
+
+struct Counts {
+  int bounced = 0;
+  int gone = 0;
+};
+
+inline uint32_t xorshift(uint32_t state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+// Spreads a counter's bits over the whole word, for the first states
+inline uint32_t mix(uint32_t value) {
+  value ^= value >> 16;
+  value *= 0x7feb352du;
+  value ^= value >> 15;
+  value *= 0x846ca68bu;
+  value ^= value >> 16;
+  return value;
+}
+
+// Moves particles [first, last) one tick; the SIMD kernels finish their
+// last few particles with this
+Counts stepScalar(const Lanes &p, const World &w, size_t first,
+                  size_t last) {
+  Counts counts;
+  for (size_t i = first; i < last; i++) {
+    float velocity_x = p.velocity_x[i];
+    float velocity_y = p.velocity_y[i];
+    float spin = p.spin[i];
+    float x = p.x[i] + velocity_x;
+    float y = p.y[i] + velocity_y;
+    velocity_y = velocity_y + w.gravity;
+    p.rotation[i] = p.rotation[i] + spin;
+
+    // One draw a tick: the top 24 bits decide the bounce, the low 16 the
+    // veer, 0 to 10 less 5
+    uint32_t random = xorshift(p.random[i]);
+    p.random[i] = random;
+    if (y > w.lower && y < w.height - p.height[i] && velocity_y > 0.0f &&
+        (random >> 8) < ParticlePool::BOUNCE_CHANCE) {
+      velocity_y = velocity_y * -0.8f;
+      velocity_x = velocity_x +
+                   float(int(((random & 0xffffu) * 11u) >> 16) - 5);
+      spin = spin * 1.5f;
+      counts.bounced++;
+    }
+
+    p.x[i] = x;
+    p.y[i] = y;
+    p.velocity_x[i] = velocity_x;
+    p.velocity_y[i] = velocity_y;
+    p.spin[i] = spin;
+    if (x < -p.width[i] || x > w.width || y > w.height + p.height[i]) {
+      p.gone[i] = 1;
+      counts.gone++;
+    }
+  }
+  return counts;
+}
+
+#ifdef PARTICLES_X86
+
+TARGET_SSE2 inline __m128 selectSSE2(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Four particles at a time
+TARGET_SSE2 Counts stepSSE2(const Lanes &p, const World &w, size_t count) {
+  const __m128 gravity = _mm_set1_ps(w.gravity);
+  const __m128 window_width = _mm_set1_ps(w.width);
+  const __m128 window_height = _mm_set1_ps(w.height);
+  const __m128 lower = _mm_set1_ps(w.lower);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  const __m128 rebound = _mm_set1_ps(-0.8f);
+  const __m128 faster = _mm_set1_ps(1.5f);
+  const __m128i chance = _mm_set1_epi32(int(ParticlePool::BOUNCE_CHANCE));
+  const __m128i low_bits = _mm_set1_epi32(0xffff);
+  const __m128i five = _mm_set1_epi32(5);
+
+  Counts counts;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 velocity_x = _mm_loadu_ps(p.velocity_x + i);
+    __m128 velocity_y = _mm_loadu_ps(p.velocity_y + i);
+    __m128 spin = _mm_loadu_ps(p.spin + i);
+    __m128 width = _mm_loadu_ps(p.width + i);
+    __m128 height = _mm_loadu_ps(p.height + i);
+    __m128 x = _mm_add_ps(_mm_loadu_ps(p.x + i), velocity_x);
+    __m128 y = _mm_add_ps(_mm_loadu_ps(p.y + i), velocity_y);
+    velocity_y = _mm_add_ps(velocity_y, gravity);
+    _mm_storeu_ps(p.rotation + i,
+                  _mm_add_ps(_mm_loadu_ps(p.rotation + i), spin));
+
+    __m128i *state = reinterpret_cast<__m128i *>(p.random + i);
+    __m128i random = _mm_loadu_si128(state);
+    random = _mm_xor_si128(random, _mm_slli_epi32(random, 13));
+    random = _mm_xor_si128(random, _mm_srli_epi32(random, 17));
+    random = _mm_xor_si128(random, _mm_slli_epi32(random, 5));
+    _mm_storeu_si128(state, random);
+
+    __m128 bounce = _mm_and_ps(
+        _mm_cmpgt_ps(y, lower),
+        _mm_cmplt_ps(y, _mm_sub_ps(window_height, height)));
+    bounce = _mm_and_ps(bounce, _mm_cmpgt_ps(velocity_y, zero));
+    bounce = _mm_and_ps(bounce, _mm_castsi128_ps(_mm_cmplt_epi32(
+                                    _mm_srli_epi32(random, 8), chance)));
+    // The low 16 bits times 11, without SSE4.1's 32-bit multiply
+    __m128i veer = _mm_and_si128(random, low_bits);
+    veer = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(veer, 3),
+                                       _mm_slli_epi32(veer, 1)),
+                         veer);
+    veer = _mm_sub_epi32(_mm_srli_epi32(veer, 16), five);
+    velocity_y =
+        selectSSE2(bounce, _mm_mul_ps(velocity_y, rebound), velocity_y);
+    velocity_x = selectSSE2(
+        bounce, _mm_add_ps(velocity_x, _mm_cvtepi32_ps(veer)), velocity_x);
+    spin = selectSSE2(bounce, _mm_mul_ps(spin, faster), spin);
+
+    _mm_storeu_ps(p.x + i, x);
+    _mm_storeu_ps(p.y + i, y);
+    _mm_storeu_ps(p.velocity_x + i, velocity_x);
+    _mm_storeu_ps(p.velocity_y + i, velocity_y);
+    _mm_storeu_ps(p.spin + i, spin);
+
+    __m128 gone = _mm_or_ps(_mm_cmplt_ps(x, _mm_xor_ps(width, sign)),
+                            _mm_cmpgt_ps(x, window_width));
+    gone = _mm_or_ps(gone,
+                     _mm_cmpgt_ps(y, _mm_add_ps(window_height, height)));
+    int gone_mask = _mm_movemask_ps(gone);
+    if (gone_mask) {
+      for (int lane = 0; lane < 4; lane++)
+        p.gone[i + lane] = (gone_mask >> lane) & 1;
+      counts.gone += __builtin_popcount(gone_mask);
+    }
+    counts.bounced += __builtin_popcount(_mm_movemask_ps(bounce));
+  }
+  Counts rest = stepScalar(p, w, i, count);
+  counts.bounced += rest.bounced;
+  counts.gone += rest.gone;
+  return counts;
+}
+
+// Eight particles at a time
+TARGET_AVX2 Counts stepAVX2(const Lanes &p, const World &w, size_t count) {
+  const __m256 gravity = _mm256_set1_ps(w.gravity);
+  const __m256 window_width = _mm256_set1_ps(w.width);
+  const __m256 window_height = _mm256_set1_ps(w.height);
+  const __m256 lower = _mm256_set1_ps(w.lower);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 rebound = _mm256_set1_ps(-0.8f);
+  const __m256 faster = _mm256_set1_ps(1.5f);
+  const __m256i chance =
+      _mm256_set1_epi32(int(ParticlePool::BOUNCE_CHANCE));
+  const __m256i low_bits = _mm256_set1_epi32(0xffff);
+  const __m256i eleven = _mm256_set1_epi32(11);
+  const __m256i five = _mm256_set1_epi32(5);
+
+  Counts counts;
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 velocity_x = _mm256_loadu_ps(p.velocity_x + i);
+    __m256 velocity_y = _mm256_loadu_ps(p.velocity_y + i);
+    __m256 spin = _mm256_loadu_ps(p.spin + i);
+    __m256 width = _mm256_loadu_ps(p.width + i);
+    __m256 height = _mm256_loadu_ps(p.height + i);
+    __m256 x = _mm256_add_ps(_mm256_loadu_ps(p.x + i), velocity_x);
+    __m256 y = _mm256_add_ps(_mm256_loadu_ps(p.y + i), velocity_y);
+    velocity_y = _mm256_add_ps(velocity_y, gravity);
+    _mm256_storeu_ps(p.rotation + i,
+                     _mm256_add_ps(_mm256_loadu_ps(p.rotation + i), spin));
+
+    __m256i *state = reinterpret_cast<__m256i *>(p.random + i);
+    __m256i random = _mm256_loadu_si256(state);
+    random = _mm256_xor_si256(random, _mm256_slli_epi32(random, 13));
+    random = _mm256_xor_si256(random, _mm256_srli_epi32(random, 17));
+    random = _mm256_xor_si256(random, _mm256_slli_epi32(random, 5));
+    _mm256_storeu_si256(state, random);
+
+    __m256 bounce = _mm256_and_ps(
+        _mm256_cmp_ps(y, lower, _CMP_GT_OQ),
+        _mm256_cmp_ps(y, _mm256_sub_ps(window_height, height), _CMP_LT_OQ));
+    bounce = _mm256_and_ps(bounce, _mm256_cmp_ps(velocity_y, zero, _CMP_GT_OQ));
+    bounce = _mm256_and_ps(
+        bounce, _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+                    chance, _mm256_srli_epi32(random, 8))));
+    __m256i veer = _mm256_mullo_epi32(_mm256_and_si256(random, low_bits),
+                                      eleven);
+    veer = _mm256_sub_epi32(_mm256_srli_epi32(veer, 16), five);
+    velocity_y = _mm256_blendv_ps(
+        velocity_y, _mm256_mul_ps(velocity_y, rebound), bounce);
+    velocity_x = _mm256_blendv_ps(
+        velocity_x, _mm256_add_ps(velocity_x, _mm256_cvtepi32_ps(veer)),
+        bounce);
+    spin = _mm256_blendv_ps(spin, _mm256_mul_ps(spin, faster), bounce);
+
+    _mm256_storeu_ps(p.x + i, x);
+    _mm256_storeu_ps(p.y + i, y);
+    _mm256_storeu_ps(p.velocity_x + i, velocity_x);
+    _mm256_storeu_ps(p.velocity_y + i, velocity_y);
+    _mm256_storeu_ps(p.spin + i, spin);
+
+    __m256 gone = _mm256_or_ps(
+        _mm256_cmp_ps(x, _mm256_xor_ps(width, sign), _CMP_LT_OQ),
+        _mm256_cmp_ps(x, window_width, _CMP_GT_OQ));
+    gone = _mm256_or_ps(gone, _mm256_cmp_ps(y, _mm256_add_ps(window_height,
+                                                             height),
+                                            _CMP_GT_OQ));
+    int gone_mask = _mm256_movemask_ps(gone);
+    if (gone_mask) {
+      for (int lane = 0; lane < 8; lane++)
+        p.gone[i + lane] = (gone_mask >> lane) & 1;
+      counts.gone += __builtin_popcount(gone_mask);
+    }
+    counts.bounced += __builtin_popcount(_mm256_movemask_ps(bounce));
+  }
+  Counts rest = stepScalar(p, w, i, count);
+  counts.bounced += rest.bounced;
+  counts.gone += rest.gone;
+  return counts;
+}
+
+#endif // PARTICLES_X86
+
+// Removes values at the ascending indices gaps, keeping the rest in order
+template <typename T>
+void closeGaps(std::vector<T> &values, const std::vector<size_t> &gaps) {
+  auto kept = values.begin() + gaps.front();
+  for (size_t k = 0; k < gaps.size(); k++) {
+    auto from = values.begin() + gaps[k] + 1;
+    auto to = k + 1 < gaps.size() ? values.begin() + gaps[k + 1] : values.end();
+    kept = std::copy(from, to, kept);
+  }
+  values.erase(kept, values.end());
+}
+
+} // namespace
+
+void ParticlePool::add(float x, float y, float width, float height,
+                       float velocity_x, float velocity_y, float rotation,
+                       float spin, uint32_t tag) {
+  x_.push_back(x);
+  y_.push_back(y);
+  width_.push_back(width);
+  height_.push_back(height);
+  velocity_x_.push_back(velocity_x);
+  velocity_y_.push_back(velocity_y);
+  rotation_.push_back(rotation);
+  spin_.push_back(spin);
+  tag_.push_back(tag);
+  // A xorshift state must not be zero
+  seed_ += 0x9e3779b9u;
+  uint32_t random = mix(seed_);
+  random_.push_back(random ? random : 1);
+}
+
+int ParticlePool::update(float gravity, float window_width,
+                         float window_height, SimdLevel level) {
+  died_.clear();
+  size_t count = x_.size();
+  if (count == 0)
+    return 0;
+  level = std::min(level, cpuSimdLevel());
+  gone_.assign(count, 0);
+
+  Lanes lanes = {x_.data(),          y_.data(),          velocity_x_.data(),
+                 velocity_y_.data(), rotation_.data(),   spin_.data(),
+                 width_.data(),      height_.data(),     random_.data(),
+                 gone_.data()};
+  World world = {gravity, window_width, window_height, window_height * 0.5f};
+  Counts counts;
+  switch (level) {
+#ifdef PARTICLES_X86
+  case SimdLevel::AVX2:
+    counts = stepAVX2(lanes, world, count);
+    break;
+  case SimdLevel::SSE2:
+    counts = stepSSE2(lanes, world, count);
+    break;
+#endif
+  default:
+    counts = stepScalar(lanes, world, 0, count);
+    break;
+  }
+  if (counts.gone)
+    compact();
+  return counts.bounced;
+}
+
+void ParticlePool::reserve(size_t count) {
+  for (auto *floats : {&x_, &y_, &width_, &height_, &velocity_x_,
+                       &velocity_y_, &rotation_, &spin_})
+    floats->reserve(count);
+  random_.reserve(count);
+  tag_.reserve(count);
+  gone_.reserve(count);
+}
+
+void ParticlePool::clear() {
+  for (auto *floats : {&x_, &y_, &width_, &height_, &velocity_x_,
+                       &velocity_y_, &rotation_, &spin_})
+    floats->clear();
+  random_.clear();
+  tag_.clear();
+  gone_.clear();
+  died_.clear();
+}
+
+// Drops the particles the kernels marked gone, moving the runs between
+// them down each array in turn
+void ParticlePool::compact() {
+  gaps_.clear();
+  for (size_t i = 0; i < gone_.size(); i++) {
+    if (gone_[i]) {
+      gaps_.push_back(i);
+      died_.push_back(tag_[i]);
+    }
+  }
+  for (auto *floats : {&x_, &y_, &width_, &height_, &velocity_x_,
+                       &velocity_y_, &rotation_, &spin_})
+    closeGaps(*floats, gaps_);
+  closeGaps(random_, gaps_);
+  closeGaps(tag_, gaps_);
+}
+
+} // namespace render
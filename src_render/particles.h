@@ -0,0 +1,73 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+// The Cairo win animations' card fragments, a structure-of-arrays pool
+// updated with SSE2 or AVX2 kernels that match the plain C++ bit for bit.
+
+#include "resample.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+class ParticlePool {
+public:
+  // The chance in 2^24 that a falling particle in the window's lower half
+  // bounces on a tick, about one in two hundred
+  static constexpr uint32_t BOUNCE_CHANCE = 83886;
+
+  explicit ParticlePool(uint32_t seed = 0x9e3779b9u) : seed_(seed) {}
+
+  // Adds a width x height particle at (x, y), turned rotation radians
+  // about its centre, moving by (velocity_x, velocity_y) and turning by
+  // spin each tick
+  void add(float x, float y, float width, float height, float velocity_x,
+           float velocity_y, float rotation, float spin, uint32_t tag);
+
+  // Moves every particle one tick, velocity_y growing by gravity, in a
+  // window_width x window_height window. A particle falling through the
+  // lower half of the window may bounce: it goes back up at 0.8 of its
+  // speed, veers by up to 5 pixels a tick either way and spins half as
+  // fast again. Drops those that have left the window past its sides or
+  // bottom and returns how many bounced. A level the CPU does not have is
+  // lowered to one it does.
+  int update(float gravity, float window_width, float window_height,
+             SimdLevel level = simdLevel());
+
+  // The tags of the particles the last update() dropped, in the order
+  // they were added
+  const std::vector<uint32_t> &died() const { return died_; }
+
+  size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+  void reserve(size_t count);
+  // Drops every particle, without adding their tags to died()
+  void clear();
+
+  float x(size_t i) const { return x_[i]; }
+  float y(size_t i) const { return y_[i]; }
+  float width(size_t i) const { return width_[i]; }
+  float height(size_t i) const { return height_[i]; }
+  float velocityX(size_t i) const { return velocity_x_[i]; }
+  float velocityY(size_t i) const { return velocity_y_[i]; }
+  float rotation(size_t i) const { return rotation_[i]; }
+  float spin(size_t i) const { return spin_[i]; }
+  uint32_t tag(size_t i) const { return tag_[i]; }
+
+private:
+  void compact();
+
+  std::vector<float> x_, y_, width_, height_;
+  std::vector<float> velocity_x_, velocity_y_, rotation_, spin_;
+  std::vector<uint32_t> random_; // each particle's xorshift state
+  std::vector<uint32_t> tag_;
+  std::vector<uint8_t> gone_;    // which particles the last update dropped
+  std::vector<size_t> gaps_;     // and where they were
+  std::vector<uint32_t> died_;
+  uint32_t seed_; // mixed into each added particle's xorshift state
+};
+
+} // namespace render
+
+#endif // PARTICLES_H
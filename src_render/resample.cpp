@@ -0,0 +1,452 @@
+#include "resample.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RESAMPLE_X86 1
+#include <immintrin.h>
+// Built for the baseline CPU; these compile single functions for more
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace render {
+
+namespace {
+
+constexpr int PRECISION = 14;
+constexpr int32_t ROUNDING = 1 << (PRECISION - 1);
+constexpr double PI = 3.14159265358979323846;
+
+// For each output pixel along one axis, the window of source pixels it is
+// made of and their weights, which sum to 1 << PRECISION. Every window is
+// taps long, zero weights filling out the short ones, and lies inside the
+// source, so the kernels read whole windows without bounds checks.
+struct Coefficients {
+  int taps = 0;
+  std::vector<int> first;
+  std::vector<int16_t> weights; // taps per output pixel
+};
+
+double sinc(double x) {
+  if (x == 0)
+    return 1;
+  x *= PI;
+  return std::sin(x) / x;
+}
+
+double lanczos3(double x) {
+  return x > -3 && x < 3 ? sinc(x) * sinc(x / 3) : 0;
+}
+
+Coefficients makeCoefficients(int in, int out, ScaleFilter filter) {
+  Coefficients coefficients;
+  double scale = double(in) / out;
+  // Shrinking widens the filter to cover every source pixel
+  double filter_scale = std::max(scale, 1.0);
+  double support = (filter == ScaleFilter::BOX ? 0.5 : 3.0) * filter_scale;
+  // Rounded up to whole steps of the widest kernel
+  int taps = (int(std::ceil(support)) * 2 + 2 + 3) & ~3;
+  coefficients.taps = taps = std::min(taps, in);
+  coefficients.first.resize(out);
+  coefficients.weights.assign(size_t(out) * taps, 0);
+
+  std::vector<double> weights(taps);
+  for (int i = 0; i < out; i++) {
+    double centre = (i + 0.5) * scale;
+    int lo, hi;
+    if (filter == ScaleFilter::BOX) {
+      // The share of [left, right) each source pixel covers
+      double left = centre - support;
+      double right = centre + support;
+      lo = std::max(0, int(std::floor(left)));
+      hi = std::min(in, int(std::ceil(right)));
+      hi = std::min(hi, lo + taps);
+      for (int s = lo; s < hi; s++)
+        weights[s - lo] =
+            std::max(0.0, std::min(right, s + 1.0) - std::max(left, double(s)));
+    } else {
+      lo = std::max(0, int(centre - support + 0.5));
+      hi = std::min(in, int(centre + support + 0.5));
+      hi = std::min(hi, lo + taps);
+      for (int s = lo; s < hi; s++)
+        weights[s - lo] = lanczos3((s + 0.5 - centre) / filter_scale);
+    }
+    double total = 0;
+    for (int s = lo; s < hi; s++)
+      total += weights[s - lo];
+
+    // Slid left where the window would run off the end
+    int first = std::min(lo, in - taps);
+    coefficients.first[i] = first;
+    int16_t *fixed = coefficients.weights.data() + size_t(i) * taps;
+    int sum = 0;
+    int largest = lo - first;
+    for (int s = lo; s < hi; s++) {
+      int weight = int(std::lround(weights[s - lo] / total * (1 << PRECISION)));
+      fixed[s - first] = int16_t(weight);
+      sum += weight;
+      if (weight > fixed[largest])
+        largest = s - first;
+    }
+    // Rounding the weights must not brighten or darken a flat area
+    fixed[largest] = int16_t(fixed[largest] + (1 << PRECISION) - sum);
+  }
+  return coefficients;
+}
+
+inline uint32_t clampChannel(int32_t sum) {
+  return uint32_t(std::min(std::max(sum >> PRECISION, 0), 255));
+}
+
+// Premultiplied: no channel may be brighter than the pixel's alpha
+inline uint32_t clampToAlpha(uint32_t pixel) {
+  uint32_t a = pixel >> 24;
+  return a << 24 | std::min((pixel >> 16) & 0xFF, a) << 16 |
+         std::min((pixel >> 8) & 0xFF, a) << 8 | std::min(pixel & 0xFF, a);
+}
+
+// One output pixel of the horizontal pass
+uint32_t acrossPixel(const uint32_t *in, const int16_t *weights, int taps) {
+  int32_t sum[4] = {ROUNDING, ROUNDING, ROUNDING, ROUNDING};
+  for (int k = 0; k < taps; k++) {
+    for (int c = 0; c < 4; c++)
+      sum[c] += weights[k] * int32_t((in[k] >> (8 * c)) & 0xFF);
+  }
+  return clampToAlpha(clampChannel(sum[0]) | clampChannel(sum[1]) << 8 |
+                      clampChannel(sum[2]) << 16 | clampChannel(sum[3]) << 24);
+}
+
+void acrossScalar(const uint32_t *in, uint32_t *out, int width,
+                  const Coefficients &across) {
+  for (int x = 0; x < width; x++)
+    out[x] = acrossPixel(in + across.first[x],
+                         across.weights.data() + size_t(x) * across.taps,
+                         across.taps);
+}
+
+// Row by row, so each row is read in order, in runs short enough to sum
+// on the stack
+void downScalar(const uint32_t *const *rows, const int16_t *weights, int taps,
+                uint32_t *out, int x, int width) {
+  constexpr int RUN = 64;
+  int32_t sums[RUN * 4];
+  for (; x < width; x += RUN) {
+    int count = std::min(RUN, width - x);
+    std::fill_n(sums, count * 4, ROUNDING);
+    for (int k = 0; k < taps; k++) {
+      const uint32_t *row = rows[k] + x;
+      int32_t weight = weights[k];
+      for (int i = 0; i < count; i++) {
+        int32_t *sum = sums + i * 4;
+        uint32_t pixel = row[i];
+        sum[0] += weight * int32_t(pixel & 0xFF);
+        sum[1] += weight * int32_t((pixel >> 8) & 0xFF);
+        sum[2] += weight * int32_t((pixel >> 16) & 0xFF);
+        sum[3] += weight * int32_t(pixel >> 24);
+      }
+    }
+    for (int i = 0; i < count; i++) {
+      const int32_t *sum = sums + i * 4;
+      out[x + i] = clampToAlpha(clampChannel(sum[0]) |
+                                clampChannel(sum[1]) << 8 |
+                                clampChannel(sum[2]) << 16 |
+                                clampChannel(sum[3]) << 24);
+    }
+  }
+}
+
+#ifdef RESAMPLE_X86
+
+// Two weights in the 32-bit lane madd pairs them in: the first low, for
+// the first of the two pixels or rows interleaved with it
+inline int32_t weightPair(const int16_t *weights) {
+  int32_t pair;
+  std::memcpy(&pair, weights, sizeof(pair));
+  return pair;
+}
+
+inline int32_t weightPair(int16_t weight) { return uint16_t(weight); }
+
+TARGET_SSE2 inline __m128i load128(const uint32_t *pixels) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels));
+}
+
+TARGET_SSE2 inline __m128i clampToAlphaSSE2(__m128i pixels) {
+  __m128i alpha = _mm_srli_epi32(pixels, 24);
+  alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+  alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+  return _mm_min_epu8(pixels, alpha);
+}
+
+// Adds taps k onwards of the window at in to sum's four channels, two at a
+// time: the pixels' channels interleaved as 16-bit pairs, so one madd
+// multiplies and adds both
+TARGET_SSE2 inline __m128i acrossTapsSSE2(const uint32_t *in,
+                                          const int16_t *weights, int k,
+                                          int taps, __m128i sum) {
+  const __m128i zero = _mm_setzero_si128();
+  for (; k + 1 < taps; k += 2) {
+    __m128i pixels = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in + k)), zero);
+    pixels = _mm_unpacklo_epi16(pixels, _mm_srli_si128(pixels, 8));
+    sum = _mm_add_epi32(
+        sum, _mm_madd_epi16(pixels, _mm_set1_epi32(weightPair(weights + k))));
+  }
+  if (k < taps) {
+    __m128i pixel = _mm_unpacklo_epi16(
+        _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(in[k])), zero), zero);
+    sum = _mm_add_epi32(
+        sum, _mm_madd_epi16(pixel, _mm_set1_epi32(weightPair(weights[k]))));
+  }
+  return sum;
+}
+
+TARGET_SSE2 inline uint32_t packPixelSSE2(__m128i sum) {
+  sum = _mm_srai_epi32(sum, PRECISION);
+  sum = _mm_packs_epi32(sum, sum);
+  return uint32_t(
+      _mm_cvtsi128_si32(clampToAlphaSSE2(_mm_packus_epi16(sum, sum))));
+}
+
+TARGET_SSE2 void acrossSSE2(const uint32_t *in, uint32_t *out, int width,
+                            const Coefficients &across) {
+  for (int x = 0; x < width; x++) {
+    out[x] = packPixelSSE2(acrossTapsSSE2(
+        in + across.first[x], across.weights.data() + size_t(x) * across.taps,
+        0, across.taps, _mm_set1_epi32(ROUNDING)));
+  }
+}
+
+// Four pixels at a time, two rows per madd: each row's channels
+// interleaved with the next's
+TARGET_SSE2 void downSSE2(const uint32_t *const *rows, const int16_t *weights,
+                          int taps, uint32_t *out, int x, int width) {
+  const __m128i zero = _mm_setzero_si128();
+  for (; x + 3 < width; x += 4) {
+    __m128i sum0 = _mm_set1_epi32(ROUNDING);
+    __m128i sum1 = sum0, sum2 = sum0, sum3 = sum0;
+    for (int k = 0; k < taps; k += 2) {
+      __m128i a = load128(rows[k] + x);
+      __m128i b = zero;
+      __m128i weight;
+      if (k + 1 < taps) {
+        b = load128(rows[k + 1] + x);
+        weight = _mm_set1_epi32(weightPair(weights + k));
+      } else {
+        weight = _mm_set1_epi32(weightPair(weights[k]));
+      }
+      __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+      __m128i b_lo = _mm_unpacklo_epi8(b, zero);
+      __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+      __m128i b_hi = _mm_unpackhi_epi8(b, zero);
+      sum0 = _mm_add_epi32(
+          sum0, _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), weight));
+      sum1 = _mm_add_epi32(
+          sum1, _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), weight));
+      sum2 = _mm_add_epi32(
+          sum2, _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), weight));
+      sum3 = _mm_add_epi32(
+          sum3, _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), weight));
+    }
+    __m128i low = _mm_packs_epi32(_mm_srai_epi32(sum0, PRECISION),
+                                  _mm_srai_epi32(sum1, PRECISION));
+    __m128i high = _mm_packs_epi32(_mm_srai_epi32(sum2, PRECISION),
+                                   _mm_srai_epi32(sum3, PRECISION));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x),
+                     clampToAlphaSSE2(_mm_packus_epi16(low, high)));
+  }
+  downScalar(rows, weights, taps, out, x, width);
+}
+
+TARGET_AVX2 inline __m256i load256(const uint32_t *pixels) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels));
+}
+
+TARGET_AVX2 inline __m256i clampToAlphaAVX2(__m256i pixels) {
+  __m256i alpha = _mm256_srli_epi32(pixels, 24);
+  alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 8));
+  alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+  return _mm256_min_epu8(pixels, alpha);
+}
+
+// Four taps per madd: two pixels in each 128-bit lane, the lanes' sums
+// added at the end and the last taps left to SSE2
+TARGET_AVX2 void acrossAVX2(const uint32_t *in, uint32_t *out, int width,
+                            const Coefficients &across) {
+  const __m256i spread = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+  const int taps = across.taps;
+  for (int x = 0; x < width; x++) {
+    const uint32_t *source = in + across.first[x];
+    const int16_t *weights = across.weights.data() + size_t(x) * taps;
+    __m256i sum = _mm256_setzero_si256();
+    int k = 0;
+    for (; k + 3 < taps; k += 4) {
+      __m256i pixels = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + k)));
+      pixels = _mm256_unpacklo_epi16(pixels, _mm256_srli_si256(pixels, 8));
+      __m256i weight = _mm256_permutevar8x32_epi32(
+          _mm256_castsi128_si256(_mm_loadl_epi64(
+              reinterpret_cast<const __m128i *>(weights + k))),
+          spread);
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pixels, weight));
+    }
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                  _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi32(total, _mm_set1_epi32(ROUNDING));
+    out[x] = packPixelSSE2(acrossTapsSSE2(source, weights, k, taps, total));
+  }
+}
+
+// As downSSE2(), eight pixels at a time. Unpacking and packing both stay
+// within 128-bit lanes, so the pixels come out in the order they went in.
+TARGET_AVX2 void downAVX2(const uint32_t *const *rows, const int16_t *weights,
+                          int taps, uint32_t *out, int width) {
+  const __m256i zero = _mm256_setzero_si256();
+  int x = 0;
+  for (; x + 7 < width; x += 8) {
+    __m256i sum0 = _mm256_set1_epi32(ROUNDING);
+    __m256i sum1 = sum0, sum2 = sum0, sum3 = sum0;
+    for (int k = 0; k < taps; k += 2) {
+      __m256i a = load256(rows[k] + x);
+      __m256i b = zero;
+      __m256i weight;
+      if (k + 1 < taps) {
+        b = load256(rows[k + 1] + x);
+        weight = _mm256_set1_epi32(weightPair(weights + k));
+      } else {
+        weight = _mm256_set1_epi32(weightPair(weights[k]));
+      }
+      __m256i a_lo = _mm256_unpacklo_epi8(a, zero);
+      __m256i b_lo = _mm256_unpacklo_epi8(b, zero);
+      __m256i a_hi = _mm256_unpackhi_epi8(a, zero);
+      __m256i b_hi = _mm256_unpackhi_epi8(b, zero);
+      sum0 = _mm256_add_epi32(
+          sum0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_lo, b_lo), weight));
+      sum1 = _mm256_add_epi32(
+          sum1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_lo, b_lo), weight));
+      sum2 = _mm256_add_epi32(
+          sum2, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_hi, b_hi), weight));
+      sum3 = _mm256_add_epi32(
+          sum3, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_hi, b_hi), weight));
+    }
+    __m256i low = _mm256_packs_epi32(_mm256_srai_epi32(sum0, PRECISION),
+                                     _mm256_srai_epi32(sum1, PRECISION));
+    __m256i high = _mm256_packs_epi32(_mm256_srai_epi32(sum2, PRECISION),
+                                      _mm256_srai_epi32(sum3, PRECISION));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + x),
+                        clampToAlphaAVX2(_mm256_packus_epi16(low, high)));
+  }
+  downSSE2(rows, weights, taps, out, x, width);
+}
+
+#endif // RESAMPLE_X86
+
+inline const uint32_t *rowAt(const uint32_t *pixels, int stride, int y) {
+  return reinterpret_cast<const uint32_t *>(
+      reinterpret_cast<const uint8_t *>(pixels) + size_t(y) * stride);
+}
+
+} // namespace
+
+SimdLevel cpuSimdLevel() {
+#ifdef RESAMPLE_X86
+  static const SimdLevel level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+      return SimdLevel::SSE2;
+    return SimdLevel::SCALAR;
+  }();
+  return level;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel simdLevel() {
+  static const SimdLevel level = [] {
+    SimdLevel level = cpuSimdLevel();
+    const char *cap = getenv("SOLITAIRE_SIMD");
+    if (cap && !strcmp(cap, "scalar"))
+      level = SimdLevel::SCALAR;
+    else if (cap && !strcmp(cap, "sse2"))
+      level = std::min(level, SimdLevel::SSE2);
+    return level;
+  }();
+  return level;
+}
+
+const char *simdName(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::AVX2:
+    return "avx2";
+  case SimdLevel::SSE2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+void resample(const uint32_t *src, int src_width, int src_height,
+              int src_stride, uint32_t *dst, int dst_width, int dst_height,
+              int dst_stride, ScaleFilter filter, SimdLevel level) {
+  if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0)
+    return;
+  level = std::min(level, cpuSimdLevel());
+  Coefficients across = makeCoefficients(src_width, dst_width, filter);
+  Coefficients down = makeCoefficients(src_height, dst_height, filter);
+
+  // Down the columns the horizontal pass reads, then across. The vertical
+  // pass does eight pixels at a time where the horizontal one does one, so
+  // it goes first, on the larger image. Both clamp to alpha, keeping the
+  // rows between them premultiplied too.
+  int left = across.first.front();
+  int span = across.first.back() + across.taps - left;
+  for (int &first : across.first)
+    first -= left;
+  std::vector<uint32_t> rows(size_t(dst_height) * span);
+  std::vector<const uint32_t *> window(down.taps);
+  for (int y = 0; y < dst_height; y++) {
+    for (int k = 0; k < down.taps; k++)
+      window[k] = rowAt(src, src_stride, down.first[y] + k) + left;
+    const int16_t *weights = down.weights.data() + size_t(y) * down.taps;
+    uint32_t *out = rows.data() + size_t(y) * span;
+    switch (level) {
+#ifdef RESAMPLE_X86
+    case SimdLevel::AVX2:
+      downAVX2(window.data(), weights, down.taps, out, span);
+      break;
+    case SimdLevel::SSE2:
+      downSSE2(window.data(), weights, down.taps, out, 0, span);
+      break;
+#endif
+    default:
+      downScalar(window.data(), weights, down.taps, out, 0, span);
+    }
+  }
+
+  for (int y = 0; y < dst_height; y++) {
+    const uint32_t *in = rows.data() + size_t(y) * span;
+    uint32_t *out = reinterpret_cast<uint32_t *>(
+        reinterpret_cast<uint8_t *>(dst) + size_t(y) * dst_stride);
+    switch (level) {
+#ifdef RESAMPLE_X86
+    case SimdLevel::AVX2:
+      acrossAVX2(in, out, dst_width, across);
+      break;
+    case SimdLevel::SSE2:
+      acrossSSE2(in, out, dst_width, across);
+      break;
+#endif
+    default:
+      acrossScalar(in, out, dst_width, across);
+    }
+  }
+}
+
+} // namespace render
@@ -0,0 +1,32 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+// Box and Lanczos-3 resampling of premultiplied ARGB32 card images, in
+// plain C++, SSE2 or AVX2 with the same bytes out of each.
+
+#include <cstdint>
+
+namespace render {
+
+enum class ScaleFilter { BOX, LANCZOS3 };
+
+enum class SimdLevel { SCALAR, SSE2, AVX2 };
+
+// The widest level this CPU has, capped by SOLITAIRE_SIMD (scalar, sse2 or
+// avx2) when that is set
+SimdLevel simdLevel();
+// The widest level this CPU has
+SimdLevel cpuSimdLevel();
+const char *simdName(SimdLevel level);
+
+// Resamples the src_width x src_height image at src into dst_width x
+// dst_height pixels at dst. Strides are in bytes. A level the CPU does not
+// have is lowered to one it does.
+void resample(const uint32_t *src, int src_width, int src_height,
+              int src_stride, uint32_t *dst, int dst_width, int dst_height,
+              int dst_stride, ScaleFilter filter = ScaleFilter::LANCZOS3,
+              SimdLevel level = simdLevel());
+
+} // namespace render
+
+#endif // RESAMPLE_H
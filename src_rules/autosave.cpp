@@ -0,0 +1,198 @@
+#include "autosave.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rules {
+
+namespace {
+
+// Flushes stdio's buffer and then the OS's
+bool syncFile(FILE *file) {
+  if (fflush(file) != 0)
+    return false;
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Atomically replaces path with temp
+bool replaceFile(const std::string &temp, const std::string &path) {
+#ifdef _WIN32
+  return MoveFileExA(temp.c_str(), path.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  if (rename(temp.c_str(), path.c_str()) != 0)
+    return false;
+  // The rename is only durable once the directory is synced too
+  size_t slash = path.find_last_of('/');
+  std::string directory =
+      slash == std::string::npos ? "." : path.substr(0, slash + 1);
+  int fd = open(directory.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+  return true;
+#endif
+}
+
+} // namespace
+
+AutosaveLog::AutosaveLog(const std::string &path)
+    : path_(path), generation_(0), stream_size_(0), handed_any_(false),
+      rewrite_(false), remove_(false), stop_(false), log_(nullptr),
+      dirty_(false) {
+  worker_ = std::thread(&AutosaveLog::run, this);
+}
+
+AutosaveLog::~AutosaveLog() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  worker_.join();
+}
+
+void AutosaveLog::update(const Replay &replay) {
+  const std::vector<uint8_t> &stream = replay.stream();
+  bool restarted = !handed_any_ || replay.generation() != generation_;
+  if (!restarted && stream.size() == stream_size_)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (restarted) {
+      appended_.clear();
+      rewrite_ = replay.recording();
+      remove_ = !rewrite_;
+      whole_ = rewrite_ ? replay.encode() : std::vector<uint8_t>();
+    } else {
+      appended_.insert(appended_.end(), stream.begin() + stream_size_,
+                       stream.end());
+    }
+  }
+  generation_ = replay.generation();
+  stream_size_ = stream.size();
+  handed_any_ = true;
+  wake_.notify_one();
+}
+
+void AutosaveLog::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    auto ready = [this] {
+      return rewrite_ || remove_ || !appended_.empty() || stop_;
+    };
+    // With unsynced appends, wake up when the sync is due even if nothing
+    // else arrives
+    if (dirty_) {
+      wake_.wait_until(lock, sync_due_, ready);
+    } else {
+      wake_.wait(lock, ready);
+    }
+
+    bool rewrite = rewrite_;
+    bool remove = remove_;
+    bool stopping = stop_;
+    std::vector<uint8_t> whole;
+    std::vector<uint8_t> appended;
+    whole.swap(whole_);
+    appended.swap(appended_);
+    rewrite_ = false;
+    remove_ = false;
+    lock.unlock();
+
+    if (remove) {
+      closeLog();
+      std::remove(path_.c_str());
+    }
+    if (rewrite)
+      replaceLog(whole);
+    if (!appended.empty())
+      appendLog(appended);
+    if (dirty_ &&
+        (stopping || std::chrono::steady_clock::now() >= sync_due_)) {
+      syncFile(log_);
+      dirty_ = false;
+    }
+    if (stopping) {
+      closeLog();
+      return;
+    }
+    lock.lock();
+  }
+}
+
+void AutosaveLog::replaceLog(const std::vector<uint8_t> &data) {
+  closeLog();
+  std::string temp = path_ + ".tmp";
+  FILE *file = fopen(temp.c_str(), "wb");
+  if (!file)
+    return;
+  bool written =
+      fwrite(data.data(), 1, data.size(), file) == data.size() &&
+      syncFile(file);
+  if (fclose(file) != 0 || !written || !replaceFile(temp, path_)) {
+    std::remove(temp.c_str());
+    return;
+  }
+  log_ = fopen(path_.c_str(), "ab");
+}
+
+void AutosaveLog::appendLog(const std::vector<uint8_t> &data) {
+  if (!log_)
+    return;
+  // Flushed to the OS straight away, so only a system crash can lose it
+  fwrite(data.data(), 1, data.size(), log_);
+  fflush(log_);
+  if (!dirty_) {
+    dirty_ = true;
+    sync_due_ = std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(SYNC_INTERVAL_MS);
+  }
+}
+
+void AutosaveLog::closeLog() {
+  if (!log_)
+    return;
+  if (dirty_)
+    syncFile(log_);
+  fclose(log_);
+  log_ = nullptr;
+  dirty_ = false;
+}
+
+bool loadAutosave(const std::string &path, Replay &saved) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t got;
+  while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data.insert(data.end(), buffer, buffer + got);
+  fclose(file);
+
+  // A crash during an append can leave the last step half written: drop
+  // the bytes at the end still waiting for a continuation
+  constexpr size_t FLAGS_BYTE = 6;
+  size_t stream_start = REPLAY_HEADER_SIZE;
+  if (data.size() > FLAGS_BYTE &&
+      (data[FLAGS_BYTE] & REPLAY_FLAG_DECK_ORDER))
+    stream_start += REPLAY_DECK_ORDER_SIZE;
+  size_t size = data.size();
+  while (size > stream_start && (data[size - 1] & 0x80))
+    size--;
+  return saved.decode(data.data(), size);
+}
+
+} // namespace rules
@@ -0,0 +1,123 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+// Crash-safe saving of the game in progress, so closing a game, or losing
+// it to a crash, doesn't lose the session.
+//
+// The save is the game's replay (see replay.h): a versioned header with
+// the deal, then every move, undo and redo. It grows by a couple of bytes
+// a move, so autosaving appends just the new steps to a log file. The log
+// is an ordinary replay and can be opened as one.
+//
+// The game calls update() after every change. That only copies the new
+// bytes for a worker thread, which does all the file work, so saving
+// never holds up a frame. The worker appends each batch, fsync()s at most
+// once every SYNC_INTERVAL_MS, and syncs what is left when the log is
+// closed. A new game is written whole to a temporary file, synced and
+// renamed over the log, so the log is always the old game or the new one,
+// never a mix. After a crash at most the last second of moves is lost,
+// and a step torn in half at the end is dropped by loadAutosave().
+
+#include "undo_journal.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rules {
+
+class AutosaveLog {
+public:
+  static constexpr int SYNC_INTERVAL_MS = 1000;
+
+  explicit AutosaveLog(const std::string &path);
+  // Writes and syncs whatever is still pending
+  ~AutosaveLog();
+
+  AutosaveLog(const AutosaveLog &) = delete;
+  AutosaveLog &operator=(const AutosaveLog &) = delete;
+
+  // Brings the log in line with replay: appends the steps since the last
+  // call, rewrites the log for a new recording and deletes it once the
+  // replay stops recording. Cheap when nothing changed, so it can be
+  // called on every redraw.
+  void update(const Replay &replay);
+
+private:
+  void run();
+  void replaceLog(const std::vector<uint8_t> &data);
+  void appendLog(const std::vector<uint8_t> &data);
+  void closeLog();
+
+  std::string path_;
+
+  // What the game has handed over so far; game thread only
+  uint32_t generation_;
+  size_t stream_size_;
+  bool handed_any_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool rewrite_;                 // whole_ replaces the log
+  bool remove_;                  // the log is to go
+  std::vector<uint8_t> whole_;
+  std::vector<uint8_t> appended_; // steps to add after the log or whole_
+  bool stop_;
+
+  // Worker only
+  FILE *log_;
+  bool dirty_; // appended to since the last fsync
+  std::chrono::steady_clock::time_point sync_due_;
+
+  std::thread worker_;
+};
+
+// Reads a log written by AutosaveLog. False if there is none or it is not
+// a replay.
+bool loadAutosave(const std::string &path, Replay &saved);
+
+// Rebuilds a saved game in one pass over its steps: deals it, then plays
+// every move, undo and redo through history, which re-records them into
+// recording (attached to history) and leaves the undo journal just as it
+// was. state is the board at the end. False, with history and recording
+// cleared, if the save is for another game or a step is not legal.
+template <typename State>
+bool restoreAutosave(const Replay &saved, UndoHistory<State> &history,
+                     Replay &recording, State &state) {
+  State start;
+  if (!dealReplayStart(saved.header(), start))
+    return false;
+  history.clear();
+  history.track(start);
+  recording.start(saved.header());
+
+  Replay::Reader reader(saved.stream());
+  ReplayStep step;
+  bool ok = true;
+  while (ok && reader.next(step)) {
+    if (step.kind == ReplayStepKind::MOVE) {
+      ok = history.position().isLegal(step.move);
+      if (ok)
+        history.record(step.move);
+    } else if (step.kind == ReplayStepKind::UNDO) {
+      ok = history.undo(state);
+    } else {
+      ok = history.redo(state);
+    }
+  }
+
+  if (!ok || !reader.atEnd()) {
+    history.clear();
+    recording.stop();
+    return false;
+  }
+  state = history.position();
+  return true;
+}
+
+} // namespace rules
+
+#endif // AUTOSAVE_H
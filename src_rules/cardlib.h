@@ -0,0 +1 @@
+../shared/cardlib.h
\ No newline at end of file
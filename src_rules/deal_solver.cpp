@@ -0,0 +1,105 @@
+#include "deal_solver.h"
+
+namespace rules {
+
+const char *dealVariantName(DealVariant variant) {
+  switch (variant) {
+  case DealVariant::KLONDIKE_DRAW1:
+    return "klondike-draw1";
+  case DealVariant::KLONDIKE_DRAW3:
+    return "klondike-draw3";
+  case DealVariant::FREECELL:
+    return "freecell";
+  case DealVariant::DOUBLE_FREECELL:
+    return "double-freecell";
+  case DealVariant::SPIDER_1SUIT:
+    return "spider-1suit";
+  case DealVariant::SPIDER_2SUIT:
+    return "spider-2suit";
+  case DealVariant::SPIDER_4SUIT:
+    return "spider-4suit";
+  case DealVariant::PYRAMID:
+    return "pyramid";
+  }
+  return "unknown";
+}
+
+bool parseDealVariant(const std::string &name, DealVariant &variant) {
+  for (DealVariant candidate : ALL_DEAL_VARIANTS) {
+    if (name == dealVariantName(candidate)) {
+      variant = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool exhaustedIsProof(DealVariant variant) {
+  return variant == DealVariant::PYRAMID;
+}
+
+const char *dealStatusName(DealVariant variant, SolveStatus status) {
+  if (status != SolveStatus::EXHAUSTED)
+    return solveStatusName(status);
+  return exhaustedIsProof(variant) ? "unwinnable" : "not-proven";
+}
+
+DealSolver::DealSolver(DealVariant variant, unsigned table_bits)
+    : variant_(variant), deck_order_(zipDeckOrder()) {
+  switch (variant) {
+  case DealVariant::KLONDIKE_DRAW1:
+  case DealVariant::KLONDIKE_DRAW3:
+    klondike_ = std::make_unique<KlondikeSolver>(table_bits);
+    break;
+  case DealVariant::FREECELL:
+  case DealVariant::DOUBLE_FREECELL:
+    // Callers run one DealSolver per core, so each search is single-threaded
+    freecell_ = std::make_unique<FreecellSolver>(1, table_bits);
+    break;
+  case DealVariant::SPIDER_1SUIT:
+  case DealVariant::SPIDER_2SUIT:
+  case DealVariant::SPIDER_4SUIT:
+    // Same memory as the other tables: 2^bits 8-byte keys
+    spider_ = std::make_unique<SpiderSolver>((size_t(8) << table_bits) >> 20);
+    break;
+  case DealVariant::PYRAMID:
+    pyramid_ = std::make_unique<PyramidSolver>(table_bits);
+    break;
+  }
+}
+
+DealSolver::~DealSolver() = default;
+
+SolveResult DealSolver::solve(unsigned seed, const SolverLimits &limits) {
+  switch (variant_) {
+  case DealVariant::KLONDIKE_DRAW1:
+  case DealVariant::KLONDIKE_DRAW3: {
+    KlondikeState state;
+    state.deal(seed, variant_ == DealVariant::KLONDIKE_DRAW3, deck_order_);
+    return klondike_->solve(state, limits);
+  }
+  case DealVariant::FREECELL:
+  case DealVariant::DOUBLE_FREECELL: {
+    FreecellState state;
+    state.deal(seed, variant_ == DealVariant::DOUBLE_FREECELL);
+    return freecell_->solve(state, limits);
+  }
+  case DealVariant::SPIDER_1SUIT:
+  case DealVariant::SPIDER_2SUIT:
+  case DealVariant::SPIDER_4SUIT: {
+    static const int suits[] = {1, 2, 4};
+    SpiderState state;
+    state.deal(seed, suits[static_cast<int>(variant_) -
+                           static_cast<int>(DealVariant::SPIDER_1SUIT)]);
+    return spider_->solve(state, limits);
+  }
+  case DealVariant::PYRAMID: {
+    PyramidState state;
+    state.deal(seed, deck_order_);
+    return pyramid_->solve(state, limits);
+  }
+  }
+  return SolveResult();
+}
+
+} // namespace rules
@@ -0,0 +1,66 @@
+#ifndef DEAL_SOLVER_H
+#define DEAL_SOLVER_H
+
+#include "freecell_solver.h"
+#include "klondike_solver.h"
+#include "pyramid_solver.h"
+#include "spider_solver.h"
+#include <memory>
+#include <string>
+
+namespace rules {
+
+// Every game and mode a seed can be dealt in. The values are stored in
+// analysis and seed index files, so never renumber them.
+enum class DealVariant : uint8_t {
+  KLONDIKE_DRAW1 = 1,
+  KLONDIKE_DRAW3 = 2,
+  FREECELL = 3,
+  DOUBLE_FREECELL = 4,
+  SPIDER_1SUIT = 5,
+  SPIDER_2SUIT = 6,
+  SPIDER_4SUIT = 7,
+  PYRAMID = 8
+};
+
+constexpr DealVariant ALL_DEAL_VARIANTS[] = {
+    DealVariant::KLONDIKE_DRAW1, DealVariant::KLONDIKE_DRAW3,
+    DealVariant::FREECELL,       DealVariant::DOUBLE_FREECELL,
+    DealVariant::SPIDER_1SUIT,   DealVariant::SPIDER_2SUIT,
+    DealVariant::SPIDER_4SUIT,   DealVariant::PYRAMID};
+
+// Command-line names: klondike-draw1, klondike-draw3, freecell,
+// double-freecell, spider-1suit, spider-2suit, spider-4suit, pyramid
+const char *dealVariantName(DealVariant variant);
+bool parseDealVariant(const std::string &name, DealVariant &variant);
+
+// Whether EXHAUSTED proves a deal of this variant unwinnable. Only the
+// Pyramid search is exact; the others skip moves they judge useless.
+bool exhaustedIsProof(DealVariant variant);
+// "unwinnable" where EXHAUSTED is a proof, "not-proven" where it is not,
+// otherwise solveStatusName()
+const char *dealStatusName(DealVariant variant, SolveStatus status);
+
+// Deals seeds of one variant, in the order the game itself deals them, and
+// runs the matching solver. Owns its solver and transposition table, so
+// use one per thread.
+class DealSolver {
+public:
+  explicit DealSolver(DealVariant variant, unsigned table_bits = 20);
+  ~DealSolver();
+
+  DealVariant variant() const { return variant_; }
+  SolveResult solve(unsigned seed, const SolverLimits &limits);
+
+private:
+  DealVariant variant_;
+  std::vector<Card> deck_order_;
+  std::unique_ptr<KlondikeSolver> klondike_;
+  std::unique_ptr<FreecellSolver> freecell_;
+  std::unique_ptr<SpiderSolver> spider_;
+  std::unique_ptr<PyramidSolver> pyramid_;
+};
+
+} // namespace rules
+
+#endif // DEAL_SOLVER_H
@@ -0,0 +1,329 @@
+#include "freecell_rules.h"
+#include <algorithm>
+
+namespace rules {
+
+void FreecellState::deal(unsigned seed, bool double_mode) {
+  if (!double_mode) {
+    deal(seed, zipDeckOrder());
+    return;
+  }
+
+  // Double FreeCell loads MultiDeck(2, zip) and then calls
+  // includeJokersInAllDecks(false), which resets both decks to the
+  // standard order before shuffling.
+  std::vector<Card> cards = shuffleMultiDeck(
+      {standardDeckOrder(), standardDeckOrder()}, seed);
+
+  double_deck = true;
+  num_cells = 6;
+  num_columns = 10;
+  cells.fill(PackedCard());
+  for (auto &pile : foundation)
+    pile.clear();
+  for (auto &pile : tableau)
+    pile.clear();
+
+  for (int i = 0; !cards.empty(); i++) {
+    tableau[i % 10].push(PackedCard(cards.back()));
+    cards.pop_back();
+  }
+}
+
+void FreecellState::deal(unsigned seed, const std::vector<Card> &deck_order) {
+  std::vector<Card> cards = shuffleDeck(deck_order, seed);
+
+  double_deck = false;
+  num_cells = 4;
+  num_columns = 8;
+  cells.fill(PackedCard());
+  for (auto &pile : foundation)
+    pile.clear();
+  for (auto &pile : tableau)
+    pile.clear();
+
+  for (int i = 0; !cards.empty(); i++) {
+    tableau[i % 8].push(PackedCard(cards.back()));
+    cards.pop_back();
+  }
+}
+
+bool FreecellState::canMoveToFoundation(PackedCard card,
+                                        int foundation_index) const {
+  const auto &pile = foundation[foundation_index];
+  if (pile.empty()) {
+    return card.rank() == Rank::ACE;
+  }
+
+  PackedCard top = pile.back();
+  if (double_deck) {
+    // Second run wraps from King back to Ace, and stops at 26 cards
+    if (pile.full())
+      return false;
+    if (top.rank() == Rank::KING) {
+      return card.suit() == top.suit() && card.rank() == Rank::ACE;
+    }
+  }
+  return cardlib::buildsOnFoundation(card, top);
+}
+
+bool FreecellState::canMoveToTableau(PackedCard card, int tableau_index) const {
+  const auto &pile = tableau[tableau_index];
+  if (pile.empty()) {
+    return true;
+  }
+  PackedCard top = pile.back();
+  return cardlib::isOppositeColor(card, top) &&
+         cardlib::isOneRankBelow(card, top);
+}
+
+int FreecellState::emptyCells() const {
+  int count = 0;
+  for (int i = 0; i < num_cells; i++) {
+    if (!cells[i].isValid())
+      count++;
+  }
+  return count;
+}
+
+int FreecellState::emptyColumns(int excluding) const {
+  int count = 0;
+  for (int i = 0; i < num_columns; i++) {
+    if (i != excluding && tableau[i].empty())
+      count++;
+  }
+  return count;
+}
+
+size_t FreecellState::maxMovable(int destination_column) const {
+  return static_cast<size_t>(emptyCells() + 1)
+         << emptyColumns(destination_column);
+}
+
+size_t FreecellState::movableRunLength(int column) const {
+  const auto &pile = tableau[column];
+  if (pile.empty())
+    return 0;
+  size_t length = 1;
+  for (size_t i = pile.size() - 1; i > 0; i--) {
+    PackedCard upper = pile[i - 1];
+    PackedCard lower = pile[i];
+    if (!cardlib::isOppositeColor(upper, lower) ||
+        !cardlib::isOneRankBelow(lower, upper))
+      break;
+    length++;
+  }
+  return length;
+}
+
+bool FreecellState::isLegal(const Move &move) const {
+  if (move.from >= FREECELL_PILE_COUNT || move.to >= FREECELL_PILE_COUNT ||
+      move.from == move.to || move.count == 0)
+    return false;
+
+  // Source card (the bottom card of the moved run)
+  PackedCard card;
+  if (move.from < FREECELL_FOUNDATION) {
+    if (move.from >= num_cells || !cells[move.from].isValid() ||
+        move.count != 1)
+      return false;
+    card = cells[move.from];
+  } else if (move.from < FREECELL_TABLEAU) {
+    const auto &pile = foundation[move.from - FREECELL_FOUNDATION];
+    if (pile.empty() || move.count != 1)
+      return false;
+    card = pile.back();
+  } else {
+    int column = move.from - FREECELL_TABLEAU;
+    if (column >= num_columns || move.count > movableRunLength(column))
+      return false;
+    const auto &pile = tableau[column];
+    card = pile[pile.size() - move.count];
+  }
+
+  // Destination
+  if (move.to < FREECELL_FOUNDATION) {
+    return move.to < num_cells && !cells[move.to].isValid() &&
+           move.count == 1 && move.from >= FREECELL_TABLEAU;
+  }
+  if (move.to < FREECELL_TABLEAU) {
+    return move.count == 1 &&
+           (move.from < FREECELL_FOUNDATION || move.from >= FREECELL_TABLEAU) &&
+           canMoveToFoundation(card, move.to - FREECELL_FOUNDATION);
+  }
+  int column = move.to - FREECELL_TABLEAU;
+  if (column >= num_columns || !canMoveToTableau(card, column))
+    return false;
+  return move.count == 1 || move.count <= maxMovable(column);
+}
+
+void FreecellState::applyMove(Move &move) {
+  move.flags = 0;
+
+  std::array<PackedCard, 13> moving;
+  size_t count = move.count;
+
+  if (move.from < FREECELL_FOUNDATION) {
+    moving[0] = cells[move.from];
+    cells[move.from] = PackedCard();
+  } else if (move.from < FREECELL_TABLEAU) {
+    moving[0] = foundation[move.from - FREECELL_FOUNDATION].pop();
+  } else {
+    auto &pile = tableau[move.from - FREECELL_TABLEAU];
+    for (size_t i = 0; i < count; i++) {
+      moving[i] = pile[pile.size() - count + i];
+    }
+    for (size_t i = 0; i < count; i++)
+      pile.pop();
+  }
+
+  if (move.to < FREECELL_FOUNDATION) {
+    cells[move.to] = moving[0];
+  } else if (move.to < FREECELL_TABLEAU) {
+    foundation[move.to - FREECELL_FOUNDATION].push(moving[0]);
+  } else {
+    auto &pile = tableau[move.to - FREECELL_TABLEAU];
+    for (size_t i = 0; i < count; i++) {
+      pile.push(moving[i]);
+    }
+  }
+}
+
+MoveDelta FreecellState::applyRecorded(const Move &move) {
+  MoveDelta delta(move);
+  applyMove(delta.move);
+  return delta;
+}
+
+// Nothing is ever turned over, so undoing is the same transfer backwards
+void FreecellState::undoMove(const MoveDelta &delta) {
+  Move back(delta.move.to, delta.move.from, delta.move.count);
+  applyMove(back);
+}
+
+void FreecellState::legalMoves(MoveList &moves) const {
+  moves.clear();
+
+  auto firstFoundationFor = [this](PackedCard card) {
+    for (int f = 0; f < 4; f++) {
+      if (canMoveToFoundation(card, f))
+        return f;
+    }
+    return -1;
+  };
+
+  // To the foundations
+  for (int c = 0; c < num_cells; c++) {
+    if (!cells[c].isValid())
+      continue;
+    int f = firstFoundationFor(cells[c]);
+    if (f >= 0)
+      moves.push(Move(FREECELL_CELL + c, FREECELL_FOUNDATION + f));
+  }
+  for (int t = 0; t < num_columns; t++) {
+    if (tableau[t].empty())
+      continue;
+    int f = firstFoundationFor(tableau[t].back());
+    if (f >= 0)
+      moves.push(Move(FREECELL_TABLEAU + t, FREECELL_FOUNDATION + f));
+  }
+
+  // Tableau to tableau. Only the first empty column is offered as a
+  // destination since all empty columns are interchangeable.
+  int first_empty = -1;
+  for (int t = 0; t < num_columns; t++) {
+    if (tableau[t].empty()) {
+      first_empty = t;
+      break;
+    }
+  }
+
+  for (int t = 0; t < num_columns; t++) {
+    const auto &pile = tableau[t];
+    if (pile.empty())
+      continue;
+    size_t run = movableRunLength(t);
+    for (int d = 0; d < num_columns; d++) {
+      if (d == t)
+        continue;
+      if (tableau[d].empty()) {
+        if (d != first_empty)
+          continue;
+        // Any part of the run can go to an empty column
+        size_t limit = std::min(run, maxMovable(d));
+        if (limit == pile.size())
+          limit--; // moving a whole column into an empty one is pointless
+        for (size_t n = 1; n <= limit; n++) {
+          moves.push(Move(FREECELL_TABLEAU + t, FREECELL_TABLEAU + d,
+                          static_cast<uint8_t>(n)));
+        }
+        continue;
+      }
+      // Exactly one run length can fit on a non-empty column
+      int needed = tableau[d].back().rankValue() - 1;
+      for (size_t n = 1; n <= run; n++) {
+        PackedCard base = pile[pile.size() - n];
+        if (base.rankValue() == needed) {
+          if (canMoveToTableau(base, d) && (n == 1 || n <= maxMovable(d))) {
+            moves.push(Move(FREECELL_TABLEAU + t, FREECELL_TABLEAU + d,
+                            static_cast<uint8_t>(n)));
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  // Free cells to the tableau
+  for (int c = 0; c < num_cells; c++) {
+    if (!cells[c].isValid())
+      continue;
+    for (int d = 0; d < num_columns; d++) {
+      if (tableau[d].empty() && d != first_empty)
+        continue;
+      if (canMoveToTableau(cells[c], d))
+        moves.push(Move(FREECELL_CELL + c, FREECELL_TABLEAU + d));
+    }
+  }
+
+  // Tableau to the first empty free cell
+  for (int c = 0; c < num_cells; c++) {
+    if (cells[c].isValid())
+      continue;
+    for (int t = 0; t < num_columns; t++) {
+      if (!tableau[t].empty())
+        moves.push(Move(FREECELL_TABLEAU + t, FREECELL_CELL + c));
+    }
+    break;
+  }
+
+  // Foundation back to the tableau (the game allows it)
+  for (int f = 0; f < 4; f++) {
+    if (foundation[f].empty())
+      continue;
+    for (int d = 0; d < num_columns; d++) {
+      if (tableau[d].empty() && d != first_empty)
+        continue;
+      if (canMoveToTableau(foundation[f].back(), d))
+        moves.push(Move(FREECELL_FOUNDATION + f, FREECELL_TABLEAU + d));
+    }
+  }
+}
+
+int FreecellState::foundationCount() const {
+  int total = 0;
+  for (const auto &pile : foundation)
+    total += static_cast<int>(pile.size());
+  return total;
+}
+
+bool FreecellState::isWon() const {
+  return foundationCount() == (double_deck ? 104 : 52);
+}
+
+bool FreecellState::operator==(const FreecellState &other) const {
+  return double_deck == other.double_deck && cells == other.cells &&
+         foundation == other.foundation && tableau == other.tableau;
+}
+
+} // namespace rules
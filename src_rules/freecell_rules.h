@@ -0,0 +1,59 @@
+#ifndef FREECELL_RULES_H
+#define FREECELL_RULES_H
+
+#include "rules_common.h"
+
+namespace rules {
+
+// Pile numbering is fixed across both modes (the game shifts its indices
+// by the number of free cells; this does not).
+enum FreecellPile : uint8_t {
+  FREECELL_CELL = 0,        // 0..5 (only 0..3 in classic mode)
+  FREECELL_FOUNDATION = 6,  // 6..9
+  FREECELL_TABLEAU = 10,    // 10..19 (only 10..17 in classic mode)
+  FREECELL_PILE_COUNT = 20
+};
+
+// Classic (4 cells, 8 columns, one deck) and Double FreeCell (6 cells,
+// 10 columns, two decks, foundations go A..K twice) as played by
+// FreecellGame. Multi-card moves are "supermoves" limited by
+// (free cells + 1) * 2^(empty columns other than the destination).
+struct FreecellState {
+  std::array<PackedCard, 6> cells;
+  std::array<FixedPile<26>, 4> foundation;
+  std::array<FixedPile<24>, 10> tableau;
+  uint8_t num_cells;
+  uint8_t num_columns;
+  bool double_deck;
+
+  FreecellState() : cells{}, num_cells(4), num_columns(8), double_deck(false) {}
+
+  // Deals exactly like FreecellGame::initializeGame() + deal()
+  void deal(unsigned seed, bool double_mode = false);
+  void deal(unsigned seed, const std::vector<Card> &deck_order);
+
+  bool isLegal(const Move &move) const;
+  void applyMove(Move &move); // move must be legal
+  // applyMove, returning what undoMove() needs to take the move back
+  MoveDelta applyRecorded(const Move &move);
+  void undoMove(const MoveDelta &delta); // delta must be the last move played
+  void legalMoves(MoveList &moves) const;
+
+  bool canMoveToFoundation(PackedCard card, int foundation_index) const;
+  bool canMoveToTableau(PackedCard card, int tableau_index) const;
+  int emptyCells() const;
+  int emptyColumns(int excluding = -1) const;
+  size_t maxMovable(int destination_column) const;
+  // Length of the alternating-colour descending run on top of a column
+  size_t movableRunLength(int column) const;
+
+  bool isWon() const;
+  int foundationCount() const;
+
+  bool operator==(const FreecellState &other) const;
+  bool operator!=(const FreecellState &other) const { return !(*this == other); }
+};
+
+} // namespace rules
+
+#endif // FREECELL_RULES_H
@@ -0,0 +1,460 @@
+#include "freecell_solver.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+
+namespace rules {
+
+namespace {
+
+constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+constexpr size_t FRONTIER_PER_THREAD = 8;
+// Scores are scaled so helper threads can add a little noise without
+// reordering positions that are clearly better or worse
+constexpr int SCORE_SCALE = 8;
+
+// Compact copy of a position for the search tree: free cells, foundation
+// sizes and tops, then each column as a length byte followed by its cards.
+// The largest Double FreeCell position needs 6 + 8 + 10 + 104 bytes.
+struct PackedPosition {
+  std::array<uint8_t, 128> bytes;
+};
+
+struct Node {
+  PackedPosition position;
+  uint32_t parent;
+  Move move;
+};
+
+struct FrontierEntry {
+  FreecellState state;
+  std::vector<Move> path;
+};
+
+uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void pack(const FreecellState &state, PackedPosition &packed) {
+  uint8_t *out = packed.bytes.data();
+  for (int c = 0; c < 6; c++)
+    *out++ = state.cells[c].bits;
+  for (const auto &pile : state.foundation) {
+    *out++ = static_cast<uint8_t>(pile.size());
+    *out++ = pile.empty() ? 0 : pile.back().bits;
+  }
+  for (int t = 0; t < state.num_columns; t++) {
+    const auto &pile = state.tableau[t];
+    *out++ = static_cast<uint8_t>(pile.size());
+    for (size_t i = 0; i < pile.size(); i++)
+      *out++ = pile[i].bits;
+  }
+}
+
+// layout must already hold num_cells, num_columns and double_deck
+void unpack(const PackedPosition &packed, FreecellState &state) {
+  const uint8_t *in = packed.bytes.data();
+  for (int c = 0; c < 6; c++)
+    state.cells[c] = PackedCard(*in++);
+  for (auto &pile : state.foundation) {
+    pile.clear();
+    int size = *in++;
+    PackedCard top(*in++);
+    // Foundations run A..K (twice in Double FreeCell) in one suit
+    for (int i = 0; i < size; i++)
+      pile.push(PackedCard(top.suit(), static_cast<Rank>(i % 13 + 1)));
+  }
+  for (int t = 0; t < state.num_columns; t++) {
+    auto &pile = state.tableau[t];
+    pile.clear();
+    int size = *in++;
+    for (int i = 0; i < size; i++)
+      pile.push(PackedCard(*in++));
+  }
+}
+
+// Cards of a suit already on the foundations
+int foundationCount(const FreecellState &state, Suit suit) {
+  for (const auto &pile : state.foundation) {
+    if (!pile.empty() && pile.back().suit() == suit)
+      return static_cast<int>(pile.size());
+  }
+  return 0;
+}
+
+// A card is safe on the foundation once every card that could be built on
+// it in the tableau (opposite colour, one rank lower) is already home.
+// With two decks that means both copies, i.e. the suit's second run.
+bool isSafeOnFoundation(const FreecellState &state, PackedCard card) {
+  int rank = card.rankValue();
+  if (rank == 1)
+    return true;
+  int lowest_opposite;
+  if (card.isRed()) {
+    lowest_opposite = std::min(foundationCount(state, Suit::CLUBS),
+                               foundationCount(state, Suit::SPADES));
+  } else {
+    lowest_opposite = std::min(foundationCount(state, Suit::DIAMONDS),
+                               foundationCount(state, Suit::HEARTS));
+  }
+  int needed = state.double_deck ? 13 + rank - 1 : rank - 1;
+  return lowest_opposite >= needed;
+}
+
+void playSafeMoves(FreecellState &state, std::vector<Move> &played) {
+  bool moved = true;
+  while (moved) {
+    moved = false;
+    for (int source = 0; source < FREECELL_PILE_COUNT; source++) {
+      PackedCard card;
+      if (source < FREECELL_FOUNDATION) {
+        if (source >= state.num_cells)
+          continue;
+        card = state.cells[source];
+      } else if (source >= FREECELL_TABLEAU) {
+        int column = source - FREECELL_TABLEAU;
+        if (column >= state.num_columns || state.tableau[column].empty())
+          continue;
+        card = state.tableau[column].back();
+      }
+      if (!card.isValid() || !isSafeOnFoundation(state, card))
+        continue;
+      for (int f = 0; f < 4; f++) {
+        if (state.canMoveToFoundation(card, f)) {
+          Move move(static_cast<uint8_t>(source),
+                    static_cast<uint8_t>(FREECELL_FOUNDATION + f));
+          state.applyMove(move);
+          played.push_back(move);
+          moved = true;
+          break;
+        }
+      }
+    }
+  }
+}
+
+struct SharedSearch {
+  FreecellState layout;
+  ConcurrentTranspositionTable *table;
+  SolverLimits limits;
+  std::chrono::steady_clock::time_point start;
+  std::atomic<uint64_t> nodes{0};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> limit_hit{false};
+  std::mutex mutex;
+  bool solved = false;
+  std::vector<Move> solution;
+
+  double elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  }
+
+  // Counts one expansion; returns false once the budget is used up
+  bool tick(uint64_t &local) {
+    uint64_t count = nodes.fetch_add(1, std::memory_order_relaxed) + 1;
+    bool over = limits.max_nodes && count >= limits.max_nodes;
+    if (!over && (++local & 255) == 0) {
+      if (limits.max_seconds > 0 && elapsed() >= limits.max_seconds)
+        over = true;
+      if (limits.cancel && limits.cancel->load(std::memory_order_relaxed))
+        over = true;
+    }
+    if (over) {
+      limit_hit = true;
+      stop = true;
+    }
+    return !over;
+  }
+
+  void reportWin(std::vector<Move> path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!solved) {
+      solved = true;
+      solution = std::move(path);
+    }
+    stop = true;
+  }
+};
+
+// Expands one position: every child that is new to the table is handed to
+// visit(child, moves) with the move plus any safe moves played after it
+template <typename Visit>
+void expand(const FreecellState &state, ConcurrentTranspositionTable &table,
+            Visit visit) {
+  MoveList moves;
+  state.legalMoves(moves);
+  std::vector<Move> played;
+  for (const Move &candidate : moves) {
+    if (candidate.from >= FREECELL_FOUNDATION &&
+        candidate.from < FREECELL_TABLEAU)
+      continue;
+    FreecellState child = state;
+    Move move = candidate;
+    child.applyMove(move);
+    played.clear();
+    played.push_back(move);
+    playSafeMoves(child, played);
+    if (table.testAndSet(FreecellSolver::canonicalHash(child)))
+      continue;
+    if (!visit(child, played))
+      return;
+  }
+}
+
+void runWorker(SharedSearch &shared, const std::vector<FrontierEntry> &roots,
+               unsigned index) {
+  std::vector<Node> nodes;
+  nodes.reserve(1 << 16);
+  using Entry = std::pair<int, uint32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+  std::mt19937 rng(index);
+  auto priority = [&](const FreecellState &state) {
+    int jitter = index ? static_cast<int>(rng() % (SCORE_SCALE * 2)) : 0;
+    return FreecellSolver::score(state) * SCORE_SCALE + jitter;
+  };
+
+  for (const auto &root : roots) {
+    Node node;
+    pack(root.state, node.position);
+    node.parent = NO_PARENT;
+    nodes.push_back(node);
+    open.push({priority(root.state), static_cast<uint32_t>(nodes.size() - 1)});
+  }
+
+  auto pathTo = [&](uint32_t index_in_tree) {
+    std::vector<Move> tail;
+    while (nodes[index_in_tree].parent != NO_PARENT) {
+      tail.push_back(nodes[index_in_tree].move);
+      index_in_tree = nodes[index_in_tree].parent;
+    }
+    std::vector<Move> path = roots[index_in_tree].path;
+    path.insert(path.end(), tail.rbegin(), tail.rend());
+    return path;
+  };
+
+  uint64_t local = 0;
+  FreecellState state = shared.layout;
+  while (!open.empty() && !shared.stop.load(std::memory_order_relaxed)) {
+    uint32_t current = open.top().second;
+    open.pop();
+    if (!shared.tick(local))
+      break;
+
+    unpack(nodes[current].position, state);
+    expand(state, *shared.table,
+           [&](const FreecellState &child, const std::vector<Move> &played) {
+             // One tree node per move so the path can be walked back
+             uint32_t parent = current;
+             for (const Move &move : played) {
+               Node node;
+               node.parent = parent;
+               node.move = move;
+               nodes.push_back(node);
+               parent = static_cast<uint32_t>(nodes.size() - 1);
+             }
+             if (child.isWon()) {
+               shared.reportWin(pathTo(parent));
+               return false;
+             }
+             pack(child, nodes[parent].position);
+             open.push({priority(child), parent});
+             return true;
+           });
+  }
+}
+
+} // namespace
+
+FreecellSolver::FreecellSolver(unsigned threads, unsigned table_bits)
+    : threads_(threads ? threads : std::thread::hardware_concurrency()),
+      table_(table_bits) {
+  if (threads_ == 0)
+    threads_ = 1;
+}
+
+uint64_t FreecellSolver::canonicalHash(const FreecellState &state) {
+  uint64_t h = state.double_deck ? 0x5A17 : 0;
+
+  std::array<uint8_t, 6> cells;
+  for (int c = 0; c < 6; c++)
+    cells[c] = state.cells[c].bits;
+  std::sort(cells.begin(), cells.end());
+  for (uint8_t bits : cells)
+    h = mix(h ^ bits);
+
+  // Which foundation slot holds a suit does not matter either
+  std::array<uint16_t, 4> foundations;
+  for (int f = 0; f < 4; f++) {
+    const auto &pile = state.foundation[f];
+    foundations[f] =
+        pile.empty() ? 0
+                     : static_cast<uint16_t>(
+                           (static_cast<int>(pile.back().suit()) + 1) << 8 |
+                           pile.size());
+  }
+  std::sort(foundations.begin(), foundations.end());
+  for (uint16_t f : foundations)
+    h = mix(h ^ f);
+
+  std::array<uint64_t, 10> columns;
+  for (int t = 0; t < 10; t++) {
+    const auto &pile = state.tableau[t];
+    uint64_t column = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < pile.size(); i++)
+      column = (column ^ pile[i].bits) * 0x100000001B3ULL;
+    columns[t] = pile.empty() ? 0 : mix(column ^ pile.size());
+  }
+  std::sort(columns.begin(), columns.end());
+  for (uint64_t column : columns)
+    h = mix(h ^ column);
+
+  return h;
+}
+
+int FreecellSolver::score(const FreecellState &state) {
+  int total = state.double_deck ? 104 : 52;
+  int remaining = total - state.foundationCount();
+
+  // Next card each suit needs on its foundation
+  int next_rank[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+  for (const auto &pile : state.foundation) {
+    if (!pile.empty()) {
+      next_rank[static_cast<int>(pile.back().suit()) & 7] =
+          pile.full() ? 0 : static_cast<int>(pile.size() % 13) + 1;
+    }
+  }
+
+  // Cards sitting on the next card each suit needs; with two decks only
+  // the shallower copy counts
+  int buried[8] = {};
+  bool seen[8] = {};
+  for (int c = 0; c < state.num_cells; c++) {
+    PackedCard card = state.cells[c];
+    int suit = static_cast<int>(card.suit()) & 7;
+    if (card.isValid() && card.rankValue() == next_rank[suit])
+      seen[suit] = true;
+  }
+  int disorder = 0; // places where a column is not a proper build
+  int empty_columns = 0;
+  for (int t = 0; t < state.num_columns; t++) {
+    const auto &pile = state.tableau[t];
+    if (pile.empty()) {
+      empty_columns++;
+      continue;
+    }
+    for (size_t i = 0; i < pile.size(); i++) {
+      PackedCard card = pile[i];
+      int suit = static_cast<int>(card.suit()) & 7;
+      if (card.rankValue() == next_rank[suit]) {
+        int depth = static_cast<int>(pile.size() - 1 - i);
+        buried[suit] = seen[suit] ? std::min(buried[suit], depth) : depth;
+        seen[suit] = true;
+      }
+      if (i > 0 && !(cardlib::isOppositeColor(card, pile[i - 1]) &&
+                     cardlib::isOneRankBelow(card, pile[i - 1])))
+        disorder++;
+    }
+  }
+  int total_buried = 0;
+  for (int depth : buried)
+    total_buried += depth;
+
+  int used_cells = state.num_cells - state.emptyCells();
+  return remaining * 12 + total_buried * 2 + disorder * 3 + used_cells * 2 -
+         empty_columns * 4;
+}
+
+SolveResult FreecellSolver::solve(const FreecellState &start,
+                                  const SolverLimits &limits) {
+  SharedSearch shared;
+  shared.layout = start;
+  shared.table = &table_;
+  shared.limits = limits;
+  shared.start = std::chrono::steady_clock::now();
+  table_.clear();
+
+  SolveResult result;
+  auto finish = [&](SolveStatus status) {
+    result.status = status;
+    result.nodes = shared.nodes.load();
+    result.seconds = shared.elapsed();
+    return result;
+  };
+
+  FrontierEntry root{start, {}};
+  playSafeMoves(root.state, root.path);
+  table_.testAndSet(canonicalHash(root.state));
+  if (root.state.isWon()) {
+    result.moves = root.path;
+    return finish(SolveStatus::SOLVED);
+  }
+
+  // Grow a frontier breadth-first so every thread gets its own subtrees
+  std::deque<FrontierEntry> frontier;
+  frontier.push_back(root);
+  size_t target = threads_ > 1 ? threads_ * FRONTIER_PER_THREAD : 1;
+  uint64_t local = 0;
+  while (!frontier.empty() && frontier.size() < target) {
+    FrontierEntry entry = std::move(frontier.front());
+    frontier.pop_front();
+    if (!shared.tick(local))
+      return finish(SolveStatus::LIMIT_REACHED);
+
+    bool won = false;
+    expand(entry.state, table_,
+           [&](const FreecellState &child, const std::vector<Move> &played) {
+             FrontierEntry next{child, entry.path};
+             next.path.insert(next.path.end(), played.begin(), played.end());
+             if (child.isWon()) {
+               result.moves = std::move(next.path);
+               won = true;
+               return false;
+             }
+             frontier.push_back(std::move(next));
+             return true;
+           });
+    if (won)
+      return finish(SolveStatus::SOLVED);
+  }
+  if (frontier.empty())
+    return finish(SolveStatus::EXHAUSTED);
+
+  // Deal the frontier out best-first, round robin
+  std::vector<FrontierEntry> entries(frontier.begin(), frontier.end());
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const FrontierEntry &a, const FrontierEntry &b) {
+                     return score(a.state) < score(b.state);
+                   });
+  unsigned workers = std::min<unsigned>(threads_, entries.size());
+  std::vector<std::vector<FrontierEntry>> roots(workers);
+  for (size_t i = 0; i < entries.size(); i++)
+    roots[i % workers].push_back(std::move(entries[i]));
+
+  if (workers == 1) {
+    runWorker(shared, roots[0], 0);
+  } else {
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < workers; i++)
+      pool.emplace_back(runWorker, std::ref(shared), std::cref(roots[i]), i);
+    for (auto &thread : pool)
+      thread.join();
+  }
+
+  if (shared.solved) {
+    result.moves = std::move(shared.solution);
+    return finish(SolveStatus::SOLVED);
+  }
+  return finish(shared.limit_hit ? SolveStatus::LIMIT_REACHED
+                                 : SolveStatus::EXHAUSTED);
+}
+
+} // namespace rules
@@ -0,0 +1,43 @@
+#ifndef FREECELL_SOLVER_H
+#define FREECELL_SOLVER_H
+
+#include "freecell_rules.h"
+#include "solver_common.h"
+
+namespace rules {
+
+// Best-first FreeCell solver for classic and Double FreeCell.
+//
+// Multi-card moves are taken as single supermoves (FreecellState already
+// generates them within the free cell / empty column limit). Positions are
+// deduplicated on a canonical form, with free cells and columns sorted, in
+// a lock-free table shared by all worker threads. A short breadth-first
+// pass builds a frontier that is dealt out to the threads; each then runs
+// its own best-first search and the first win found is returned.
+//
+// Cards that are safe on the foundations are played automatically, and
+// foundation-to-tableau moves are not tried.
+class FreecellSolver {
+public:
+  // threads = 0 uses every core
+  explicit FreecellSolver(unsigned threads = 0, unsigned table_bits = 22);
+
+  SolveResult solve(const FreecellState &start, const SolverLimits &limits);
+
+  unsigned threads() const { return threads_; }
+
+  // Hash of the canonical form; equal for positions that differ only in
+  // the order of free cells, foundations or columns
+  static uint64_t canonicalHash(const FreecellState &state);
+
+  // Lower is closer to a win
+  static int score(const FreecellState &state);
+
+private:
+  unsigned threads_;
+  ConcurrentTranspositionTable table_;
+};
+
+} // namespace rules
+
+#endif // FREECELL_SOLVER_H
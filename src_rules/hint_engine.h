@@ -0,0 +1,225 @@
+#ifndef HINT_ENGINE_H
+#define HINT_ENGINE_H
+
+#include "solver_common.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rules {
+
+enum class HintStatus : uint8_t {
+  THINKING, // no answer yet for the position last passed to update()
+  WINNING,  // the move is on a line the solver proved wins
+  GUESS,    // no win found within the budget; the move looks most useful
+  LOST,     // the solver found no win from here; move is the best guess
+  NO_MOVES  // there is no legal move at all
+};
+
+struct Hint {
+  HintStatus status = HintStatus::THINKING;
+  Move move; // valid for WINNING, GUESS and LOST
+};
+
+// Background hint search for one game, shared by Klondike, FreeCell and
+// Spider: State is the game's rules state, Solver the matching solver.
+//
+// The game calls update() with the board after every change and current()
+// when the player asks for a hint; neither blocks. A worker thread owns
+// the solver. When a new position arrives it first diffs it against the
+// positions along the last winning line, so following a hint, or undoing
+// back onto the line, costs no search at all. Only a position that left
+// the line is searched again, and a search that is overtaken by another
+// update() is cancelled.
+//
+// Results are published as one 64-bit word tagged with the generation of
+// the position they answer, so a result for a board that has since
+// changed is never shown.
+template <typename State, typename Solver> class HintEngine {
+public:
+  // solver_args are passed to the Solver constructor
+  template <typename... SolverArgs>
+  explicit HintEngine(const SolverLimits &limits, SolverArgs &&...solver_args)
+      : solver_(std::forward<SolverArgs>(solver_args)...), limits_(limits),
+        generation_(0), snapshot_(pack(0, Hint())), cancel_(false),
+        pending_(false), posted_any_(false), stop_(false) {
+    limits_.cancel = &cancel_;
+    worker_ = std::thread(&HintEngine::run, this);
+  }
+
+  ~HintEngine() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+      cancel_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+  }
+
+  HintEngine(const HintEngine &) = delete;
+  HintEngine &operator=(const HintEngine &) = delete;
+
+  // Hands the worker a new position. Cheap when nothing changed, so it can
+  // be called on every redraw. Returns false if the position is the one
+  // already posted.
+  bool update(const State &state) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (posted_any_ && state == posted_)
+        return false;
+      posted_ = state;
+      posted_any_ = true;
+      pending_ = true;
+      generation_.store(generation_.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+      cancel_ = true;
+    }
+    wake_.notify_one();
+    return true;
+  }
+
+  // The hint for the position last passed to update(), or THINKING
+  Hint current() const {
+    uint64_t snapshot = snapshot_.load(std::memory_order_acquire);
+    if (static_cast<uint32_t>(snapshot) !=
+        generation_.load(std::memory_order_acquire))
+      return Hint();
+    return unpack(snapshot);
+  }
+
+private:
+  // generation in bits 0..31, then status, from, to and count a byte each
+  static uint64_t pack(uint32_t generation, const Hint &hint) {
+    return uint64_t(generation) | uint64_t(hint.status) << 32 |
+           uint64_t(hint.move.from) << 40 | uint64_t(hint.move.to) << 48 |
+           uint64_t(hint.move.count) << 56;
+  }
+
+  static Hint unpack(uint64_t snapshot) {
+    Hint hint;
+    hint.status = static_cast<HintStatus>((snapshot >> 32) & 0xFF);
+    hint.move = Move(static_cast<uint8_t>(snapshot >> 40),
+                     static_cast<uint8_t>(snapshot >> 48),
+                     static_cast<uint8_t>(snapshot >> 56));
+    return hint;
+  }
+
+  void run() {
+    for (;;) {
+      State state;
+      uint32_t generation;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this] { return pending_ || stop_; });
+        if (stop_)
+          return;
+        state = posted_;
+        generation = generation_.load(std::memory_order_relaxed);
+        pending_ = false;
+        cancel_ = false;
+      }
+
+      Hint hint;
+      if (!think(state, hint))
+        continue; // overtaken by a newer position
+      snapshot_.store(pack(generation, hint), std::memory_order_release);
+    }
+  }
+
+  // Returns false if the search was cancelled
+  bool think(const State &state, Hint &hint) {
+    for (size_t i = 0; i < line_moves_.size(); i++) {
+      if (line_states_[i] == state) {
+        hint.status = HintStatus::WINNING;
+        hint.move = line_moves_[i];
+        return true;
+      }
+    }
+
+    if (state.isWon()) {
+      hint.status = HintStatus::NO_MOVES;
+      return true;
+    }
+
+    SolveResult result = solver_.solve(state, limits_);
+    if (cancel_.load(std::memory_order_relaxed))
+      return false;
+
+    if (result.status == SolveStatus::SOLVED && !result.moves.empty()) {
+      line_moves_ = std::move(result.moves);
+      line_states_.clear();
+      line_states_.reserve(line_moves_.size());
+      State position = state;
+      for (const Move &solution_move : line_moves_) {
+        line_states_.push_back(position);
+        Move move = solution_move;
+        position.applyMove(move);
+      }
+      hint.status = HintStatus::WINNING;
+      hint.move = line_moves_.front();
+    } else if (result.status == SolveStatus::EXHAUSTED) {
+      // Not every solver's EXHAUSTED is a proof, so the game decides
+      // whether to say so or to show the guess
+      hint.status = bestGuess(state, hint.move) ? HintStatus::LOST
+                                                : HintStatus::NO_MOVES;
+    } else {
+      hint.status = bestGuess(state, hint.move) ? HintStatus::GUESS
+                                                : HintStatus::NO_MOVES;
+    }
+    return true;
+  }
+
+  // Without a proven line, prefer moves that put cards on the foundations
+  // or complete runs, then ones that turn a card over; otherwise the first
+  // legal move, which every game generates in a sensible order
+  static bool bestGuess(const State &state, Move &best) {
+    MoveList moves;
+    state.legalMoves(moves);
+    if (moves.empty())
+      return false;
+
+    int best_score = -1000;
+    int progress = state.foundationCount();
+    for (const Move &candidate : moves) {
+      State child = state;
+      Move move = candidate;
+      child.applyMove(move);
+      int score = 4 * (child.foundationCount() - progress);
+      if (move.flags & MOVE_FLIPPED)
+        score += 2;
+      if (score > best_score) {
+        best_score = score;
+        best = candidate;
+      }
+    }
+    return true;
+  }
+
+  Solver solver_;
+  SolverLimits limits_;
+
+  // Winning line from the last solved position: line_states_[i] is the
+  // position line_moves_[i] is played from
+  std::vector<State> line_states_;
+  std::vector<Move> line_moves_;
+
+  std::atomic<uint32_t> generation_;
+  std::atomic<uint64_t> snapshot_;
+  std::atomic<bool> cancel_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  State posted_;
+  bool pending_;
+  bool posted_any_;
+  bool stop_;
+  std::thread worker_;
+};
+
+} // namespace rules
+
+#endif // HINT_ENGINE_H
@@ -0,0 +1,296 @@
+#include "klondike_rules.h"
+#include <algorithm>
+
+namespace rules {
+
+void KlondikeState::deal(unsigned seed, bool draw_three_mode) {
+  deal(seed, draw_three_mode, zipDeckOrder());
+}
+
+void KlondikeState::deal(unsigned seed, bool draw_three_mode,
+                         const std::vector<Card> &deck_order) {
+  std::vector<Card> cards = shuffleDeck(deck_order, seed);
+
+  draw_three = draw_three_mode;
+  stock.clear();
+  waste.clear();
+  for (auto &pile : foundation)
+    pile.clear();
+  for (auto &pile : tableau)
+    pile.clear();
+
+  // Pile i gets i face-down cards and one face-up card
+  for (int i = 0; i < 7; i++) {
+    for (int j = 0; j <= i && !cards.empty(); j++) {
+      tableau[i].push(PackedCard(cards.back(), j == i));
+      cards.pop_back();
+    }
+  }
+
+  // Remaining cards go to the stock in draw order
+  while (!cards.empty()) {
+    stock.push(PackedCard(cards.back(), false));
+    cards.pop_back();
+  }
+}
+
+bool KlondikeState::canMoveToFoundation(PackedCard card,
+                                        int foundation_index) const {
+  const auto &pile = foundation[foundation_index];
+  if (pile.empty()) {
+    return card.rank() == Rank::ACE;
+  }
+  return cardlib::buildsOnFoundation(card, pile.back());
+}
+
+bool KlondikeState::canMoveToTableau(PackedCard card, int tableau_index) const {
+  const auto &pile = tableau[tableau_index];
+  if (pile.empty()) {
+    return card.rank() == Rank::KING;
+  }
+  PackedCard top = pile.back();
+  return cardlib::isOppositeColor(card, top) &&
+         cardlib::isOneRankBelow(card, top);
+}
+
+bool KlondikeState::isLegal(const Move &move) const {
+  if (move.from >= KLONDIKE_PILE_COUNT || move.to >= KLONDIKE_PILE_COUNT ||
+      move.count == 0)
+    return false;
+
+  // Turn cards from the stock
+  if (move.from == KLONDIKE_STOCK) {
+    size_t turn = draw_three ? std::min<size_t>(3, stock.size()) : 1;
+    return move.to == KLONDIKE_WASTE && !stock.empty() && move.count == turn;
+  }
+
+  // Turn the waste back over
+  if (move.to == KLONDIKE_STOCK) {
+    return move.from == KLONDIKE_WASTE && stock.empty() && !waste.empty() &&
+           move.count == waste.size();
+  }
+
+  if (move.to == KLONDIKE_WASTE)
+    return false;
+
+  // Find the card(s) being moved
+  PackedCard card;
+  if (move.from == KLONDIKE_WASTE) {
+    if (waste.empty() || move.count != 1)
+      return false;
+    card = waste.back();
+  } else if (move.from < KLONDIKE_TABLEAU) {
+    const auto &pile = foundation[move.from - KLONDIKE_FOUNDATION];
+    if (pile.empty() || move.count != 1)
+      return false;
+    card = pile.back();
+  } else {
+    const auto &pile = tableau[move.from - KLONDIKE_TABLEAU];
+    if (move.count > pile.size())
+      return false;
+    card = pile[pile.size() - move.count];
+    if (!card.faceUp())
+      return false;
+  }
+
+  if (move.to < KLONDIKE_TABLEAU) {
+    bool from_foundation = move.from >= KLONDIKE_FOUNDATION &&
+                           move.from < KLONDIKE_TABLEAU;
+    return move.count == 1 && !from_foundation &&
+           canMoveToFoundation(card, move.to - KLONDIKE_FOUNDATION);
+  }
+  return move.from != move.to &&
+         canMoveToTableau(card, move.to - KLONDIKE_TABLEAU);
+}
+
+void KlondikeState::applyMove(Move &move) {
+  move.flags = 0;
+
+  if (move.from == KLONDIKE_STOCK) {
+    // Turned cards keep their order, so the old stock top ends on top
+    for (size_t i = stock.size() - move.count; i < stock.size(); i++) {
+      waste.push(stock[i].withFaceUp(true));
+    }
+    for (int i = 0; i < move.count; i++)
+      stock.pop();
+    return;
+  }
+
+  if (move.to == KLONDIKE_STOCK) {
+    while (!waste.empty()) {
+      stock.push(waste.pop().withFaceUp(false));
+    }
+    return;
+  }
+
+  // Take the cards off the source
+  std::array<PackedCard, 13> moving;
+  size_t count = move.count;
+  if (move.from == KLONDIKE_WASTE) {
+    moving[0] = waste.pop();
+  } else if (move.from < KLONDIKE_TABLEAU) {
+    moving[0] = foundation[move.from - KLONDIKE_FOUNDATION].pop();
+  } else {
+    auto &pile = tableau[move.from - KLONDIKE_TABLEAU];
+    for (size_t i = 0; i < count; i++) {
+      moving[i] = pile[pile.size() - count + i];
+    }
+    for (size_t i = 0; i < count; i++)
+      pile.pop();
+    if (!pile.empty() && !pile.back().faceUp()) {
+      pile.back() = pile.back().withFaceUp(true);
+      move.flags |= MOVE_FLIPPED;
+    }
+  }
+
+  // And put them on the destination
+  if (move.to < KLONDIKE_TABLEAU) {
+    foundation[move.to - KLONDIKE_FOUNDATION].push(moving[0]);
+  } else {
+    auto &pile = tableau[move.to - KLONDIKE_TABLEAU];
+    for (size_t i = 0; i < count; i++) {
+      pile.push(moving[i]);
+    }
+  }
+}
+
+MoveDelta KlondikeState::applyRecorded(const Move &move) {
+  MoveDelta delta(move);
+  applyMove(delta.move);
+  return delta;
+}
+
+void KlondikeState::undoMove(const MoveDelta &delta) {
+  const Move &move = delta.move;
+
+  if (move.from == KLONDIKE_STOCK) {
+    size_t first = waste.size() - move.count;
+    for (size_t i = first; i < waste.size(); i++) {
+      stock.push(waste[i].withFaceUp(false));
+    }
+    for (int i = 0; i < move.count; i++)
+      waste.pop();
+    return;
+  }
+
+  // The waste is only turned over onto an empty stock
+  if (move.to == KLONDIKE_STOCK) {
+    while (!stock.empty()) {
+      waste.push(stock.pop().withFaceUp(true));
+    }
+    return;
+  }
+
+  std::array<PackedCard, 13> moving;
+  size_t count = move.count;
+  if (move.to < KLONDIKE_TABLEAU) {
+    moving[0] = foundation[move.to - KLONDIKE_FOUNDATION].pop();
+  } else {
+    auto &pile = tableau[move.to - KLONDIKE_TABLEAU];
+    for (size_t i = 0; i < count; i++) {
+      moving[i] = pile[pile.size() - count + i];
+    }
+    for (size_t i = 0; i < count; i++)
+      pile.pop();
+  }
+
+  if (move.from == KLONDIKE_WASTE) {
+    waste.push(moving[0]);
+  } else if (move.from < KLONDIKE_TABLEAU) {
+    foundation[move.from - KLONDIKE_FOUNDATION].push(moving[0]);
+  } else {
+    auto &pile = tableau[move.from - KLONDIKE_TABLEAU];
+    if (move.flags & MOVE_FLIPPED)
+      pile.back() = pile.back().withFaceUp(false);
+    for (size_t i = 0; i < count; i++) {
+      pile.push(moving[i]);
+    }
+  }
+}
+
+void KlondikeState::legalMoves(MoveList &moves) const {
+  moves.clear();
+
+  // Foundation moves first; solvers try them in generation order
+  if (!waste.empty()) {
+    for (int f = 0; f < 4; f++) {
+      if (canMoveToFoundation(waste.back(), f)) {
+        moves.push(Move(KLONDIKE_WASTE, KLONDIKE_FOUNDATION + f));
+        break;
+      }
+    }
+  }
+  for (int t = 0; t < 7; t++) {
+    if (tableau[t].empty())
+      continue;
+    for (int f = 0; f < 4; f++) {
+      if (canMoveToFoundation(tableau[t].back(), f)) {
+        moves.push(Move(KLONDIKE_TABLEAU + t, KLONDIKE_FOUNDATION + f));
+        break;
+      }
+    }
+  }
+
+  // Tableau to tableau, any face-up card and everything on it
+  for (int t = 0; t < 7; t++) {
+    const auto &pile = tableau[t];
+    for (size_t i = 0; i < pile.size(); i++) {
+      if (!pile[i].faceUp())
+        continue;
+      uint8_t count = static_cast<uint8_t>(pile.size() - i);
+      for (int d = 0; d < 7; d++) {
+        if (d != t && canMoveToTableau(pile[i], d)) {
+          moves.push(Move(KLONDIKE_TABLEAU + t, KLONDIKE_TABLEAU + d, count));
+        }
+      }
+    }
+  }
+
+  // Waste to tableau
+  if (!waste.empty()) {
+    for (int d = 0; d < 7; d++) {
+      if (canMoveToTableau(waste.back(), d)) {
+        moves.push(Move(KLONDIKE_WASTE, KLONDIKE_TABLEAU + d));
+      }
+    }
+  }
+
+  // Foundation back to tableau
+  for (int f = 0; f < 4; f++) {
+    if (foundation[f].empty())
+      continue;
+    for (int d = 0; d < 7; d++) {
+      if (canMoveToTableau(foundation[f].back(), d)) {
+        moves.push(Move(KLONDIKE_FOUNDATION + f, KLONDIKE_TABLEAU + d));
+      }
+    }
+  }
+
+  // Stock
+  if (!stock.empty()) {
+    uint8_t turn =
+        draw_three ? static_cast<uint8_t>(std::min<size_t>(3, stock.size()))
+                   : 1;
+    moves.push(Move(KLONDIKE_STOCK, KLONDIKE_WASTE, turn));
+  } else if (!waste.empty()) {
+    moves.push(Move(KLONDIKE_WASTE, KLONDIKE_STOCK,
+                    static_cast<uint8_t>(waste.size())));
+  }
+}
+
+int KlondikeState::foundationCount() const {
+  int total = 0;
+  for (const auto &pile : foundation)
+    total += static_cast<int>(pile.size());
+  return total;
+}
+
+bool KlondikeState::isWon() const { return foundationCount() == 52; }
+
+bool KlondikeState::operator==(const KlondikeState &other) const {
+  return draw_three == other.draw_three && stock == other.stock &&
+         waste == other.waste && foundation == other.foundation &&
+         tableau == other.tableau;
+}
+
+} // namespace rules
@@ -0,0 +1,54 @@
+#ifndef KLONDIKE_RULES_H
+#define KLONDIKE_RULES_H
+
+#include "rules_common.h"
+
+namespace rules {
+
+// Pile numbering matches SolitaireGame in src_klondike: stock, waste,
+// foundations, then the seven tableau columns.
+enum KlondikePile : uint8_t {
+  KLONDIKE_STOCK = 0,
+  KLONDIKE_WASTE = 1,
+  KLONDIKE_FOUNDATION = 2, // 2..5
+  KLONDIKE_TABLEAU = 6,    // 6..12
+  KLONDIKE_PILE_COUNT = 13
+};
+
+// Standard single-deck Klondike. Stock-to-waste is one move (from STOCK to
+// WASTE, count = cards turned); turning the waste back over is a move from
+// WASTE to STOCK. Redeals are unlimited, as in the game.
+struct KlondikeState {
+  FixedPile<24> stock;
+  FixedPile<24> waste;
+  std::array<FixedPile<13>, 4> foundation;
+  std::array<FixedPile<20>, 7> tableau; // 6 face down + K..A
+  bool draw_three;
+
+  KlondikeState() : draw_three(true) {}
+
+  // Deals exactly like SolitaireGame::initializeGame() + deal()
+  void deal(unsigned seed, bool draw_three_mode);
+  void deal(unsigned seed, bool draw_three_mode,
+            const std::vector<Card> &deck_order);
+
+  bool isLegal(const Move &move) const;
+  void applyMove(Move &move); // move must be legal
+  // applyMove, returning what undoMove() needs to take the move back
+  MoveDelta applyRecorded(const Move &move);
+  void undoMove(const MoveDelta &delta); // delta must be the last move played
+  void legalMoves(MoveList &moves) const;
+
+  bool canMoveToFoundation(PackedCard card, int foundation_index) const;
+  bool canMoveToTableau(PackedCard card, int tableau_index) const;
+
+  bool isWon() const;
+  int foundationCount() const;
+
+  bool operator==(const KlondikeState &other) const;
+  bool operator!=(const KlondikeState &other) const { return !(*this == other); }
+};
+
+} // namespace rules
+
+#endif // KLONDIKE_RULES_H
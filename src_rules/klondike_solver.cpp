@@ -0,0 +1,290 @@
+#include "klondike_solver.h"
+#include <algorithm>
+
+namespace rules {
+
+namespace {
+
+uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+} // namespace
+
+KlondikeSolver::KlondikeSolver(unsigned table_bits)
+    : table_(table_bits), budget_(nullptr), depth_cut_(false) {
+  ZobristGenerator gen(0x4B4C4F4E44494B45ULL);
+  for (auto &row : tableau_keys_)
+    for (auto &key : row)
+      key = gen.next();
+  for (auto &row : stock_keys_)
+    for (auto &key : row)
+      key = gen.next();
+  for (auto &row : waste_keys_)
+    for (auto &key : row)
+      key = gen.next();
+  for (auto &row : foundation_keys_)
+    for (auto &key : row)
+      key = gen.next();
+  draw_three_key_ = gen.next();
+}
+
+uint64_t KlondikeSolver::hash(const KlondikeState &state) const {
+  uint64_t h = state.draw_three ? draw_three_key_ : 0;
+
+  // Each column is hashed on its own, its cards by depth with the face-up
+  // bit, and the columns are summed, so the result does not depend on which
+  // column a pile sits in. XOR-ing the cards straight into h would lose
+  // which column a card is in: a 9 on one of two 10s at the same depth
+  // would hash the same on either.
+  uint64_t tableau = 0;
+  for (const auto &pile : state.tableau) {
+    if (pile.empty())
+      continue;
+    uint64_t column = 0;
+    for (size_t i = 0; i < pile.size(); i++)
+      column ^= tableau_keys_[i][pile[i].bits];
+    tableau += mix(column);
+  }
+  h ^= tableau;
+
+  // Foundations are fully described by the top rank of each suit
+  for (const auto &pile : state.foundation) {
+    if (!pile.empty()) {
+      PackedCard top = pile.back();
+      h ^= foundation_keys_[static_cast<int>(top.suit())][top.rankValue()];
+    }
+  }
+
+  for (size_t i = 0; i < state.stock.size(); i++)
+    h ^= stock_keys_[i][state.stock[i].id()];
+  for (size_t i = 0; i < state.waste.size(); i++)
+    h ^= waste_keys_[i][state.waste[i].id()];
+
+  return h;
+}
+
+int KlondikeSolver::foundationRank(const KlondikeState &state, Suit suit) {
+  for (const auto &pile : state.foundation) {
+    if (!pile.empty() && pile.back().suit() == suit)
+      return pile.back().rankValue();
+  }
+  return 0;
+}
+
+// A card is safe on the foundation once both opposite-colour foundations
+// hold the rank below it: the only cards that could be built on it are
+// already home, so it will never be needed in the tableau again.
+bool KlondikeSolver::isSafeOnFoundation(const KlondikeState &state,
+                                        PackedCard card) const {
+  int rank = card.rankValue();
+  if (rank <= 2)
+    return true;
+  int lowest_opposite;
+  if (card.isRed()) {
+    lowest_opposite = std::min(foundationRank(state, Suit::CLUBS),
+                               foundationRank(state, Suit::SPADES));
+  } else {
+    lowest_opposite = std::min(foundationRank(state, Suit::DIAMONDS),
+                               foundationRank(state, Suit::HEARTS));
+  }
+  return rank <= lowest_opposite + 1;
+}
+
+void KlondikeSolver::playSafeMoves(KlondikeState &state) {
+  bool moved = true;
+  while (moved) {
+    moved = false;
+    for (int source = KLONDIKE_WASTE; source < KLONDIKE_PILE_COUNT; source++) {
+      if (source >= KLONDIKE_FOUNDATION && source < KLONDIKE_TABLEAU)
+        continue;
+      const PackedCard card =
+          source == KLONDIKE_WASTE
+              ? (state.waste.empty() ? PackedCard() : state.waste.back())
+              : (state.tableau[source - KLONDIKE_TABLEAU].empty()
+                     ? PackedCard()
+                     : state.tableau[source - KLONDIKE_TABLEAU].back());
+      if (!card.isValid() || !isSafeOnFoundation(state, card))
+        continue;
+      for (int f = 0; f < 4; f++) {
+        if (state.canMoveToFoundation(card, f)) {
+          Move move(static_cast<uint8_t>(source),
+                    static_cast<uint8_t>(KLONDIKE_FOUNDATION + f));
+          state.applyMove(move);
+          path_.push_back(move);
+          moved = true;
+          break;
+        }
+      }
+    }
+  }
+}
+
+bool KlondikeSolver::worthTrying(const KlondikeState &state,
+                                 const Move &move) const {
+  bool from_foundation =
+      move.from >= KLONDIKE_FOUNDATION && move.from < KLONDIKE_TABLEAU;
+  if (from_foundation) {
+    // Safe cards never need to come back down
+    PackedCard card = state.foundation[move.from - KLONDIKE_FOUNDATION].back();
+    return !isSafeOnFoundation(state, card);
+  }
+
+  if (move.from < KLONDIKE_TABLEAU || move.to < KLONDIKE_TABLEAU)
+    return true;
+
+  // Tableau to tableau
+  const auto &source = state.tableau[move.from - KLONDIKE_TABLEAU];
+  const auto &target = state.tableau[move.to - KLONDIKE_TABLEAU];
+  size_t base = source.size() - move.count;
+
+  if (target.empty()) {
+    // A King already at the bottom gains nothing from moving, and all
+    // empty columns are the same position under the hash
+    if (base == 0)
+      return false;
+    for (int t = 0; t < move.to - KLONDIKE_TABLEAU; t++) {
+      if (state.tableau[t].empty())
+        return false;
+    }
+  }
+
+  if (base == 0 || !source[base - 1].faceUp())
+    return true; // empties the column or turns a card
+
+  // Splitting a face-up run only swaps it onto an equivalent card; it helps
+  // only if the card uncovered can then go up
+  PackedCard uncovered = source[base - 1];
+  for (int f = 0; f < 4; f++) {
+    if (state.canMoveToFoundation(uncovered, f))
+      return true;
+  }
+  return false;
+}
+
+SolveResult KlondikeSolver::solve(const KlondikeState &start,
+                                  const SolverLimits &limits) {
+  SearchBudget budget(limits);
+  budget_ = &budget;
+  depth_cut_ = false;
+  path_.clear();
+  table_.clear();
+
+  bool won = search(start);
+
+  SolveResult result;
+  if (won) {
+    result.status = SolveStatus::SOLVED;
+    result.moves = path_;
+  } else if (budget.exceeded() || depth_cut_) {
+    result.status = SolveStatus::LIMIT_REACHED;
+  } else {
+    result.status = SolveStatus::EXHAUSTED;
+  }
+  result.nodes = budget.nodes();
+  result.seconds = budget.elapsed();
+
+  budget_ = nullptr;
+  return result;
+}
+
+// Stacks up the moves worth trying from state, in rough order of promise:
+// foundation, moves that turn a card or empty a column, waste plays, the
+// rest, and the stock last
+void KlondikeSolver::pushFrame(const KlondikeState &state, size_t mark) {
+  MoveList moves;
+  state.legalMoves(moves);
+
+  int priority[MoveList::CAPACITY];
+  for (size_t i = 0; i < moves.size(); i++) {
+    const Move &move = moves[i];
+    if (move.to >= KLONDIKE_FOUNDATION && move.to < KLONDIKE_TABLEAU) {
+      priority[i] = 0;
+    } else if (move.from >= KLONDIKE_TABLEAU) {
+      const auto &source = state.tableau[move.from - KLONDIKE_TABLEAU];
+      size_t base = source.size() - move.count;
+      priority[i] = (base == 0 || !source[base - 1].faceUp()) ? 1 : 3;
+    } else if (move.from == KLONDIKE_WASTE && move.to >= KLONDIKE_TABLEAU) {
+      priority[i] = 2;
+    } else if (move.from == KLONDIKE_STOCK || move.to == KLONDIKE_STOCK) {
+      priority[i] = 4;
+    } else {
+      priority[i] = 3;
+    }
+  }
+
+  Frame frame;
+  frame.state = state;
+  frame.mark = mark;
+  frame.first = frame.next = pending_.size();
+  for (int level = 0; level <= 4; level++) {
+    for (size_t i = 0; i < moves.size(); i++) {
+      if (priority[i] == level && worthTrying(state, moves[i]))
+        pending_.push_back(moves[i]);
+    }
+  }
+  frame.end = pending_.size();
+  frames_.push_back(frame);
+}
+
+// Depth-first, with the positions on the way down kept in frames_
+bool KlondikeSolver::search(const KlondikeState &start) {
+  frames_.clear();
+  pending_.clear();
+  KlondikeState state = start;
+
+  for (;;) {
+    // Enter the position: play its safe moves, then unless it was seen
+    // before or is too deep, stack up its moves
+    bool entered = false;
+    if (budget_->tick()) {
+      size_t mark = path_.size();
+      playSafeMoves(state);
+      if (state.isWon())
+        return true;
+
+      size_t depth = frames_.size();
+      bool seen = table_.testAndSet(hash(state));
+      if (depth >= MAX_DEPTH)
+        depth_cut_ = true;
+      if (seen || depth >= MAX_DEPTH) {
+        path_.resize(mark);
+      } else {
+        pushFrame(state, mark);
+        entered = true;
+      }
+    }
+
+    // It failed; take back the move that led to it
+    if (!entered) {
+      if (frames_.empty())
+        return false;
+      path_.pop_back();
+      if (budget_->exceeded())
+        return false;
+    }
+
+    // Leave the positions that have no moves left to try
+    while (frames_.back().next == frames_.back().end) {
+      path_.resize(frames_.back().mark);
+      pending_.resize(frames_.back().first);
+      frames_.pop_back();
+      if (frames_.empty())
+        return false;
+      path_.pop_back();
+      if (budget_->exceeded())
+        return false;
+    }
+
+    // And try the next move of the deepest one left
+    Frame &frame = frames_.back();
+    Move move = pending_[frame.next++];
+    state = frame.state;
+    state.applyMove(move);
+    path_.push_back(move);
+  }
+}
+
+} // namespace rules
@@ -0,0 +1,66 @@
+#ifndef KLONDIKE_SOLVER_H
+#define KLONDIKE_SOLVER_H
+
+#include "klondike_rules.h"
+#include "solver_common.h"
+
+namespace rules {
+
+// Depth-first Klondike solver for draw-1 and draw-3.
+//
+// Positions are deduplicated with a Zobrist-hashed transposition table; the
+// tableau hash is order independent, so positions that differ only by which
+// column holds which pile are searched once. Cards that are safe to put on
+// a foundation (no card that could still be built on them is left in play)
+// are moved there without branching, and a handful of moves that can never
+// help are skipped, which is what makes draw-3 tractable.
+//
+// EXHAUSTED means no win exists within the moves the solver tries. The
+// skipped moves are dominated by the ones it keeps, so in practice this is
+// "unwinnable", but it is not a formal proof.
+class KlondikeSolver {
+public:
+  explicit KlondikeSolver(unsigned table_bits = 22);
+
+  SolveResult solve(const KlondikeState &start, const SolverLimits &limits);
+
+  // Order-independent Zobrist hash of a position
+  uint64_t hash(const KlondikeState &state) const;
+
+private:
+  // Search depth cap
+  static constexpr size_t MAX_DEPTH = 1000;
+
+  // A position being searched, on the heap rather than the call stack so
+  // the depth costs nothing on small thread stacks. Its moves are
+  // pending_[first, end), those from next on still to try.
+  struct Frame {
+    KlondikeState state;
+    size_t mark; // path_ length before its safe moves
+    size_t first, next, end;
+  };
+
+  bool search(const KlondikeState &start);
+  void pushFrame(const KlondikeState &state, size_t mark);
+  void playSafeMoves(KlondikeState &state);
+  bool isSafeOnFoundation(const KlondikeState &state, PackedCard card) const;
+  bool worthTrying(const KlondikeState &state, const Move &move) const;
+  static int foundationRank(const KlondikeState &state, Suit suit);
+
+  uint64_t tableau_keys_[20][256];
+  uint64_t stock_keys_[24][64];
+  uint64_t waste_keys_[24][64];
+  uint64_t foundation_keys_[8][16];
+  uint64_t draw_three_key_;
+
+  TranspositionTable table_;
+  SearchBudget *budget_;
+  std::vector<Move> path_;
+  std::vector<Frame> frames_;
+  std::vector<Move> pending_;
+  bool depth_cut_;
+};
+
+} // namespace rules
+
+#endif // KLONDIKE_SOLVER_H
@@ -0,0 +1,230 @@
+#include "pyramid_rules.h"
+
+namespace rules {
+
+void PyramidState::deal(unsigned seed) { deal(seed, zipDeckOrder()); }
+
+void PyramidState::deal(unsigned seed, const std::vector<Card> &deck_order) {
+  std::vector<Card> cards = shuffleDeck(deck_order, seed);
+
+  removed = 0;
+  redeals = 0;
+  stock.clear();
+  waste.clear();
+
+  // Row i gets i + 1 cards, all face up
+  for (int i = 0; i < PYRAMID_SIZE && !cards.empty(); i++) {
+    pyramid[i] = PackedCard(cards.back());
+    cards.pop_back();
+  }
+
+  while (!cards.empty()) {
+    stock.push(PackedCard(cards.back(), false));
+    cards.pop_back();
+  }
+}
+
+int PyramidState::rowOf(int position) {
+  int row = 0;
+  while ((row + 1) * (row + 2) / 2 <= position)
+    row++;
+  return row;
+}
+
+bool PyramidState::isExposed(int position) const {
+  if (removed & (1u << position))
+    return false;
+  int row = rowOf(position);
+  if (row == PYRAMID_ROWS - 1)
+    return true;
+  // Covered by (row + 1, j) and (row + 1, j + 1)
+  int below = position + row + 1;
+  uint32_t cover = (1u << below) | (1u << (below + 1));
+  return (removed & cover) == cover;
+}
+
+uint32_t PyramidState::exposedMask() const {
+  uint32_t mask = 0;
+  for (int i = 0; i < PYRAMID_SIZE; i++) {
+    if (isExposed(i))
+      mask |= 1u << i;
+  }
+  return mask;
+}
+
+bool PyramidState::cardAt(uint8_t source, PackedCard &card) const {
+  if (source < PYRAMID_SIZE) {
+    if (!isExposed(source))
+      return false;
+    card = pyramid[source];
+    return true;
+  }
+  if (source == PYRAMID_STOCK && !stock.empty()) {
+    card = stock.back();
+    return true;
+  }
+  if (source == PYRAMID_WASTE && !waste.empty()) {
+    card = waste.back();
+    return true;
+  }
+  return false;
+}
+
+void PyramidState::take(uint8_t source) {
+  if (source < PYRAMID_SIZE) {
+    removed |= 1u << source;
+  } else if (source == PYRAMID_STOCK) {
+    stock.pop();
+  } else {
+    waste.pop();
+  }
+}
+
+bool PyramidState::isLegal(const Move &move) const {
+  if (move.from == PYRAMID_STOCK && move.to == PYRAMID_WASTE &&
+      move.count == 1) {
+    return !stock.empty();
+  }
+  // Waste to stock is a redeal once the stock has run out; before that it
+  // can only be a pair of the two tops
+  if (move.from == PYRAMID_WASTE && move.to == PYRAMID_STOCK && stock.empty()) {
+    return !waste.empty() && redeals < MAX_REDEALS &&
+           move.count == waste.size();
+  }
+
+  PackedCard first;
+  if (!cardAt(move.from, first))
+    return false;
+
+  if (move.to == PYRAMID_FOUNDATION) {
+    return move.count == 1 && first.rank() == Rank::KING;
+  }
+
+  PackedCard second;
+  if (move.count != 2 || move.from == move.to || !cardAt(move.to, second))
+    return false;
+  return first.rankValue() + second.rankValue() == 13;
+}
+
+void PyramidState::applyMove(Move &move) {
+  move.flags = 0;
+
+  if (move.from == PYRAMID_STOCK && move.to == PYRAMID_WASTE &&
+      move.count == 1) {
+    waste.push(stock.pop().withFaceUp(true));
+    return;
+  }
+  if (move.from == PYRAMID_WASTE && move.to == PYRAMID_STOCK && stock.empty()) {
+    while (!waste.empty())
+      stock.push(waste.pop().withFaceUp(false));
+    redeals++;
+    return;
+  }
+
+  take(move.from);
+  if (move.to != PYRAMID_FOUNDATION)
+    take(move.to);
+}
+
+MoveDelta PyramidState::applyRecorded(const Move &move) {
+  // A pyramid card only needs its removed bit cleared to come back, but
+  // stock and waste cards are popped, so keep them: the source's card in
+  // bits 0..7 of detail and the partner's in bits 8..15. Turning the stock
+  // and redealing keep every card and leave detail at 0.
+  MoveDelta delta(move);
+  bool turn = move.from == PYRAMID_STOCK && move.to == PYRAMID_WASTE &&
+              move.count == 1;
+  bool redeal = move.from == PYRAMID_WASTE && move.to == PYRAMID_STOCK &&
+                stock.empty();
+  if (!turn && !redeal) {
+    PackedCard card;
+    if (move.from >= PYRAMID_STOCK && cardAt(move.from, card))
+      delta.detail |= card.bits;
+    if (move.to >= PYRAMID_STOCK && move.to != PYRAMID_FOUNDATION &&
+        cardAt(move.to, card))
+      delta.detail |= uint32_t(card.bits) << 8;
+  }
+  applyMove(delta.move);
+  return delta;
+}
+
+void PyramidState::undoMove(const MoveDelta &delta) {
+  const Move &move = delta.move;
+
+  if (move.from == PYRAMID_STOCK && move.to == PYRAMID_WASTE &&
+      move.count == 1) {
+    stock.push(waste.pop().withFaceUp(false));
+    return;
+  }
+  if (move.from == PYRAMID_WASTE && move.to == PYRAMID_STOCK &&
+      delta.detail == 0) {
+    while (!stock.empty())
+      waste.push(stock.pop().withFaceUp(true));
+    redeals--;
+    return;
+  }
+
+  restore(move.from, PackedCard(static_cast<uint8_t>(delta.detail)));
+  if (move.to != PYRAMID_FOUNDATION)
+    restore(move.to, PackedCard(static_cast<uint8_t>(delta.detail >> 8)));
+}
+
+void PyramidState::restore(uint8_t source, PackedCard card) {
+  if (source < PYRAMID_SIZE) {
+    removed &= ~(1u << source);
+  } else if (source == PYRAMID_STOCK) {
+    stock.push(card);
+  } else {
+    waste.push(card);
+  }
+}
+
+void PyramidState::legalMoves(MoveList &moves) const {
+  moves.clear();
+
+  // Everything that can be played: exposed pyramid cards plus the tops of
+  // the stock and waste
+  uint8_t sources[PYRAMID_SIZE + 2];
+  PackedCard cards[PYRAMID_SIZE + 2];
+  int count = 0;
+  for (uint8_t i = 0; i < PYRAMID_SIZE; i++) {
+    if (isExposed(i)) {
+      sources[count] = i;
+      cards[count++] = pyramid[i];
+    }
+  }
+  if (!stock.empty()) {
+    sources[count] = PYRAMID_STOCK;
+    cards[count++] = stock.back();
+  }
+  if (!waste.empty()) {
+    sources[count] = PYRAMID_WASTE;
+    cards[count++] = waste.back();
+  }
+
+  for (int a = 0; a < count; a++) {
+    if (cards[a].rank() == Rank::KING) {
+      moves.push(Move(sources[a], PYRAMID_FOUNDATION, 1));
+      continue;
+    }
+    for (int b = a + 1; b < count; b++) {
+      if (cards[a].rankValue() + cards[b].rankValue() == 13)
+        moves.push(Move(sources[a], sources[b], 2));
+    }
+  }
+
+  if (!stock.empty()) {
+    moves.push(Move(PYRAMID_STOCK, PYRAMID_WASTE, 1));
+  } else if (!waste.empty() && redeals < MAX_REDEALS) {
+    moves.push(Move(PYRAMID_WASTE, PYRAMID_STOCK,
+                    static_cast<uint8_t>(waste.size())));
+  }
+}
+
+bool PyramidState::operator==(const PyramidState &other) const {
+  return removed == other.removed && redeals == other.redeals &&
+         pyramid == other.pyramid && stock == other.stock &&
+         waste == other.waste;
+}
+
+} // namespace rules
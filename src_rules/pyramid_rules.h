@@ -0,0 +1,70 @@
+#ifndef PYRAMID_RULES_H
+#define PYRAMID_RULES_H
+
+#include "rules_common.h"
+
+namespace rules {
+
+// Pyramid positions are numbered row by row: row r, card j is
+// r * (r + 1) / 2 + j. The stock and waste tops can also be paired.
+// Moves:
+//   pair two cards        Move(a, b, 2)
+//   discard a King        Move(a, PYRAMID_FOUNDATION, 1)
+//   turn a stock card     Move(PYRAMID_STOCK, PYRAMID_WASTE, 1)
+//   redeal the waste      Move(PYRAMID_WASTE, PYRAMID_STOCK, waste size)
+enum PyramidPile : uint8_t {
+  PYRAMID_CARD = 0, // 0..27
+  PYRAMID_STOCK = 28,
+  PYRAMID_WASTE = 29,
+  PYRAMID_FOUNDATION = 30,
+  PYRAMID_PILE_COUNT = 31
+};
+
+constexpr int PYRAMID_SIZE = 28;
+constexpr int PYRAMID_ROWS = 7;
+constexpr uint32_t PYRAMID_ALL_REMOVED = (1u << PYRAMID_SIZE) - 1;
+
+// Standard single-deck Pyramid as played by PyramidGame: pairs summing to
+// 13 are removed, Kings go alone, and the waste may be turned over twice
+// (stock_redeals_).
+struct PyramidState {
+  static constexpr int MAX_REDEALS = 2;
+
+  std::array<PackedCard, PYRAMID_SIZE> pyramid;
+  uint32_t removed; // bit i set once pyramid card i is gone
+  FixedPile<24> stock;
+  FixedPile<24> waste;
+  uint8_t redeals;
+
+  PyramidState() : pyramid{}, removed(0), redeals(0) {}
+
+  // Deals exactly like PyramidGame::initializeGame() + deal()
+  void deal(unsigned seed);
+  void deal(unsigned seed, const std::vector<Card> &deck_order);
+
+  bool isLegal(const Move &move) const;
+  void applyMove(Move &move); // move must be legal
+  // applyMove, returning what undoMove() needs to take the move back
+  MoveDelta applyRecorded(const Move &move);
+  void undoMove(const MoveDelta &delta); // delta must be the last move played
+  void legalMoves(MoveList &moves) const;
+
+  static int rowOf(int position);
+  bool isExposed(int position) const;
+  // Bitmask of pyramid cards that can be played right now
+  uint32_t exposedMask() const;
+
+  bool isWon() const { return removed == PYRAMID_ALL_REMOVED; }
+
+  bool operator==(const PyramidState &other) const;
+  bool operator!=(const PyramidState &other) const { return !(*this == other); }
+
+private:
+  bool cardAt(uint8_t source, PackedCard &card) const;
+  void take(uint8_t source);
+  void restore(uint8_t source, PackedCard card);
+};
+
+} // namespace rules
+
+#endif // PYRAMID_RULES_H
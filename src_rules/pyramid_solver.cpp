@@ -0,0 +1,379 @@
+#include "pyramid_solver.h"
+#include <algorithm>
+#include <cmath>
+
+namespace rules {
+
+namespace {
+
+constexpr int KING = 13;
+
+// First talon card in a card mask; pyramid cards take bits 0..27
+constexpr int TALON_BIT = 32;
+
+// Pairs among 7 exposed cards and 2 talon tops, plus a stock move
+constexpr size_t MAX_MOVES = 40;
+
+uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Thresholds on PyramidDifficulty::score
+constexpr int EASY_SCORE_LIMIT = 10;
+constexpr int MEDIUM_SCORE_LIMIT = 30;
+
+} // namespace
+
+PyramidRating pyramidRating(const PyramidDifficulty &difficulty) {
+  switch (difficulty.status) {
+  case SolveStatus::EXHAUSTED:
+    return PyramidRating::UNWINNABLE;
+  case SolveStatus::LIMIT_REACHED:
+    return PyramidRating::UNKNOWN;
+  case SolveStatus::SOLVED:
+    break;
+  }
+  if (difficulty.score < EASY_SCORE_LIMIT)
+    return PyramidRating::EASY;
+  if (difficulty.score < MEDIUM_SCORE_LIMIT)
+    return PyramidRating::MEDIUM;
+  return PyramidRating::HARD;
+}
+
+const char *pyramidRatingName(PyramidRating rating) {
+  switch (rating) {
+  case PyramidRating::EASY:
+    return "Easy";
+  case PyramidRating::MEDIUM:
+    return "Medium";
+  case PyramidRating::HARD:
+    return "Hard";
+  case PyramidRating::UNWINNABLE:
+    return "Unwinnable";
+  case PyramidRating::UNKNOWN:
+    break;
+  }
+  return "Unknown";
+}
+
+PyramidSolver::PyramidSolver(unsigned table_bits)
+    : talon_size_(0), root_(), lost_(table_bits), budget_(nullptr) {}
+
+uint64_t PyramidSolver::Node::key() const {
+  return pyramid | static_cast<uint64_t>(talon) << 28 |
+         static_cast<uint64_t>(turned) << 52 |
+         static_cast<uint64_t>(redeals) << 57;
+}
+
+void PyramidSolver::load(const PyramidState &start) {
+  for (int i = 0; i < PYRAMID_SIZE; i++) {
+    pyramid_ranks_[i] = static_cast<uint8_t>(start.pyramid[i].rankValue());
+    int row = PyramidState::rowOf(i);
+    int below = i + row + 1;
+    cover_[i] = row == PYRAMID_ROWS - 1 ? 0 : (1u << below) | (1u << (below + 1));
+  }
+
+  // The waste holds the talon cards turned so far, oldest first, and the
+  // stock the rest with the next card on top; a redeal keeps that order
+  talon_size_ = 0;
+  for (size_t i = 0; i < start.waste.size(); i++)
+    talon_ranks_[talon_size_++] = static_cast<uint8_t>(start.waste[i].rankValue());
+  for (size_t i = start.stock.size(); i-- > 0;)
+    talon_ranks_[talon_size_++] = static_cast<uint8_t>(start.stock[i].rankValue());
+
+  // A card's cone is itself plus everything covering it, directly or not;
+  // cards in the same cone can never be exposed together
+  std::array<uint32_t, PYRAMID_SIZE> cone;
+  for (int i = PYRAMID_SIZE - 1; i >= 0; i--) {
+    cone[i] = 1u << i;
+    if (cover_[i]) {
+      int below = i + PyramidState::rowOf(i) + 1;
+      cone[i] |= cone[below] | cone[below + 1];
+    }
+  }
+
+  uint8_t ranks[64] = {};
+  for (int i = 0; i < PYRAMID_SIZE; i++)
+    ranks[i] = pyramid_ranks_[i];
+  for (int i = 0; i < talon_size_; i++)
+    ranks[TALON_BIT + i] = talon_ranks_[i];
+
+  partners_.fill(0);
+  groups_.fill(0);
+  for (int i = 0; i < 64; i++) {
+    if (!ranks[i] || ranks[i] == KING)
+      continue;
+    groups_[std::min<int>(ranks[i], KING - ranks[i]) - 1] |= 1ull << i;
+    for (int j = 0; j < 64; j++) {
+      if (ranks[i] + ranks[j] != KING)
+        continue;
+      if (i < PYRAMID_SIZE && j < PYRAMID_SIZE &&
+          ((cone[i] & (1u << j)) || (cone[j] & (1u << i))))
+        continue;
+      partners_[i] |= 1ull << j;
+    }
+  }
+
+  root_.pyramid = start.removed;
+  root_.talon = 0;
+  root_.turned = static_cast<uint8_t>(start.waste.size());
+  root_.redeals = start.redeals;
+}
+
+int PyramidSolver::wasteTop(const Node &node) const {
+  for (int i = node.turned - 1; i >= 0; i--) {
+    if (!(node.talon & (1u << i)))
+      return i;
+  }
+  return -1;
+}
+
+int PyramidSolver::stockTop(const Node &node) const {
+  for (int i = node.turned; i < talon_size_; i++) {
+    if (!(node.talon & (1u << i)))
+      return i;
+  }
+  return -1;
+}
+
+size_t PyramidSolver::expand(const Node &node, Move *moves,
+                             Node *children) const {
+  // Playable cards: exposed pyramid cards, then the stock and waste tops
+  uint8_t sources[PYRAMID_SIZE + 2];
+  uint8_t ranks[PYRAMID_SIZE + 2];
+  int count = 0;
+  for (int i = 0; i < PYRAMID_SIZE; i++) {
+    uint32_t bit = 1u << i;
+    if (!(node.pyramid & bit) && (node.pyramid & cover_[i]) == cover_[i]) {
+      sources[count] = static_cast<uint8_t>(i);
+      ranks[count++] = pyramid_ranks_[i];
+    }
+  }
+  int stock = stockTop(node);
+  int waste = wasteTop(node);
+  if (stock >= 0) {
+    sources[count] = PYRAMID_STOCK;
+    ranks[count++] = talon_ranks_[stock];
+  }
+  if (waste >= 0) {
+    sources[count] = PYRAMID_WASTE;
+    ranks[count++] = talon_ranks_[waste];
+  }
+
+  // Where a playable card sits in the cardsLeft() layout
+  auto bit = [&](uint8_t source) {
+    if (source < PYRAMID_SIZE)
+      return 1ull << source;
+    return 1ull << (TALON_BIT + (source == PYRAMID_STOCK ? stock : waste));
+  };
+  uint64_t left = cardsLeft(node);
+
+  auto remove = [&](Node &child, uint8_t source) {
+    if (source < PYRAMID_SIZE) {
+      child.pyramid |= 1u << source;
+    } else if (source == PYRAMID_STOCK) {
+      child.talon |= 1u << stock;
+    } else {
+      child.talon |= 1u << waste;
+      // The next waste card down becomes the top
+      child.turned = static_cast<uint8_t>(waste);
+      while (child.turned > 0 && (child.talon & (1u << (child.turned - 1))))
+        child.turned--;
+    }
+  };
+
+  // A King is never paired, so taking it off at once loses nothing
+  for (int a = 0; a < count; a++) {
+    if (ranks[a] == KING) {
+      moves[0] = Move(sources[a], PYRAMID_FOUNDATION, 1);
+      children[0] = node;
+      remove(children[0], sources[a]);
+      return 1;
+    }
+  }
+
+  size_t n = 0;
+  for (int a = 0; a < count; a++) {
+    for (int b = a + 1; b < count; b++) {
+      if (ranks[a] + ranks[b] != KING)
+        continue;
+      moves[n] = Move(sources[a], sources[b], 2);
+      children[n] = node;
+      remove(children[n], sources[a]);
+      remove(children[n], sources[b]);
+
+      // Two cards that are each other's last partner are never needed
+      // for anything else
+      uint64_t a_bit = bit(sources[a]), b_bit = bit(sources[b]);
+      if ((partners_[__builtin_ctzll(a_bit)] & left) == b_bit &&
+          (partners_[__builtin_ctzll(b_bit)] & left) == a_bit) {
+        moves[0] = moves[n];
+        children[0] = children[n];
+        return 1;
+      }
+      n++;
+    }
+  }
+
+  if (stock >= 0) {
+    moves[n] = Move(PYRAMID_STOCK, PYRAMID_WASTE, 1);
+    children[n] = node;
+    children[n].turned = static_cast<uint8_t>(stock + 1);
+    n++;
+  } else if (waste >= 0 && node.redeals < PyramidState::MAX_REDEALS) {
+    uint8_t waste_size = 0;
+    for (int i = 0; i < node.turned; i++)
+      waste_size += !(node.talon & (1u << i));
+    moves[n] = Move(PYRAMID_WASTE, PYRAMID_STOCK, waste_size);
+    children[n] = node;
+    children[n].turned = 0;
+    children[n].redeals++;
+    n++;
+  }
+  return n;
+}
+
+namespace {
+
+// True if every card in needy can be given its own partner from left,
+// where partners[i] lists the cards card i may pair with
+bool matchable(uint64_t needy, uint64_t left, const uint64_t *partners) {
+  if (!needy)
+    return true;
+  int card = __builtin_ctzll(needy);
+  uint64_t options = partners[card] & left;
+  while (options) {
+    int partner = __builtin_ctzll(options);
+    options &= options - 1;
+    uint64_t used = (1ull << card) | (1ull << partner);
+    if (matchable(needy & ~used, left & ~used, partners))
+      return true;
+  }
+  return false;
+}
+
+} // namespace
+
+uint64_t PyramidSolver::cardsLeft(const Node &node) const {
+  uint32_t talon = ~node.talon & ((1u << talon_size_) - 1);
+  return (~node.pyramid & PYRAMID_ALL_REMOVED) |
+         static_cast<uint64_t>(talon) << TALON_BIT;
+}
+
+bool PyramidSolver::hopeless(const Node &node) const {
+  uint64_t left = cardsLeft(node);
+  // Ranks r and 13 - r only pair with each other, so each such group can
+  // be matched on its own
+  uint64_t needy = left & PYRAMID_ALL_REMOVED;
+  for (uint64_t group : groups_) {
+    if (!matchable(needy & group, left & group, partners_.data()))
+      return true;
+  }
+  return false;
+}
+
+bool PyramidSolver::search(const Node &node) {
+  if (node.pyramid == PYRAMID_ALL_REMOVED)
+    return true;
+  // Pairs and Kings only ever take cards away and turns only move forward,
+  // so there are no cycles and a position seen before was lost
+  uint64_t key = mix(node.key());
+  if (lost_.contains(key) || !budget_->tick())
+    return false;
+
+  if (!hopeless(node)) {
+    Move moves[MAX_MOVES];
+    Node children[MAX_MOVES];
+    size_t n = expand(node, moves, children);
+    for (size_t i = 0; i < n; i++) {
+      path_.push_back(moves[i]);
+      if (search(children[i]))
+        return true;
+      path_.pop_back();
+      if (budget_->exceeded())
+        return false;
+    }
+  }
+  lost_.testAndSet(key);
+  return false;
+}
+
+SolveResult PyramidSolver::solve(const PyramidState &start,
+                                 const SolverLimits &limits) {
+  SearchBudget budget(limits);
+  budget_ = &budget;
+  lost_.clear();
+  path_.clear();
+  load(start);
+
+  SolveResult result;
+  if (search(root_)) {
+    result.status = SolveStatus::SOLVED;
+    result.moves = path_;
+  } else {
+    result.status = budget.exceeded() ? SolveStatus::LIMIT_REACHED
+                                      : SolveStatus::EXHAUSTED;
+  }
+
+  result.nodes = budget.nodes();
+  result.seconds = budget.elapsed();
+  budget_ = nullptr;
+  return result;
+}
+
+PyramidDifficulty PyramidSolver::rate(const PyramidState &start,
+                                      const SolverLimits &limits) {
+  PyramidDifficulty difficulty;
+  SolveResult result = solve(start, limits);
+  difficulty.status = result.status;
+  if (result.status != SolveStatus::SOLVED)
+    return difficulty;
+
+  // Judging the alternatives may need fresh search, under the same budget.
+  // Whatever the first search proved lost is still in the table.
+  SearchBudget budget(limits);
+  budget_ = &budget;
+
+  Move moves[MAX_MOVES];
+  Node children[MAX_MOVES];
+  unsigned choices = 0;
+  Node node = root_;
+  for (const Move &played : result.moves) {
+    size_t n = expand(node, moves, children);
+    size_t next = 0;
+    if (n > 1) {
+      difficulty.decisions++;
+      choices += static_cast<unsigned>(n);
+    }
+    for (size_t i = 0; i < n; i++) {
+      // The whole move: a stock+waste pair and a stock turn share from/to
+      if (moves[i] == played)
+        next = i;
+      else if (n > 1 && !search(children[i]))
+        difficulty.dead_ends++;
+      path_.clear();
+      if (budget.exceeded()) {
+        difficulty.status = SolveStatus::LIMIT_REACHED;
+        budget_ = nullptr;
+        return difficulty;
+      }
+    }
+    difficulty.moves.push_back(moves[next]);
+    node = children[next];
+  }
+  budget_ = nullptr;
+
+  if (difficulty.decisions > 0) {
+    difficulty.branching = static_cast<double>(choices) / difficulty.decisions;
+    // Share of the wrong turns that could have been taken which are fatal
+    difficulty.score = static_cast<int>(std::lround(
+        100.0 * difficulty.dead_ends / (choices - difficulty.decisions)));
+  } else {
+    difficulty.score = 0;
+  }
+  return difficulty;
+}
+
+} // namespace rules
@@ -0,0 +1,94 @@
+#ifndef PYRAMID_SOLVER_H
+#define PYRAMID_SOLVER_H
+
+#include "pyramid_rules.h"
+#include "solver_common.h"
+
+namespace rules {
+
+// How hard a deal is to win, measured along the solver's winning line
+struct PyramidDifficulty {
+  SolveStatus status = SolveStatus::LIMIT_REACHED;
+  // Positions on the line where there was more than one move to choose from
+  unsigned decisions = 0;
+  // Moves available at those positions that lead to an unwinnable game
+  unsigned dead_ends = 0;
+  // Average number of moves to choose from at a decision
+  double branching = 0.0;
+  // 0 (every move wins) .. 100 (almost every choice loses); -1 if the deal
+  // was not solved
+  int score = -1;
+  // The winning line the rating followed, move by move
+  std::vector<Move> moves;
+};
+
+enum class PyramidRating { EASY, MEDIUM, HARD, UNWINNABLE, UNKNOWN };
+
+PyramidRating pyramidRating(const PyramidDifficulty &difficulty);
+const char *pyramidRatingName(PyramidRating rating);
+
+// Pyramid solver: exact when given no budget, though a few deals in a
+// hundred need millions of positions and seconds to decide.
+//
+// A position is fully described by which of the 28 pyramid cards are gone,
+// which talon (stock + waste) cards are gone, how far the talon has been
+// turned and how many redeals are left, so it packs into one 64-bit key
+// and the search can remember every position it has proven lost. Kings,
+// and pairs of cards that have no other partner left, are always removed
+// as soon as they can be, since that never hurts.
+class PyramidSolver {
+public:
+  explicit PyramidSolver(unsigned table_bits = 22);
+
+  // EXHAUSTED means the deal is provably unwinnable
+  SolveResult solve(const PyramidState &start, const SolverLimits &limits);
+
+  // Solves the deal, then checks every alternative along the winning line
+  // to see how many of them would have lost. The limits apply to each of
+  // the two searches.
+  PyramidDifficulty rate(const PyramidState &start, const SolverLimits &limits);
+
+private:
+  // Compact position; talon cards are numbered in the order they are turned
+  struct Node {
+    uint32_t pyramid; // removed pyramid cards
+    uint32_t talon;   // removed talon cards
+    uint8_t turned;   // talon cards below this index are in the waste
+    uint8_t redeals;
+    uint64_t key() const;
+  };
+
+  void load(const PyramidState &start);
+  int wasteTop(const Node &node) const;
+  int stockTop(const Node &node) const;
+  // Moves from node, pairs first. Returns just one move when it is safe to
+  // play without looking at the others.
+  size_t expand(const Node &node, Move *moves, Node *children) const;
+  // Remaining cards, pyramid in bits 0..27 and talon from bit 32
+  uint64_t cardsLeft(const Node &node) const;
+  // True if the pyramid cards left cannot all be given a partner each
+  bool hopeless(const Node &node) const;
+  // Leaves the winning line in path_ when it returns true
+  bool search(const Node &node);
+
+  std::array<uint8_t, PYRAMID_SIZE> pyramid_ranks_;
+  std::array<uint32_t, PYRAMID_SIZE> cover_;
+  std::array<uint8_t, 24> talon_ranks_;
+  int talon_size_;
+  // Card masks in the cardsLeft() layout: what each card could ever pair
+  // with (pyramid cards never pair with a card that covers them or that
+  // they cover), and the cards of each rank pair, Ace and Queen, Two and
+  // Jack and so on
+  std::array<uint64_t, 64> partners_;
+  std::array<uint64_t, 6> groups_;
+  Node root_;
+
+  // Positions proven lost
+  TranspositionTable lost_;
+  SearchBudget *budget_;
+  std::vector<Move> path_;
+};
+
+} // namespace rules
+
+#endif // PYRAMID_SOLVER_H
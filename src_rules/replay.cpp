@@ -0,0 +1,178 @@
+#include "replay.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace rules {
+
+namespace {
+
+constexpr uint32_t TOKEN_UNDO = 0;
+constexpr uint32_t TOKEN_REDO = 1;
+
+uint32_t moveToken(const Move &move) {
+  return uint32_t(move.from & 0x1F) | uint32_t(move.to & 0x1F) << 5 |
+         uint32_t(move.count) << 10;
+}
+
+bool usesDeckOrder(DealVariant variant) {
+  return variant == DealVariant::KLONDIKE_DRAW1 ||
+         variant == DealVariant::KLONDIKE_DRAW3 ||
+         variant == DealVariant::FREECELL || variant == DealVariant::PYRAMID;
+}
+
+} // namespace
+
+const std::vector<Card> &replayDeckOrder(const ReplayHeader &header) {
+  static const std::vector<Card> zip_order = zipDeckOrder();
+  return header.deck_order.empty() ? zip_order : header.deck_order;
+}
+
+void Replay::start(const ReplayHeader &header) {
+  header_ = header;
+  stream_.clear();
+  step_count_ = 0;
+  generation_++;
+  recording_ = true;
+}
+
+void Replay::stop() {
+  stream_.clear();
+  step_count_ = 0;
+  generation_++;
+  recording_ = false;
+}
+
+void Replay::appendToken(uint32_t token) {
+  if (!recording_)
+    return;
+  do {
+    uint8_t byte = token & 0x7F;
+    token >>= 7;
+    stream_.push_back(token ? byte | 0x80 : byte);
+  } while (token);
+  step_count_++;
+}
+
+void Replay::appendMove(const Move &move) { appendToken(moveToken(move)); }
+void Replay::appendUndo() { appendToken(TOKEN_UNDO); }
+void Replay::appendRedo() { appendToken(TOKEN_REDO); }
+
+bool Replay::Reader::next(ReplayStep &step) {
+  uint32_t token = 0;
+  for (int shift = 0;; shift += 7) {
+    if (offset_ == stream_.size() || shift > 28)
+      return false;
+    uint8_t byte = stream_[offset_++];
+    token |= uint32_t(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+
+  if (token == TOKEN_UNDO) {
+    step.kind = ReplayStepKind::UNDO;
+  } else if (token == TOKEN_REDO) {
+    step.kind = ReplayStepKind::REDO;
+  } else {
+    if (token >> 18)
+      return false;
+    step.kind = ReplayStepKind::MOVE;
+    step.move = Move(token & 0x1F, (token >> 5) & 0x1F, token >> 10);
+  }
+  return true;
+}
+
+std::vector<uint8_t> encodeReplayHeader(const ReplayHeader &header) {
+  std::vector<uint8_t> data(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+  bool with_order = !header.deck_order.empty();
+  data.push_back(REPLAY_VERSION);
+  data.push_back(static_cast<uint8_t>(header.variant));
+  data.push_back((with_order ? REPLAY_FLAG_DECK_ORDER : 0) |
+                 (header.relaxed_rules ? REPLAY_FLAG_RELAXED : 0));
+  data.push_back(0);
+  for (int i = 0; i < 4; i++)
+    data.push_back(static_cast<uint8_t>(header.seed >> (8 * i)));
+  if (with_order) {
+    for (const Card &card : header.deck_order)
+      data.push_back(PackedCard(card).bits);
+  }
+  return data;
+}
+
+std::vector<uint8_t> Replay::encode() const {
+  std::vector<uint8_t> data = encodeReplayHeader(header_);
+  data.insert(data.end(), stream_.begin(), stream_.end());
+  return data;
+}
+
+bool Replay::decode(const uint8_t *data, size_t size) {
+  if (size < REPLAY_HEADER_SIZE || memcmp(data, REPLAY_MAGIC, 4) != 0 ||
+      data[4] != REPLAY_VERSION)
+    return false;
+
+  ReplayHeader header;
+  header.variant = static_cast<DealVariant>(data[5]);
+  if (std::find(std::begin(ALL_DEAL_VARIANTS), std::end(ALL_DEAL_VARIANTS),
+                header.variant) == std::end(ALL_DEAL_VARIANTS))
+    return false;
+  uint8_t flags = data[6];
+  header.relaxed_rules = (flags & REPLAY_FLAG_RELAXED) != 0;
+  header.seed = 0;
+  for (int i = 0; i < 4; i++)
+    header.seed |= unsigned(data[8 + i]) << (8 * i);
+
+  size_t offset = REPLAY_HEADER_SIZE;
+  if (flags & REPLAY_FLAG_DECK_ORDER) {
+    if (!usesDeckOrder(header.variant) ||
+        size < offset + REPLAY_DECK_ORDER_SIZE)
+      return false;
+    for (size_t i = 0; i < REPLAY_DECK_ORDER_SIZE; i++) {
+      PackedCard card(data[offset + i]);
+      if (!card.isValid())
+        return false;
+      header.deck_order.push_back(card.toCard());
+    }
+    offset += REPLAY_DECK_ORDER_SIZE;
+  }
+
+  std::vector<uint8_t> stream(data + offset, data + size);
+  size_t steps = 0;
+  Reader reader(stream);
+  ReplayStep step;
+  while (reader.next(step))
+    steps++;
+  if (!reader.atEnd())
+    return false;
+
+  header_ = std::move(header);
+  stream_ = std::move(stream);
+  step_count_ = steps;
+  generation_++;
+  recording_ = false;
+  return true;
+}
+
+bool Replay::save(const std::string &path) const {
+  std::vector<uint8_t> data = encode();
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+  return fclose(file) == 0 && ok;
+}
+
+bool Replay::load(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t got;
+  while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data.insert(data.end(), buffer, buffer + got);
+  fclose(file);
+  return decode(data.data(), data.size());
+}
+
+} // namespace rules
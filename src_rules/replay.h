@@ -0,0 +1,279 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Compact, deterministic game replays: the deal (variant and seed) plus
+// every move, undo and redo the player made.
+//
+// File layout, integers little-endian:
+//
+//   header, 12 bytes:
+//     char[4]  magic "SRPL"
+//     uint8    version (1)
+//     uint8    rules::DealVariant
+//     uint8    flags: bit 0 a deck order follows the header,
+//                     bit 1 Spider's relaxed rules
+//     uint8    reserved, 0
+//     uint32   seed
+//   deck order, only if flag bit 0 is set: 52 bytes, one PackedCard each,
+//     the deck's order before the shuffle. Without it the deal uses the
+//     order of the shipped cards.zip.
+//   the step stream, to the end of the file, one LEB128 varint per step:
+//     0 undo, 1 redo, otherwise from | to << 5 | count << 10
+//
+// A move takes two bytes, so a whole game is a few hundred. The stream
+// has no length and no trailer, so a recording can be written out by
+// appending to it.
+
+#include "deal_solver.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace rules {
+
+constexpr char REPLAY_MAGIC[4] = {'S', 'R', 'P', 'L'};
+constexpr uint8_t REPLAY_VERSION = 1;
+constexpr size_t REPLAY_HEADER_SIZE = 12;
+constexpr uint8_t REPLAY_FLAG_DECK_ORDER = 0x01;
+constexpr uint8_t REPLAY_FLAG_RELAXED = 0x02;
+constexpr size_t REPLAY_DECK_ORDER_SIZE = 52;
+
+struct ReplayHeader {
+  DealVariant variant = DealVariant::KLONDIKE_DRAW3;
+  unsigned seed = 0;
+  bool relaxed_rules = false;
+  std::vector<Card> deck_order; // empty for the shipped cards.zip order
+};
+
+enum class ReplayStepKind : uint8_t { MOVE, UNDO, REDO };
+
+struct ReplayStep {
+  ReplayStepKind kind = ReplayStepKind::MOVE;
+  Move move; // for MOVE
+};
+
+class Replay {
+public:
+  Replay() : generation_(0), recording_(false) {}
+
+  // Starts a new recording of the deal described by header
+  void start(const ReplayHeader &header);
+  // Stops recording and drops the steps; the board no longer follows
+  // from the deal
+  void stop();
+  bool recording() const { return recording_; }
+  // Changes whenever the replay is started, stopped or decoded, so a
+  // writer can tell a new stream from one that has only grown
+  uint32_t generation() const { return generation_; }
+
+  const ReplayHeader &header() const { return header_; }
+  // The encoded step stream, and how many steps it holds
+  const std::vector<uint8_t> &stream() const { return stream_; }
+  size_t stepCount() const { return step_count_; }
+
+  // Ignored unless recording
+  void appendMove(const Move &move);
+  void appendUndo();
+  void appendRedo();
+
+  // Whole file, header and stream
+  std::vector<uint8_t> encode() const;
+  // Replaces this replay with a decoded one; false if the data is not a
+  // valid version 1 replay. A decoded replay is not recording.
+  bool decode(const uint8_t *data, size_t size);
+
+  bool save(const std::string &path) const;
+  bool load(const std::string &path);
+
+  // Decodes stream() a step at a time
+  class Reader {
+  public:
+    explicit Reader(const std::vector<uint8_t> &stream)
+        : stream_(stream), offset_(0) {}
+    // False at the end of the stream or on a malformed step
+    bool next(ReplayStep &step);
+    bool atEnd() const { return offset_ == stream_.size(); }
+
+  private:
+    const std::vector<uint8_t> &stream_;
+    size_t offset_;
+  };
+
+private:
+  void appendToken(uint32_t token);
+
+  ReplayHeader header_;
+  std::vector<uint8_t> stream_;
+  size_t step_count_ = 0;
+  uint32_t generation_;
+  bool recording_;
+};
+
+// Encodes the header on its own, for writers that stream steps after it
+std::vector<uint8_t> encodeReplayHeader(const ReplayHeader &header);
+
+// The deck order a replay's deal shuffles
+const std::vector<Card> &replayDeckOrder(const ReplayHeader &header);
+
+// The position a replay starts from. False if the variant is for another
+// game. Inline so each game links only its own rules.
+inline bool dealReplayStart(const ReplayHeader &header, KlondikeState &state) {
+  if (header.variant != DealVariant::KLONDIKE_DRAW1 &&
+      header.variant != DealVariant::KLONDIKE_DRAW3)
+    return false;
+  state.deal(header.seed, header.variant == DealVariant::KLONDIKE_DRAW3,
+             replayDeckOrder(header));
+  return true;
+}
+
+inline bool dealReplayStart(const ReplayHeader &header, FreecellState &state) {
+  if (header.variant == DealVariant::DOUBLE_FREECELL) {
+    state.deal(header.seed, true);
+    return true;
+  }
+  if (header.variant != DealVariant::FREECELL)
+    return false;
+  state.deal(header.seed, replayDeckOrder(header));
+  return true;
+}
+
+inline bool dealReplayStart(const ReplayHeader &header, SpiderState &state) {
+  int suits;
+  switch (header.variant) {
+  case DealVariant::SPIDER_1SUIT:
+    suits = 1;
+    break;
+  case DealVariant::SPIDER_2SUIT:
+    suits = 2;
+    break;
+  case DealVariant::SPIDER_4SUIT:
+    suits = 4;
+    break;
+  default:
+    return false;
+  }
+  state.deal(header.seed, suits, header.relaxed_rules);
+  return true;
+}
+
+inline bool dealReplayStart(const ReplayHeader &header, PyramidState &state) {
+  if (header.variant != DealVariant::PYRAMID)
+    return false;
+  state.deal(header.seed, replayDeckOrder(header));
+  return true;
+}
+
+// A replay decoded for playback, for any rules state with isLegal,
+// applyRecorded and undoMove.
+//
+// Loading plays the whole replay through once, checking every step, and
+// keeps a copy of the board every KEYFRAME_INTERVAL steps. seek() then
+// finds the nearest keyframe before the wanted step by binary search and
+// plays at most KEYFRAME_INTERVAL - 1 steps from there: O(log n), however
+// long the game. Undos are resolved at load time into the move they take
+// back, so stepping in either direction needs no undo stack.
+template <typename State> class ReplayPlayer {
+public:
+  static constexpr size_t KEYFRAME_INTERVAL = 64;
+
+  // False, leaving the player empty, if the replay is for another game or
+  // any step is illegal where it is played
+  bool load(const Replay &replay) {
+    steps_.clear();
+    keyframes_.clear();
+
+    State state;
+    if (!dealReplayStart(replay.header(), state))
+      return false;
+
+    std::vector<MoveDelta> undo_stack;
+    std::vector<MoveDelta> redo_stack;
+    Replay::Reader reader(replay.stream());
+    ReplayStep step;
+    keyframes_.push_back(Keyframe{0, state});
+
+    while (reader.next(step)) {
+      Step resolved;
+      if (step.kind == ReplayStepKind::MOVE) {
+        if (!state.isLegal(step.move))
+          return fail();
+        resolved.delta = state.applyRecorded(step.move);
+        resolved.backwards = false;
+        undo_stack.push_back(resolved.delta);
+        redo_stack.clear();
+      } else if (step.kind == ReplayStepKind::UNDO) {
+        if (undo_stack.empty())
+          return fail();
+        resolved.delta = undo_stack.back();
+        resolved.backwards = true;
+        undo_stack.pop_back();
+        state.undoMove(resolved.delta);
+        redo_stack.push_back(resolved.delta);
+      } else {
+        if (redo_stack.empty())
+          return fail();
+        resolved.delta = state.applyRecorded(redo_stack.back().move);
+        resolved.backwards = false;
+        redo_stack.pop_back();
+        undo_stack.push_back(resolved.delta);
+      }
+      steps_.push_back(resolved);
+      if (steps_.size() % KEYFRAME_INTERVAL == 0)
+        keyframes_.push_back(Keyframe{steps_.size(), state});
+    }
+    if (!reader.atEnd())
+      return fail();
+    return true;
+  }
+
+  bool loaded() const { return !keyframes_.empty(); }
+  // Number of steps; positions run from 0 (the deal) to length()
+  size_t length() const { return steps_.size(); }
+
+  // The board after the first `position` steps
+  bool seek(size_t position, State &state) const {
+    if (keyframes_.empty() || position > steps_.size())
+      return false;
+    auto after = std::upper_bound(
+        keyframes_.begin(), keyframes_.end(), position,
+        [](size_t wanted, const Keyframe &key) {
+          return wanted < key.position;
+        });
+    const Keyframe &key = *(after - 1);
+    state = key.state;
+    for (size_t i = key.position; i < position; i++)
+      play(steps_[i], state);
+    return true;
+  }
+
+private:
+  struct Step {
+    MoveDelta delta;
+    bool backwards;
+  };
+  struct Keyframe {
+    size_t position;
+    State state;
+  };
+
+  static void play(const Step &step, State &state) {
+    if (step.backwards) {
+      state.undoMove(step.delta);
+    } else {
+      state.applyRecorded(step.delta.move);
+    }
+  }
+
+  bool fail() {
+    steps_.clear();
+    keyframes_.clear();
+    return false;
+  }
+
+  std::vector<Step> steps_;
+  std::vector<Keyframe> keyframes_;
+};
+
+} // namespace rules
+
+#endif // REPLAY_H
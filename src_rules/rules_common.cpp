@@ -0,0 +1,85 @@
+#include "rules_common.h"
+#include <algorithm>
+#include <random>
+
+namespace rules {
+
+std::vector<Card> zipDeckOrder() {
+  // File names sort as 10, 2..9, ace, jack, king, queen; within a rank the
+  // suits sort alphabetically, which happens to match the Suit enum order.
+  static const Rank ranks[] = {Rank::TEN,   Rank::TWO,  Rank::THREE, Rank::FOUR,
+                               Rank::FIVE,  Rank::SIX,  Rank::SEVEN, Rank::EIGHT,
+                               Rank::NINE,  Rank::ACE,  Rank::JACK,  Rank::KING,
+                               Rank::QUEEN};
+  static const Suit suits[] = {Suit::CLUBS, Suit::DIAMONDS, Suit::HEARTS,
+                               Suit::SPADES};
+
+  std::vector<Card> cards;
+  cards.reserve(52);
+  for (Rank rank : ranks) {
+    for (Suit suit : suits) {
+      cards.emplace_back(suit, rank);
+    }
+  }
+  return cards;
+}
+
+std::vector<Card> standardDeckOrder() {
+  return standardDeckOrder(
+      {Suit::CLUBS, Suit::DIAMONDS, Suit::HEARTS, Suit::SPADES});
+}
+
+std::vector<Card> standardDeckOrder(const std::vector<Suit> &allowed_suits) {
+  static const Suit suits[] = {Suit::CLUBS, Suit::DIAMONDS, Suit::HEARTS,
+                               Suit::SPADES};
+
+  // Build the full deck and filter it, like Deck::filterCards does
+  std::vector<Card> cards;
+  for (Suit suit : suits) {
+    if (std::find(allowed_suits.begin(), allowed_suits.end(), suit) ==
+        allowed_suits.end())
+      continue;
+    for (int r = 1; r <= 13; r++) {
+      cards.emplace_back(suit, static_cast<Rank>(r));
+    }
+  }
+  return cards;
+}
+
+bool sameDeckOrder(const std::vector<Card> &a, const std::vector<Card> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].suit != b[i].suit || a[i].rank != b[i].rank)
+      return false;
+  }
+  return true;
+}
+
+std::vector<Card> shuffleDeck(std::vector<Card> cards, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::shuffle(cards.begin(), cards.end(), gen);
+  return cards;
+}
+
+std::vector<Card> shuffleMultiDeck(const std::vector<std::vector<Card>> &decks,
+                                   unsigned seed) {
+  std::mt19937 gen(seed);
+
+  // Each deck is shuffled on its own first (with a fresh generator)
+  std::vector<Card> all_cards;
+  for (const auto &deck : decks) {
+    auto shuffled = shuffleDeck(deck, seed);
+    all_cards.insert(all_cards.end(), shuffled.begin(), shuffled.end());
+  }
+
+  // MultiDeck skips the combined shuffle for a single deck
+  if (decks.size() < 2) {
+    return all_cards;
+  }
+
+  std::shuffle(all_cards.begin(), all_cards.end(), gen);
+  return all_cards;
+}
+
+} // namespace rules
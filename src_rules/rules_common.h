@@ -0,0 +1,126 @@
+#ifndef RULES_COMMON_H
+#define RULES_COMMON_H
+
+// Headless rules engine shared by the solvers, tools and benchmarks.
+//
+// Nothing in src_rules depends on GTK, Cairo, OpenGL or libzip; only the
+// header-only parts of cardlib.h (Card, PackedCard, FixedPile) are used.
+// Deals are reproduced exactly as the games produce them for a given seed, so
+// a seed analysed here is the same deal a player gets from "Enter Seed".
+
+#include "cardlib.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace rules {
+
+using cardlib::Card;
+using cardlib::FixedPile;
+using cardlib::PackedCard;
+using cardlib::Rank;
+using cardlib::Suit;
+
+// ============================================================================
+// MOVES
+// ============================================================================
+
+enum MoveFlags : uint8_t {
+  MOVE_FLIPPED = 0x01,       // a face-down card was turned up by the move
+  MOVE_COMPLETED_RUN = 0x02, // Spider: a K..A run was removed afterwards
+};
+
+// A move in one of the games. Pile numbering is per game (see the
+// *_PILE constants in each game's header). count is the number of cards
+// moved; flags are filled in by applyMove so the move can be reported or
+// reverted.
+struct Move {
+  uint8_t from;
+  uint8_t to;
+  uint8_t count;
+  uint8_t flags;
+
+  Move() : from(0), to(0), count(0), flags(0) {}
+  Move(uint8_t f, uint8_t t, uint8_t c = 1) : from(f), to(t), count(c), flags(0) {}
+
+  bool operator==(const Move &other) const {
+    return from == other.from && to == other.to && count == other.count;
+  }
+  bool operator!=(const Move &other) const { return !(*this == other); }
+};
+
+// A move as played, with whatever it destroyed that the flags can't hold,
+// so it can be taken back without keeping a copy of the board. detail is
+// per game (see each state's undoMove); Klondike and FreeCell don't need
+// it. Eight bytes, so a long history is one small flat array.
+struct MoveDelta {
+  Move move;       // flags as set by applyMove
+  uint32_t detail;
+
+  MoveDelta() : detail(0) {}
+  MoveDelta(const Move &m, uint32_t d = 0) : move(m), detail(d) {}
+};
+
+static_assert(sizeof(MoveDelta) == 8, "MoveDelta must stay eight bytes");
+
+// Fixed-capacity move list so move generation never allocates
+class MoveList {
+public:
+  static constexpr size_t CAPACITY = 256;
+
+  MoveList() : count_(0) {}
+
+  void clear() { count_ = 0; }
+  void push(const Move &move) {
+    if (count_ < CAPACITY)
+      moves_[count_++] = move;
+  }
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  const Move &operator[](size_t i) const { return moves_[i]; }
+  Move &operator[](size_t i) { return moves_[i]; }
+  const Move *begin() const { return moves_.data(); }
+  const Move *end() const { return moves_.data() + count_; }
+  Move *begin() { return moves_.data(); }
+  Move *end() { return moves_.data() + count_; }
+
+private:
+  std::array<Move, CAPACITY> moves_;
+  size_t count_;
+};
+
+// ============================================================================
+// DECK ORDER AND SHUFFLING
+// ============================================================================
+//
+// The games shuffle a cardlib::Deck whose initial order depends on how it
+// was built, so the same seed only gives the same deal if the starting
+// order matches:
+//   - Deck(zip_path) keeps the zip's entry order. The shipped cards.zip is
+//     sorted by file name ("10_of_clubs.png", "2_of_clubs.png", ...).
+//   - Deck() (and anything that calls reset()) uses clubs, diamonds,
+//     hearts, spades, each Ace to King.
+
+// Order of a Deck loaded from the shipped cards.zip, jokers removed
+std::vector<Card> zipDeckOrder();
+
+// Order of a default-constructed Deck, optionally limited to some suits
+std::vector<Card> standardDeckOrder();
+std::vector<Card> standardDeckOrder(const std::vector<Suit> &suits);
+
+// True if the two orders hold the same cards in the same places; seeds
+// analysed offline in one order are only valid for a deck in that order
+bool sameDeckOrder(const std::vector<Card> &a, const std::vector<Card> &b);
+
+// Same result as cardlib::Deck::shuffle(seed) on a deck in this order.
+// Deck::drawCard() pops from the back of the returned vector.
+std::vector<Card> shuffleDeck(std::vector<Card> cards, unsigned seed);
+
+// Same result as cardlib::MultiDeck::shuffle(seed) on these decks; all
+// cards end up in one vector that is drawn from the back.
+std::vector<Card> shuffleMultiDeck(const std::vector<std::vector<Card>> &decks,
+                                   unsigned seed);
+
+} // namespace rules
+
+#endif // RULES_COMMON_H
@@ -0,0 +1,198 @@
+#include "seed_index.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rules {
+
+namespace {
+
+uint64_t readLE(const uint8_t *bytes, int count) {
+  uint64_t value = 0;
+  for (int i = 0; i < count; i++)
+    value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  return value;
+}
+
+} // namespace
+
+SeedIndex::SeedIndex()
+    : data_(nullptr), size_(0),
+#ifdef _WIN32
+      file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr),
+#else
+      fd_(-1),
+#endif
+      section_count_(0), random_(std::random_device{}()) {
+}
+
+SeedIndex::~SeedIndex() { close(); }
+
+bool SeedIndex::open(const std::string &path) {
+  close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  file_handle_ = file;
+  mapping_handle_ = mapping;
+  data_ = static_cast<const uint8_t *>(view);
+  size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                    MAP_SHARED, fd, 0);
+  if (view == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+  fd_ = fd;
+  data_ = static_cast<const uint8_t *>(view);
+  size_ = static_cast<size_t>(info.st_size);
+#endif
+
+  // Check the header and that every bitmap lies inside the file
+  bool valid = size_ >= SEED_INDEX_HEADER_SIZE &&
+               memcmp(data_, SEED_INDEX_MAGIC, 4) == 0 &&
+               readLE(data_ + 4, 2) == SEED_INDEX_VERSION;
+  uint64_t sections = valid ? readLE(data_ + 6, 2) : 0;
+  valid = valid && sections <= MAX_SECTIONS &&
+          size_ >= SEED_INDEX_HEADER_SIZE + sections * SEED_INDEX_SECTION_SIZE;
+  for (uint64_t i = 0; valid && i < sections; i++) {
+    const uint8_t *entry =
+        data_ + SEED_INDEX_HEADER_SIZE + i * SEED_INDEX_SECTION_SIZE;
+    Section &section = sections_[i];
+    section.first = static_cast<uint32_t>(readLE(entry + 4, 4));
+    section.count = readLE(entry + 8, 8);
+    section.winnable = readLE(entry + 16, 8);
+    uint64_t offset = readLE(entry + 24, 8);
+    uint64_t bytes = (section.count + 7) / 8;
+    valid = section.count <= (uint64_t(1) << 32) - section.first &&
+            offset <= size_ &&
+            bytes <= size_ - offset && section.winnable <= section.count;
+    section.bits = data_ + offset;
+    variants_[i] = static_cast<DealVariant>(entry[0]);
+  }
+  if (!valid) {
+    close();
+    return false;
+  }
+  section_count_ = static_cast<int>(sections);
+  return true;
+}
+
+void SeedIndex::close() {
+  if (data_) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    CloseHandle(static_cast<HANDLE>(file_handle_));
+    mapping_handle_ = nullptr;
+    file_handle_ = INVALID_HANDLE_VALUE;
+#else
+    munmap(const_cast<uint8_t *>(data_), size_);
+    ::close(fd_);
+    fd_ = -1;
+#endif
+  }
+  data_ = nullptr;
+  size_ = 0;
+  section_count_ = 0;
+}
+
+const SeedIndex::Section *SeedIndex::find(DealVariant variant) const {
+  for (int i = 0; i < section_count_; i++) {
+    if (variants_[i] == variant)
+      return &sections_[i];
+  }
+  return nullptr;
+}
+
+bool SeedIndex::has(DealVariant variant) const {
+  const Section *section = find(variant);
+  return section && section->winnable > 0;
+}
+
+uint64_t SeedIndex::winnableCount(DealVariant variant) const {
+  const Section *section = find(variant);
+  return section ? section->winnable : 0;
+}
+
+bool SeedIndex::isWinnable(DealVariant variant, unsigned seed) const {
+  const Section *section = find(variant);
+  if (!section || seed < section->first)
+    return false;
+  uint64_t index = static_cast<uint64_t>(seed) - section->first;
+  return index < section->count && testBit(*section, index);
+}
+
+bool SeedIndex::pickSeed(DealVariant variant, unsigned &seed) {
+  const Section *section = find(variant);
+  if (!section || section->winnable == 0)
+    return false;
+
+  std::uniform_int_distribution<uint64_t> position(0, section->count - 1);
+  uint64_t index = 0;
+  for (int attempt = 0; attempt < PICK_ATTEMPTS; attempt++) {
+    index = position(random_);
+    if (testBit(*section, index)) {
+      seed = static_cast<unsigned>(section->first + index);
+      return true;
+    }
+  }
+
+  // Sparse bitmap: take the next winnable seed after the last miss,
+  // skipping empty bytes whole
+  for (uint64_t step = 0; step <= section->count + 8; step++) {
+    if ((index & 7) == 0 && index + 8 <= section->count &&
+        section->bits[index >> 3] == 0) {
+      step += 7;
+      index += 8;
+    } else {
+      if (testBit(*section, index)) {
+        seed = static_cast<unsigned>(section->first + index);
+        return true;
+      }
+      index++;
+    }
+    if (index >= section->count)
+      index = 0;
+  }
+  return false;
+}
+
+} // namespace rules
@@ -0,0 +1,99 @@
+#ifndef SEED_INDEX_H
+#define SEED_INDEX_H
+
+// Read-only, memory-mapped index of seeds known to be winnable.
+//
+// The file is built offline by build_seed_index from solitaire_analyze
+// output (make winnable-seeds runs both) and shipped next to cards.zip. It is mapped, not parsed: opening
+// only checks the header, and lookups read the mapping directly.
+//
+// Layout, all integers little-endian:
+//
+//   header, 16 bytes:
+//     char[4]  magic "SIDX"
+//     uint16   version (1)
+//     uint16   number of sections, at most 16
+//     uint64   reserved, 0
+//   one 32-byte entry per section:
+//     uint8    rules::DealVariant
+//     uint8[3] reserved, 0
+//     uint32   first seed covered
+//     uint64   number of seeds covered
+//     uint64   number of winnable seeds
+//     uint64   offset of the bitmap from the start of the file
+//   bitmaps, each (seeds covered + 7) / 8 bytes: bit (i % 8) of byte i / 8
+//   is set if seed first + i is winnable.
+//
+// A seed the analyser could not decide within its limits is left out, so
+// every seed in the index is a proven win, in the deal order of the
+// shipped cards.zip.
+
+#include "deal_solver.h"
+#include <random>
+#include <string>
+
+namespace rules {
+
+constexpr char SEED_INDEX_MAGIC[4] = {'S', 'I', 'D', 'X'};
+constexpr uint16_t SEED_INDEX_VERSION = 1;
+constexpr size_t SEED_INDEX_HEADER_SIZE = 16;
+constexpr size_t SEED_INDEX_SECTION_SIZE = 32;
+
+// Name of the index file the games look for next to cards.zip
+constexpr const char *SEED_INDEX_FILENAME = "winnable_seeds.idx";
+
+class SeedIndex {
+public:
+  SeedIndex();
+  ~SeedIndex();
+  SeedIndex(const SeedIndex &) = delete;
+  SeedIndex &operator=(const SeedIndex &) = delete;
+
+  // Maps the file. Returns false, and stays closed, if it is missing or
+  // its header is not a valid version 1 index.
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const { return data_ != nullptr; }
+
+  bool has(DealVariant variant) const;
+  uint64_t winnableCount(DealVariant variant) const;
+  bool isWinnable(DealVariant variant, unsigned seed) const;
+
+  // Picks a winnable seed of the variant at random. Expected constant
+  // time: random positions in the bitmap are tried first, and only if they
+  // all miss is the bitmap scanned forward from the last one.
+  bool pickSeed(DealVariant variant, unsigned &seed);
+
+private:
+  static constexpr int PICK_ATTEMPTS = 64;
+  static constexpr int MAX_SECTIONS = 16;
+
+  struct Section {
+    uint32_t first;
+    uint64_t count;
+    uint64_t winnable;
+    const uint8_t *bits;
+  };
+
+  const Section *find(DealVariant variant) const;
+  static bool testBit(const Section &section, uint64_t index) {
+    return section.bits[index >> 3] & (1u << (index & 7));
+  }
+
+  const uint8_t *data_;
+  size_t size_;
+#ifdef _WIN32
+  void *file_handle_;
+  void *mapping_handle_;
+#else
+  int fd_;
+#endif
+  Section sections_[MAX_SECTIONS];
+  DealVariant variants_[MAX_SECTIONS];
+  int section_count_;
+  std::mt19937_64 random_;
+};
+
+} // namespace rules
+
+#endif // SEED_INDEX_H
@@ -0,0 +1,12 @@
+#ifndef SOLITAIRE_RULES_H
+#define SOLITAIRE_RULES_H
+
+// Umbrella header for libsolitaire_rules (see rules_common.h)
+
+#include "freecell_rules.h"
+#include "klondike_rules.h"
+#include "pyramid_rules.h"
+#include "rules_common.h"
+#include "spider_rules.h"
+
+#endif // SOLITAIRE_RULES_H
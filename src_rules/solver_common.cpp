@@ -0,0 +1,97 @@
+#include "solver_common.h"
+#include <algorithm>
+
+namespace rules {
+
+const char *solveStatusName(SolveStatus status) {
+  switch (status) {
+  case SolveStatus::SOLVED:
+    return "solved";
+  case SolveStatus::EXHAUSTED:
+    return "exhausted";
+  case SolveStatus::LIMIT_REACHED:
+    return "limit";
+  }
+  return "unknown";
+}
+
+TranspositionTable::TranspositionTable(unsigned bits)
+    : slots_(size_t(1) << bits, 0), mask_((uint64_t(1) << bits) - 1) {}
+
+bool TranspositionTable::testAndSet(uint64_t hash) {
+  if (hash == 0)
+    hash = 1; // 0 marks an empty slot
+
+  uint64_t index = hash & mask_;
+  for (int i = 0; i < PROBE_LIMIT; i++) {
+    uint64_t &slot = slots_[(index + i) & mask_];
+    if (slot == hash)
+      return true;
+    if (slot == 0) {
+      slot = hash;
+      return false;
+    }
+  }
+
+  // Probe sequence full: replace an entry chosen by the hash itself so
+  // different states evict different slots
+  slots_[(index + (hash >> 61)) & mask_] = hash;
+  return false;
+}
+
+bool TranspositionTable::contains(uint64_t hash) const {
+  if (hash == 0)
+    hash = 1;
+  uint64_t index = hash & mask_;
+  for (int i = 0; i < PROBE_LIMIT; i++) {
+    uint64_t slot = slots_[(index + i) & mask_];
+    if (slot == hash)
+      return true;
+    if (slot == 0)
+      return false;
+  }
+  return false;
+}
+
+void TranspositionTable::clear() {
+  std::fill(slots_.begin(), slots_.end(), 0);
+}
+
+ConcurrentTranspositionTable::ConcurrentTranspositionTable(unsigned bits)
+    : slots_(new std::atomic<uint64_t>[size_t(1) << bits]),
+      size_(size_t(1) << bits), mask_((uint64_t(1) << bits) - 1) {
+  clear();
+}
+
+bool ConcurrentTranspositionTable::testAndSet(uint64_t hash) {
+  if (hash == 0)
+    hash = 1;
+
+  uint64_t index = hash & mask_;
+  for (int i = 0; i < PROBE_LIMIT; i++) {
+    std::atomic<uint64_t> &slot = slots_[(index + i) & mask_];
+    uint64_t current = slot.load(std::memory_order_relaxed);
+    if (current == hash)
+      return true;
+    if (current == 0) {
+      // Another thread may claim the slot first; if it stored the same hash
+      // the state is taken, otherwise keep probing
+      if (slot.compare_exchange_strong(current, hash,
+                                       std::memory_order_relaxed))
+        return false;
+      if (current == hash)
+        return true;
+    }
+  }
+
+  slots_[(index + (hash >> 61)) & mask_].store(hash,
+                                                std::memory_order_relaxed);
+  return false;
+}
+
+void ConcurrentTranspositionTable::clear() {
+  for (size_t i = 0; i < size_; i++)
+    slots_[i].store(0, std::memory_order_relaxed);
+}
+
+} // namespace rules
@@ -0,0 +1,137 @@
+#ifndef SOLVER_COMMON_H
+#define SOLVER_COMMON_H
+
+// Pieces shared by the game solvers: search limits, results, Zobrist keys
+// and a fixed-size transposition table.
+
+#include "rules_common.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rules {
+
+struct SolverLimits {
+  uint64_t max_nodes = 2000000; // 0 = unlimited
+  double max_seconds = 0.0;     // 0 = unlimited
+  // Another thread can set this to stop the search early; it then ends
+  // as LIMIT_REACHED
+  const std::atomic<bool> *cancel = nullptr;
+};
+
+// Stored in analysis files, so the values are fixed
+enum class SolveStatus : uint8_t {
+  SOLVED = 0,       // moves holds a winning line from the start position
+  EXHAUSTED = 1,    // the search finished without finding a win
+  LIMIT_REACHED = 2 // node or time budget ran out first
+};
+
+struct SolveResult {
+  SolveStatus status = SolveStatus::LIMIT_REACHED;
+  std::vector<Move> moves;
+  uint64_t nodes = 0;
+  double seconds = 0.0;
+};
+
+const char *solveStatusName(SolveStatus status);
+
+// Deterministic 64-bit generator for Zobrist tables (splitmix64), so hashes
+// are identical from run to run and across threads
+class ZobristGenerator {
+public:
+  explicit ZobristGenerator(uint64_t seed) : state_(seed) {}
+  uint64_t next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+private:
+  uint64_t state_;
+};
+
+// Open-addressing set of 64-bit state hashes with a fixed number of slots.
+// When a probe sequence is full the oldest-looking slot is overwritten, so
+// memory stays bounded; a lost entry only costs a re-search.
+class TranspositionTable {
+public:
+  explicit TranspositionTable(unsigned bits = 22);
+
+  // Returns true if the hash was already present, inserts it otherwise
+  bool testAndSet(uint64_t hash);
+  bool contains(uint64_t hash) const;
+  void clear();
+
+  size_t capacity() const { return slots_.size(); }
+  size_t memoryBytes() const { return slots_.size() * sizeof(uint64_t); }
+
+private:
+  static constexpr int PROBE_LIMIT = 8;
+  std::vector<uint64_t> slots_;
+  uint64_t mask_;
+};
+
+// Same idea for searches that run on several threads at once. Slots are
+// claimed with compare-and-swap, so lookups and inserts never take a lock.
+class ConcurrentTranspositionTable {
+public:
+  explicit ConcurrentTranspositionTable(unsigned bits = 22);
+
+  // Thread safe. Returns true if the hash was already present.
+  bool testAndSet(uint64_t hash);
+  // Not thread safe; call between searches
+  void clear();
+
+  size_t capacity() const { return size_; }
+  size_t memoryBytes() const { return size_ * sizeof(uint64_t); }
+
+private:
+  static constexpr int PROBE_LIMIT = 8;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  size_t size_;
+  uint64_t mask_;
+};
+
+// Tracks the node and time budget of a search
+class SearchBudget {
+public:
+  explicit SearchBudget(const SolverLimits &limits)
+      : limits_(limits), start_(std::chrono::steady_clock::now()), nodes_(0),
+        exceeded_(false) {}
+
+  // Counts one node; returns false once the budget is used up
+  bool tick() {
+    nodes_++;
+    if (limits_.max_nodes && nodes_ >= limits_.max_nodes)
+      exceeded_ = true;
+    // Reading the clock every node is measurable, so only check now and then
+    if ((nodes_ & 1023) == 0) {
+      if (limits_.max_seconds > 0 && elapsed() >= limits_.max_seconds)
+        exceeded_ = true;
+      if (limits_.cancel && limits_.cancel->load(std::memory_order_relaxed))
+        exceeded_ = true;
+    }
+    return !exceeded_;
+  }
+
+  bool exceeded() const { return exceeded_; }
+  uint64_t nodes() const { return nodes_; }
+  double elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_)
+        .count();
+  }
+
+private:
+  SolverLimits limits_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t nodes_;
+  bool exceeded_;
+};
+
+} // namespace rules
+
+#endif // SOLVER_COMMON_H
@@ -0,0 +1,254 @@
+#include "spider_rules.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace rules {
+
+void SpiderState::deal(unsigned seed, int suits, bool relaxed) {
+  // Same deck layout as cardlib::SpiderDeck
+  int total_decks;
+  std::vector<Suit> suits_to_use;
+  switch (suits) {
+  case 1:
+    total_decks = 8;
+    suits_to_use = {Suit::SPADES};
+    break;
+  case 2:
+    total_decks = 4;
+    suits_to_use = {Suit::SPADES, Suit::HEARTS};
+    break;
+  case 4:
+    total_decks = 2;
+    suits_to_use = {Suit::SPADES, Suit::HEARTS, Suit::CLUBS, Suit::DIAMONDS};
+    break;
+  default:
+    throw std::invalid_argument("Invalid number of suits");
+  }
+
+  std::vector<std::vector<Card>> decks(total_decks,
+                                       standardDeckOrder(suits_to_use));
+  std::vector<Card> cards = shuffleMultiDeck(decks, seed);
+
+  num_suits = static_cast<uint8_t>(suits);
+  relaxed_rules = relaxed;
+  stock.clear();
+  completed.clear();
+  for (auto &pile : tableau)
+    pile.clear();
+
+  for (int i = 0; i < 10; i++) {
+    int cards_to_deal = (i < 6) ? 6 : 5;
+    for (int j = 0; j < cards_to_deal && !cards.empty(); j++) {
+      tableau[i].push(PackedCard(cards.back(), j == cards_to_deal - 1));
+      cards.pop_back();
+    }
+  }
+
+  while (!cards.empty()) {
+    stock.push(PackedCard(cards.back(), false));
+    cards.pop_back();
+  }
+}
+
+size_t SpiderState::movableRunLength(int column) const {
+  const auto &pile = tableau[column];
+  if (pile.empty() || !pile.back().faceUp())
+    return 0;
+  size_t length = 1;
+  for (size_t i = pile.size() - 1; i > 0; i--) {
+    PackedCard upper = pile[i - 1];
+    PackedCard lower = pile[i];
+    if (!upper.faceUp() || upper.suit() != lower.suit() ||
+        !cardlib::isOneRankBelow(lower, upper))
+      break;
+    length++;
+  }
+  return length;
+}
+
+bool SpiderState::canDealFromStock() const {
+  if (stock.empty())
+    return false;
+  if (relaxed_rules)
+    return true;
+  for (const auto &pile : tableau) {
+    if (pile.empty())
+      return false;
+  }
+  return true;
+}
+
+bool SpiderState::isLegal(const Move &move) const {
+  if (move.from == SPIDER_STOCK) {
+    return move.to == SPIDER_TABLEAU && canDealFromStock() &&
+           move.count == std::min<size_t>(10, stock.size());
+  }
+
+  if (move.from < SPIDER_TABLEAU || move.from >= SPIDER_PILE_COUNT ||
+      move.to < SPIDER_TABLEAU || move.to >= SPIDER_PILE_COUNT ||
+      move.from == move.to || move.count == 0)
+    return false;
+
+  int column = move.from - SPIDER_TABLEAU;
+  if (move.count > movableRunLength(column))
+    return false;
+
+  const auto &source = tableau[column];
+  const auto &target = tableau[move.to - SPIDER_TABLEAU];
+  if (target.empty())
+    return true;
+  return cardlib::isOneRankBelow(source[source.size() - move.count],
+                                 target.back());
+}
+
+bool SpiderState::removeCompletedRun(int column, uint32_t &detail) {
+  auto &pile = tableau[column];
+  if (pile.size() < 13 || pile.back().rank() != Rank::ACE)
+    return false;
+
+  // Same check as SolitaireGame::checkForCompletedSequence
+  Suit suit = pile.back().suit();
+  size_t top = pile.size() - 1;
+  for (int i = 0; i < 13; i++) {
+    PackedCard card = pile[top - i];
+    if (!card.faceUp() || card.suit() != suit || card.rankValue() != 1 + i)
+      return false;
+  }
+
+  completed.push(pile.back());
+  for (int i = 0; i < 13; i++)
+    pile.pop();
+  detail |= 1u << column;
+  if (!pile.empty() && !pile.back().faceUp()) {
+    pile.back() = pile.back().withFaceUp(true);
+    detail |= 1u << (SPIDER_RUN_FLIPPED_SHIFT + column);
+  }
+  return true;
+}
+
+void SpiderState::applyMove(Move &move) {
+  uint32_t detail = 0;
+  apply(move, detail);
+}
+
+MoveDelta SpiderState::applyRecorded(const Move &move) {
+  MoveDelta delta(move);
+  apply(delta.move, delta.detail);
+  return delta;
+}
+
+void SpiderState::apply(Move &move, uint32_t &detail) {
+  move.flags = 0;
+
+  if (move.from == SPIDER_STOCK) {
+    for (int i = 0; i < move.count; i++) {
+      tableau[i].push(stock.pop().withFaceUp(true));
+    }
+    for (int i = 0; i < move.count; i++) {
+      if (removeCompletedRun(i, detail))
+        move.flags |= MOVE_COMPLETED_RUN;
+    }
+    return;
+  }
+
+  auto &source = tableau[move.from - SPIDER_TABLEAU];
+  auto &target = tableau[move.to - SPIDER_TABLEAU];
+  source.moveTopTo(target, move.count);
+
+  if (!source.empty() && !source.back().faceUp()) {
+    source.back() = source.back().withFaceUp(true);
+    move.flags |= MOVE_FLIPPED;
+  }
+
+  if (removeCompletedRun(move.to - SPIDER_TABLEAU, detail))
+    move.flags |= MOVE_COMPLETED_RUN;
+}
+
+void SpiderState::undoMove(const MoveDelta &delta) {
+  const Move &move = delta.move;
+
+  // Put back the runs that were taken off, last removed first. Each one
+  // was K..A of the suit of the Ace that went to completed.
+  for (int t = 9; t >= 0; t--) {
+    if (!(delta.detail & (1u << t)))
+      continue;
+    auto &pile = tableau[t];
+    if (delta.detail & (1u << (SPIDER_RUN_FLIPPED_SHIFT + t)))
+      pile.back() = pile.back().withFaceUp(false);
+    Suit suit = completed.pop().suit();
+    for (int rank = 13; rank >= 1; rank--) {
+      pile.push(PackedCard(suit, static_cast<Rank>(rank)));
+    }
+  }
+
+  if (move.from == SPIDER_STOCK) {
+    // Column 0 got the old stock top, so it goes back last
+    for (int i = move.count - 1; i >= 0; i--) {
+      stock.push(tableau[i].pop().withFaceUp(false));
+    }
+    return;
+  }
+
+  auto &source = tableau[move.from - SPIDER_TABLEAU];
+  auto &target = tableau[move.to - SPIDER_TABLEAU];
+  if (move.flags & MOVE_FLIPPED)
+    source.back() = source.back().withFaceUp(false);
+  target.moveTopTo(source, move.count);
+}
+
+void SpiderState::legalMoves(MoveList &moves) const {
+  moves.clear();
+
+  int first_empty = -1;
+  for (int t = 0; t < 10; t++) {
+    if (tableau[t].empty()) {
+      first_empty = t;
+      break;
+    }
+  }
+
+  for (int t = 0; t < 10; t++) {
+    const auto &pile = tableau[t];
+    size_t run = movableRunLength(t);
+    if (run == 0)
+      continue;
+
+    for (int d = 0; d < 10; d++) {
+      if (d == t)
+        continue;
+      const auto &target = tableau[d];
+      if (target.empty()) {
+        // All empty columns are equivalent; offer the first one only, and
+        // don't move a whole column into it
+        if (d != first_empty)
+          continue;
+        size_t limit = run == pile.size() ? run - 1 : run;
+        for (size_t n = 1; n <= limit; n++) {
+          moves.push(Move(SPIDER_TABLEAU + t, SPIDER_TABLEAU + d,
+                          static_cast<uint8_t>(n)));
+        }
+        continue;
+      }
+      // Only one run length can match the target's rank
+      int base_rank = target.back().rankValue() - 1;
+      int top_rank = pile.back().rankValue();
+      int n = base_rank - top_rank + 1;
+      if (n >= 1 && static_cast<size_t>(n) <= run) {
+        moves.push(Move(SPIDER_TABLEAU + t, SPIDER_TABLEAU + d,
+                        static_cast<uint8_t>(n)));
+      }
+    }
+  }
+
+  if (canDealFromStock()) {
+    moves.push(Move(SPIDER_STOCK, SPIDER_TABLEAU,
+                    static_cast<uint8_t>(std::min<size_t>(10, stock.size()))));
+  }
+}
+
+bool SpiderState::operator==(const SpiderState &other) const {
+  return num_suits == other.num_suits && stock == other.stock &&
+         tableau == other.tableau && completed == other.completed;
+}
+
+} // namespace rules
@@ -0,0 +1,65 @@
+#ifndef SPIDER_RULES_H
+#define SPIDER_RULES_H
+
+#include "rules_common.h"
+
+namespace rules {
+
+// Pile numbering matches SolitaireGame in src_spider (tableau 6..15).
+// Dealing a row from the stock is Move(SPIDER_STOCK, SPIDER_TABLEAU, n).
+enum SpiderPile : uint8_t {
+  SPIDER_STOCK = 0,
+  SPIDER_TABLEAU = 6, // 6..15
+  SPIDER_PILE_COUNT = 16
+};
+
+// MoveDelta::detail for Spider: bit t is set if a completed run was removed
+// from column t, bit SPIDER_RUN_FLIPPED_SHIFT + t if that turned the card
+// under it face up.
+constexpr int SPIDER_RUN_FLIPPED_SHIFT = 10;
+
+// Spider with 1, 2 or 4 suits (104 cards from SpiderDeck). As in the game,
+// the first six columns get six cards and the rest five, so the stock holds
+// 48 cards and the last row only reaches eight columns. Completed K..A runs
+// of one suit are removed straight away and counted in `completed`.
+struct SpiderState {
+  // A column holds at most 5 face-down cards plus six descending runs
+  // (the initial card and one per stock row), so 96 is plenty.
+  FixedPile<50> stock;
+  std::array<FixedPile<96>, 10> tableau;
+  FixedPile<8> completed; // the Ace of each removed run, like foundation_[0]
+  uint8_t num_suits;
+  bool relaxed_rules;
+
+  SpiderState() : num_suits(2), relaxed_rules(false) {}
+
+  // Deals exactly like SolitaireGame::deal() in src_spider
+  void deal(unsigned seed, int suits, bool relaxed = false);
+
+  bool isLegal(const Move &move) const;
+  void applyMove(Move &move); // move must be legal
+  // applyMove, returning what undoMove() needs to take the move back
+  MoveDelta applyRecorded(const Move &move);
+  void undoMove(const MoveDelta &delta); // delta must be the last move played
+  void legalMoves(MoveList &moves) const;
+
+  bool canDealFromStock() const;
+  // Length of the same-suit descending run on top of a column
+  size_t movableRunLength(int column) const;
+
+  bool isWon() const { return completed.size() >= 8; }
+  // Cards removed in completed runs, comparable with the other games'
+  // foundation counts
+  int foundationCount() const { return static_cast<int>(completed.size()) * 13; }
+
+  bool operator==(const SpiderState &other) const;
+  bool operator!=(const SpiderState &other) const { return !(*this == other); }
+
+private:
+  void apply(Move &move, uint32_t &detail);
+  bool removeCompletedRun(int column, uint32_t &detail);
+};
+
+} // namespace rules
+
+#endif // SPIDER_RULES_H
@@ -0,0 +1,223 @@
+#include "spider_solver.h"
+#include <algorithm>
+
+namespace rules {
+
+namespace {
+
+uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Slack passes, in order; the last one is unlimited
+constexpr uint8_t SLACK_SCHEDULE[] = {1, 2, 4, 8, 255};
+
+} // namespace
+
+SpiderSolver::SpiderSolver(size_t table_megabytes)
+    : budget_(nullptr), pass_slack_(0), depth_cut_(false) {
+  size_t bytes = std::max<size_t>(table_megabytes, 1) << 20;
+  size_t entries = 1;
+  while (entries * 2 * (sizeof(uint64_t) + 1) <= bytes)
+    entries *= 2;
+  keys_.assign(entries, 0);
+  slack_.assign(entries, 0);
+  mask_ = entries - 1;
+}
+
+uint64_t SpiderSolver::hash(const SpiderState &state) {
+  // Columns are hashed on their own and summed; unlike XOR, a sum does not
+  // cancel out when two columns hold the same cards, which happens with
+  // duplicate decks
+  uint64_t h = mix(state.stock.size() * 131 + state.completed.size());
+  for (const auto &pile : state.tableau) {
+    if (pile.empty())
+      continue;
+    uint64_t column = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < pile.size(); i++)
+      column = (column ^ pile[i].bits) * 0x100000001B3ULL;
+    h += mix(column ^ pile.size());
+  }
+  return h ? h : 1;
+}
+
+bool SpiderSolver::seen(uint64_t hash, uint8_t slack) {
+  uint64_t index = hash & mask_;
+  size_t victim = index;
+  for (int i = 0; i < PROBE_LIMIT; i++) {
+    size_t slot = (index + i) & mask_;
+    if (keys_[slot] == hash) {
+      if (slack_[slot] >= slack)
+        return true;
+      slack_[slot] = slack;
+      return false;
+    }
+    if (keys_[slot] == 0) {
+      victim = slot;
+      break;
+    }
+    if (slack_[slot] < slack_[victim])
+      victim = slot;
+  }
+  keys_[victim] = hash;
+  slack_[victim] = slack;
+  return false;
+}
+
+SolveResult SpiderSolver::solve(const SpiderState &start,
+                                const SolverLimits &limits) {
+  SearchBudget budget(limits);
+  budget_ = &budget;
+  std::fill(keys_.begin(), keys_.end(), 0);
+  std::fill(slack_.begin(), slack_.end(), 0);
+
+  SolveResult result;
+  result.status = SolveStatus::EXHAUSTED;
+  for (uint8_t slack : SLACK_SCHEDULE) {
+    pass_slack_ = slack;
+    path_.clear();
+    depth_cut_ = false;
+    if (search(start, slack)) {
+      result.status = SolveStatus::SOLVED;
+      result.moves = path_;
+      break;
+    }
+    if (budget.exceeded()) {
+      result.status = SolveStatus::LIMIT_REACHED;
+      break;
+    }
+  }
+  if (result.status == SolveStatus::EXHAUSTED && depth_cut_)
+    result.status = SolveStatus::LIMIT_REACHED;
+
+  result.nodes = budget.nodes();
+  result.seconds = budget.elapsed();
+  budget_ = nullptr;
+  return result;
+}
+
+// Stacks up the moves to try from state in order: moves that turn a card
+// or empty a column, same-suit builds, other builds, and the stock last
+void SpiderSolver::pushFrame(const SpiderState &state, uint8_t slack) {
+  MoveList moves;
+  state.legalMoves(moves);
+
+  int priority[MoveList::CAPACITY];
+  bool suit_build[MoveList::CAPACITY];
+  for (size_t i = 0; i < moves.size(); i++) {
+    const Move &move = moves[i];
+    suit_build[i] = false;
+    if (move.from == SPIDER_STOCK) {
+      priority[i] = 3;
+      continue;
+    }
+    const auto &source = state.tableau[move.from - SPIDER_TABLEAU];
+    const auto &target = state.tableau[move.to - SPIDER_TABLEAU];
+    size_t base = source.size() - move.count;
+    PackedCard moved = source[base];
+
+    // Leaving a same-suit parent for another card is only worth it when
+    // it completes a run, which only a same-suit target can do
+    bool on_suit_parent = base > 0 && source[base - 1].faceUp() &&
+                          source[base - 1].suit() == moved.suit() &&
+                          cardlib::isOneRankBelow(moved, source[base - 1]);
+    bool to_suit = !target.empty() && target.back().suit() == moved.suit();
+    if (on_suit_parent && !to_suit)
+      priority[i] = -1;
+    else if (to_suit && !on_suit_parent) {
+      suit_build[i] = true;
+      priority[i] = (base == 0 || !source[base - 1].faceUp()) ? 0 : 1;
+    } else if (base == 0 || !source[base - 1].faceUp())
+      priority[i] = 0;
+    else
+      priority[i] = 2;
+  }
+
+  Frame frame;
+  frame.state = state;
+  frame.slack = slack;
+  frame.first = frame.next = pending_.size();
+  for (int level = 0; level <= 3; level++) {
+    for (size_t i = 0; i < moves.size(); i++) {
+      if (priority[i] == level)
+        pending_.push_back({moves[i], suit_build[i]});
+    }
+  }
+  frame.end = pending_.size();
+  frames_.push_back(frame);
+}
+
+// Depth-first, with the positions on the way down kept in frames_
+bool SpiderSolver::search(const SpiderState &start, uint8_t slack) {
+  frames_.clear();
+  pending_.clear();
+  SpiderState state = start;
+
+  for (;;) {
+    // Enter the position: unless it is too deep or was searched with as
+    // much slack before, stack up its moves
+    bool entered = false;
+    if (budget_->tick()) {
+      if (state.isWon())
+        return true;
+      if (frames_.size() >= MAX_DEPTH) {
+        depth_cut_ = true;
+      } else if (!seen(hash(state), slack)) {
+        pushFrame(state, slack);
+        entered = true;
+      }
+    }
+
+    // It failed; take back the move that led to it
+    if (!entered) {
+      if (frames_.empty())
+        return false;
+      path_.pop_back();
+      if (budget_->exceeded())
+        return false;
+    }
+
+    // Find the next move to try, leaving the positions that have none left
+    for (;;) {
+      Frame &frame = frames_.back();
+      if (frame.next == frame.end) {
+        pending_.resize(frame.first);
+        frames_.pop_back();
+        if (frames_.empty())
+          return false;
+        path_.pop_back();
+        if (budget_->exceeded())
+          return false;
+        continue;
+      }
+
+      const Candidate &candidate = pending_[frame.next++];
+      bool emptied =
+          candidate.move.from != SPIDER_STOCK &&
+          frame.state.tableau[candidate.move.from - SPIDER_TABLEAU].size() ==
+              candidate.move.count;
+
+      state = frame.state;
+      Move move = candidate.move;
+      state.applyMove(move);
+
+      bool progress = candidate.suit_build || emptied ||
+                      candidate.move.from == SPIDER_STOCK ||
+                      (move.flags & (MOVE_FLIPPED | MOVE_COMPLETED_RUN));
+      // Progress earns back the full allowance for this pass
+      slack = progress ? pass_slack_ : frame.slack;
+      if (!progress && frame.slack != UNLIMITED_SLACK) {
+        if (frame.slack == 0)
+          continue;
+        slack--;
+      }
+
+      path_.push_back(move);
+      break;
+    }
+  }
+}
+
+} // namespace rules
@@ -0,0 +1,73 @@
+#ifndef SPIDER_SOLVER_H
+#define SPIDER_SOLVER_H
+
+#include "solver_common.h"
+#include "spider_rules.h"
+
+namespace rules {
+
+// Depth-first Spider solver for 1, 2 and 4 suits.
+//
+// Moves count as progress when they turn a card, empty a column, complete
+// a run, deal a stock row or join two cards of the same suit. The search
+// deepens on "slack", the number of non-progress moves allowed in a row:
+// the first passes only follow near-greedy lines, later ones open up, and
+// the last pass has no slack limit at all. Runs of one suit move as a
+// unit, and moves that break one up for a card of another suit are not
+// tried.
+//
+// Positions are remembered in a fixed-size table together with the slack
+// they were searched with, so a position is not searched again unless
+// there is more room to manoeuvre. The table never grows past the size
+// given to the constructor; when it is full, low-slack entries go first.
+class SpiderSolver {
+public:
+  explicit SpiderSolver(size_t table_megabytes = 64);
+
+  // LIMIT_REACHED is "unsolved within limits.max_nodes"
+  SolveResult solve(const SpiderState &start, const SolverLimits &limits);
+
+  // Hash of a position that ignores the order of the columns
+  static uint64_t hash(const SpiderState &state);
+
+private:
+  static constexpr uint8_t UNLIMITED_SLACK = 255;
+  static constexpr size_t MAX_DEPTH = 1000;
+  static constexpr int PROBE_LIMIT = 4;
+
+  // A move to try, and whether it builds on a card of its own suit
+  struct Candidate {
+    Move move;
+    bool suit_build;
+  };
+
+  // A position being searched, kept on the heap rather than the call
+  // stack. Its moves are pending_[first, end), those from next on still to
+  // try.
+  struct Frame {
+    SpiderState state;
+    uint8_t slack;
+    size_t first, next, end;
+  };
+
+  bool search(const SpiderState &start, uint8_t slack);
+  void pushFrame(const SpiderState &state, uint8_t slack);
+  // True if the position was already searched with at least this much
+  // slack; otherwise records it
+  bool seen(uint64_t hash, uint8_t slack);
+
+  std::vector<uint64_t> keys_;
+  std::vector<uint8_t> slack_;
+  uint64_t mask_;
+
+  SearchBudget *budget_;
+  std::vector<Move> path_;
+  std::vector<Frame> frames_;
+  std::vector<Candidate> pending_;
+  uint8_t pass_slack_;
+  bool depth_cut_;
+};
+
+} // namespace rules
+
+#endif // SPIDER_SOLVER_H
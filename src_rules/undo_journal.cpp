@@ -0,0 +1,46 @@
+#include "undo_journal.h"
+
+namespace rules {
+
+UndoJournal::UndoJournal(size_t capacity)
+    : oldest_(0), undo_count_(0), redo_count_(0) {
+  size_t size = 1;
+  while (size < capacity)
+    size <<= 1;
+  ring_.resize(size);
+  mask_ = size - 1;
+}
+
+void UndoJournal::clear() {
+  oldest_ = 0;
+  undo_count_ = 0;
+  redo_count_ = 0;
+}
+
+void UndoJournal::record(const MoveDelta &delta) {
+  redo_count_ = 0;
+  if (undo_count_ == ring_.size()) {
+    // Full: the new move takes the oldest one's place
+    oldest_ = (oldest_ + 1) & mask_;
+    undo_count_--;
+  }
+  at(undo_count_++) = delta;
+}
+
+bool UndoJournal::undo(MoveDelta &delta) {
+  if (undo_count_ == 0)
+    return false;
+  delta = at(--undo_count_);
+  redo_count_++;
+  return true;
+}
+
+bool UndoJournal::redo(MoveDelta &delta) {
+  if (redo_count_ == 0)
+    return false;
+  delta = at(undo_count_++);
+  redo_count_--;
+  return true;
+}
+
+} // namespace rules
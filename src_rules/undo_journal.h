@@ -0,0 +1,195 @@
+#ifndef UNDO_JOURNAL_H
+#define UNDO_JOURNAL_H
+
+// Undo and redo for all the games, kept as a journal of moves rather than
+// copies of the board.
+//
+// Each entry is a MoveDelta: the move plus the little it destroyed, eight
+// bytes however big the board is. A state's undoMove() takes the newest
+// entry back and applying the move again redoes it. The entries live in a
+// ring allocated once, so recording, undoing and redoing are O(1) and
+// never allocate; when the ring is full the oldest moves are forgotten.
+
+#include "replay.h"
+#include "rules_common.h"
+#include <vector>
+
+namespace rules {
+
+class UndoJournal {
+public:
+  // 64K moves, 512 KB; far more than a game ever needs
+  static constexpr size_t DEFAULT_CAPACITY = size_t(1) << 16;
+
+  // capacity is rounded up to a power of two
+  explicit UndoJournal(size_t capacity = DEFAULT_CAPACITY);
+
+  void clear();
+
+  // Adds a move after the current one, dropping anything that could have
+  // been redone
+  void record(const MoveDelta &delta);
+
+  // Steps back over the newest move, or forward over the next undone one.
+  // Return false, leaving delta alone, if there is nothing to step over.
+  bool undo(MoveDelta &delta);
+  bool redo(MoveDelta &delta);
+
+  size_t undoCount() const { return undo_count_; }
+  size_t redoCount() const { return redo_count_; }
+  size_t capacity() const { return ring_.size(); }
+  size_t memoryBytes() const { return ring_.size() * sizeof(MoveDelta); }
+
+private:
+  MoveDelta &at(size_t offset) { return ring_[(oldest_ + offset) & mask_]; }
+
+  std::vector<MoveDelta> ring_;
+  size_t mask_;
+  size_t oldest_;      // ring index of the oldest move still kept
+  size_t undo_count_;  // moves that can be undone, starting at oldest_
+  size_t redo_count_;  // undone moves after those that can be redone
+};
+
+// Keeps a journal in step with a game's board, for any rules state with
+// isLegal, applyRecorded and undoMove.
+//
+// The front-end reports every settled position with track() and the moves
+// in between are worked out from the rules, so the many ways a game moves
+// cards (drag, click, keyboard, auto moves) need no hooks of their own. A
+// change no one or two legal moves explain, like a new deal, starts the
+// history again from there.
+//
+// An attached Replay gets every move, undo and redo as it is recorded and
+// is stopped when the history starts again.
+template <typename State> class UndoHistory {
+public:
+  explicit UndoHistory(size_t capacity = UndoJournal::DEFAULT_CAPACITY)
+      : journal_(capacity), tracking_(false), replay_(nullptr) {}
+
+  void attachReplay(Replay *replay) { replay_ = replay; }
+
+  // Forgets everything; the next tracked position is the start
+  void clear() {
+    journal_.clear();
+    tracking_ = false;
+  }
+
+  // True if state starts the history again, so a new replay can begin
+  bool track(const State &state) {
+    if (tracking_ && state == position_)
+      return false;
+    if (tracking_ && follow(state))
+      return false;
+    journal_.clear();
+    position_ = state;
+    tracking_ = true;
+    if (replay_)
+      replay_->stop();
+    return true;
+  }
+
+  // For callers that know the move: plays a legal move on the tracked
+  // position and records it without searching
+  void record(const Move &move) { recordDelta(position_.applyRecorded(move)); }
+
+  // Step the tracked position back or forward one move and copy it to
+  // state for the game to show. Return false if there is nothing to do.
+  bool undo(State &state) {
+    MoveDelta delta;
+    if (!tracking_ || !journal_.undo(delta))
+      return false;
+    position_.undoMove(delta);
+    state = position_;
+    if (replay_)
+      replay_->appendUndo();
+    return true;
+  }
+
+  bool redo(State &state) {
+    MoveDelta delta;
+    if (!tracking_ || !journal_.redo(delta))
+      return false;
+    position_.applyRecorded(delta.move);
+    state = position_;
+    if (replay_)
+      replay_->appendRedo();
+    return true;
+  }
+
+  // The board after the current move
+  const State &position() const { return position_; }
+
+  bool canUndo() const { return journal_.undoCount() > 0; }
+  bool canRedo() const { return journal_.redoCount() > 0; }
+  const UndoJournal &journal() const { return journal_; }
+
+private:
+  // Pile numbers and move sizes are below these in every game; isLegal
+  // turns down anything out of range
+  static constexpr int MAX_PILES = 32;
+  static constexpr int MAX_COUNT = 24;
+
+  void recordDelta(const MoveDelta &delta) {
+    journal_.record(delta);
+    if (replay_)
+      replay_->appendMove(delta.move);
+  }
+
+  // Finds the move from position_ to target among every legal one, not
+  // just those legalMoves offers, since players make moves solvers prune
+  bool findMove(const State &target, MoveDelta &found) {
+    for (int from = 0; from < MAX_PILES; from++) {
+      for (int to = 0; to < MAX_PILES; to++) {
+        for (int count = 1; count <= MAX_COUNT; count++) {
+          Move move(static_cast<uint8_t>(from), static_cast<uint8_t>(to),
+                    static_cast<uint8_t>(count));
+          if (!position_.isLegal(move))
+            continue;
+          MoveDelta delta = position_.applyRecorded(move);
+          bool match = position_ == target;
+          position_.undoMove(delta);
+          if (match) {
+            found = delta;
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  // Records the move, or pair of moves, that leads to state. Two covers a
+  // move followed by an automatic one; only the offered moves are tried
+  // first, to keep the search small.
+  bool follow(const State &state) {
+    MoveDelta delta;
+    if (findMove(state, delta)) {
+      recordDelta(delta);
+      position_ = state;
+      return true;
+    }
+
+    MoveList moves;
+    position_.legalMoves(moves);
+    for (const Move &move : moves) {
+      MoveDelta first = position_.applyRecorded(move);
+      if (findMove(state, delta)) {
+        recordDelta(first);
+        recordDelta(delta);
+        position_ = state;
+        return true;
+      }
+      position_.undoMove(first);
+    }
+    return false;
+  }
+
+  UndoJournal journal_;
+  State position_; // the board after the journal's current move
+  bool tracking_;
+  Replay *replay_;
+};
+
+} // namespace rules
+
+#endif // UNDO_JOURNAL_H
@@ -0,0 +1,140 @@
+#include "spider.h"
+#include <gtk/gtk.h>
+#include <iostream>
+
+// Copies the board into the headless rules representation. Pile numbers
+// are the same in both; completed runs are kept as their Aces, like
+// foundation_[0].
+bool SolitaireGame::buildRulesState(rules::SpiderState &state) const {
+  if (tableau_.size() != 10 || foundation_.empty() || stock_.size() > 50 ||
+      foundation_[0].size() > 8) {
+    return false;
+  }
+
+  state.num_suits = static_cast<uint8_t>(number_of_suits);
+  state.relaxed_rules = relaxed_rules_mode_;
+
+  state.stock.clear();
+  for (const auto &card : stock_) {
+    state.stock.push(cardlib::PackedCard(card, false));
+  }
+
+  state.completed.clear();
+  for (const auto &card : foundation_[0]) {
+    state.completed.push(cardlib::PackedCard(card));
+  }
+
+  for (size_t t = 0; t < tableau_.size(); t++) {
+    state.tableau[t].clear();
+    for (const auto &tableau_card : tableau_[t]) {
+      if (!state.tableau[t].push(
+              cardlib::PackedCard(tableau_card.card, tableau_card.face_up))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// No cards in flight: the piles hold the whole board
+bool SolitaireGame::isBoardSettled() const {
+  return !(dragging_ || win_animation_active_ ||
+           deal_animation_active_ || foundation_move_animation_active_ ||
+           stock_to_waste_animation_active_ || sequence_animation_active_ ||
+           auto_finish_active_);
+}
+
+// Called on every redraw; the engine ignores positions it already has
+void SolitaireGame::postHintPosition() {
+  if (!hint_engine_ || !isBoardSettled()) {
+    return;
+  }
+
+  rules::SpiderState state;
+  if (!buildRulesState(state)) {
+    return;
+  }
+
+  // A hint still being waited for belongs to the old position
+  if (hint_engine_->update(state) && hint_poll_timer_id_ > 0) {
+    g_source_remove(hint_poll_timer_id_);
+    hint_poll_timer_id_ = 0;
+  }
+}
+
+void SolitaireGame::showHint() {
+  rules::SpiderState state;
+  if (!hint_engine_ || !buildRulesState(state) || state.isWon()) {
+    return;
+  }
+  postHintPosition();
+
+  // Usually the worker has finished long before the player asks; if not,
+  // check back until it has
+  if (!showHintIfReady() && hint_poll_timer_id_ == 0) {
+    hint_poll_timer_id_ = g_timeout_add(HINT_POLL_INTERVAL, onHintPoll, this);
+  }
+}
+
+bool SolitaireGame::showHintIfReady() {
+  rules::Hint hint = hint_engine_->current();
+
+  switch (hint.status) {
+  case rules::HintStatus::THINKING:
+    return false;
+
+  case rules::HintStatus::LOST:
+  case rules::HintStatus::NO_MOVES: {
+    GtkWidget *dialog = gtk_message_dialog_new(
+        GTK_WINDOW(window_), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
+        "%s", hint.status == rules::HintStatus::LOST
+                  ? "This game can no longer be won."
+                  : "There are no moves left.");
+    gtk_dialog_run(GTK_DIALOG(dialog));
+    gtk_widget_destroy(dialog);
+    return true;
+  }
+
+  case rules::HintStatus::WINNING:
+  case rules::HintStatus::GUESS:
+    break;
+  }
+
+  const rules::Move &move = hint.move;
+  keyboard_navigation_active_ = true;
+
+  if (move.from == rules::SPIDER_STOCK) {
+    // Dealing a row: point at the stock, Enter deals it
+    keyboard_selection_active_ = false;
+    source_pile_ = -1;
+    source_card_idx_ = -1;
+    selected_pile_ = 0;
+    selected_card_idx_ = stock_.empty() ? -1 : static_cast<int>(stock_.size()) - 1;
+  } else {
+    // Pick up the run to move and put the cursor on its destination,
+    // exactly as if the player had done it from the keyboard
+    const auto &source = tableau_[move.from - rules::SPIDER_TABLEAU];
+    const auto &target = tableau_[move.to - rules::SPIDER_TABLEAU];
+    keyboard_selection_active_ = true;
+    source_pile_ = move.from;
+    source_card_idx_ = static_cast<int>(source.size()) - move.count;
+    selected_pile_ = move.to;
+    selected_card_idx_ = static_cast<int>(target.size()) - 1;
+  }
+
+  if (hint.status == rules::HintStatus::GUESS) {
+    std::cerr << "Hint: no winning line found, showing the most promising move"
+              << std::endl;
+  }
+  refreshDisplay();
+  return true;
+}
+
+gboolean SolitaireGame::onHintPoll(gpointer data) {
+  SolitaireGame *game = static_cast<SolitaireGame *>(data);
+  if (!game->showHintIfReady()) {
+    return TRUE;
+  }
+  game->hint_poll_timer_id_ = 0;
+  return FALSE;
+}
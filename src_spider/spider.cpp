@@ -47,8 +47,21 @@ SolitaireGame::SolitaireGame()
       current_seed_(0) {
   srand(time(NULL));
   current_seed_ = rand();
-  initializeGame();
+#ifdef _WIN32
+  seed_index_.open(getExecutableDir() + "\\" + rules::SEED_INDEX_FILENAME);
+#else
+  seed_index_.open(rules::SEED_INDEX_FILENAME);
+#endif
+
+  rules::SolverLimits hint_limits;
+  hint_limits.max_nodes = 0;
+  hint_limits.max_seconds = HINT_SOLVE_SECONDS;
+  hint_engine_ = std::make_unique<
+      rules::HintEngine<rules::SpiderState, rules::SpiderSolver>>(
+      hint_limits, HINT_TABLE_MEGABYTES);
+  undo_history_.attachReplay(&replay_);
   initializeSettingsDir();
+  resumeSavedGame();
   
   // Load engine preference and initialize rendering
   loadEnginePreference();
@@ -98,6 +111,10 @@ void SolitaireGame::run(int argc, char **argv) {
 }
 
 void SolitaireGame::initializeGame() {
+  if (replay_playback_active_) {
+    stopReplayPlayback();
+  }
+
   try {
     // Try to find cards.zip in several common locations
 #ifdef _WIN32
@@ -579,7 +596,8 @@ gboolean SolitaireGame::onButtonPress(GtkWidget *widget, GdkEventButton *event,
                                       gpointer data) {
   SolitaireGame *game = static_cast<SolitaireGame *>(data);
 
-  if (game->auto_finish_active_ || game->sequence_animation_active_) {
+  if (game->auto_finish_active_ || game->sequence_animation_active_ ||
+      game->replay_playback_active_) {
       return TRUE;
   }
 
@@ -705,7 +723,7 @@ gboolean SolitaireGame::onButtonRelease(GtkWidget *widget,
     game->dragging_ = false;
     game->drag_cards_.clear();
     game->drag_source_pile_ = -1;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
@@ -790,7 +808,7 @@ gboolean SolitaireGame::onMotionNotify(GtkWidget *widget, GdkEventMotion *event,
   if (game->dragging_) {
     game->drag_start_x_ = event->x;
     game->drag_start_y_ = event->y;
-    gtk_widget_queue_draw(game->game_area_);
+    game->queueRedraw();
   }
 
   return TRUE;
@@ -944,18 +962,10 @@ bool SolitaireGame::checkWinCondition() const {
 
 // Function to refresh the display
 void SolitaireGame::refreshDisplay() {
-#ifdef USEOPENGL
-  // Queue redraw on whichever renderer is currently active
-  if (rendering_engine_ == RenderingEngine::OPENGL && gl_area_) {
-    gtk_widget_queue_draw(gl_area_);
-  } else if (game_area_) {
-    gtk_widget_queue_draw(game_area_);
-  }
-#else
-  if (game_area_) {
-    gtk_widget_queue_draw(game_area_);
-  }
-#endif
+  // Let the hint search start on the new position straight away
+  postHintPosition();
+  trackUndoPosition();
+  queueRedraw();
 }
 
 int main(int argc, char **argv) {
@@ -965,8 +975,13 @@ int main(int argc, char **argv) {
 }
 
 void SolitaireGame::cleanupCardCache() {
-  for (auto &[key, surface] : card_surface_cache_) {
-    cairo_surface_destroy(surface);
+  // Every card on screen is redrawn with the new images
+  damage_.invalidate();
+  // A rescale still in flight would bring the old images back
+  card_scaler_.cancel();
+  for (cairo_surface_t *surface : card_surface_cache_) {
+    if (surface)
+      cairo_surface_destroy(surface);
   }
   card_surface_cache_.clear();
 }
@@ -1039,6 +1054,7 @@ void SolitaireGame::setupCairoArea() {
                 CAIRO_FORMAT_ARGB32, allocation->width, allocation->height);
             game->buffer_cr_ = cairo_create(game->buffer_surface_);
 
+            game->damage_.invalidate();
             gtk_widget_queue_draw(widget);
           }),
       this);
@@ -1175,6 +1191,49 @@ void SolitaireGame::setupMenuBar() {
                   }),
                   this);
   gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), autoFinishItem);
+
+  // Hint option
+  GtkWidget *hintItem = gtk_menu_item_new_with_mnemonic("_Hint (H)");
+  g_signal_connect(G_OBJECT(hintItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->showHint();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), hintItem);
+
+  // Undo and redo options
+  GtkWidget *undoItem = gtk_menu_item_new_with_mnemonic("_Undo (Ctrl+Z)");
+  g_signal_connect(G_OBJECT(undoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->undoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), undoItem);
+
+  GtkWidget *redoItem = gtk_menu_item_new_with_mnemonic("_Redo (Ctrl+Y)");
+  g_signal_connect(G_OBJECT(redoItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->redoLastMove();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), redoItem);
+
+  // Replay options
+  GtkWidget *saveReplayItem = gtk_menu_item_new_with_mnemonic("Save Re_play...");
+  g_signal_connect(G_OBJECT(saveReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->saveReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), saveReplayItem);
+
+  GtkWidget *openReplayItem = gtk_menu_item_new_with_mnemonic("_Open Replay...");
+  g_signal_connect(G_OBJECT(openReplayItem), "activate",
+                  G_CALLBACK(+[](GtkWidget *widget, gpointer data) {
+                    static_cast<SolitaireGame *>(data)->openReplay();
+                  }),
+                  this);
+  gtk_menu_shell_append(GTK_MENU_SHELL(gameMenu), openReplayItem);
   
   // Separator before difficulty options
   GtkWidget *sep1 = gtk_separator_menu_item_new();
@@ -1519,13 +1578,21 @@ void SolitaireGame::setupMenuBar() {
                         "<span size='large' weight='bold'>Keyboard Shortcuts</span>\n\n"
                         "<b>F11</b> - Toggle Fullscreen\n"
                         "<b>Ctrl+N</b> - New Game\n"
+                        "<b>Ctrl+Z</b> - Undo\n"
+                        "<b>Ctrl+Y</b> - Redo\n"
                         "<b>Ctrl+Q</b> - Quit\n"
                         "<b>Ctrl+H</b> - Help\n"
                         "<b>Arrow Keys</b> - Navigate piles\n"
                         "<b>Enter</b> - Select or place cards\n"
                         "<b>Esc</b> - Cancel selection\n"
                         "<b>Space</b> - Deal cards from stock pile\n"
-                        "<b>F</b> - Auto-Finish (find best moves)";
+                        "<b>F</b> - Auto-Finish (find best moves)\n"
+                        "<b>H</b> - Hint (Enter plays the suggested move)\n\n"
+                        "<b>While a replay plays</b>\n"
+                        "<b>Space</b> - Pause or resume\n"
+                        "<b>Left / Right</b> - Step back or forward one move\n"
+                        "<b>Home / End</b> - Jump to the deal or the last move\n"
+                        "<b>Esc</b> - Stop and play on from the move shown";
                     
                     gtk_label_set_markup(GTK_LABEL(label), markup);
                     gtk_container_add(GTK_CONTAINER(content_area), label);
@@ -1560,7 +1627,13 @@ void SolitaireGame::onNewGame(GtkWidget *widget, gpointer data) {
     game->stopWinAnimation();
   }
 
-  game->current_seed_ = rand();
+  // Deal a known-winnable seed when the shipped index covers this suit count
+  rules::DealVariant variant = game->number_of_suits == 4 ? rules::DealVariant::SPIDER_4SUIT
+                               : game->number_of_suits == 2 ? rules::DealVariant::SPIDER_2SUIT
+                                                            : rules::DealVariant::SPIDER_1SUIT;
+  if (!game->seed_index_.pickSeed(variant, game->current_seed_)) {
+    game->current_seed_ = rand();
+  }
 
   game->initializeGame();
   game->refreshDisplay();
@@ -1652,10 +1725,19 @@ void SolitaireGame::onAbout(GtkWidget * /* widget */, gpointer data) {
       "- Enter to select a card or perform a move\n"
       "- Escape to cancel a selection\n"
       "- F to auto-finish any valid moves (automatically finds best moves)\n"
+      "- H for a hint; Enter plays the suggested move\n"
       "- F11 to toggle fullscreen mode\n"
       "- Ctrl+N for a new game\n"
+      "- Ctrl+Z to undo a move, Ctrl+Y to redo it\n"
       "- Ctrl+Q to quit\n"
       "- Ctrl+H for help\n\n"
+      "Replays:\n"
+      "- Game > Save Replay keeps every move of the game in a small file\n"
+      "- Game > Open Replay plays one back: Space pauses, Left and Right "
+      "step, Home and End jump to the start and the end, Escape stops and "
+      "lets you play on from the move shown\n"
+      "- The game in progress is saved as you play, and picks up where you "
+      "left off next time\n\n"
       "Written by Jason Hall\n"
       "Licensed under the MIT License\n"
       "https://github.com/jasonbrianhall/solitaire";
@@ -1968,10 +2050,10 @@ void SolitaireGame::clearCustomBack() {
   custom_back_path_.clear();
 
   // Remove the custom back from cache if it exists
-  auto it = card_surface_cache_.find("custom_back");
-  if (it != card_surface_cache_.end()) {
-    cairo_surface_destroy(it->second);
-    card_surface_cache_.erase(it);
+  if (cairo_surface_t *surface =
+          card_surface_cache_.take(render::CUSTOM_BACK_ID)) {
+    cairo_surface_destroy(surface);
+    damage_.invalidate();
   }
 
   // Update settings file
@@ -2032,8 +2114,11 @@ void SolitaireGame::updateCardDimensions(int window_width, int window_height) {
   current_card_spacing_ = std::max(min_spacing, optimal_card_width / 10); // Slightly larger spacing
   current_vert_spacing_ = vertical_spacing;
   
-  // Reinitialize card cache with new dimensions
-  initializeCardCache();
+  // Rescale the card cache in the background, drawing from the old
+  // surfaces until it is done
+  rescaleCardCache();
+  // The cached board is drawn again, at the new size, when next needed
+  static_layer_.release();
 }
 
 double SolitaireGame::getScaleFactor(int window_width, int window_height) const {
@@ -2,6 +2,14 @@
 #define SOLITAIRE_H
 
 #include "cardlib.h"
+#include "../src_rules/autosave.h"
+#include "../src_rules/hint_engine.h"
+#include "../src_rules/seed_index.h"
+#include "../src_rules/undo_journal.h"
+#include "../src_rules/spider_solver.h"
+#include "../src_render/gtk_card_scaler.h"
+#include "../src_render/gtk_damage.h"
+#include "../src_render/particles.h"
 #include <gtk/gtk.h>
 #include <memory>
 #include <optional>
@@ -14,6 +22,9 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include "../src_render/gl_card_batch.h"
+#include "../src_render/gl_explosions.h"
+#include "../src_render/gl_overlay.h"
 #endif
 
 enum class RenderingEngine {
@@ -30,21 +41,6 @@ enum class GameSoundEvent {
   Firework
 };
 
-struct CardFragment {
-  double x;
-  double y;
-  double width;
-  double height;
-  double velocity_x;
-  double velocity_y;
-  double rotation;
-  double rotation_velocity;
-  double target_x;  // UV coordinate X for texture mapping
-  double target_y;  // UV coordinate Y for texture mapping
-  cairo_surface_t *surface;
-  bool active;
-};
-
 struct AnimatedCard {
   cardlib::Card card;
   double x;
@@ -55,7 +51,6 @@ struct AnimatedCard {
   double rotation_velocity;
   bool active;
   bool exploded;
-  std::vector<CardFragment> fragments;
 
   // New fields for deal animation
   double target_x;
@@ -128,10 +123,12 @@ private:
   std::vector<AnimatedCard> animated_cards_;
   guint animation_timer_id_ = 0;
   static constexpr double GRAVITY = 0.8;
+  static constexpr int FRAGMENT_GRID = 4; // An exploded card's rows and columns
   static constexpr double BOUNCE_FACTOR = -0.7;
   static constexpr int ANIMATION_INTERVAL = 16; // ~60 FPS
   int cards_launched_ = 0;
   double launch_timer_ = 0;
+  render::ParticlePool fragments_; // Exploded cards' pieces, by card and cell
 
   // Deal animation fields
   bool deal_animation_active_ = false;
@@ -171,6 +168,8 @@ private:
   void handleStockPileClick();
   void drawCard(cairo_t *cr, int x, int y, const cardlib::Card *card,
                 bool face_up);
+  void paintCard(cairo_t *cr, int x, int y, const cardlib::Card *card,
+                 bool face_up);
   void flipTopTableauCard(int);
   // Drag and drop state
   bool dragging_;
@@ -248,14 +247,22 @@ private:
   double drag_offset_x_;
   double drag_offset_y_;
 
-  std::unordered_map<std::string, cairo_surface_t *> card_surface_cache_;
+  render::CardScaler::Cache card_surface_cache_;
 
   // Double buffering surface
   cairo_surface_t *buffer_surface_;
   cairo_t *buffer_cr_;
+  render::DamageTracker damage_; // What changed since the last frame
+  render::StaticLayer static_layer_; // The settled board, cached
+  render::CardScaler card_scaler_;         // Rescales the card cache
+  std::shared_ptr<const render::CardAtlas> card_atlas_; // Decoded deck
+  render::FrameStats frame_stats_{"spider"};
 
   // Methods for image caching
   void initializeCardCache();
+  void rescaleCardCache();
+  // The deck's images, decoded when they were loaded
+  const std::shared_ptr<const render::CardAtlas> &cardAtlas();
   void cleanupCardCache();
   cairo_surface_t *getCardSurface(const cardlib::Card &card);
   cairo_surface_t *getCardBackSurface();
@@ -278,7 +285,6 @@ private:
   void drawCard_gl(const cardlib::Card &card, int x, int y, bool face_up);
   void drawEmptyPile_gl(int x, int y);
   void drawAnimatedCard_gl(const AnimatedCard &anim_card, GLuint shaderProgram, GLuint VAO);
-  void drawCardFragment_gl(const CardFragment &fragment, const AnimatedCard &card, GLuint shaderProgram, GLuint VAO);
   
   void drawStockPile_gl();
   void drawFoundationPiles_gl();
@@ -306,7 +312,6 @@ private:
   void cleanupOpenGLResources_gl();
   bool validateOpenGLContext_gl();
   bool reloadCustomCardBackTexture_gl();
-  GLuint loadTextureFromMemory(const std::vector<unsigned char> &data);
   
   gboolean onAutoFinishTick_gl(gpointer data);
   void processNextAutoFinishMove_gl();
@@ -318,8 +323,10 @@ private:
   GLuint cardQuadVBO_gl_ = 0;            // Vertex Buffer Object
   GLuint cardQuadEBO_gl_ = 0;            // Element Buffer Object
 
-  std::unordered_map<std::string, GLuint> cardTextures_gl_;  // Texture cache
-  GLuint cardBackTexture_gl_ = 0;                             // Card back texture
+  render::GLCardBatch card_batch_gl_;    // Card textures; a frame's cards
+  render::GLExplosions explosions_gl_;   // The win animation's fragments
+  render::GLOverlay overlay_gl_;         // Highlight outlines
+  render::GLState render_state_gl_{"spider gl"}; // What a frame has bound
 
   static gboolean onGLRealize(GtkGLArea *area, gpointer data);
   static gboolean onGLRender(GtkGLArea *area, GdkGLContext *context, gpointer data);
@@ -347,8 +354,8 @@ private:
       0.7; // Maximum distance threshold (as percentage of screen height)
 
   void explodeCard(AnimatedCard &card);
-  void updateCardFragments(AnimatedCard &card);
-  void drawCardFragment(cairo_t *cr, const CardFragment &fragment);
+  void updateCardFragments();
+  void drawCardFragment(cairo_t *cr, size_t index);
   void startFoundationMoveAnimation(const cardlib::Card &card, int source_pile,
                                     int source_index, int target_pile);
   void updateFoundationMoveAnimation();
@@ -395,6 +402,56 @@ private:
   static gboolean onAutoFinishTick(gpointer data);
   void resetKeyboardNavigation();
 
+  // Hints: the best move is searched for on a worker thread as the board
+  // changes, so H can show it at once
+  static constexpr double HINT_SOLVE_SECONDS = 2.0;   // Hint search budget per position
+  static constexpr size_t HINT_TABLE_MEGABYTES = 16;  // Solver position table
+  static constexpr int HINT_POLL_INTERVAL = 50;       // ms between checks while a hint is pending
+  static constexpr int REPLAY_STEP_INTERVAL = 400;    // ms between moves in replay playback
+  std::unique_ptr<rules::HintEngine<rules::SpiderState, rules::SpiderSolver>> hint_engine_;
+  guint hint_poll_timer_id_ = 0;
+
+  bool buildRulesState(rules::SpiderState &state) const;
+  bool isBoardSettled() const;
+  void postHintPosition();
+  void showHint();
+  bool showHintIfReady();
+  static gboolean onHintPoll(gpointer data);
+
+  // Undo and redo: moves played are kept as reversible deltas
+  rules::UndoHistory<rules::SpiderState> undo_history_;
+
+  // The game as it is played, for Save Replay, and one opened for playback
+  rules::Replay replay_;
+  rules::ReplayPlayer<rules::SpiderState> replay_player_;
+  bool replay_playback_active_ = false;
+  bool replay_paused_ = false;
+  size_t replay_position_ = 0;
+  guint replay_timer_id_ = 0;
+
+  // Keeps replay_ on disk, so the game resumes after a restart or a crash
+  std::unique_ptr<rules::AutosaveLog> autosave_;
+
+  void applyRulesState(const rules::SpiderState &state);
+  bool trackUndoPosition();
+  void undoLastMove();
+  void redoLastMove();
+  void showUndoPosition(const rules::SpiderState &state);
+
+  // Replays: recorded as the game is played, saved and played back
+  rules::ReplayHeader replayHeader() const;
+  void startReplayRecording(const rules::SpiderState &state);
+  void saveReplay();
+  void openReplay();
+  void startReplayPlayback();
+  void stopReplayPlayback();
+  void pauseReplayPlayback(bool paused);
+  void showReplayPosition(size_t position);
+  bool handleReplayKey(GdkEventKey *event);
+  static gboolean onReplayTick(gpointer data);
+  std::string autosavePath() const;
+  void resumeSavedGame();
+
   std::string sounds_zip_path_;
   bool sound_enabled_;
 
@@ -411,6 +468,7 @@ private:
   void cleanupAudio();
 
   unsigned int current_seed_;
+  rules::SeedIndex seed_index_;  // Precomputed winnable seeds, if shipped
   void drawEmptyPile(cairo_t *cr, int x, int y, bool isStockPile);
 
   bool checkForCompletedSequence(int tableau_index);
@@ -440,7 +498,11 @@ void drawAnimations(cairo_t *cr);
 void drawWinAnimation(cairo_t *cr);
 void drawDealAnimation(cairo_t *cr);
 void drawKeyboardNavigation(cairo_t *cr);
-void initBufferSurface(GtkAllocation &allocation);
+bool initBufferSurface(GtkAllocation &allocation);
+void drawBoard();
+void drawStaticLayer(cairo_t *cr);
+void updateStaticLayer(int width, int height);
+void queueRedraw();
 void executeMove(size_t source_pile_idx, int source_card_idx, 
                                size_t target_pile_idx, const std::vector<cardlib::Card>& cards_to_drag);
   
@@ -7,6 +7,34 @@
 #include <direct.h>
 #endif
 
+namespace {
+
+// What a damage tracker item is, the first part of every key
+enum DrawItem {
+  ITEM_BACKGROUND,
+  ITEM_CARD,
+  ITEM_EMPTY_PILE,
+  ITEM_ANIMATED_CARD,
+  ITEM_FRAGMENT,
+  ITEM_HIGHLIGHT,
+  ITEM_STACK_HIGHLIGHT,
+  ITEM_DEAL_MARKER
+};
+
+// Card faces are told apart by suit and rank; every back looks the same
+render::DrawKey cardKey(DrawItem item, const cardlib::Card *card,
+                        bool face_up) {
+  render::DrawKey key;
+  key.add(int(item));
+  if (face_up && card)
+    key.add(static_cast<int>(card->suit)).add(static_cast<int>(card->rank));
+  else
+    key.add(-1);
+  return key;
+}
+
+} // namespace
+
 void SolitaireGame::updateWinAnimation() {
   if (!win_animation_active_)
     return;
@@ -53,7 +81,15 @@ void SolitaireGame::updateWinAnimation() {
       // Check if card should explode (increase random chance from 2% to 5%)
       if (card.y > explosion_min && card.y < explosion_max &&
           (rand() % 100 < 5)) {
+#ifdef USEOPENGL
+        if (rendering_engine_ == RenderingEngine::OPENGL) {
+            explodeCard_gl(card);
+        } else {
+            explodeCard(card);
+        }
+#else
         explodeCard(card);
+#endif
       }
 
       // Check if card is off screen
@@ -63,26 +99,21 @@ void SolitaireGame::updateWinAnimation() {
       } else {
         all_cards_finished = false;
       }
-    } else {
-      // Update explosion fragments
-      updateCardFragments(card);
-
-      // Check if all fragments are inactive
-      bool all_fragments_inactive = true;
-      for (const auto &fragment : card.fragments) {
-        if (fragment.active) {
-          all_fragments_inactive = false;
-          all_cards_finished = false;
-          break;
-        }
-      }
-
-      if (all_fragments_inactive) {
-        card.active = false;
-      }
     }
   }
 
+  // Exploded cards' fragments, until the last leaves the window
+  updateCardFragments();
+  if (!fragments_.empty())
+    all_cards_finished = false;
+
+#ifdef USEOPENGL
+  // Exploded cards' fragments, on the GPU until the last leaves the window
+  explosions_gl_.tick();
+  if (explosions_gl_.active())
+    all_cards_finished = false;
+#endif
+
   // If all cards are finished and we've launched them all or reached a restart point,
   // reset to start launching from beginning
   if (all_cards_finished) {
@@ -174,21 +205,12 @@ void SolitaireGame::stopWinAnimation() {
     animation_timer_id_ = 0;
   }
 
-  // Clean up fragment surfaces to prevent memory leaks
-  for (auto &card : animated_cards_) {
-    for (auto &fragment : card.fragments) {
-      if (fragment.surface) {
-        // Only destroy if the surface is valid
-        if (cairo_surface_status(fragment.surface) == CAIRO_STATUS_SUCCESS) {
-          cairo_surface_destroy(fragment.surface);
-        }
-        fragment.surface = nullptr;
-      }
-    }
-    card.fragments.clear();
-  }
+  fragments_.clear();
 
   animated_cards_.clear();
+#ifdef USEOPENGL
+  explosions_gl_.clear();
+#endif
   animated_foundation_cards_.clear();
   cards_launched_ = 0;
   launch_timer_ = 0;
@@ -321,84 +343,61 @@ void SolitaireGame::launchNextCard() {
   cards_launched_++;
 }
 
-void SolitaireGame::updateCardFragments(AnimatedCard &card) {
-  if (!card.exploded)
-    return;
-
+void SolitaireGame::updateCardFragments() {
   GtkAllocation allocation;
   gtk_widget_get_allocation(game_area_, &allocation);
 
-  // Simple approach: just update existing fragments without creating new ones
-  for (auto &fragment : card.fragments) {
-    if (!fragment.active)
-      continue;
-
-    // Update position
-    fragment.x += fragment.velocity_x;
-    fragment.y += fragment.velocity_y;
-    fragment.velocity_y += GRAVITY;
-
-    // Update rotation
-    fragment.rotation += fragment.rotation_velocity;
-
-    // Check if fragment is in the lower part of the screen for potential "bounce" effect
-    const double min_height = allocation.height * 0.5;
-    if (fragment.y > min_height && fragment.y < allocation.height - fragment.height &&
-        fragment.velocity_y > 0 && // Only when moving downward
-        (rand() % 1000 < 5)) { // 0.5% chance per frame
-      
-      // Instead of creating new fragments, just give this one an upward boost
-      // and maybe change its direction slightly
-      fragment.velocity_y = -fragment.velocity_y * 0.8; // Reverse with reduced energy
-      
-      // Add a slight horizontal randomization
-      fragment.velocity_x += (rand() % 11 - 5); // -5 to +5 adjustment
-      
-      // Increase rotation for visual effect
-      fragment.rotation_velocity *= 1.5;
-      
-      // Play a sound for the "bounce"
-      playSound(GameSoundEvent::Firework);
-    }
-    
-    // Check if fragment is off screen
-    if (fragment.x < -fragment.width || fragment.x > allocation.width ||
-        fragment.y > allocation.height + fragment.height) {
-      // Free the surface if it exists
-      if (fragment.surface) {
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-      }
-      fragment.active = false;
-    }
-  }
+  // One firework for however many fragments bounced this tick
+  if (fragments_.update(GRAVITY, allocation.width, allocation.height) > 0)
+    playSound(GameSoundEvent::Firework);
 }
 
-void SolitaireGame::drawCardFragment(cairo_t *cr, const CardFragment &fragment) {
-  // Skip inactive fragments or those without a surface
-  if (!fragment.active || !fragment.surface)
+void SolitaireGame::drawCardFragment(cairo_t *cr, size_t index) {
+  // The tag is the card's id and which of its cells the fragment is
+  const uint32_t cells = FRAGMENT_GRID * FRAGMENT_GRID;
+  uint32_t tag = fragments_.tag(index);
+  cairo_surface_t *surface = card_surface_cache_.get(int(tag / cells));
+  if (!surface || cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
     return;
-
-  // Check surface status before using it
-  if (cairo_surface_status(fragment.surface) != CAIRO_STATUS_SUCCESS)
+  int cell = int(tag % cells);
+
+  double x = fragments_.x(index);
+  double y = fragments_.y(index);
+  double width = fragments_.width(index);
+  double height = fragments_.height(index);
+  double rotation = fragments_.rotation(index);
+  render::Rect bounds = render::rotatedBounds(x, y, width, height, rotation);
+  render::DrawKey key;
+  key.add(int(ITEM_FRAGMENT)).add(static_cast<const void *>(surface)).add(cell);
+  key.add(x).add(y).add(rotation);
+  if (!damage_.item(bounds, key))
     return;
 
   // Save the current transformation state
   cairo_save(cr);
 
   // Move to the center of the fragment for rotation
-  cairo_translate(cr, fragment.x + fragment.width / 2,
-                  fragment.y + fragment.height / 2);
-  cairo_rotate(cr, fragment.rotation);
-
-  // Draw the fragment
-  cairo_set_source_surface(cr, fragment.surface, -fragment.width / 2,
-                           -fragment.height / 2);
+  cairo_translate(cr, x + width / 2, y + height / 2);
+  cairo_rotate(cr, rotation);
+
+  // Draw the fragment's cell of the card, the card placed so the cell
+  // lies under the rectangle filled. While a rescale is pending the cached
+  // surface is not the card's current size, so the cell is scaled to the
+  // fragment as paintCard() scales a whole card.
+  double cell_width =
+      double(cairo_image_surface_get_width(surface)) / FRAGMENT_GRID;
+  double cell_height =
+      double(cairo_image_surface_get_height(surface)) / FRAGMENT_GRID;
+  cairo_scale(cr, width / cell_width, height / cell_height);
+  cairo_set_source_surface(cr, surface,
+                           -cell_width / 2 - cell % FRAGMENT_GRID * cell_width,
+                           -cell_height / 2 -
+                               cell / FRAGMENT_GRID * cell_height);
 
   // Only proceed if setting the source was successful
   if (cairo_status(cr) == CAIRO_STATUS_SUCCESS) {
-    cairo_rectangle(cr, -fragment.width / 2, -fragment.height / 2,
-                    fragment.width, fragment.height);
+    cairo_rectangle(cr, -cell_width / 2, -cell_height / 2, cell_width,
+                    cell_height);
     cairo_fill(cr);
   }
 
@@ -409,56 +408,146 @@ void SolitaireGame::drawCardFragment(cairo_t *cr, const CardFragment &fragment)
 gboolean SolitaireGame::onDraw(GtkWidget *widget, cairo_t *cr, gpointer data) {
 
   SolitaireGame *game = static_cast<SolitaireGame *>(data);
+  game->frame_stats_.begin();
 
   // Get the widget dimensions
   GtkAllocation allocation;
   gtk_widget_get_allocation(widget, &allocation);
 
-  // Create or resize buffer surface if needed
-  game->initBufferSurface(allocation);
-
-  // Draw all game elements
-  game->drawBackground(game->buffer_cr_);
-  game->drawStockPile(game->buffer_cr_);
-  game->drawFoundationPiles(game->buffer_cr_);
-  game->drawTableauPiles(game->buffer_cr_);
-  game->drawDraggedCards(game->buffer_cr_);
-  game->drawAnimations(game->buffer_cr_);
-  
-  // Draw keyboard navigation highlight if active
-  if (game->keyboard_navigation_active_ && !game->dragging_ &&
-      !game->deal_animation_active_ && !game->win_animation_active_ &&
-      !game->foundation_move_animation_active_ &&
-      !game->stock_to_waste_animation_active_) {
-    game->drawKeyboardNavigation(game->buffer_cr_);
+  // Only what GTK asks for is repainted, the damage queued since the last
+  // frame; the buffer keeps the rest. A new buffer is painted whole.
+  std::vector<render::Rect> clip;
+  if (game->initBufferSurface(allocation) || game->damage_.fullRedraw()) {
+    game->damage_.invalidate();
+    clip.emplace_back(0, 0, allocation.width, allocation.height);
+  } else {
+    clip = render::clipRects(cr);
   }
 
+  game->updateStaticLayer(allocation.width, allocation.height);
+  cairo_save(game->buffer_cr_);
+  render::clipTo(game->buffer_cr_, clip);
+  game->damage_.paintOverLayer(allocation.width, allocation.height, clip);
+  game->drawBoard();
+  cairo_restore(game->buffer_cr_);
+  // Changes made without a refreshDisplay() show up next frame
+  render::queueDamage(widget, game->damage_.finish());
+
   // Copy buffer to window
   cairo_set_source_surface(cr, game->buffer_surface_, 0, 0);
   cairo_paint(cr);
 
+  game->frame_stats_.end(render::totalArea(clip),
+                         (long long)allocation.width * allocation.height);
   return TRUE;
 }
 
-// Initialize or resize the buffer surface
-void SolitaireGame::initBufferSurface(GtkAllocation &allocation) {
+// Everything the Cairo view shows, in drawing order. onDraw() runs it to
+// paint and queueRedraw() to record what changed, so every piece goes
+// through damage_.item() and is painted only if that says so.
+void SolitaireGame::drawBoard() {
+  drawStaticLayer(buffer_cr_);
+  // A painted frame takes the settled board from its cached layer
+  if (damage_.painting()) {
+    static_layer_.blit(buffer_cr_);
+  }
+  drawDraggedCards(buffer_cr_);
+  drawAnimations(buffer_cr_);
+
+  // Draw keyboard navigation highlight if active
+  if (keyboard_navigation_active_ && !dragging_ && !deal_animation_active_ &&
+      !win_animation_active_ && !foundation_move_animation_active_ &&
+      !stock_to_waste_animation_active_) {
+    drawKeyboardNavigation(buffer_cr_);
+  }
+}
+
+// The static layer: the felt and the piles, without the cards being
+// dragged or animated
+void SolitaireGame::drawStaticLayer(cairo_t *cr) {
+  damage_.beginLayer();
+  drawBackground(cr);
+  drawStockPile(cr);
+  drawFoundationPiles(cr);
+  drawTableauPiles(cr);
+  damage_.endLayer();
+}
+
+// Repaints what changed in the cached static layer since it was last
+// painted, made anew after a resize. While cards are dragged or animated
+// over a settled board this finds nothing to do.
+void SolitaireGame::updateStaticLayer(int width, int height) {
+  if (static_layer_.resize(width, height)) {
+    damage_.invalidateLayer();
+  }
+  damage_.recordLayer(width, height);
+  drawStaticLayer(static_layer_.cr());
+  std::vector<render::Rect> stale = damage_.finish();
+  if (stale.empty())
+    return;
+
+  cairo_t *cr = static_layer_.cr();
+  cairo_save(cr);
+  render::clipTo(cr, stale);
+  damage_.paintLayer(width, height, stale);
+  drawStaticLayer(cr);
+  damage_.finish();
+  cairo_restore(cr);
+}
+
+// Queues a redraw of what changed since the last frame
+void SolitaireGame::queueRedraw() {
+#ifdef USEOPENGL
+  if (rendering_engine_ == RenderingEngine::OPENGL && gl_area_) {
+    gtk_widget_queue_draw(gl_area_);
+    return;
+  }
+#endif
+  if (!game_area_)
+    return;
+
+  // Until the buffer matches the window the next frame paints it whole
+  int width = gtk_widget_get_allocated_width(game_area_);
+  int height = gtk_widget_get_allocated_height(game_area_);
   if (!buffer_surface_ ||
-      cairo_image_surface_get_width(buffer_surface_) != allocation.width ||
-      cairo_image_surface_get_height(buffer_surface_) != allocation.height) {
+      cairo_image_surface_get_width(buffer_surface_) != width ||
+      cairo_image_surface_get_height(buffer_surface_) != height) {
+    gtk_widget_queue_draw(game_area_);
+    return;
+  }
 
-    if (buffer_surface_) {
-      cairo_surface_destroy(buffer_surface_);
-      cairo_destroy(buffer_cr_);
-    }
+  damage_.record(width, height);
+  drawBoard();
+  render::queueDamage(game_area_, damage_.finish());
+}
 
-    buffer_surface_ = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, allocation.width, allocation.height);
-    buffer_cr_ = cairo_create(buffer_surface_);
+// Initialize or resize the buffer surface. True if it was (re)created, and
+// so holds nothing yet.
+bool SolitaireGame::initBufferSurface(GtkAllocation &allocation) {
+  if (buffer_surface_ &&
+      cairo_image_surface_get_width(buffer_surface_) == allocation.width &&
+      cairo_image_surface_get_height(buffer_surface_) == allocation.height)
+    return false;
+
+  if (buffer_surface_) {
+    cairo_surface_destroy(buffer_surface_);
+    cairo_destroy(buffer_cr_);
   }
+
+  buffer_surface_ = cairo_image_surface_create(
+      CAIRO_FORMAT_ARGB32, allocation.width, allocation.height);
+  buffer_cr_ = cairo_create(buffer_surface_);
+  return true;
 }
 
 // Draw the game background
 void SolitaireGame::drawBackground(cairo_t *cr) {
+  int width = cairo_image_surface_get_width(buffer_surface_);
+  int height = cairo_image_surface_get_height(buffer_surface_);
+  if (!damage_.item(render::Rect(0, 0, width, height),
+                    render::DrawKey().add(int(ITEM_BACKGROUND))))
+    return;
+
   // Clear buffer with lighter green background
   cairo_set_source_rgb(cr, 0.0, 0.6, 0.0);
   cairo_paint(cr);
@@ -804,38 +893,26 @@ void SolitaireGame::drawDraggedCards(cairo_t *cr) {
 
 // Draw win animation
 void SolitaireGame::drawWinAnimation(cairo_t *cr) {
+  // The cards still whole, with rotation
   for (const auto &anim_card : animated_cards_) {
-    if (!anim_card.active)
-      continue;
-
-    if (!anim_card.exploded) {
-      // Draw the whole card with rotation
+    if (anim_card.active && !anim_card.exploded)
       drawAnimatedCard(cr, anim_card);
-    } else {
-      // Draw all the fragments for this card
-      for (const auto &fragment : anim_card.fragments) {
-        if (fragment.active) {
-#ifdef USEOPENGL
-          if (rendering_engine_ == RenderingEngine::OPENGL) {
-            drawCardFragment_gl(fragment, anim_card, cardShaderProgram_gl_, cardQuadVAO_gl_);
-          } else {
-            drawCardFragment(cr, fragment);
-          }
-#else
-          drawCardFragment(cr, fragment);
-#endif
-        }
-      }
-    }
   }
+
+  // Then the fragments of those that exploded
+  for (size_t i = 0; i < fragments_.size(); i++)
+    drawCardFragment(cr, i);
 }
 
 // Draw deal animation
 void SolitaireGame::drawDealAnimation(cairo_t *cr) {
   // Debug indicator - small red square to indicate deal animation is active
-  cairo_set_source_rgb(cr, 1.0, 0.0, 0.0);
-  cairo_rectangle(cr, 10, 10, 10, 10);
-  cairo_fill(cr);
+  if (damage_.item(render::Rect(10, 10, 10, 10),
+                   render::DrawKey().add(int(ITEM_DEAL_MARKER)))) {
+    cairo_set_source_rgb(cr, 1.0, 0.0, 0.0);
+    cairo_rectangle(cr, 10, 10, 10, 10);
+    cairo_fill(cr);
+  }
 
   for (const auto &anim_card : deal_cards_) {
     if (anim_card.active) {
@@ -891,19 +968,25 @@ void SolitaireGame::highlightSelectedCard(cairo_t *cr) {
   }
 
   // Choose highlight color based on whether we're selecting a card to move
-  if (keyboard_selection_active_ && source_pile_ == selected_pile_ &&
-      (source_card_idx_ == selected_card_idx_ || selected_card_idx_ == -1)) {
-    // Source card/pile is highlighted in blue
-    cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.5); // Semi-transparent blue
-  } else {
-    // Regular selection is highlighted in yellow
-    cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 0.5); // Semi-transparent yellow
-  }
+  bool is_source =
+      keyboard_selection_active_ && source_pile_ == selected_pile_ &&
+      (source_card_idx_ == selected_card_idx_ || selected_card_idx_ == -1);
+  if (damage_.item(render::pixelBounds(x - 2, y - 2, current_card_width_ + 4,
+                                       current_card_height_ + 4, 2),
+                   render::DrawKey().add(int(ITEM_HIGHLIGHT)).add(is_source))) {
+    if (is_source) {
+      // Source card/pile is highlighted in blue
+      cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.5); // Semi-transparent blue
+    } else {
+      // Regular selection is highlighted in yellow
+      cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 0.5); // Semi-transparent yellow
+    }
 
-  cairo_set_line_width(cr, 3.0);
-  cairo_rectangle(cr, x - 2, y - 2, current_card_width_ + 4,
-                  current_card_height_ + 4);
-  cairo_stroke(cr);
+    cairo_set_line_width(cr, 3.0);
+    cairo_rectangle(cr, x - 2, y - 2, current_card_width_ + 4,
+                    current_card_height_ + 4);
+    cairo_stroke(cr);
+  }
 
   // If we have a card selected for movement, highlight all cards below it in a
   // tableau pile
@@ -913,9 +996,6 @@ void SolitaireGame::highlightSelectedCard(cairo_t *cr) {
     auto &tableau_pile = tableau_[tableau_idx];
 
     if (!tableau_pile.empty() && source_card_idx_ < tableau_pile.size()) {
-      // Highlight all cards from the selected one to the bottom
-      cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.3); // Lighter blue for stack
-
       x = current_card_spacing_ +
           tableau_idx * (current_card_width_ + current_card_spacing_);
       y = current_card_spacing_ + current_card_height_ + current_vert_spacing_ +
@@ -926,7 +1006,14 @@ void SolitaireGame::highlightSelectedCard(cairo_t *cr) {
           (tableau_pile.size() - source_card_idx_ - 1) * current_vert_spacing_ +
           current_card_height_;
 
-      if (stack_height > 0) {
+      if (stack_height > 0 &&
+          damage_.item(render::pixelBounds(x - 2, y - 2,
+                                           current_card_width_ + 4,
+                                           stack_height + 4, 2),
+                       render::DrawKey().add(int(ITEM_STACK_HIGHLIGHT)))) {
+        // Highlight all cards from the selected one to the bottom
+        cairo_set_source_rgba(cr, 0.0, 0.5, 1.0, 0.3); // Lighter blue for stack
+        cairo_set_line_width(cr, 3.0);
         cairo_rectangle(cr, x - 2, y - 2, current_card_width_ + 4,
                         stack_height + 4);
         cairo_stroke(cr);
@@ -937,8 +1024,9 @@ void SolitaireGame::highlightSelectedCard(cairo_t *cr) {
 
 
 void SolitaireGame::explodeCard(AnimatedCard &card) {
-  // Mark the card as exploded
+  // Mark the card as exploded; its fragments are drawn from here on
   card.exploded = true;
+  card.active = false;
 
   playSound(GameSoundEvent::Firework);
 
@@ -947,29 +1035,24 @@ void SolitaireGame::explodeCard(AnimatedCard &card) {
   if (!card_surface)
     return;
 
-  // Create fragments
-  card.fragments.clear();
-
   // Split the card into smaller fragments for more dramatic effect (4x4 grid)
-  const int grid_size = 4;
-  const int fragment_width = current_card_width_ / grid_size;
-  const int fragment_height = current_card_height_ / grid_size;
+  const int grid_size = FRAGMENT_GRID;
+  const int card_id = render::cardId(card.card);
+  // Fractional, so the cells cover the whole card
+  const double fragment_width = double(current_card_width_) / grid_size;
+  const double fragment_height = double(current_card_height_) / grid_size;
 
   for (int row = 0; row < grid_size; row++) {
     for (int col = 0; col < grid_size; col++) {
-      CardFragment fragment;
-
       // Initial position
-      fragment.x = card.x + col * fragment_width;
-      fragment.y = card.y + row * fragment_height;
-      fragment.width = fragment_width;
-      fragment.height = fragment_height;
+      double x = card.x + col * fragment_width;
+      double y = card.y + row * fragment_height;
 
       // Calculate distance from center of the card
       double center_x = card.x + current_card_width_ / 2;
       double center_y = card.y + current_card_height_ / 2;
-      double fragment_center_x = fragment.x + fragment_width / 2;
-      double fragment_center_y = fragment.y + fragment_height / 2;
+      double fragment_center_x = x + fragment_width / 2;
+      double fragment_center_y = y + fragment_height / 2;
 
       // Direction vector from center of card
       double dir_x = fragment_center_x - center_x;
@@ -991,54 +1074,16 @@ void SolitaireGame::explodeCard(AnimatedCard &card) {
       double speed = 12.0 + (rand() % 8);
       double upward_bias = -15.0 - (rand() % 10);
 
-      fragment.velocity_x = dir_x * speed + (rand() % 10 - 5);
-      fragment.velocity_y = dir_y * speed + upward_bias;
+      double velocity_x = dir_x * speed + (rand() % 10 - 5);
+      double velocity_y = dir_y * speed + upward_bias;
 
       // Rotation
-      fragment.rotation = card.rotation;
-      fragment.rotation_velocity = (rand() % 60 - 30) / 5.0;
-
-      // Create a new image surface
-      fragment.surface = cairo_image_surface_create(
-          CAIRO_FORMAT_ARGB32, fragment_width, fragment_height);
-
-      if (cairo_surface_status(fragment.surface) != CAIRO_STATUS_SUCCESS) {
-        // Clean up and skip this fragment if we couldn't create the surface
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-        continue;
-      }
-
-      // Create a context for drawing on the new surface
-      cairo_t *cr = cairo_create(fragment.surface);
-      if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
-        // Clean up and skip this fragment if we couldn't create the context
-        cairo_destroy(cr);
-        cairo_surface_destroy(fragment.surface);
-        fragment.surface = nullptr;
-        continue;
-      }
-
-      // Draw white background (for transparency)
-      cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.0);
-      cairo_rectangle(cr, 0, 0, fragment_width, fragment_height);
-      cairo_fill(cr);
-
-      // Draw the fragment of the card
-      cairo_set_source_surface(cr, card_surface, -col * fragment_width,
-                               -row * fragment_height);
-
-      if (cairo_status(cr) == CAIRO_STATUS_SUCCESS) {
-        cairo_rectangle(cr, 0, 0, fragment_width, fragment_height);
-        cairo_fill(cr);
-      }
-
-      // Clean up the drawing context
-      cairo_destroy(cr);
+      double spin = (rand() % 60 - 30) / 5.0;
 
-      // Set the fragment as active
-      fragment.active = true;
-      card.fragments.push_back(fragment);
+      // Set it flying; it is drawn from its cell of the card's surface
+      fragments_.add(x, y, fragment_width, fragment_height, velocity_x,
+                     velocity_y, card.rotation, spin,
+                     uint32_t((card_id * grid_size + row) * grid_size + col));
     }
   }
 
@@ -1385,6 +1430,16 @@ void SolitaireGame::drawAnimatedCard(cairo_t *cr,
   if (!anim_card.active)
     return;
 
+  // Between whole pixels a card looks different too
+  render::Rect bounds =
+      render::rotatedBounds(anim_card.x, anim_card.y, current_card_width_,
+                            current_card_height_, anim_card.rotation);
+  render::DrawKey key =
+      cardKey(ITEM_ANIMATED_CARD, &anim_card.card, anim_card.face_up);
+  key.add(anim_card.x).add(anim_card.y).add(anim_card.rotation);
+  if (!damage_.item(bounds, key))
+    return;
+
   // Draw the card with rotation
   cairo_save(cr);
 
@@ -1399,10 +1454,10 @@ void SolitaireGame::drawAnimatedCard(cairo_t *cr,
   if (rendering_engine_ == RenderingEngine::OPENGL) {
     drawCard_gl(anim_card.card, 0, 0, anim_card.face_up);
   } else {
-    drawCard(cr, 0, 0, &anim_card.card, anim_card.face_up);
+    paintCard(cr, 0, 0, &anim_card.card, anim_card.face_up);
   }
 #else
-  drawCard(cr, 0, 0, &anim_card.card, anim_card.face_up);
+  paintCard(cr, 0, 0, &anim_card.card, anim_card.face_up);
 #endif
 
   cairo_restore(cr);
@@ -1835,6 +1890,11 @@ void SolitaireGame::completeSequenceAnimation() {
 }
 
 void SolitaireGame::drawEmptyPile(cairo_t *cr, int x, int y, bool isStockPile = false) {
+  if (!damage_.item(render::pixelBounds(x, y, current_card_width_,
+                                        current_card_height_, 1),
+                    render::DrawKey().add(int(ITEM_EMPTY_PILE)).add(isStockPile)))
+    return;
+
   // Draw a placeholder for an empty pile with a different color for stock pile
   cairo_save(cr);
   
@@ -1873,85 +1933,51 @@ void SolitaireGame::drawEmptyPile(cairo_t *cr, int x, int y, bool isStockPile =
 
 void SolitaireGame::drawCard(cairo_t *cr, int x, int y,
                              const cardlib::Card *card, bool face_up) {
-  if (face_up && card) {
-
-    std::string key = std::to_string(static_cast<int>(card->suit)) +
-                      std::to_string(static_cast<int>(card->rank));
-    auto it = card_surface_cache_.find(key);
-
-    if (it == card_surface_cache_.end()) {
-      if (auto img = deck_.getCardImage(*card)) {
-        GError *error = nullptr;
-        GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-
-        if (!gdk_pixbuf_loader_write(loader, img->data.data(), img->data.size(),
-                                     &error)) {
-          if (error)
-            g_error_free(error);
-          g_object_unref(loader);
-          return;
-        }
-
-        if (!gdk_pixbuf_loader_close(loader, &error)) {
-          if (error)
-            g_error_free(error);
-          g_object_unref(loader);
-          return;
-        }
-
-        GdkPixbuf *original_pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-        if (original_pixbuf) {
-          GdkPixbuf *scaled_pixbuf = gdk_pixbuf_scale_simple(
-              original_pixbuf,
-              current_card_width_, // Use current dimensions
-              current_card_height_, GDK_INTERP_BILINEAR);
-
-          if (scaled_pixbuf) {
-            cairo_surface_t *surface = cairo_image_surface_create(
-                CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-            cairo_t *surface_cr = cairo_create(surface);
+  if (damage_.item(
+          render::Rect(x, y, current_card_width_, current_card_height_),
+          cardKey(ITEM_CARD, card, face_up))) {
+    paintCard(cr, x, y, card, face_up);
+  }
+}
 
-            gdk_cairo_set_source_pixbuf(surface_cr, scaled_pixbuf, 0, 0);
-            cairo_paint(surface_cr);
-            cairo_destroy(surface_cr);
+// drawCard() without the damage tracking, for cards drawn transformed
+void SolitaireGame::paintCard(cairo_t *cr, int x, int y,
+                              const cardlib::Card *card, bool face_up) {
+  if (face_up && card) {
 
-            card_surface_cache_[key] = surface;
+    int id = render::cardId(*card);
+    cairo_surface_t *surface = card_surface_cache_.get(id);
 
-            g_object_unref(scaled_pixbuf);
-          }
-        }
-        g_object_unref(loader);
-
-        it = card_surface_cache_.find(key);
+    if (!surface) {
+      const render::CardAtlas &atlas = *cardAtlas();
+      if (const render::Rect *region = atlas.find(id)) {
+        surface = card_surface_cache_[id] = render::CardScaler::scale(
+            atlas, *region, current_card_width_, current_card_height_);
       }
     }
 
-    if (it != card_surface_cache_.end()) {
+    if (surface) {
       // Scale the surface to the current card dimensions
       cairo_save(cr);
       cairo_scale(cr,
                   (double)current_card_width_ /
-                      cairo_image_surface_get_width(it->second),
+                      cairo_image_surface_get_width(surface),
                   (double)current_card_height_ /
-                      cairo_image_surface_get_height(it->second));
-      cairo_set_source_surface(cr, it->second,
-                               x * cairo_image_surface_get_width(it->second) /
+                      cairo_image_surface_get_height(surface));
+      cairo_set_source_surface(cr, surface,
+                               x * cairo_image_surface_get_width(surface) /
                                    current_card_width_,
-                               y * cairo_image_surface_get_height(it->second) /
+                               y * cairo_image_surface_get_height(surface) /
                                    current_card_height_);
       cairo_paint(cr);
       cairo_restore(cr);
     }
   } else {
-    auto custom_it = card_surface_cache_.find("custom_back");
-    auto default_it = card_surface_cache_.find("back");
     cairo_surface_t *back_surface = nullptr;
-
-    if (!custom_back_path_.empty() && custom_it != card_surface_cache_.end()) {
-      back_surface = custom_it->second;
-    } else if (default_it != card_surface_cache_.end()) {
-      back_surface = default_it->second;
-    }
+    if (!custom_back_path_.empty())
+      back_surface = card_surface_cache_.get(render::CUSTOM_BACK_ID);
+    if (!back_surface)
+      back_surface = card_surface_cache_.get(render::BACK_ID);
 
     if (back_surface) {
       // Scale the surface to the current card dimensions
@@ -1978,72 +2004,61 @@ void SolitaireGame::drawCard(cairo_t *cr, int x, int y,
 }
 
 void SolitaireGame::initializeCardCache() {
-  // Pre-load all card images into cairo surfaces with current dimensions
+  // Scale every card image out of the atlas with current dimensions
   cleanupCardCache();
 
-  for (const auto &card : deck_.getAllCards()) {
-    if (auto img = deck_.getCardImage(card)) {
-      GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-      gdk_pixbuf_loader_write(loader, img->data.data(), img->data.size(),
-                              nullptr);
-      gdk_pixbuf_loader_close(loader, nullptr);
-
-      GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-      GdkPixbuf *scaled =
-          gdk_pixbuf_scale_simple(pixbuf, current_card_width_,
-                                  current_card_height_, GDK_INTERP_BILINEAR);
-
-      cairo_surface_t *surface = cairo_image_surface_create(
-          CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-      cairo_t *cr = cairo_create(surface);
-      gdk_cairo_set_source_pixbuf(cr, scaled, 0, 0);
-      cairo_paint(cr);
-      cairo_destroy(cr);
-
-      std::string key = std::to_string(static_cast<int>(card.suit)) +
-                        std::to_string(static_cast<int>(card.rank));
-      card_surface_cache_[key] = surface;
-
-      g_object_unref(scaled);
-      g_object_unref(loader);
-    }
+  const render::CardAtlas &atlas = *cardAtlas();
+  for (const auto &[id, region] : atlas.regions()) {
+    card_surface_cache_[id] = render::CardScaler::scale(
+        atlas, region, current_card_width_, current_card_height_);
   }
 
-  // Cache card back
-  if (auto back_img = deck_.getCardBackImage()) {
-    GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
-    gdk_pixbuf_loader_write(loader, back_img->data.data(),
-                            back_img->data.size(), nullptr);
-    gdk_pixbuf_loader_close(loader, nullptr);
-
-    GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
-    GdkPixbuf *scaled = gdk_pixbuf_scale_simple(
-        pixbuf, current_card_width_, current_card_height_, GDK_INTERP_BILINEAR);
+  card_scaler_.built(current_card_width_, current_card_height_);
+}
 
-    cairo_surface_t *surface = cairo_image_surface_create(
-        CAIRO_FORMAT_ARGB32, current_card_width_, current_card_height_);
-    cairo_t *cr = cairo_create(surface);
-    gdk_cairo_set_source_pixbuf(cr, scaled, 0, 0);
-    cairo_paint(cr);
-    cairo_destroy(cr);
+void SolitaireGame::rescaleCardCache() {
+  // Nothing to draw from in the meantime
+  if (card_surface_cache_.empty()) {
+    initializeCardCache();
+    return;
+  }
+  if (!card_scaler_.needs(current_card_width_, current_card_height_))
+    return;
 
-    card_surface_cache_["back"] = surface;
+  card_scaler_.start(cardAtlas(), current_card_width_,
+                     current_card_height_, 1, card_surface_cache_, [this] {
+                       // Every card on screen is redrawn with the new
+                       // surfaces
+                       damage_.invalidate();
+                       queueRedraw();
+                     });
+}
 
-    g_object_unref(scaled);
-    g_object_unref(loader);
+const std::shared_ptr<const render::CardAtlas> &SolitaireGame::cardAtlas() {
+  // Decoded again only when the deck's images change, never for a new
+  // size or rendering engine
+  if (!card_atlas_ || card_atlas_->source() != deck_.imageSerial()) {
+    std::vector<render::EncodedImage> images;
+    for (const auto &image : deck_.getCardImages()) {
+      if (!image.card_info || image.card_info->is_alternate_art)
+        continue;
+      const cardlib::Card &card = *image.card_info;
+      images.push_back({render::cardId(card), &image.data});
+    }
+    if (auto back_img = deck_.getCardBackImage()) {
+      images.push_back({render::BACK_ID, &back_img->data});
+    }
+    card_atlas_ = render::decodeCardAtlas(images, deck_.imageSerial());
   }
+  return card_atlas_;
 }
 
 cairo_surface_t *SolitaireGame::getCardSurface(const cardlib::Card &card) {
-  std::string key = std::to_string(static_cast<int>(card.suit)) +
-                    std::to_string(static_cast<int>(card.rank));
-  auto it = card_surface_cache_.find(key);
-  return it != card_surface_cache_.end() ? it->second : nullptr;
+  return card_surface_cache_.get(render::cardId(card));
 }
 
 cairo_surface_t *SolitaireGame::getCardBackSurface() {
-  auto it = card_surface_cache_.find("back");
-  return it != card_surface_cache_.end() ? it->second : nullptr;
+  return card_surface_cache_.get(render::BACK_ID);
 }
 
 void SolitaireGame::refreshCardCache() {
@@ -2084,7 +2099,7 @@ void SolitaireGame::refreshCardCache() {
               cairo_paint(surface_cr);
               cairo_destroy(surface_cr);
 
-              card_surface_cache_["custom_back"] = surface;
+              card_surface_cache_[render::CUSTOM_BACK_ID] = surface;
 
               g_object_unref(scaled);
             }
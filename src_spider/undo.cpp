@@ -0,0 +1,86 @@
+#include "spider.h"
+#include <array>
+#include <gtk/gtk.h>
+
+// Puts a rules position back on the board. The Card objects are reused
+// from the piles so each card keeps its art; cards of a completed run that
+// comes back were off the board, and are made afresh.
+void SolitaireGame::applyRulesState(const rules::SpiderState &state) {
+  std::array<cardlib::Card, 64> cards;
+  std::array<bool, 64> known{};
+  auto remember = [&](const cardlib::Card &card) {
+    uint8_t id = cardlib::PackedCard(card).id();
+    cards[id] = card;
+    known[id] = true;
+  };
+  auto cardFor = [&](cardlib::PackedCard card) {
+    return known[card.id()] ? cards[card.id()] : card.toCard();
+  };
+
+  for (const auto &card : stock_) {
+    remember(card);
+  }
+  for (const auto &card : foundation_[0]) {
+    remember(card);
+  }
+  for (const auto &pile : tableau_) {
+    for (const auto &tableau_card : pile) {
+      remember(tableau_card.card);
+    }
+  }
+
+  stock_.clear();
+  for (cardlib::PackedCard card : state.stock) {
+    stock_.push_back(cardFor(card));
+  }
+  foundation_[0].clear();
+  for (cardlib::PackedCard card : state.completed) {
+    foundation_[0].push_back(cardFor(card));
+  }
+  for (size_t t = 0; t < tableau_.size(); t++) {
+    tableau_[t].clear();
+    for (cardlib::PackedCard card : state.tableau[t]) {
+      tableau_[t].emplace_back(cardFor(card), card.faceUp());
+    }
+  }
+}
+
+// Called on every redraw; works out the move since the last position.
+// False if the board can't be followed right now.
+bool SolitaireGame::trackUndoPosition() {
+  rules::SpiderState state;
+  if (replay_playback_active_ || !isBoardSettled() ||
+      !buildRulesState(state)) {
+    return false;
+  }
+  if (undo_history_.track(state)) {
+    startReplayRecording(state);
+  }
+  if (autosave_) {
+    autosave_->update(replay_);
+  }
+  return true;
+}
+
+void SolitaireGame::undoLastMove() {
+  rules::SpiderState state;
+  if (trackUndoPosition() && undo_history_.undo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void SolitaireGame::redoLastMove() {
+  rules::SpiderState state;
+  if (trackUndoPosition() && undo_history_.redo(state)) {
+    showUndoPosition(state);
+  }
+}
+
+void SolitaireGame::showUndoPosition(const rules::SpiderState &state) {
+  applyRulesState(state);
+  keyboard_selection_active_ = false;
+  source_pile_ = -1;
+  source_card_idx_ = -1;
+  playSound(GameSoundEvent::CardPlace);
+  refreshDisplay();
+}
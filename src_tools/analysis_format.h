@@ -0,0 +1,123 @@
+#ifndef ANALYSIS_FORMAT_H
+#define ANALYSIS_FORMAT_H
+
+// Binary output of solitaire_analyze. All fields are little-endian.
+//
+//   header, 24 bytes:
+//     char[4]  magic "SOLA"
+//     uint16   version (1)
+//     uint8    rules::DealVariant
+//     uint8    reserved, 0
+//     uint64   node limit per seed (0 = none)
+//     uint64   time limit per seed in microseconds (0 = none)
+//   then one 20-byte record per seed, in completion order (not sorted):
+//     uint32   seed
+//     uint8    rules::SolveStatus: 0 solved, 1 search exhausted, 2 gave up.
+//              Exhausted proves the deal unwinnable only where
+//              rules::exhaustedIsProof() says so (Pyramid)
+//     uint8    reserved, 0
+//     uint16   solution length in moves (0 unless solved)
+//     uint64   nodes searched
+//     uint32   solve time in microseconds
+
+#include "../src_rules/deal_solver.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace analysis {
+
+constexpr char MAGIC[4] = {'S', 'O', 'L', 'A'};
+constexpr uint16_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 24;
+constexpr size_t RECORD_SIZE = 20;
+
+struct Header {
+  rules::DealVariant variant = rules::DealVariant::KLONDIKE_DRAW3;
+  uint64_t max_nodes = 0;
+  uint64_t max_micros = 0;
+};
+
+struct Record {
+  uint32_t seed = 0;
+  rules::SolveStatus status = rules::SolveStatus::LIMIT_REACHED;
+  uint16_t moves = 0;
+  uint64_t nodes = 0;
+  uint32_t micros = 0;
+};
+
+namespace detail {
+
+inline void put(uint8_t *&out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    *out++ = static_cast<uint8_t>(value >> (8 * i));
+}
+
+inline uint64_t get(const uint8_t *&in, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= static_cast<uint64_t>(*in++) << (8 * i);
+  return value;
+}
+
+} // namespace detail
+
+inline bool writeHeader(FILE *file, const Header &header) {
+  uint8_t buffer[HEADER_SIZE];
+  uint8_t *out = buffer;
+  for (char c : MAGIC)
+    *out++ = static_cast<uint8_t>(c);
+  detail::put(out, VERSION, 2);
+  detail::put(out, static_cast<uint8_t>(header.variant), 1);
+  detail::put(out, 0, 1);
+  detail::put(out, header.max_nodes, 8);
+  detail::put(out, header.max_micros, 8);
+  return fwrite(buffer, 1, HEADER_SIZE, file) == HEADER_SIZE;
+}
+
+// Fails on a short read, a bad magic or an unknown version
+inline bool readHeader(FILE *file, Header &header) {
+  uint8_t buffer[HEADER_SIZE];
+  if (fread(buffer, 1, HEADER_SIZE, file) != HEADER_SIZE)
+    return false;
+  for (int i = 0; i < 4; i++) {
+    if (buffer[i] != static_cast<uint8_t>(MAGIC[i]))
+      return false;
+  }
+  const uint8_t *in = buffer + 4;
+  if (detail::get(in, 2) != VERSION)
+    return false;
+  header.variant = static_cast<rules::DealVariant>(detail::get(in, 1));
+  detail::get(in, 1);
+  header.max_nodes = detail::get(in, 8);
+  header.max_micros = detail::get(in, 8);
+  return true;
+}
+
+// Encodes a record into buffer, which must hold RECORD_SIZE bytes
+inline void encodeRecord(const Record &record, uint8_t *buffer) {
+  uint8_t *out = buffer;
+  detail::put(out, record.seed, 4);
+  detail::put(out, static_cast<uint8_t>(record.status), 1);
+  detail::put(out, 0, 1);
+  detail::put(out, record.moves, 2);
+  detail::put(out, record.nodes, 8);
+  detail::put(out, record.micros, 4);
+}
+
+inline bool readRecord(FILE *file, Record &record) {
+  uint8_t buffer[RECORD_SIZE];
+  if (fread(buffer, 1, RECORD_SIZE, file) != RECORD_SIZE)
+    return false;
+  const uint8_t *in = buffer;
+  record.seed = static_cast<uint32_t>(detail::get(in, 4));
+  record.status = static_cast<rules::SolveStatus>(detail::get(in, 1));
+  detail::get(in, 1);
+  record.moves = static_cast<uint16_t>(detail::get(in, 2));
+  record.nodes = detail::get(in, 8);
+  record.micros = static_cast<uint32_t>(detail::get(in, 4));
+  return true;
+}
+
+} // namespace analysis
+
+#endif // ANALYSIS_FORMAT_H
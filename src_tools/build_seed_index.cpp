@@ -0,0 +1,130 @@
+// Builds the winnable-seed index the games map at startup.
+//
+//   build_seed_index --output winnable_seeds.idx ANALYSIS.bin...
+//
+// Inputs are binary files from solitaire_analyze --format binary, for any
+// mix of variants. Every seed solved in any input is marked winnable; one
+// section is written per variant, covering the lowest to the highest seed
+// analysed. See seed_index.h for the file layout.
+//
+// Typical use, one run per variant:
+//   solitaire_analyze --game klondike-draw3 --count 1000000 --format binary
+//       --output klondike3.bin
+//   build_seed_index --output winnable_seeds.idx klondike3.bin ...
+
+#include "../src_rules/seed_index.h"
+#include "analysis_format.h"
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Coverage {
+  uint32_t first = UINT32_MAX;
+  uint32_t last = 0;
+  std::vector<uint32_t> winnable;
+};
+
+void put(std::vector<uint8_t> &out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string output;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+      output = argv[++i];
+    } else {
+      inputs.push_back(argv[i]);
+    }
+  }
+  if (output.empty() || inputs.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " --output winnable_seeds.idx ANALYSIS.bin...\n";
+    return 1;
+  }
+
+  std::map<rules::DealVariant, Coverage> variants;
+  for (const auto &path : inputs) {
+    FILE *file = fopen(path.c_str(), "rb");
+    analysis::Header header;
+    if (!file || !analysis::readHeader(file, header)) {
+      std::cerr << path << ": not a solitaire_analyze binary file\n";
+      if (file)
+        fclose(file);
+      return 1;
+    }
+    Coverage &coverage = variants[header.variant];
+    analysis::Record record;
+    while (analysis::readRecord(file, record)) {
+      coverage.first = std::min(coverage.first, record.seed);
+      coverage.last = std::max(coverage.last, record.seed);
+      if (record.status == rules::SolveStatus::SOLVED)
+        coverage.winnable.push_back(record.seed);
+    }
+    fclose(file);
+  }
+
+  // Drop variants whose inputs held no records at all
+  for (auto it = variants.begin(); it != variants.end();) {
+    if (it->second.first > it->second.last)
+      it = variants.erase(it);
+    else
+      ++it;
+  }
+
+  std::vector<uint8_t> index;
+  index.insert(index.end(), rules::SEED_INDEX_MAGIC, rules::SEED_INDEX_MAGIC + 4);
+  put(index, rules::SEED_INDEX_VERSION, 2);
+  put(index, variants.size(), 2);
+  put(index, 0, 8);
+
+  // Bitmaps follow the section table, each starting on an 8-byte boundary
+  uint64_t offset = rules::SEED_INDEX_HEADER_SIZE +
+                    variants.size() * rules::SEED_INDEX_SECTION_SIZE;
+  std::vector<std::vector<uint8_t>> bitmaps;
+  for (auto &[variant, coverage] : variants) {
+    uint64_t count = uint64_t(coverage.last) - coverage.first + 1;
+    std::vector<uint8_t> bits((count + 7) / 8, 0);
+    uint64_t winnable = 0;
+    for (uint32_t seed : coverage.winnable) {
+      uint64_t i = seed - coverage.first;
+      if (!(bits[i >> 3] & (1u << (i & 7)))) {
+        bits[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+        winnable++;
+      }
+    }
+
+    index.push_back(static_cast<uint8_t>(variant));
+    put(index, 0, 3);
+    put(index, coverage.first, 4);
+    put(index, count, 8);
+    put(index, winnable, 8);
+    put(index, offset, 8);
+    offset += (bits.size() + 7) & ~uint64_t(7);
+    bits.resize((bits.size() + 7) & ~size_t(7), 0);
+    bitmaps.push_back(std::move(bits));
+
+    std::cout << rules::dealVariantName(variant) << ": seeds "
+              << coverage.first << ".." << coverage.last << ", " << winnable
+              << " winnable\n";
+  }
+  for (const auto &bits : bitmaps)
+    index.insert(index.end(), bits.begin(), bits.end());
+
+  FILE *file = fopen(output.c_str(), "wb");
+  if (!file || fwrite(index.data(), 1, index.size(), file) != index.size() ||
+      fclose(file) != 0) {
+    std::cerr << "Cannot write " << output << "\n";
+    return 1;
+  }
+  std::cout << "Wrote " << output << " (" << index.size() << " bytes)\n";
+  return 0;
+}
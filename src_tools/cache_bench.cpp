@@ -0,0 +1,265 @@
+// Headless benchmark for the games' per-card caches (see
+// src_render/card_cache.h).
+//
+//   cache_bench [--frames N]
+//
+// Runs the Cairo renderers' per-card draw loop over a Klondike deal: every
+// card through DamageTracker::item() and then a lookup of its surface, as
+// drawCard() and paintCard() do, with the dragged card moving each frame.
+// Then the OpenGL renderers' loop, a lookup of each card's texture. Each
+// runs once through the string-keyed std::unordered_map the games used
+// before and once through render::CardCache, with pointers and numbers
+// standing in for the surfaces and textures.
+//
+// The global operator new is replaced to count heap allocations. The
+// report gives the time per card drawn and the allocations per frame after
+// the first. The CardCache loops must not allocate at all; the exit status
+// says whether they did.
+
+#include "../src_render/card_cache.h"
+#include "../src_render/damage.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+size_t allocations = 0;
+
+} // namespace
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *pointer = malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { free(pointer); }
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program << " [--frames N]\n";
+}
+
+using render::Rect;
+
+using Clock = std::chrono::steady_clock;
+
+// A card as the games hold it: cardlib's Suit and Rank, as ints
+struct Card {
+  int suit;
+  int rank;
+};
+
+struct Draw {
+  Card card;
+  bool face_up;
+  Rect bounds;
+};
+
+// Klondike mid-game at 1920x1080: the seven tableau columns with their
+// face-down cards, the waste and the foundations, every face once
+std::vector<Draw> dealDraws() {
+  const int width = 174, height = 252, spacing = 21, fan = 50;
+  std::vector<Draw> draws;
+  int next = 0;
+  auto card = [&next] {
+    Card card{next % 4, next / 4 % 13 + 1};
+    next++;
+    return card;
+  };
+  for (int column = 0; column < 7; column++) {
+    int x = spacing + column * (width + spacing);
+    for (int row = 0; row <= column + 3; row++) {
+      bool face_up = row >= column;
+      draws.push_back({card(), face_up,
+                       Rect(x, 2 * spacing + height + row * fan, width,
+                            height)});
+    }
+  }
+  while (next < 52) {
+    int pile = next % 6;
+    draws.push_back(
+        {card(), true,
+         Rect(spacing + pile * (width + spacing), spacing, width, height)});
+  }
+  return draws;
+}
+
+// The key drawCard() passes the damage tracker
+uint64_t itemKey(const Draw &draw) {
+  return render::DrawKey()
+      .add(1)
+      .add(draw.face_up ? render::cardId(draw.card) : -1)
+      .value();
+}
+
+struct Result {
+  double ns_per_card = 0;
+  double allocations_per_frame = 0;
+};
+
+// Runs frames frames of draw, which draws every card in draws and returns
+// a value that keeps the lookups from being optimised out
+template <class DrawFrame>
+Result runFrames(const std::vector<Draw> &draws, int frames,
+                 DrawFrame draw_frame) {
+  uintptr_t sink = draw_frame(0); // warms the tracker's buffers up
+  size_t before = allocations;
+  Clock::time_point start = Clock::now();
+  for (int frame = 1; frame <= frames; frame++)
+    sink += draw_frame(frame);
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start)
+                  .count();
+  Result result;
+  result.ns_per_card = ns / (double(frames) * draws.size());
+  result.allocations_per_frame = double(allocations - before) / frames;
+  if (sink == 1)
+    std::cout << ""; // never, but the compiler cannot know
+  return result;
+}
+
+void printResult(const char *name, const Result &result) {
+  std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+            << std::setprecision(1) << result.ns_per_card << " ns/card, "
+            << std::setprecision(2) << result.allocations_per_frame
+            << " allocations/frame\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int frames = 20000;
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--frames") && has_value) {
+      frames = atoi(argv[++i]);
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (frames < 1) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  std::vector<Draw> draws = dealDraws();
+  const int window_width = 1920, window_height = 1080;
+  const std::vector<Rect> clip = {Rect(0, 0, window_width, window_height)};
+  // Distinct addresses standing in for the surfaces and texture names
+  static char surfaces[render::CARD_IDS];
+
+  // The caches as the games filled them before, and now
+  std::unordered_map<std::string, char *> surface_map;
+  std::unordered_map<std::string, unsigned> texture_map;
+  render::CardCache<char *> surface_cache;
+  render::CardCache<unsigned> texture_cache;
+  for (int suit = 0; suit < 4; suit++) {
+    for (int rank = 1; rank <= 13; rank++) {
+      int id = render::cardId(suit, rank);
+      surface_map[std::to_string(suit) + std::to_string(rank)] = surfaces + id;
+      texture_map[std::to_string(suit) + "_" + std::to_string(rank)] = id + 1;
+      surface_cache[id] = surfaces + id;
+      texture_cache[id] = id + 1;
+    }
+  }
+  surface_map["back"] = surfaces + render::BACK_ID;
+  surface_cache[render::BACK_ID] = surfaces + render::BACK_ID;
+  unsigned back_texture = render::BACK_ID + 1;
+
+  render::DamageTracker tracker;
+  // The last card follows the pointer, as in a drag
+  auto moved = [&draws](const Draw &draw, int frame) {
+    Rect bounds = draw.bounds;
+    if (&draw == &draws.back()) {
+      bounds.x += frame % 200;
+      bounds.y += frame % 120;
+    }
+    return bounds;
+  };
+
+  Result cairo_map = runFrames(draws, frames, [&](int frame) {
+    uintptr_t sink = 0;
+    tracker.paint(window_width, window_height, clip);
+    for (const Draw &draw : draws) {
+      if (!tracker.item(moved(draw, frame), itemKey(draw)))
+        continue;
+      if (draw.face_up) {
+        std::string key =
+            std::to_string(draw.card.suit) + std::to_string(draw.card.rank);
+        auto it = surface_map.find(key);
+        if (it != surface_map.end())
+          sink += uintptr_t(it->second);
+      } else {
+        auto it = surface_map.find("back");
+        if (it != surface_map.end())
+          sink += uintptr_t(it->second);
+      }
+    }
+    tracker.finish();
+    return sink;
+  });
+
+  Result cairo_cache = runFrames(draws, frames, [&](int frame) {
+    uintptr_t sink = 0;
+    tracker.paint(window_width, window_height, clip);
+    for (const Draw &draw : draws) {
+      if (!tracker.item(moved(draw, frame), itemKey(draw)))
+        continue;
+      sink += uintptr_t(draw.face_up
+                            ? surface_cache.get(render::cardId(draw.card))
+                            : surface_cache.get(render::BACK_ID));
+    }
+    tracker.finish();
+    return sink;
+  });
+
+  Result gl_map = runFrames(draws, frames, [&](int) {
+    uintptr_t sink = 0;
+    for (const Draw &draw : draws) {
+      unsigned texture = back_texture;
+      if (draw.face_up) {
+        std::string card_key = std::to_string(draw.card.suit) + "_" +
+                               std::to_string(draw.card.rank);
+        auto it = texture_map.find(card_key);
+        if (it != texture_map.end())
+          texture = it->second;
+      }
+      sink += texture;
+    }
+    return sink;
+  });
+
+  Result gl_cache = runFrames(draws, frames, [&](int) {
+    uintptr_t sink = 0;
+    for (const Draw &draw : draws) {
+      unsigned texture = back_texture;
+      if (draw.face_up) {
+        if (unsigned cached = texture_cache.get(render::cardId(draw.card)))
+          texture = cached;
+      }
+      sink += texture;
+    }
+    return sink;
+  });
+
+  std::cout << frames << " frames of " << draws.size() << " cards\n";
+  printResult("cairo, string map", cairo_map);
+  printResult("cairo, card cache", cairo_cache);
+  printResult("opengl, string map", gl_map);
+  printResult("opengl, card cache", gl_cache);
+  return cairo_cache.allocations_per_frame > 0 ||
+                 gl_cache.allocations_per_frame > 0
+             ? 1
+             : 0;
+}
@@ -0,0 +1,182 @@
+// Headless benchmark for cardlib's card image lookups (see
+// shared/cardlib.h).
+//
+//   cardlib_bench [--frames N] [--deck ZIP]
+//
+// Loads the deck (cards/cards.zip by default) and looks up the image of
+// every card and of the back each frame, as the OpenGL renderers did when
+// drawing. Runs once the way Deck::getCardImage() used to, a linear
+// search returning the image by value, and once through the views Deck
+// and MultiDeck return now.
+//
+// The global operator new is replaced to count heap allocations. The
+// report gives the time per lookup and the allocations per frame after the
+// first. The view lookups must not allocate at all; the exit status says
+// whether they did.
+
+#include "../shared/cardlib.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t allocations = 0;
+
+} // namespace
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *pointer = malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { free(pointer); }
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program << " [--frames N] [--deck ZIP]\n";
+}
+
+using cardlib::Card;
+using cardlib::CardImage;
+
+using Clock = std::chrono::steady_clock;
+
+// Deck::getCardImage() before it returned views
+std::optional<CardImage> copyCardImage(const cardlib::Deck &deck,
+                                       const Card &card) {
+  for (const CardImage &image : deck.getCardImages()) {
+    if (image.card_info && image.card_info->suit == card.suit &&
+        image.card_info->rank == card.rank &&
+        image.card_info->is_alternate_art == card.is_alternate_art) {
+      return image;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<CardImage> copyCardBackImage(const cardlib::Deck &deck) {
+  if (const CardImage *back = deck.getCardBackImage())
+    return *back;
+  return std::nullopt;
+}
+
+struct Result {
+  double ns_per_lookup = 0;
+  double allocations_per_frame = 0;
+};
+
+// Runs frames frames of draw_frame, which looks up every card in cards and
+// the back and returns a value that keeps the lookups from being optimised
+// out
+template <class DrawFrame>
+Result runFrames(const std::vector<Card> &cards, int frames,
+                 DrawFrame draw_frame) {
+  size_t sink = draw_frame();
+  size_t before = allocations;
+  Clock::time_point start = Clock::now();
+  for (int frame = 1; frame <= frames; frame++)
+    sink += draw_frame();
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start)
+                  .count();
+  Result result;
+  result.ns_per_lookup = ns / (double(frames) * (cards.size() + 1));
+  result.allocations_per_frame = double(allocations - before) / frames;
+  if (sink == 1)
+    std::cout << ""; // never, but the compiler cannot know
+  return result;
+}
+
+void printResult(const char *name, const Result &result) {
+  std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+            << std::setprecision(1) << result.ns_per_lookup << " ns/lookup, "
+            << std::setprecision(2) << result.allocations_per_frame
+            << " allocations/frame\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int frames = 20000;
+  std::string deck_path = "cards/cards.zip";
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--frames") && has_value) {
+      frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--deck") && has_value) {
+      deck_path = argv[++i];
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (frames < 1) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  cardlib::Deck deck;
+  cardlib::MultiDeck multi_deck;
+  try {
+    deck = cardlib::Deck(deck_path);
+    multi_deck = cardlib::MultiDeck(2, deck_path);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::vector<Card> cards = deck.getAllCards();
+
+  Result copies = runFrames(cards, frames, [&]() {
+    size_t sink = 0;
+    for (const Card &card : cards) {
+      if (auto image = copyCardImage(deck, card))
+        sink += image->data.size();
+    }
+    if (auto back = copyCardBackImage(deck))
+      sink += back->data.size();
+    return sink;
+  });
+
+  Result deck_views = runFrames(cards, frames, [&]() {
+    size_t sink = 0;
+    for (const Card &card : cards) {
+      if (auto image = deck.getCardImage(card))
+        sink += image->data.size();
+    }
+    if (auto back = deck.getCardBackImage())
+      sink += back->data.size();
+    return sink;
+  });
+
+  Result multi_deck_views = runFrames(cards, frames, [&]() {
+    size_t sink = 0;
+    for (const Card &card : cards) {
+      if (auto image = multi_deck.getCardImage(card))
+        sink += image->data.size();
+    }
+    if (auto back = multi_deck.getCardBackImage())
+      sink += back->data.size();
+    return sink;
+  });
+
+  std::cout << frames << " frames of " << cards.size()
+            << " cards and the back\n";
+  printResult("copies", copies);
+  printResult("Deck views", deck_views);
+  printResult("MultiDeck views", multi_deck_views);
+  return deck_views.allocations_per_frame > 0 ||
+                 multi_deck_views.allocations_per_frame > 0
+             ? 1
+             : 0;
+}
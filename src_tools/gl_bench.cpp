@@ -0,0 +1,794 @@
+// Headless benchmark for the batched OpenGL card renderer (see
+// src_render/gl_card_batch.h).
+//
+//   gl_bench [--frames N] [--size WxH]
+//
+// Opens an offscreen OpenGL 3.3 context through EGL, with no window or
+// display server: under Mesa that is llvmpipe where there is no GPU
+// (LIBGL_ALWAYS_SOFTWARE=1 forces it). Each scene is then drawn into a
+// framebuffer object twice over: card by card, the way the games drew
+// before, with a texture per card and the uniform lookups, bind and draw
+// call per card that went with it, and through render::GLCardBatch, in one
+// instanced draw. The report gives the time per frame, and the part of it
+// the CPU spends issuing the calls, and the draw calls and texture binds
+// card by card or the state changes render::GLState let through batched.
+// llvmpipe rasterises on the CPU too, so the frame time is mostly fill;
+// the issuing time is what a GPU's driver costs.
+//
+// The two must draw the same pixels. A texture coordinate worked out
+// along another path can round to one level off in a channel, so only a
+// pixel further off than that is counted as a mismatch; the exit status
+// says whether there were any.
+//
+// The scenes are a Spider table, all 104 cards fanned out in ten columns
+// with a run being dragged, and Klondike's win animation, half the deck in
+// flight and turning, the other half blown into 4x4 fragments. The deck is
+// generated: a colour a card, rounded translucent corners and a border.
+// The card-by-card shader takes the fragment's part of the image as a
+// uniform, which the games' did not, so both draw the same pixels.
+//
+// Then the keyboard highlight's outlines, one over each card of the Spider
+// table: made, filled, drawn and deleted one vertex array and two buffers
+// at a time, as the games drew them, and through render::GLOverlay's ring.
+// They must match to the bit.
+//
+// Last, 52 cards blown into GLExplosions::GRID x GRID fragments each: their
+// positions worked out on the CPU with render::ExplosionPhysics and queued
+// on the batch, the whole lot uploaded each frame, as a CPU simulation
+// would have to, against render::GLExplosions working them out in its
+// vertex shader from the launches uploaded once. These match as the
+// cards do.
+
+#define GL_GLEXT_PROTOTYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glcorearb.h>
+
+#include "../src_render/card_atlas.h"
+#include "../src_render/card_cache.h"
+#include "../src_render/gl_card_batch.h"
+#include "../src_render/gl_explosions.h"
+#include "../src_render/gl_overlay.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program << " [--frames N] [--size WxH]\n";
+}
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// An offscreen context: Mesa's surfaceless platform where it has one, the
+// default display's otherwise, drawing into no surface at all
+bool createContext() {
+  EGLDisplay display = EGL_NO_DISPLAY;
+  auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+      eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (get_platform_display)
+    display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                   EGL_DEFAULT_DISPLAY, nullptr);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY ||
+        !eglInitialize(display, nullptr, nullptr))
+      return false;
+  }
+  if (!eglBindAPI(EGL_OPENGL_API))
+    return false;
+
+  const EGLint config_attributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                      EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint configs = 0;
+  eglChooseConfig(display, config_attributes, &config, 1, &configs);
+  const EGLint context_attributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  EGLContext context =
+      eglCreateContext(display, configs > 0 ? config : EGL_NO_CONFIG_KHR,
+                       EGL_NO_CONTEXT, context_attributes);
+  return context != EGL_NO_CONTEXT &&
+         eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+constexpr int IMAGE_WIDTH = 250;
+constexpr int IMAGE_HEIGHT = 363;
+
+// A colour of its own for each id, so a card drawn from the wrong layer
+// shows, inside a dark border and rounded corners that fade out
+std::vector<uint8_t> generateImage(int id) {
+  const int radius = 16;
+  std::vector<uint8_t> rgba(size_t(IMAGE_WIDTH) * IMAGE_HEIGHT * 4);
+  for (int y = 0; y < IMAGE_HEIGHT; y++) {
+    for (int x = 0; x < IMAGE_WIDTH; x++) {
+      uint8_t *pixel = rgba.data() + (size_t(y) * IMAGE_WIDTH + x) * 4;
+      double dx = std::max({radius - x - 0.5, x + 0.5 - (IMAGE_WIDTH - radius),
+                            0.0});
+      double dy = std::max({radius - y - 0.5,
+                            y + 0.5 - (IMAGE_HEIGHT - radius), 0.0});
+      double inside = radius - std::sqrt(dx * dx + dy * dy);
+      bool border = inside < 3;
+      pixel[0] = border ? 30 : uint8_t(id * 37 + x / 2);
+      pixel[1] = border ? 30 : uint8_t(id * 91 + y / 3);
+      pixel[2] = border ? 30 : uint8_t(id * 53 + (x ^ y) % 64);
+      pixel[3] = uint8_t(
+          std::lround(std::min(std::max(inside + 0.5, 0.0), 1.0) * 255));
+    }
+  }
+  return rgba;
+}
+
+void generateDeck(render::CardAtlas &atlas) {
+  for (int suit = 0; suit < render::CARD_SUITS; suit++) {
+    for (int rank = 1; rank <= 13; rank++) {
+      int id = render::cardId(suit, rank);
+      std::vector<uint8_t> rgba = generateImage(id);
+      atlas.add(id, IMAGE_WIDTH, IMAGE_HEIGHT, 4, IMAGE_WIDTH * 4,
+                rgba.data());
+    }
+  }
+  std::vector<uint8_t> back = generateImage(render::BACK_ID);
+  atlas.add(render::BACK_ID, IMAGE_WIDTH, IMAGE_HEIGHT, 4, IMAGE_WIDTH * 4,
+            back.data());
+  atlas.pack();
+}
+
+// One card or fragment to draw, as the games hold them
+struct Sprite {
+  int id;
+  float x, y, width, height;
+  float rotation;
+  float alpha;
+  float u, v, part_width, part_height;
+};
+
+struct Scene {
+  const char *name;
+  std::vector<Sprite> sprites;
+};
+
+Sprite card(int id, float x, float y, float width, float height,
+            float rotation = 0.0f) {
+  return {id, x, y, width, height, rotation, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f};
+}
+
+// Card sizes from Klondike's layout rules: a tenth of the width across,
+// 1.45 times that down
+Scene spiderTable(int width) {
+  float card_width = width / 11.0f, card_height = card_width * 1.45f;
+  float spacing = card_width / 10, fan = card_height / 5;
+  Scene scene{"spider", {}};
+  for (int index = 0; index < 104; index++) {
+    int column = index % 10, row = index / 10;
+    bool face_up = row >= 5;
+    int id = face_up ? render::cardId(index % 4, index % 13 + 1)
+                     : render::BACK_ID;
+    scene.sprites.push_back(card(id, spacing + column * (card_width + spacing),
+                                 spacing + row * fan, card_width,
+                                 card_height));
+  }
+  for (int index = 0; index < 4; index++) {
+    scene.sprites.push_back(card(render::cardId(1, 9 - index),
+                                 width * 0.4f + 7, card_height + index * fan,
+                                 card_width, card_height));
+  }
+  return scene;
+}
+
+Scene winAnimation(int width, int height) {
+  float card_width = width / 11.0f, card_height = card_width * 1.45f;
+  Scene scene{"win", {}};
+  const int grid = 4;
+  for (int index = 0; index < 52; index++) {
+    int id = render::cardId(index / 13, index % 13 + 1);
+    float x = float((index * 397) % (width - int(card_width)));
+    float y = float((index * 241) % (height - int(card_height)));
+    float rotation = index * 0.37f;
+    if (index % 2 == 0) {
+      scene.sprites.push_back(card(id, x, y, card_width, card_height,
+                                   rotation));
+      continue;
+    }
+    float part_width = card_width / grid, part_height = card_height / grid;
+    for (int row = 0; row < grid; row++) {
+      for (int column = 0; column < grid; column++) {
+        float spread = 1.0f + index % 5 * 0.2f;
+        scene.sprites.push_back(
+            {id, x + column * part_width * spread,
+             y + row * part_height * spread, part_width, part_height,
+             rotation + (row * grid + column) * 0.5f, 0.9f,
+             float(column) / grid, float(row) / grid, 1.0f / grid,
+             1.0f / grid});
+      }
+    }
+  }
+  return scene;
+}
+
+// The games' card shader, with the fragment's part of the image added
+const char *VERTEX_SHADER = R"(
+    #version 330 core
+    layout(location = 0) in vec2 position;
+    layout(location = 1) in vec2 texCoord;
+
+    uniform mat4 projection;
+    uniform mat4 view;
+    uniform mat4 model;
+    uniform vec4 part;
+
+    out VS_OUT {
+        vec2 texCoord;
+    } vs_out;
+
+    void main()
+    {
+        gl_Position = projection * view * model * vec4(position, 0.0, 1.0);
+        vs_out.texCoord = part.xy + texCoord * part.zw;
+    }
+)";
+
+const char *FRAGMENT_SHADER = R"(
+    #version 330 core
+    in VS_OUT {
+        vec2 texCoord;
+    } fs_in;
+
+    uniform sampler2D cardTexture;
+    uniform float alpha;
+
+    out vec4 FragColor;
+
+    void main()
+    {
+        vec4 texColor = texture(cardTexture, fs_in.texCoord);
+        FragColor = vec4(texColor.rgb, texColor.a * alpha);
+    }
+)";
+
+GLuint compileProgram() {
+  GLuint program = glCreateProgram();
+  for (auto [type, source] : {std::make_pair(GL_VERTEX_SHADER, VERTEX_SHADER),
+                              std::make_pair(GL_FRAGMENT_SHADER,
+                                             FRAGMENT_SHADER)}) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    glAttachShader(program, shader);
+    glDeleteShader(shader);
+  }
+  glLinkProgram(program);
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  return linked ? program : 0;
+}
+
+// The card-by-card renderer: the games' quad, a texture per card id and a
+// draw call per sprite
+class CardByCard {
+public:
+  explicit CardByCard(const render::CardAtlas &deck) {
+    program_ = compileProgram();
+    static const float vertices[] = {0, 0, 0, 0, 1, 0, 1, 0,
+                                     1, 1, 1, 1, 0, 1, 0, 1};
+    static const unsigned indices[] = {0, 1, 2, 2, 3, 0};
+    GLuint buffers[2];
+    glGenVertexArrays(1, &vertex_array_);
+    glGenBuffers(2, buffers);
+    glBindVertexArray(vertex_array_);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices,
+                 GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                          nullptr);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                          reinterpret_cast<const void *>(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    for (const auto &[id, region] : deck.regions()) {
+      std::vector<uint8_t> pixels = deck.straightRGBA(region);
+      GLuint &texture = textures_[id];
+      glGenTextures(1, &texture);
+      glBindTexture(GL_TEXTURE_2D, texture);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, region.width, region.height, 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    }
+  }
+
+  bool ready() const { return program_ != 0; }
+  long long draws() const { return draws_; }
+  long long binds() const { return binds_; }
+
+  void draw(const std::vector<Sprite> &sprites, int width, int height) {
+    // glm::ortho(0, width, height, 0, -1, 1), column by column
+    const float projection[16] = {2.0f / width, 0, 0, 0, 0, -2.0f / height,
+                                  0, 0, 0, 0, -1, 0, -1, 1, 0, 1};
+    const float view[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    glUseProgram(program_);
+    glUniformMatrix4fv(glGetUniformLocation(program_, "projection"), 1,
+                       GL_FALSE, projection);
+    glUniformMatrix4fv(glGetUniformLocation(program_, "view"), 1, GL_FALSE,
+                       view);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    for (const Sprite &sprite : sprites) {
+      // translate(x, y) * translate(centre) * rotate * translate(-centre) *
+      // scale(width, height), as the games built it with glm
+      float c = std::cos(sprite.rotation), s = std::sin(sprite.rotation);
+      float half_width = sprite.width / 2, half_height = sprite.height / 2;
+      float model[16] = {
+          c * sprite.width, s * sprite.width, 0, 0,
+          -s * sprite.height, c * sprite.height, 0, 0,
+          0, 0, 1, 0,
+          sprite.x + half_width - c * half_width + s * half_height,
+          sprite.y + half_height - s * half_width - c * half_height, 0, 1};
+      glUniformMatrix4fv(glGetUniformLocation(program_, "model"), 1, GL_FALSE,
+                         model);
+      glUniform4f(glGetUniformLocation(program_, "part"), sprite.u, sprite.v,
+                  sprite.part_width, sprite.part_height);
+      glUniform1f(glGetUniformLocation(program_, "alpha"), sprite.alpha);
+      glUniform1i(glGetUniformLocation(program_, "cardTexture"), 0);
+      glActiveTexture(GL_TEXTURE0);
+      glBindTexture(GL_TEXTURE_2D, textures_[sprite.id]);
+      glBindVertexArray(vertex_array_);
+      glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+      draws_++;
+      binds_++;
+    }
+    glDisable(GL_BLEND);
+  }
+
+private:
+  GLuint program_ = 0;
+  GLuint vertex_array_ = 0;
+  GLuint textures_[render::CARD_IDS] = {};
+  long long draws_ = 0;
+  long long binds_ = 0;
+};
+
+// An outline to draw, as the games' keyboard highlight draws them
+struct Outline {
+  float x, y, width, height;
+  float r, g, b, a;
+};
+
+// A card-sized outline over each card of a Spider table, in the
+// highlight's translucent yellow and blue
+std::vector<Outline> outlines(int width) {
+  float card_width = width / 11.0f, card_height = card_width * 1.45f;
+  float spacing = card_width / 10, fan = card_height / 5;
+  std::vector<Outline> outlines;
+  for (int index = 0; index < 104; index++) {
+    int column = index % 10, row = index / 10;
+    bool blue = index % 2 == 0;
+    outlines.push_back({spacing + column * (card_width + spacing) - 2,
+                        spacing + row * fan - 2, card_width + 4,
+                        card_height + 4, blue ? 0.0f : 1.0f,
+                        blue ? 0.5f : 1.0f, blue ? 1.0f : 0.0f,
+                        blue ? 0.5f : 0.3f});
+  }
+  return outlines;
+}
+
+// The highlight's colour shader
+const char *COLOUR_VERTEX_SHADER = R"(
+    #version 330 core
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec4 color;
+
+    uniform mat4 projection;
+    uniform mat4 view;
+
+    out VS_OUT {
+        vec4 color;
+    } vs_out;
+
+    void main() {
+        gl_Position = projection * view * vec4(position, 1.0);
+        vs_out.color = color;
+    }
+)";
+
+const char *COLOUR_FRAGMENT_SHADER = R"(
+    #version 330 core
+    in VS_OUT {
+        vec4 color;
+    } fs_in;
+
+    out vec4 FragColor;
+
+    void main() {
+        FragColor = fs_in.color;
+    }
+)";
+
+// The outline-by-outline renderer: a vertex array and two buffers made,
+// filled, drawn from and deleted for each outline, as the highlight did
+class OutlineByOutline {
+public:
+  OutlineByOutline() {
+    program_.link("Outline by outline", COLOUR_VERTEX_SHADER,
+                  COLOUR_FRAGMENT_SHADER);
+    projection_location_ = program_.location("projection");
+    view_location_ = program_.location("view");
+  }
+
+  bool ready() const { return program_.id() != 0; }
+  long long objects() const { return objects_; }
+
+  void draw(const std::vector<Outline> &outlines, int width, int height) {
+    const float projection[16] = {2.0f / width, 0, 0, 0, 0, -2.0f / height,
+                                  0, 0, 0, 0, -1, 0, -1, 1, 0, 1};
+    const float view[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    for (const Outline &outline : outlines) {
+      float left = outline.x, top = outline.y;
+      float right = left + outline.width, bottom = top + outline.height;
+      float positions[] = {left, top, 0, right, top, 0,
+                           right, bottom, 0, left, bottom, 0};
+      float colours[16];
+      for (int corner = 0; corner < 4; corner++) {
+        colours[corner * 4] = outline.r;
+        colours[corner * 4 + 1] = outline.g;
+        colours[corner * 4 + 2] = outline.b;
+        colours[corner * 4 + 3] = outline.a;
+      }
+      GLuint vertex_array = 0, buffers[2] = {};
+      glGenVertexArrays(1, &vertex_array);
+      glGenBuffers(2, buffers);
+      objects_ += 3;
+      glBindVertexArray(vertex_array);
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions,
+                   GL_STATIC_DRAW);
+      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
+                            nullptr);
+      glEnableVertexAttribArray(0);
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(colours), colours, GL_STATIC_DRAW);
+      glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                            nullptr);
+      glEnableVertexAttribArray(1);
+      glUseProgram(program_.id());
+      glUniformMatrix4fv(projection_location_, 1, GL_FALSE, projection);
+      glUniformMatrix4fv(view_location_, 1, GL_FALSE, view);
+      glDrawArrays(GL_LINE_LOOP, 0, 4);
+      glDeleteBuffers(2, buffers);
+      glDeleteVertexArrays(1, &vertex_array);
+    }
+    glDisable(GL_BLEND);
+  }
+
+private:
+  render::GLProgram program_;
+  GLint projection_location_ = -1;
+  GLint view_location_ = -1;
+  long long objects_ = 0;
+};
+
+void clear() {
+  glClearColor(0.0f, 0.5f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+}
+
+std::vector<uint8_t> readPixels(int width, int height) {
+  std::vector<uint8_t> pixels(size_t(width) * height * 4);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+  return pixels;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int frames = 50;
+  int width = 1920, height = 1080;
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--frames") && has_value) {
+      frames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--size") && has_value &&
+               sscanf(argv[++i], "%dx%d", &width, &height) == 2) {
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (frames < 1 || width < 64 || height < 64) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (!createContext()) {
+    std::cerr << "No offscreen OpenGL 3.3 context through EGL\n";
+    return 1;
+  }
+  std::cout << glGetString(GL_RENDERER) << ", OpenGL "
+            << glGetString(GL_VERSION) << "\n";
+
+  GLuint framebuffer = 0, colour = 0;
+  glGenFramebuffers(1, &framebuffer);
+  glGenRenderbuffers(1, &colour);
+  glBindRenderbuffer(GL_RENDERBUFFER, colour);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, colour);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Offscreen framebuffer incomplete\n";
+    return 1;
+  }
+  glViewport(0, 0, width, height);
+
+  render::CardAtlas deck;
+  generateDeck(deck);
+  CardByCard card_by_card(deck);
+  render::GLCardBatch batch;
+  render::GLState state("gl_bench");
+  if (!card_by_card.ready() || !batch.create() || !batch.load(deck)) {
+    std::cerr << "Card shaders or textures failed\n";
+    return 1;
+  }
+
+  bool all_matched = true;
+  for (const Scene &scene : {spiderTable(width), winAnimation(width, height)}) {
+    auto draw_batched = [&] {
+      state.beginFrame();
+      for (const Sprite &sprite : scene.sprites)
+        batch.addPart(sprite.id, sprite.u, sprite.v, sprite.part_width,
+                      sprite.part_height, sprite.x, sprite.y, sprite.width,
+                      sprite.height, sprite.rotation, sprite.alpha);
+      batch.draw(state, width, height);
+      state.endFrame();
+    };
+
+    clear();
+    card_by_card.draw(scene.sprites, width, height);
+    std::vector<uint8_t> expected = readPixels(width, height);
+    clear();
+    draw_batched();
+    std::vector<uint8_t> actual = readPixels(width, height);
+    long long mismatched = 0, off_by_one = 0;
+    for (size_t i = 0; i < expected.size(); i += 4) {
+      int difference = 0;
+      for (size_t channel = i; channel < i + 4; channel++)
+        difference = std::max(difference,
+                               std::abs(expected[channel] - actual[channel]));
+      mismatched += difference > 1;
+      off_by_one += difference == 1;
+    }
+    all_matched = all_matched && mismatched == 0;
+
+    long long draws_before = card_by_card.draws();
+    long long binds_before = card_by_card.binds();
+    double issuing_ms = 0;
+    Clock::time_point start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+      clear();
+      Clock::time_point issue = Clock::now();
+      card_by_card.draw(scene.sprites, width, height);
+      issuing_ms += millisecondsSince(issue);
+      glFinish();
+    }
+    double per_card_ms = millisecondsSince(start) / frames;
+    double per_card_issuing_ms = issuing_ms / frames;
+    double per_card_draws =
+        double(card_by_card.draws() - draws_before) / frames;
+    double per_card_binds =
+        double(card_by_card.binds() - binds_before) / frames;
+
+    batch.resetStats();
+    state.resetTotal();
+    issuing_ms = 0;
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+      clear();
+      Clock::time_point issue = Clock::now();
+      draw_batched();
+      issuing_ms += millisecondsSince(issue);
+      glFinish();
+    }
+    double batched_ms = millisecondsSince(start) / frames;
+    double batched_issuing_ms = issuing_ms / frames;
+    double batched_draws = double(batch.stats().draws) / frames;
+    double batched_changes = double(state.total().changes()) / frames;
+
+    std::cout << std::left << std::setw(7) << scene.name << std::right
+              << scene.sprites.size() << " cards at " << width << "x"
+              << height << ": card by card " << std::fixed
+              << std::setprecision(2) << per_card_ms << " ms/frame, "
+              << per_card_issuing_ms << " ms issuing ("
+              << std::setprecision(0) << per_card_draws << " draws, "
+              << per_card_binds << " texture binds); batched "
+              << std::setprecision(2) << batched_ms << " ms/frame, "
+              << batched_issuing_ms << " ms issuing ("
+              << std::setprecision(0) << batched_draws
+              << " draw, " << batched_changes << " state changes), "
+              << std::setprecision(1)
+              << per_card_issuing_ms / batched_issuing_ms
+              << "x less issuing; " << mismatched << " mismatched pixels, "
+              << off_by_one << " off by one\n";
+  }
+
+  // The keyboard highlight's outlines, one vertex array and two buffers
+  // each, against render::GLOverlay's ring
+  OutlineByOutline outline_by_outline;
+  render::GLOverlay overlay;
+  if (!outline_by_outline.ready() || !overlay.create()) {
+    std::cerr << "Outline shaders failed\n";
+    return 1;
+  }
+  std::vector<Outline> scene = outlines(width);
+  auto draw_overlay = [&] {
+    state.beginFrame();
+    for (const Outline &outline : scene)
+      overlay.outline(outline.x, outline.y, outline.width, outline.height,
+                      outline.r, outline.g, outline.b, outline.a);
+    overlay.draw(state, width, height);
+    state.endFrame();
+  };
+
+  clear();
+  outline_by_outline.draw(scene, width, height);
+  std::vector<uint8_t> expected = readPixels(width, height);
+  clear();
+  draw_overlay();
+  std::vector<uint8_t> actual = readPixels(width, height);
+  long long mismatched = 0;
+  for (size_t i = 0; i < expected.size(); i += 4)
+    mismatched += memcmp(&expected[i], &actual[i], 4) != 0;
+  all_matched = all_matched && mismatched == 0;
+
+  long long objects_before = outline_by_outline.objects();
+  Clock::time_point start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    clear();
+    outline_by_outline.draw(scene, width, height);
+    glFinish();
+  }
+  double per_outline_ms = millisecondsSince(start) / frames;
+  double per_outline_objects =
+      double(outline_by_outline.objects() - objects_before) / frames;
+
+  overlay.resetStats();
+  start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    clear();
+    draw_overlay();
+    glFinish();
+  }
+  double overlay_ms = millisecondsSince(start) / frames;
+  double overlay_draws = double(overlay.stats().draws) / frames;
+
+  std::cout << std::left << std::setw(7) << "lines" << std::right
+            << scene.size() << " outlines at " << width << "x" << height
+            << ": outline by outline " << std::fixed << std::setprecision(2)
+            << per_outline_ms << " ms/frame (" << std::setprecision(0)
+            << per_outline_objects << " GL objects made and deleted); ring "
+            << std::setprecision(2) << overlay_ms << " ms/frame ("
+            << std::setprecision(0) << overlay_draws << " draws, 0 objects, "
+            << overlay.stats().orphans << " orphanings in " << frames + 1
+            << " frames); " << mismatched << " mismatched pixels\n";
+
+  // The win animation's explosions, GRID x GRID fragments a card: worked
+  // out on the CPU with ExplosionPhysics and queued on the card batch,
+  // uploaded every frame, against render::GLExplosions' vertex shader
+  render::GLExplosions explosions;
+  if (!explosions.create()) {
+    std::cerr << "Explosion shaders failed\n";
+    return 1;
+  }
+  const int grid = render::GLExplosions::GRID;
+  float card_width = width / 11.0f, card_height = card_width * 1.45f;
+  for (int index = 0; index < 52; index++) {
+    int id = render::cardId(index / 13, index % 13 + 1);
+    explosions.launch(id, float((index * 397) % (width - int(card_width))),
+                      float(height / 4 + (index * 241) % (height / 3)),
+                      card_width, card_height, index * 0.37f, 0.8f, 0.9f,
+                      width, height);
+    explosions.tick();
+  }
+  auto draw_on_cpu = [&] {
+    state.beginFrame();
+    for (const render::ExplosionLaunch &launch : explosions.launches()) {
+      float ticks = explosions.currentTick() - launch.tick;
+      for (int fragment = 0; fragment < grid * grid; fragment++) {
+        render::ExplosionFragment part = render::ExplosionPhysics::at(
+            launch, fragment, grid, ticks, float(width), float(height));
+        batch.addPart(int(launch.layer), part.u, part.v, 1.0f / grid,
+                      1.0f / grid, part.x, part.y, part.width, part.height,
+                      part.rotation, launch.alpha);
+      }
+    }
+    batch.draw(state, width, height);
+    state.endFrame();
+  };
+  auto draw_on_gpu = [&] {
+    state.beginFrame();
+    explosions.draw(state, batch.texture(), width, height);
+    state.endFrame();
+  };
+
+  clear();
+  draw_on_cpu();
+  expected = readPixels(width, height);
+  clear();
+  draw_on_gpu();
+  actual = readPixels(width, height);
+  mismatched = 0;
+  long long off_by_one = 0;
+  for (size_t i = 0; i < expected.size(); i += 4) {
+    int difference = 0;
+    for (size_t channel = i; channel < i + 4; channel++)
+      difference = std::max(difference,
+                            std::abs(expected[channel] - actual[channel]));
+    mismatched += difference > 1;
+    off_by_one += difference == 1;
+  }
+  all_matched = all_matched && mismatched == 0;
+
+  double issuing_ms = 0;
+  start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    clear();
+    Clock::time_point issue = Clock::now();
+    draw_on_cpu();
+    issuing_ms += millisecondsSince(issue);
+    glFinish();
+  }
+  double cpu_ms = millisecondsSince(start) / frames;
+  double cpu_issuing_ms = issuing_ms / frames;
+  size_t particles = explosions.explosions() * grid * grid;
+  // The batch's instances are three vec4s
+  size_t cpu_bytes = particles * 12 * sizeof(float);
+
+  explosions.resetStats();
+  issuing_ms = 0;
+  start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    clear();
+    Clock::time_point issue = Clock::now();
+    draw_on_gpu();
+    issuing_ms += millisecondsSince(issue);
+    glFinish();
+  }
+  double gpu_ms = millisecondsSince(start) / frames;
+  double gpu_issuing_ms = issuing_ms / frames;
+  double gpu_bytes = double(explosions.stats().bytes) / frames;
+
+  std::cout << std::left << std::setw(7) << "boom" << std::right
+            << particles << " fragments at " << width << "x" << height
+            << ": on the CPU " << std::fixed << std::setprecision(2)
+            << cpu_ms << " ms/frame, " << cpu_issuing_ms << " ms issuing ("
+            << std::setprecision(0) << cpu_bytes
+            << " bytes uploaded); on the GPU " << std::setprecision(2)
+            << gpu_ms << " ms/frame, " << gpu_issuing_ms << " ms issuing ("
+            << std::setprecision(0) << gpu_bytes << " bytes uploaded); "
+            << mismatched << " mismatched pixels, " << off_by_one
+            << " off by one\n";
+
+  return all_matched ? 0 : 1;
+}
@@ -0,0 +1,477 @@
+// Headless benchmark for the win animation's particle pool (see
+// src_render/particles.h).
+//
+//   particle_bench [--particles N] [--ticks N] [--size WxH]
+//
+// Keeps N card fragments (10000 by default) in flight in a WxH window,
+// blowing a new 4x4 card's worth into the air wherever the last tick
+// dropped some, and times the updates. The pool runs once per SIMD level
+// this CPU has; beside it runs the loop the games had before, over a
+// vector of structs of doubles with rand() for the bounces, fed the same
+// launches. The report gives the time per update for each, scaled to
+// 10000 particles.
+//
+// Every level must leave the pool as the scalar one does, bit for bit,
+// with the same bounces and the same particles dropped in the same order;
+// the exit status says whether they did.
+//
+//   particle_bench --win [--size WxH]
+//
+// Plays a win animation instead: the 52 cards blown up one after another
+// into 4x4 fragments and every frame drawn, nearest neighbour, into a WxH
+// ARGB buffer until the last fragment has fallen out. It is played twice,
+// each in a child process of its own: "copies" gives each fragment a
+// buffer of its own, copied from the card when it is blown up and freed
+// when it leaves, as the Cairo games did with image surfaces; "cells"
+// draws each straight from its cell of the card's image. The report gives
+// the time per frame and the child's peak RSS for each; the two must draw
+// the same frames.
+
+#include "../src_render/particles.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--particles N] [--ticks N] [--size WxH]\n"
+            << "       " << program << " --win [--size WxH]\n";
+}
+
+using render::ParticlePool;
+using render::SimdLevel;
+
+using Clock = std::chrono::steady_clock;
+
+double microsecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+      .count();
+}
+
+// Klondike's fragment size at 1280x720, a quarter of its card
+constexpr float FRAGMENT_WIDTH = 29;
+constexpr float FRAGMENT_HEIGHT = 42;
+constexpr float GRAVITY = 0.8f;
+
+struct Launch {
+  float x, y, velocity_x, velocity_y, rotation, spin;
+};
+
+// The 4x4 fragments of cards blown up at random places, one after another,
+// moving as the games' explodeCard() set them off; random() stands in for
+// rand()
+class Launcher {
+public:
+  Launch next(float window_width, float window_height) {
+    if (cell_ == 16) {
+      card_x_ = float(random() % unsigned(window_width));
+      card_y_ = float(random() % unsigned(window_height / 2));
+      cell_ = 0;
+    }
+    int row = cell_ / 4, column = cell_ % 4;
+    cell_++;
+    double dir_x = (column + 0.5) * FRAGMENT_WIDTH - 2 * FRAGMENT_WIDTH;
+    double dir_y = (row + 0.5) * FRAGMENT_HEIGHT - 2 * FRAGMENT_HEIGHT;
+    double magnitude = std::sqrt(dir_x * dir_x + dir_y * dir_y);
+    double speed = 12.0 + random() % 8;
+    double upward_bias = -15.0 - random() % 10;
+    return {card_x_ + column * FRAGMENT_WIDTH,
+            card_y_ + row * FRAGMENT_HEIGHT,
+            float(dir_x / magnitude * speed + (int(random() % 10) - 5)),
+            float(dir_y / magnitude * speed + upward_bias), 0.0f,
+            float((int(random() % 60) - 30) / 5.0)};
+  }
+
+private:
+  uint32_t random() {
+    state_ = state_ * 1664525u + 1013904223u;
+    return state_ >> 8;
+  }
+
+  uint32_t state_ = 12345;
+  int cell_ = 16;
+  float card_x_ = 0, card_y_ = 0;
+};
+
+// The games' fragments before the pool
+struct OldFragment {
+  double x, y, width, height;
+  double velocity_x, velocity_y, rotation, rotation_velocity;
+  void *surface;
+  bool active;
+};
+
+// The games' updateCardFragments(), less the sound and the surface
+int updateOld(std::vector<OldFragment> &fragments, double window_width,
+              double window_height) {
+  int bounced = 0;
+  for (auto &fragment : fragments) {
+    if (!fragment.active)
+      continue;
+    fragment.x += fragment.velocity_x;
+    fragment.y += fragment.velocity_y;
+    fragment.velocity_y += GRAVITY;
+    fragment.rotation += fragment.rotation_velocity;
+    const double min_height = window_height * 0.5;
+    if (fragment.y > min_height &&
+        fragment.y < window_height - fragment.height &&
+        fragment.velocity_y > 0 && (rand() % 1000 < 5)) {
+      fragment.velocity_y = -fragment.velocity_y * 0.8;
+      fragment.velocity_x += (rand() % 11 - 5);
+      fragment.rotation_velocity *= 1.5;
+      bounced++;
+    }
+    if (fragment.x < -fragment.width || fragment.x > window_width ||
+        fragment.y > window_height + fragment.height)
+      fragment.active = false;
+  }
+  return bounced;
+}
+
+// Runs the old loop for ticks, refilling inactive slots as the games'
+// cards did; microseconds per update
+double runOld(int particles, int ticks, float width, float height) {
+  Launcher launcher;
+  std::vector<OldFragment> fragments(particles);
+  for (auto &fragment : fragments)
+    fragment.active = false;
+  srand(1);
+  double total = 0;
+  for (int tick = 0; tick < ticks; tick++) {
+    for (auto &fragment : fragments) {
+      if (fragment.active)
+        continue;
+      Launch launch = launcher.next(width, height);
+      fragment = {launch.x,          launch.y,         FRAGMENT_WIDTH,
+                  FRAGMENT_HEIGHT,   launch.velocity_x, launch.velocity_y,
+                  launch.rotation,   launch.spin,      nullptr,
+                  true};
+    }
+    Clock::time_point start = Clock::now();
+    updateOld(fragments, width, height);
+    total += microsecondsSince(start);
+  }
+  return total / ticks;
+}
+
+struct Run {
+  double us = 0;              // per update
+  long long bounced = 0;
+  std::vector<uint32_t> died; // every tag dropped, in order
+  ParticlePool pool;
+};
+
+// Runs the pool at level for ticks, topping it up to particles before
+// each update
+void runPool(Run &run, int particles, int ticks, float width, float height,
+             SimdLevel level) {
+  Launcher launcher;
+  uint32_t next_tag = 0;
+  run.pool.reserve(particles);
+  double total = 0;
+  for (int tick = 0; tick < ticks; tick++) {
+    while (run.pool.size() < size_t(particles)) {
+      Launch launch = launcher.next(width, height);
+      run.pool.add(launch.x, launch.y, FRAGMENT_WIDTH, FRAGMENT_HEIGHT,
+                   launch.velocity_x, launch.velocity_y, launch.rotation,
+                   launch.spin, next_tag++);
+    }
+    Clock::time_point start = Clock::now();
+    run.bounced += run.pool.update(GRAVITY, width, height, level);
+    total += microsecondsSince(start);
+    run.died.insert(run.died.end(), run.pool.died().begin(),
+                    run.pool.died().end());
+  }
+  run.us = total / ticks;
+}
+
+bool samePool(const ParticlePool &a, const ParticlePool &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    const float left[] = {a.x(i),         a.y(i),         a.velocityX(i),
+                          a.velocityY(i), a.rotation(i),  a.spin(i)};
+    const float right[] = {b.x(i),         b.y(i),         b.velocityX(i),
+                           b.velocityY(i), b.rotation(i),  b.spin(i)};
+    if (memcmp(left, right, sizeof(left)) != 0 || a.tag(i) != b.tag(i))
+      return false;
+  }
+  return true;
+}
+
+// The win animation, as drawn
+
+constexpr int CARD_WIDTH = 4 * int(FRAGMENT_WIDTH);
+constexpr int CARD_HEIGHT = 4 * int(FRAGMENT_HEIGHT);
+constexpr int CARD_COUNT = 52;
+constexpr int LAUNCH_INTERVAL = 4; // ticks between cards blown up
+
+struct WinResult {
+  double ms = 0;             // per frame
+  long peak_kb = 0;          // the process's peak RSS
+  int frames = 0;
+  size_t most_fragments = 0; // in flight at once
+  uint64_t checksum = 0;     // of every frame drawn
+};
+
+// Draws the w x h image at source, stride pixels to a row, into frame as
+// a particle at (x, y) turned rotation about its centre, sampling the
+// pixel under each frame pixel's centre and compositing it over
+void drawRotated(std::vector<uint32_t> &frame, int frame_width,
+                 int frame_height, const uint32_t *source, int stride,
+                 float x, float y, int w, int h, float rotation) {
+  const float cx = x + w * 0.5f, cy = y + h * 0.5f;
+  const float c = std::cos(rotation), s = std::sin(rotation);
+  const float reach = 0.5f * std::sqrt(float(w * w + h * h));
+  int x0 = std::max(0, int(std::floor(cx - reach)));
+  int x1 = std::min(frame_width, int(std::ceil(cx + reach)));
+  int y0 = std::max(0, int(std::floor(cy - reach)));
+  int y1 = std::min(frame_height, int(std::ceil(cy + reach)));
+  for (int py = y0; py < y1; py++) {
+    uint32_t *row = frame.data() + size_t(py) * frame_width;
+    for (int px = x0; px < x1; px++) {
+      float dx = px + 0.5f - cx, dy = py + 0.5f - cy;
+      float u = c * dx + s * dy + w * 0.5f;
+      float v = -s * dx + c * dy + h * 0.5f;
+      if (u < 0 || v < 0 || u >= w || v >= h)
+        continue;
+      uint32_t src = source[size_t(v) * stride + size_t(u)];
+      uint32_t alpha = src >> 24;
+      if (alpha == 255) {
+        row[px] = src;
+      } else if (alpha) {
+        // Premultiplied OVER, channel by channel
+        uint32_t dst = row[px], out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+          uint32_t d = (dst >> shift) & 255, s8 = (src >> shift) & 255;
+          out |= std::min(255u, s8 + d * (255 - alpha) / 255) << shift;
+        }
+        row[px] = out;
+      }
+    }
+  }
+}
+
+// Plays the win animation, drawing fragments from copies of their cells
+// if copies, else from the card images; runs in its own process so the
+// peak RSS is the animation's alone
+WinResult playWin(bool copies, int width, int height) {
+  // The cards' images: opaque faces with transparent corners
+  std::vector<uint32_t> cards(size_t(CARD_COUNT) * CARD_WIDTH * CARD_HEIGHT);
+  for (int card = 0; card < CARD_COUNT; card++) {
+    uint32_t *image = cards.data() + size_t(card) * CARD_WIDTH * CARD_HEIGHT;
+    for (int v = 0; v < CARD_HEIGHT; v++)
+      for (int u = 0; u < CARD_WIDTH; u++) {
+        bool corner = (u < 3 || u >= CARD_WIDTH - 3) &&
+                      (v < 3 || v >= CARD_HEIGHT - 3);
+        image[v * CARD_WIDTH + u] =
+            corner ? 0 : 0xff000000u | uint32_t(card * 4u + u) << 16 |
+                             uint32_t(v) << 8 | uint32_t(u ^ v);
+      }
+  }
+
+  std::vector<uint32_t> frame(size_t(width) * height);
+  std::vector<uint32_t *> fragment_copies; // by tag, if copies
+  ParticlePool pool;
+  Launcher launcher;
+  WinResult result;
+  double total = 0;
+  for (int tick = 0; result.frames == 0 || !pool.empty(); tick++) {
+    Clock::time_point start = Clock::now();
+
+    // Blow up the next card, copying out its cells if asked
+    int card = tick / LAUNCH_INTERVAL;
+    if (tick % LAUNCH_INTERVAL == 0 && card < CARD_COUNT) {
+      const uint32_t *image =
+          cards.data() + size_t(card) * CARD_WIDTH * CARD_HEIGHT;
+      for (int cell = 0; cell < 16; cell++) {
+        Launch launch = launcher.next(float(width), float(height));
+        uint32_t tag = uint32_t(card * 16 + cell);
+        if (copies) {
+          const int w = int(FRAGMENT_WIDTH), h = int(FRAGMENT_HEIGHT);
+          uint32_t *copy =
+              static_cast<uint32_t *>(malloc(sizeof(uint32_t) * w * h));
+          for (int v = 0; v < h; v++)
+            memcpy(copy + v * w,
+                   image + size_t(cell / 4 * h + v) * CARD_WIDTH + cell % 4 * w,
+                   sizeof(uint32_t) * w);
+          tag = uint32_t(fragment_copies.size());
+          fragment_copies.push_back(copy);
+        }
+        pool.add(launch.x, launch.y, FRAGMENT_WIDTH, FRAGMENT_HEIGHT,
+                 launch.velocity_x, launch.velocity_y, launch.rotation,
+                 launch.spin, tag);
+      }
+    }
+
+    pool.update(GRAVITY, float(width), float(height));
+    if (copies) {
+      for (uint32_t tag : pool.died()) {
+        free(fragment_copies[tag]);
+        fragment_copies[tag] = nullptr;
+      }
+    }
+    result.most_fragments = std::max(result.most_fragments, pool.size());
+
+    // Draw the frame
+    std::fill(frame.begin(), frame.end(), 0xff004000u);
+    for (size_t i = 0; i < pool.size(); i++) {
+      const int w = int(pool.width(i)), h = int(pool.height(i));
+      uint32_t tag = pool.tag(i);
+      const uint32_t *source;
+      int stride;
+      if (copies) {
+        source = fragment_copies[tag];
+        stride = w;
+      } else {
+        int cell = int(tag % 16);
+        source = cards.data() + size_t(tag / 16) * CARD_WIDTH * CARD_HEIGHT +
+                 size_t(cell / 4 * h) * CARD_WIDTH + cell % 4 * w;
+        stride = CARD_WIDTH;
+      }
+      drawRotated(frame, width, height, source, stride, pool.x(i), pool.y(i),
+                  w, h, pool.rotation(i));
+    }
+    total += microsecondsSince(start);
+    result.frames++;
+
+    // FNV-1a over the frame, so the two ways can be compared
+    for (uint32_t pixel : frame)
+      result.checksum = (result.checksum ^ pixel) * 1099511628211ull;
+  }
+
+  for (uint32_t *copy : fragment_copies)
+    free(copy);
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  result.peak_kb = usage.ru_maxrss;
+  result.ms = total / 1000.0 / result.frames;
+  return result;
+}
+
+// Runs playWin() in a child process and hands back what it found
+bool playWinApart(bool copies, int width, int height, WinResult &result) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return false;
+  pid_t child = fork();
+  if (child < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (child == 0) {
+    close(fds[0]);
+    WinResult found = playWin(copies, width, height);
+    bool written = write(fds[1], &found, sizeof(found)) == sizeof(found);
+    _exit(written ? 0 : 1);
+  }
+  close(fds[1]);
+  bool read_all = read(fds[0], &result, sizeof(result)) == sizeof(result);
+  close(fds[0]);
+  int status = 0;
+  waitpid(child, &status, 0);
+  return read_all && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int runWin(int width, int height) {
+  std::cout << "Win animation, " << CARD_COUNT << " cards, " << width << "x"
+            << height << "\n";
+  WinResult results[2];
+  const char *names[2] = {"copies", "cells"};
+  for (int i = 0; i < 2; i++) {
+    if (!playWinApart(i == 0, width, height, results[i])) {
+      std::cerr << "Could not play the " << names[i] << " win animation\n";
+      return 1;
+    }
+    const WinResult &result = results[i];
+    std::cout << std::fixed << std::setprecision(3) << std::left
+              << std::setw(8) << names[i] << std::right << ": " << result.ms
+              << " ms/frame, peak RSS " << result.peak_kb << " KiB, "
+              << result.frames << " frames, at most " << result.most_fragments
+              << " fragments\n";
+  }
+  bool same = results[0].checksum == results[1].checksum &&
+              results[0].frames == results[1].frames;
+  std::cout << (same ? "Frames match\n" : "FRAMES DIFFER\n");
+  return same ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int particles = 10000;
+  int ticks = 2000;
+  int width = 1280, height = 720;
+  bool win = false;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--particles") && has_value) {
+      particles = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--ticks") && has_value) {
+      ticks = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--win")) {
+      win = true;
+    } else if (!strcmp(argv[i], "--size") && has_value) {
+      if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+        printUsage(argv[0]);
+        return 1;
+      }
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (particles < 1 || ticks < 1 || width < 64 || height < 64) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  if (win)
+    return runWin(width, height);
+
+  std::cout << particles << " particles, " << ticks << " ticks, " << width
+            << "x" << height << ", CPU has "
+            << render::simdName(render::cpuSimdLevel()) << "\n";
+  const double scale = 10000.0 / particles;
+
+  double old_us = runOld(particles, ticks, float(width), float(height));
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(8) << "structs" << std::right << ": "
+            << old_us * scale << " us/update per 10k\n";
+
+  SimdLevel best = render::cpuSimdLevel();
+  std::vector<Run> runs(int(best) + 1);
+  unsigned failures = 0;
+  for (int level = 0; level <= int(best); level++) {
+    Run &run = runs[level];
+    runPool(run, particles, ticks, float(width), float(height),
+            SimdLevel(level));
+    bool same = level == 0 ||
+                (run.bounced == runs[0].bounced && run.died == runs[0].died &&
+                 samePool(run.pool, runs[0].pool));
+    failures += !same;
+    std::cout << std::left << std::setw(8)
+              << render::simdName(SimdLevel(level)) << std::right << ": "
+              << run.us * scale << " us/update per 10k ("
+              << std::setprecision(1) << old_us / std::max(run.us, 1e-9)
+              << "x structs), " << run.bounced << " bounced, "
+              << run.died.size() << " dropped"
+              << (level == 0 ? "" : same ? ", matches scalar"
+                                         : ", DIFFERS FROM SCALAR")
+              << std::setprecision(2) << "\n";
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,518 @@
+// Headless benchmark for the Cairo renderers' damage tracking.
+//
+//   render_bench [--scenario drag|deal|win|all] [--width W] [--height H]
+//                [--frames N]
+//
+// Plays a scripted drag, deal or win animation on a Klondike layout sized
+// for the window (3840x2160 by default) and paints every frame three times
+// into software ARGB buffers: whole, as the games did before damage
+// tracking; through render::DamageTracker, repainting and blitting only the
+// damage; and over a cached static layer the way the games' draw handlers
+// do now, blitting the settled board into the damage and painting only the
+// moving cards over it. Reports the time per frame and the share of the
+// window repainted for each, and checks the buffers match after every
+// frame.
+//
+// The painter stands in for Cairo's image back-end: an OVER blend of each
+// item's pixels into the back buffer, then a copy of the repainted part to
+// the window. Absolute times differ from Cairo's, the ratio is what to
+// look at.
+
+#include "../src_render/damage.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--scenario drag|deal|win|all] [--width W] [--height H]"
+               " [--frames N]\n";
+}
+
+using render::Rect;
+
+// One item as the scene emits it: where, what, how opaque, and whether it
+// belongs to the static layer, the settled board drawn first
+struct SceneItem {
+  Rect bounds;
+  uint64_t key;
+  uint8_t alpha;
+  bool layer = false;
+};
+using Emit = std::function<void(const SceneItem &)>;
+
+enum ItemKind { BACKGROUND, CARD, EMPTY_PILE, MOVING_CARD, FRAGMENT };
+
+uint64_t cardKey(ItemKind kind, int card, bool face_up) {
+  return render::DrawKey().add(int(kind)).add(face_up ? card : -1).value();
+}
+
+// Klondike's layout scaled to the window
+struct Layout {
+  int card_width;
+  int card_height;
+  int spacing;
+  int vert_spacing;
+
+  explicit Layout(int width) {
+    card_width = width / 11;
+    card_height = card_width * 145 / 100;
+    spacing = card_width / 8;
+    vert_spacing = card_height / 5;
+  }
+  Rect card(int x, int y) const {
+    return Rect(x, y, card_width, card_height);
+  }
+  int columnX(int column) const {
+    return spacing + column * (card_width + spacing);
+  }
+  int tableauY(int row) const {
+    return spacing + card_height + vert_spacing + row * vert_spacing;
+  }
+};
+
+void emitBackground(int width, int height, const Emit &emit) {
+  emit({Rect(0, 0, width, height),
+        render::DrawKey().add(int(BACKGROUND)).value(), 255, true});
+}
+
+// A card turned by rotation radians with its corner at (x, y)
+void emitMovingCard(const Layout &layout, double x, double y, double rotation,
+                    int card, const Emit &emit) {
+  render::DrawKey key;
+  key.add(int(MOVING_CARD)).add(card).add(x).add(y).add(rotation);
+  Rect bounds = render::rotatedBounds(x, y, layout.card_width,
+                                      layout.card_height, rotation);
+  // Turned cards leave corners of their bounds showing through
+  emit({bounds, key.value(), uint8_t(rotation == 0 ? 255 : 224)});
+}
+
+// Stock, waste, foundations and seven columns, column i holding
+// column_cards[i] cards, the last face up
+void emitBoard(const Layout &layout, const std::vector<int> &column_cards,
+               const std::vector<int> &foundation_tops, const Emit &board) {
+  Emit emit = [&board](SceneItem item) {
+    item.layer = true;
+    board(item);
+  };
+  int top = layout.spacing;
+  emit({layout.card(layout.columnX(0), top), cardKey(CARD, 0, false), 255});
+  emit({layout.card(layout.columnX(1), top), cardKey(CARD, 51, true), 255});
+  for (int i = 0; i < 4; i++) {
+    Rect slot = layout.card(layout.columnX(3 + i), top);
+    emit({slot, render::DrawKey().add(int(EMPTY_PILE)).value(), 128});
+    if (foundation_tops[i] >= 0)
+      emit({slot, cardKey(CARD, foundation_tops[i], true), 255});
+  }
+  int card = 0;
+  for (int column = 0; column < 7; column++) {
+    int x = layout.columnX(column);
+    if (column_cards[column] == 0)
+      emit({layout.card(x, layout.tableauY(0)),
+            render::DrawKey().add(int(EMPTY_PILE)).value(), 128});
+    for (int row = 0; row < column_cards[column]; row++, card++) {
+      bool face_up = row == column_cards[column] - 1;
+      emit({layout.card(x, layout.tableauY(row)), cardKey(CARD, card, face_up),
+            255});
+    }
+  }
+}
+
+// A three-card run dragged from the last column along a loop across the
+// board
+void dragScene(int width, int height, int frame, int frames,
+               const Emit &emit) {
+  Layout layout(width);
+  emitBackground(width, height, emit);
+  std::vector<int> columns = {1, 2, 3, 4, 5, 6, 4};
+  emitBoard(layout, columns, {12, 25, -1, -1}, emit);
+
+  double t = 2 * M_PI * frame / frames;
+  double x = width * (0.45 + 0.35 * std::sin(t));
+  double y = height * (0.45 + 0.25 * std::sin(2 * t));
+  for (int i = 0; i < 3; i++) {
+    emit({layout.card(int(x), int(y) + i * layout.vert_spacing),
+          cardKey(CARD, 40 + i, true), 255});
+  }
+}
+
+// The 28 tableau cards flying out from the stock, a new one every
+// DEAL_GAP frames, each in flight for DEAL_FLIGHT
+void dealScene(int width, int height, int frame, int frames,
+               const Emit &emit) {
+  constexpr int DEAL_GAP = 3;
+  constexpr int DEAL_FLIGHT = 15;
+  (void)frames;
+  Layout layout(width);
+  emitBackground(width, height, emit);
+
+  int cycle = frame % (28 * DEAL_GAP + DEAL_FLIGHT);
+  std::vector<int> columns(7, 0);
+  std::vector<std::pair<int, double>> flying; // card, progress
+  int card = 0;
+  for (int row = 0; row < 7; row++) {
+    for (int column = row; column < 7; column++, card++) {
+      int started = card * DEAL_GAP;
+      if (cycle >= started + DEAL_FLIGHT) {
+        columns[column]++;
+      } else if (cycle >= started) {
+        flying.emplace_back(card, double(cycle - started) / DEAL_FLIGHT);
+      }
+    }
+  }
+  emitBoard(layout, columns, {-1, -1, -1, -1}, emit);
+
+  for (const auto &[index, progress] : flying) {
+    // Which slot the card is headed for
+    int column = 0, row = 0, counted = 0;
+    for (int r = 0; r < 7 && counted <= index; r++) {
+      for (int c = r; c < 7 && counted <= index; c++, counted++) {
+        column = c;
+        row = r;
+      }
+    }
+    double from_x = layout.columnX(0), from_y = layout.spacing;
+    double x = from_x + (layout.columnX(column) - from_x) * progress;
+    double y = from_y + (layout.tableauY(row) - from_y) * progress;
+    emitMovingCard(layout, x, y, 0, index, emit);
+  }
+}
+
+// Cards thrown off the foundations one by one, bouncing across the board
+// and bursting into 4x4 fragments
+void winScene(int width, int height, int frame, int frames,
+              const Emit &emit) {
+  constexpr int LAUNCH_GAP = 4;
+  constexpr int BURST_AFTER = 50;
+  constexpr int FRAGMENT_GRID = 4;
+  (void)frames;
+  Layout layout(width);
+  emitBackground(width, height, emit);
+
+  int launched = std::min(52, frame / LAUNCH_GAP + 1);
+  std::vector<int> tops(4);
+  for (int i = 0; i < 4; i++)
+    tops[i] = 51 - i - 4 * ((launched + 3 - i) / 4);
+  emitBoard(layout, std::vector<int>(7, 0), tops, emit);
+
+  for (int card = 0; card < launched; card++) {
+    double age = frame - card * LAUNCH_GAP;
+    double x = layout.columnX(3 + card % 4);
+    double y = layout.spacing;
+    double vx = (card % 2 ? -1 : 1) * (8.0 + card % 7);
+    double vy = -12.0 - card % 5;
+    double rotation = 0.05 * age * (card % 3 - 1);
+    x += vx * std::min(age, double(BURST_AFTER));
+    // Bounce off the floor
+    double t = std::min(age, double(BURST_AFTER));
+    y += vy * t + 0.5 * t * t;
+    double floor = height - layout.card_height;
+    if (y > floor)
+      y = floor - std::fmod(y - floor, floor * 0.8);
+
+    if (age < BURST_AFTER) {
+      emitMovingCard(layout, x, y, rotation, card, emit);
+      continue;
+    }
+    double burst = age - BURST_AFTER;
+    double piece_width = double(layout.card_width) / FRAGMENT_GRID;
+    double piece_height = double(layout.card_height) / FRAGMENT_GRID;
+    for (int piece = 0; piece < FRAGMENT_GRID * FRAGMENT_GRID; piece++) {
+      int col = piece % FRAGMENT_GRID, row = piece / FRAGMENT_GRID;
+      double px = x + col * piece_width + (col - 1.5) * 6 * burst;
+      double py = y + row * piece_height + (row - 1.5) * 6 * burst +
+                  0.5 * burst * burst;
+      if (py > height)
+        continue;
+      double spin = 0.2 * burst * ((piece % 3) - 1);
+      render::DrawKey key;
+      key.add(int(FRAGMENT)).add(card).add(piece).add(px).add(py).add(spin);
+      emit({render::rotatedBounds(px, py, piece_width, piece_height, spin),
+            key.value(), 224});
+    }
+  }
+}
+
+using Scene = void (*)(int, int, int, int, const Emit &);
+
+// An ARGB32 buffer, premultiplied like Cairo's
+struct Image {
+  int width;
+  int height;
+  std::vector<uint32_t> pixels;
+
+  Image(int width, int height)
+      : width(width), height(height), pixels(size_t(width) * height, 0) {}
+};
+
+// Where clip covers row y between x and x + width, as sorted, disjoint
+// spans; clip's rectangles may overlap
+void rowSpans(const std::vector<Rect> &clip, int y, int x, int width,
+              std::vector<std::pair<int, int>> &spans) {
+  spans.clear();
+  for (const Rect &rect : clip) {
+    if (y < rect.y || y >= rect.y + rect.height)
+      continue;
+    int left = std::max(x, rect.x);
+    int right = std::min(x + width, rect.x + rect.width);
+    if (left < right)
+      spans.emplace_back(left, right);
+  }
+  std::sort(spans.begin(), spans.end());
+  size_t merged = 0;
+  for (size_t i = 0; i < spans.size(); i++) {
+    if (merged && spans[i].first <= spans[merged - 1].second) {
+      spans[merged - 1].second =
+          std::max(spans[merged - 1].second, spans[i].second);
+    } else {
+      spans[merged++] = spans[i];
+    }
+  }
+  spans.resize(merged);
+}
+
+// Blends an item over image inside clip. Its pixels depend only on its key
+// and where they are in it, like a card surface's.
+void paintItem(Image &image, const SceneItem &item,
+               const std::vector<Rect> &clip,
+               std::vector<std::pair<int, int>> &spans) {
+  Rect area = item.bounds.intersected(Rect(0, 0, image.width, image.height));
+  if (area.empty())
+    return;
+  uint32_t alpha = item.alpha;
+  uint32_t colour = uint32_t(item.key) & 0xFFFFFF;
+  for (int y = area.y; y < area.y + area.height; y++) {
+    rowSpans(clip, y, area.x, area.width, spans);
+    uint32_t *row = &image.pixels[size_t(y) * image.width];
+    uint32_t shade = uint32_t(y - item.bounds.y) >> 3 & 0x0F;
+    for (const auto &[left, right] : spans) {
+      for (int x = left; x < right; x++) {
+        uint32_t source = colour ^ ((uint32_t(x - item.bounds.x) >> 3 & 0x0F) |
+                                    shade << 8);
+        // The background is opaque, so everything over it is too
+        uint32_t out = 0xFF000000;
+        for (int shift = 0; shift < 24; shift += 8) {
+          uint32_t s = (source >> shift & 0xFF) * alpha / 255;
+          uint32_t d = (row[x] >> shift & 0xFF) * (255 - alpha) / 255;
+          out |= (s + d) << shift;
+        }
+        row[x] = out;
+      }
+    }
+  }
+}
+
+// Copies the clip from the back buffer to the window
+void blit(const Image &buffer, Image &window, const std::vector<Rect> &clip,
+          std::vector<std::pair<int, int>> &spans) {
+  for (int y = 0; y < buffer.height; y++) {
+    rowSpans(clip, y, 0, buffer.width, spans);
+    size_t offset = size_t(y) * buffer.width;
+    for (const auto &[left, right] : spans)
+      memcpy(&window.pixels[offset + left], &buffer.pixels[offset + left],
+             sizeof(uint32_t) * (right - left));
+  }
+}
+
+// Tells the tracker where the scene's static layer starts and ends
+class LayerMarks {
+public:
+  explicit LayerMarks(render::DamageTracker &damage) : damage_(damage) {}
+
+  void operator()(const SceneItem &item) {
+    if (item.layer == in_layer_)
+      return;
+    in_layer_ = item.layer;
+    if (in_layer_)
+      damage_.beginLayer();
+    else
+      damage_.endLayer();
+  }
+  bool inLayer() const { return in_layer_; }
+
+private:
+  render::DamageTracker &damage_;
+  bool in_layer_ = false;
+};
+
+struct Result {
+  double full_ms = 0;
+  double damage_ms = 0;
+  double layer_ms = 0;
+  long long painted = 0;
+  unsigned mismatches = 0;
+  unsigned missed = 0;
+};
+
+Result runScene(Scene scene, int width, int height, int frames) {
+  Image full_buffer(width, height), full_window(width, height);
+  Image buffer(width, height), window(width, height);
+  Image layer(width, height), layered_buffer(width, height),
+      layered_window(width, height);
+  std::vector<Rect> whole = {Rect(0, 0, width, height)};
+  std::vector<std::pair<int, int>> spans;
+  render::DamageTracker damage, layered;
+  Result result;
+
+  using Clock = std::chrono::steady_clock;
+  auto elapsed = [](Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since)
+        .count();
+  };
+
+  for (int frame = 0; frame < frames; frame++) {
+    // Before: every frame painted and blitted whole
+    auto started = Clock::now();
+    scene(width, height, frame, frames, [&](const SceneItem &item) {
+      paintItem(full_buffer, item, whole, spans);
+    });
+    blit(full_buffer, full_window, whole, spans);
+    result.full_ms += elapsed(started);
+
+    // After: recorded when the board changes, then painted in the damage
+    started = Clock::now();
+    damage.record(width, height);
+    scene(width, height, frame, frames, [&](const SceneItem &item) {
+      damage.item(item.bounds, item.key);
+    });
+    std::vector<Rect> clip = damage.finish();
+    damage.paint(width, height, clip);
+    scene(width, height, frame, frames, [&](const SceneItem &item) {
+      if (damage.item(item.bounds, item.key))
+        paintItem(buffer, item, clip, spans);
+    });
+    result.missed += !damage.finish().empty();
+    blit(buffer, window, clip, spans);
+    result.damage_ms += elapsed(started);
+
+    // Now: the static layer brought up to date, then blitted into the
+    // damage under the moving cards
+    started = Clock::now();
+    {
+      LayerMarks marks(layered);
+      layered.recordLayer(width, height);
+      scene(width, height, frame, frames, [&](const SceneItem &item) {
+        marks(item);
+        layered.item(item.bounds, item.key);
+      });
+    }
+    std::vector<Rect> stale = layered.finish();
+    if (!stale.empty()) {
+      LayerMarks marks(layered);
+      layered.paintLayer(width, height, stale);
+      scene(width, height, frame, frames, [&](const SceneItem &item) {
+        marks(item);
+        if (layered.item(item.bounds, item.key))
+          paintItem(layer, item, stale, spans);
+      });
+      result.missed += !layered.finish().empty();
+    }
+    {
+      LayerMarks marks(layered);
+      layered.record(width, height);
+      scene(width, height, frame, frames, [&](const SceneItem &item) {
+        marks(item);
+        layered.item(item.bounds, item.key);
+      });
+    }
+    std::vector<Rect> layered_clip = layered.finish();
+    {
+      LayerMarks marks(layered);
+      bool blitted = false;
+      layered.paintOverLayer(width, height, layered_clip);
+      scene(width, height, frame, frames, [&](const SceneItem &item) {
+        marks(item);
+        if (!marks.inLayer() && !blitted) {
+          blit(layer, layered_buffer, layered_clip, spans);
+          blitted = true;
+        }
+        if (layered.item(item.bounds, item.key))
+          paintItem(layered_buffer, item, layered_clip, spans);
+      });
+      if (!blitted)
+        blit(layer, layered_buffer, layered_clip, spans);
+    }
+    result.missed += !layered.finish().empty();
+    blit(layered_buffer, layered_window, layered_clip, spans);
+    result.layer_ms += elapsed(started);
+
+    for (int y = 0; y < height; y++) {
+      std::vector<std::pair<int, int>> row;
+      rowSpans(clip, y, 0, width, row);
+      for (const auto &[left, right] : row)
+        result.painted += right - left;
+    }
+    result.mismatches += window.pixels != full_window.pixels;
+    result.mismatches += layered_window.pixels != full_window.pixels;
+  }
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string scenario = "all";
+  int width = 3840;
+  int height = 2160;
+  int frames = 240;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--scenario") && has_value) {
+      scenario = argv[++i];
+    } else if (!strcmp(argv[i], "--width") && has_value) {
+      width = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--height") && has_value) {
+      height = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--frames") && has_value) {
+      frames = atoi(argv[++i]);
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  const std::pair<const char *, Scene> scenes[] = {
+      {"drag", dragScene}, {"deal", dealScene}, {"win", winScene}};
+  bool known = scenario == "all";
+  for (const auto &entry : scenes)
+    known = known || scenario == entry.first;
+  if (!known || width < 64 || height < 64 || frames < 1) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  unsigned failures = 0;
+  for (const auto &[name, scene] : scenes) {
+    if (scenario != "all" && scenario != name)
+      continue;
+    Result result = runScene(scene, width, height, frames);
+    double window = double(width) * height * frames;
+    std::cout << std::left << std::setw(5) << name << std::right << " "
+              << frames << " frames at " << width << "x" << height
+              << std::fixed << std::setprecision(2)
+              << ": full redraw " << result.full_ms / frames
+              << " ms/frame, damage " << result.damage_ms / frames
+              << " ms/frame (" << std::setprecision(1)
+              << 100.0 * result.painted / window << "% repainted, "
+              << std::setprecision(1)
+              << result.full_ms / std::max(result.damage_ms, 1e-9)
+              << "x), static layer " << std::setprecision(2)
+              << result.layer_ms / frames << " ms/frame ("
+              << std::setprecision(1)
+              << result.full_ms / std::max(result.layer_ms, 1e-9)
+              << "x), " << result.mismatches << " mismatched frames, "
+              << result.missed << " missed\n";
+    failures += result.mismatches + result.missed;
+  }
+  return failures ? 1 : 0;
+}
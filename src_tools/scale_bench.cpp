@@ -0,0 +1,335 @@
+// Headless benchmark for the card scaler (see src_render/resample.h).
+//
+//   scale_bench [--deck FILE] [--sizes WxH,WxH,...] [--filter box|lanczos3|all]
+//               [--runs N]
+//
+// Scales every image of a deck to the card size Klondike's layout gives
+// each window size, once per SIMD level this CPU has, and reports the time
+// per deck for each. Every level's pixels are checked against the scalar
+// ones, which they must match byte for byte.
+//
+// Built where pkg-config finds gdk-pixbuf and libzip, it decodes the deck
+// from --deck (cards.zip by default) and also times
+// gdk_pixbuf_scale_simple() on the same images, with GDK_INTERP_BILINEAR,
+// which the games scaled their cards with before the atlas, and with
+// GDK_INTERP_HYPER, gdk-pixbuf's best filter. Elsewhere it scales a
+// generated deck: 54 images the size of the bundled ones, with edges,
+// fine lines and a cross-hatched back for the filters to work on.
+
+#include "../src_render/card_atlas.h"
+#include "../src_render/card_cache.h"
+#include "../src_render/resample.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef HAVE_GDK_PIXBUF
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <zip.h>
+#endif
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--deck FILE] [--sizes WxH,WxH,...]"
+               " [--filter box|lanczos3|all] [--runs N]\n";
+}
+
+using render::CardAtlas;
+using render::Rect;
+using render::ScaleFilter;
+using render::SimdLevel;
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// The bundled deck's image size
+constexpr int IMAGE_WIDTH = 500;
+constexpr int IMAGE_HEIGHT = 726;
+
+// A card face or back in straight-alpha RGBA: white with rounded,
+// antialiased corners and a dark border, rank-many pips and rows of thin
+// strokes standing in for the index. The back is cross-hatched.
+std::vector<uint8_t> generateImage(int suit, int rank, bool back) {
+  const int radius = 24;
+  std::vector<uint8_t> rgba(size_t(IMAGE_WIDTH) * IMAGE_HEIGHT * 4);
+  bool red = suit == 1 || suit == 2;
+  for (int y = 0; y < IMAGE_HEIGHT; y++) {
+    for (int x = 0; x < IMAGE_WIDTH; x++) {
+      uint8_t *pixel = rgba.data() + (size_t(y) * IMAGE_WIDTH + x) * 4;
+      // Distance into the rounded rectangle, for the alpha edge
+      double dx = std::max({radius - x - 0.5, x + 0.5 - (IMAGE_WIDTH - radius),
+                            0.0});
+      double dy = std::max({radius - y - 0.5,
+                            y + 0.5 - (IMAGE_HEIGHT - radius), 0.0});
+      double inside = radius - std::sqrt(dx * dx + dy * dy);
+      double alpha = std::min(std::max(inside + 0.5, 0.0), 1.0);
+      int r = 255, g = 255, b = 255;
+      if (inside < 4) {
+        r = g = b = 40;
+      } else if (back) {
+        bool hatch = (x + y) % 12 < 3 || (x - y + 1200) % 12 < 3;
+        r = hatch ? 200 : 30;
+        g = hatch ? 40 : 60;
+        b = hatch ? 40 : 150;
+      } else {
+        bool ink = false;
+        // The index: rank-many strokes, a pixel or two wide
+        if (x >= 20 && x < 80 && y >= 20 && y < 20 + 8 * (rank + 1))
+          ink = (y - 20) % 8 < 1 + (x % 3 == 0);
+        // The pips, on a 3-column grid
+        for (int pip = 0; pip < rank && !ink; pip++) {
+          int cx = 150 + (pip % 3) * 100;
+          int cy = 140 + (pip / 3) * 110;
+          int px = x - cx, py = y - cy;
+          ink = px * px + py * py < 30 * 30;
+        }
+        if (ink) {
+          r = red ? 200 : 20;
+          g = 20;
+          b = red ? 30 : 20;
+        }
+      }
+      pixel[0] = uint8_t(r);
+      pixel[1] = uint8_t(g);
+      pixel[2] = uint8_t(b);
+      pixel[3] = uint8_t(std::lround(alpha * 255));
+    }
+  }
+  return rgba;
+}
+
+void generateDeck(CardAtlas &atlas) {
+  for (int suit = 0; suit < 4; suit++) {
+    for (int rank = 1; rank <= 13; rank++) {
+      std::vector<uint8_t> rgba = generateImage(suit, rank, false);
+      atlas.add(render::cardId(suit, rank), IMAGE_WIDTH, IMAGE_HEIGHT, 4,
+                IMAGE_WIDTH * 4, rgba.data());
+    }
+  }
+  std::vector<uint8_t> joker = generateImage(0, 0, false);
+  atlas.add(render::cardId(2, render::CARD_RANKS), IMAGE_WIDTH, IMAGE_HEIGHT,
+            4, IMAGE_WIDTH * 4, joker.data());
+  std::vector<uint8_t> back = generateImage(0, 0, true);
+  atlas.add(render::BACK_ID, IMAGE_WIDTH, IMAGE_HEIGHT, 4, IMAGE_WIDTH * 4,
+            back.data());
+  atlas.pack();
+}
+
+#ifdef HAVE_GDK_PIXBUF
+// Decodes every PNG in the zip at path into atlas, numbered in the order
+// they come, and pixbufs. False if the zip does not open.
+bool loadDeck(const std::string &path, CardAtlas &atlas,
+              std::vector<GdkPixbuf *> &pixbufs) {
+  int error = 0;
+  zip_t *archive = zip_open(path.c_str(), ZIP_RDONLY, &error);
+  if (!archive)
+    return false;
+  zip_int64_t entries = zip_get_num_entries(archive, 0);
+  for (zip_int64_t i = 0; i < entries; i++) {
+    std::string name = zip_get_name(archive, i, 0);
+    zip_stat_t stat;
+    if (name.size() < 4 || name.compare(name.size() - 4, 4, ".png") ||
+        zip_stat_index(archive, i, 0, &stat) != 0)
+      continue;
+    std::vector<unsigned char> data(stat.size);
+    zip_file_t *file = zip_fopen_index(archive, i, 0);
+    if (!file)
+      continue;
+    zip_int64_t read = zip_fread(file, data.data(), data.size());
+    zip_fclose(file);
+    if (read != zip_int64_t(data.size()))
+      continue;
+
+    GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
+    gdk_pixbuf_loader_write(loader, data.data(), data.size(), nullptr);
+    gdk_pixbuf_loader_close(loader, nullptr);
+    GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+    if (pixbuf) {
+      atlas.add(int(pixbufs.size()), gdk_pixbuf_get_width(pixbuf),
+                gdk_pixbuf_get_height(pixbuf),
+                gdk_pixbuf_get_n_channels(pixbuf),
+                gdk_pixbuf_get_rowstride(pixbuf),
+                gdk_pixbuf_get_pixels(pixbuf));
+      pixbufs.push_back(GDK_PIXBUF(g_object_ref(pixbuf)));
+    }
+    g_object_unref(loader);
+  }
+  zip_close(archive);
+  atlas.pack();
+  return true;
+}
+
+double timePixbuf(const std::vector<GdkPixbuf *> &pixbufs, int width,
+                  int height, GdkInterpType interp, int runs) {
+  Clock::time_point start = Clock::now();
+  for (int run = 0; run < runs; run++) {
+    for (GdkPixbuf *pixbuf : pixbufs)
+      g_object_unref(gdk_pixbuf_scale_simple(pixbuf, width, height, interp));
+  }
+  return millisecondsSince(start) / runs;
+}
+#endif
+
+// Parses "WxH,WxH,..." into sizes. False if any is malformed.
+bool parseSizes(const char *text, std::vector<std::pair<int, int>> &sizes) {
+  sizes.clear();
+  while (*text) {
+    char *end;
+    long width = strtol(text, &end, 10);
+    if (*end != 'x')
+      return false;
+    long height = strtol(end + 1, &end, 10);
+    if (width < 64 || height < 64 || (*end && *end != ','))
+      return false;
+    sizes.emplace_back(int(width), int(height));
+    text = *end ? end + 1 : end;
+  }
+  return !sizes.empty();
+}
+
+struct Result {
+  double ms[3] = {0, 0, 0}; // per deck, by SimdLevel
+  unsigned mismatches = 0;  // images that differ from the scalar ones
+};
+
+Result runSize(const CardAtlas &atlas, const std::vector<Rect> &images,
+               int width, int height, ScaleFilter filter, int runs) {
+  Result result;
+  SimdLevel best = render::cpuSimdLevel();
+  size_t pixels = size_t(width) * height;
+  std::vector<std::vector<uint32_t>> scalar(images.size(),
+                                            std::vector<uint32_t>(pixels));
+  std::vector<uint32_t> out(pixels);
+  for (int level = 0; level <= int(best); level++) {
+    Clock::time_point start = Clock::now();
+    for (int run = 0; run < runs; run++) {
+      for (size_t i = 0; i < images.size(); i++) {
+        const Rect &region = images[i];
+        uint32_t *dst = level == 0 ? scalar[i].data() : out.data();
+        render::resample(atlas.pixels() + size_t(region.y) * atlas.width() +
+                             region.x,
+                         region.width, region.height, atlas.width() * 4, dst,
+                         width, height, width * 4, filter, SimdLevel(level));
+        if (level > 0 && run == 0)
+          result.mismatches += out != scalar[i];
+      }
+    }
+    result.ms[level] = millisecondsSince(start) / runs;
+  }
+  return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string deck = "cards.zip";
+  std::vector<std::pair<int, int>> sizes = {
+      {800, 600}, {1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160}};
+  std::string filter_name = "all";
+  int runs = 5;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--deck") && has_value) {
+      deck = argv[++i];
+    } else if (!strcmp(argv[i], "--sizes") && has_value) {
+      if (!parseSizes(argv[++i], sizes)) {
+        printUsage(argv[0]);
+        return 1;
+      }
+    } else if (!strcmp(argv[i], "--filter") && has_value) {
+      filter_name = argv[++i];
+    } else if (!strcmp(argv[i], "--runs") && has_value) {
+      runs = atoi(argv[++i]);
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  const std::pair<const char *, ScaleFilter> filters[] = {
+      {"box", ScaleFilter::BOX}, {"lanczos3", ScaleFilter::LANCZOS3}};
+  bool known = filter_name == "all";
+  for (const auto &entry : filters)
+    known = known || filter_name == entry.first;
+  if (!known || runs < 1) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  CardAtlas atlas;
+#ifdef HAVE_GDK_PIXBUF
+  std::vector<GdkPixbuf *> pixbufs;
+  if (!loadDeck(deck, atlas, pixbufs) || pixbufs.empty()) {
+    std::cerr << "Cannot read a deck from " << deck << "\n";
+    return 1;
+  }
+  std::cout << "deck " << deck << ": ";
+#else
+  generateDeck(atlas);
+  std::cout << "generated deck (built without gdk-pixbuf): ";
+#endif
+  std::vector<Rect> images;
+  for (const auto &entry : atlas.regions())
+    images.push_back(entry.second);
+  std::cout << images.size() << " images, CPU has "
+            << render::simdName(render::cpuSimdLevel()) << "\n";
+
+  unsigned failures = 0;
+  for (const auto &[width, height] : sizes) {
+    // Klondike's card size for the window, as render_bench lays it out
+    int card_width = width / 11;
+    int card_height = card_width * 145 / 100;
+#ifdef HAVE_GDK_PIXBUF
+    std::cout << width << "x" << height << " (" << card_width << "x"
+              << card_height << " cards) gdk-pixbuf" << std::fixed
+              << std::setprecision(2) << ": bilinear "
+              << timePixbuf(pixbufs, card_width, card_height,
+                            GDK_INTERP_BILINEAR, runs)
+              << " ms/deck, hyper "
+              << timePixbuf(pixbufs, card_width, card_height, GDK_INTERP_HYPER,
+                            runs)
+              << " ms/deck\n";
+#endif
+    for (const auto &[name, filter] : filters) {
+      if (filter_name != "all" && filter_name != name)
+        continue;
+      Result result =
+          runSize(atlas, images, card_width, card_height, filter, runs);
+      std::cout << width << "x" << height << " (" << card_width << "x"
+                << card_height << " cards) " << std::left << std::setw(8)
+                << name << std::right << ":" << std::fixed
+                << std::setprecision(2);
+      for (int level = 0; level <= int(render::cpuSimdLevel()); level++) {
+        std::cout << " " << render::simdName(SimdLevel(level)) << " "
+                  << result.ms[level] << " ms/deck";
+        if (level > 0)
+          std::cout << " (" << std::setprecision(1)
+                    << result.ms[0] / std::max(result.ms[level], 1e-9)
+                    << "x)" << std::setprecision(2);
+        std::cout << ",";
+      }
+      std::cout << " " << result.mismatches << " mismatched\n";
+      failures += result.mismatches;
+    }
+  }
+
+#ifdef HAVE_GDK_PIXBUF
+  for (GdkPixbuf *pixbuf : pixbufs)
+    g_object_unref(pixbuf);
+#endif
+  return failures ? 1 : 0;
+}
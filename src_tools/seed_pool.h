@@ -0,0 +1,88 @@
+#ifndef SEED_POOL_H
+#define SEED_POOL_H
+
+// Work-stealing distribution of a seed range over worker threads.
+//
+// The range is cut into fixed-size chunks and each worker starts with an
+// equal, contiguous share in its own queue. Workers take chunks from the
+// front of their own queue; one that runs dry steals from the back of the
+// fullest other queue, so a few slow seeds (deals that run into the solver
+// limit) do not leave the other cores idle at the end.
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+struct SeedChunk {
+  uint64_t begin; // first seed
+  uint64_t end;   // one past the last seed
+};
+
+class SeedPool {
+public:
+  SeedPool(uint64_t begin, uint64_t end, unsigned workers, uint64_t chunk_size)
+      : queues_(workers ? workers : 1) {
+    uint64_t chunks = (end - begin + chunk_size - 1) / chunk_size;
+    uint64_t per_worker = (chunks + queues_.size() - 1) / queues_.size();
+    uint64_t seed = begin;
+    for (auto &queue : queues_) {
+      for (uint64_t i = 0; i < per_worker && seed < end; i++) {
+        uint64_t last = seed + chunk_size < end ? seed + chunk_size : end;
+        queue.chunks.push_back({seed, last});
+        seed = last;
+      }
+    }
+  }
+
+  // Next chunk for worker; false once every queue is empty
+  bool next(unsigned worker, SeedChunk &chunk) {
+    Queue &own = queues_[worker];
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.chunks.empty()) {
+        chunk = own.chunks.front();
+        own.chunks.pop_front();
+        return true;
+      }
+    }
+
+    // Steal from whoever has the most left. The victim may run dry before
+    // we get its lock, in which case look again.
+    while (true) {
+      Queue *victim = nullptr;
+      size_t most = 0;
+      for (auto &queue : queues_) {
+        size_t size = queue.size();
+        if (size > most) {
+          most = size;
+          victim = &queue;
+        }
+      }
+      if (!victim)
+        return false;
+
+      std::lock_guard<std::mutex> lock(victim->mutex);
+      if (!victim->chunks.empty()) {
+        chunk = victim->chunks.back();
+        victim->chunks.pop_back();
+        return true;
+      }
+    }
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<SeedChunk> chunks;
+
+    size_t size() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return chunks.size();
+    }
+  };
+
+  std::vector<Queue> queues_;
+};
+
+#endif // SEED_POOL_H
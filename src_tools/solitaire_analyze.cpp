@@ -0,0 +1,250 @@
+// Headless batch seed analyser.
+//
+//   solitaire_analyze --game VARIANT [--start SEED] [--count N]
+//                     [--threads N] [--nodes N] [--time SECONDS]
+//                     [--format csv|binary] [--output FILE]
+//
+// VARIANT is one of klondike-draw1, klondike-draw3, freecell,
+// double-freecell, spider-1suit, spider-2suit, spider-4suit, pyramid.
+//
+// Deals seeds start..start+count-1 exactly as the game would, solves each
+// one and streams a line or record per seed to the output (stdout by
+// default) as results come in, so the output is not in seed order. CSV
+// columns are seed,status,moves,nodes,micros, status being solved, limit,
+// or for a search that ran out of moves unwinnable where that is a proof
+// (Pyramid) and not-proven elsewhere; the binary layout is in
+// analysis_format.h. Progress goes to stderr.
+
+#include "analysis_format.h"
+#include "seed_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t CHUNK_SIZE = 64;      // Seeds handed out at a time
+constexpr unsigned TABLE_BITS = 20;      // 8 MB transposition table per thread
+constexpr double PROGRESS_INTERVAL = 2.0; // Seconds between progress lines
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " --game VARIANT [--start SEED] [--count N] [--threads N]"
+               " [--nodes N] [--time SECONDS] [--format csv|binary]"
+               " [--output FILE]\n"
+               "VARIANT: ";
+  for (rules::DealVariant variant : rules::ALL_DEAL_VARIANTS)
+    std::cerr << rules::dealVariantName(variant) << " ";
+  std::cerr << "\n";
+}
+
+// Output shared by the workers. Each worker encodes a whole chunk and
+// writes it in one go, so the lock is taken once per chunk.
+class ResultWriter {
+public:
+  ResultWriter(FILE *file, bool binary, rules::DealVariant variant)
+      : file_(file), binary_(binary), variant_(variant) {}
+
+  bool begin(const analysis::Header &header) {
+    if (binary_)
+      return analysis::writeHeader(file_, header);
+    return fputs("seed,status,moves,nodes,micros\n", file_) >= 0;
+  }
+
+  void append(std::string &buffer, const analysis::Record &record) const {
+    if (binary_) {
+      uint8_t bytes[analysis::RECORD_SIZE];
+      analysis::encodeRecord(record, bytes);
+      buffer.append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+    } else {
+      char line[96];
+      int length = snprintf(line, sizeof(line), "%" PRIu32 ",%s,%u,%" PRIu64
+                            ",%" PRIu32 "\n",
+                            record.seed,
+                            rules::dealStatusName(variant_, record.status),
+                            record.moves, record.nodes, record.micros);
+      buffer.append(line, static_cast<size_t>(length));
+    }
+  }
+
+  bool flush(const std::string &buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fwrite(buffer.data(), 1, buffer.size(), file_) == buffer.size();
+  }
+
+private:
+  FILE *file_;
+  bool binary_;
+  rules::DealVariant variant_;
+  std::mutex mutex_;
+};
+
+struct Totals {
+  std::atomic<uint64_t> done{0};
+  std::atomic<uint64_t> solved{0};
+  std::atomic<uint64_t> exhausted{0};
+  std::atomic<bool> write_failed{false};
+};
+
+void worker(unsigned index, rules::DealVariant variant,
+            const rules::SolverLimits &limits, SeedPool &pool,
+            ResultWriter &writer, Totals &totals) {
+  rules::DealSolver solver(variant, TABLE_BITS);
+  std::string buffer;
+  SeedChunk chunk;
+  while (!totals.write_failed && pool.next(index, chunk)) {
+    buffer.clear();
+    uint64_t solved = 0, exhausted = 0;
+    for (uint64_t seed = chunk.begin; seed < chunk.end; seed++) {
+      rules::SolveResult result =
+          solver.solve(static_cast<unsigned>(seed), limits);
+
+      analysis::Record record;
+      record.seed = static_cast<uint32_t>(seed);
+      record.status = result.status;
+      record.moves = static_cast<uint16_t>(
+          std::min<size_t>(result.moves.size(), UINT16_MAX));
+      record.nodes = result.nodes;
+      record.micros = static_cast<uint32_t>(
+          std::min(result.seconds * 1e6, static_cast<double>(UINT32_MAX)));
+      writer.append(buffer, record);
+
+      solved += result.status == rules::SolveStatus::SOLVED;
+      exhausted += result.status == rules::SolveStatus::EXHAUSTED;
+    }
+    if (!writer.flush(buffer))
+      totals.write_failed = true;
+    totals.solved += solved;
+    totals.exhausted += exhausted;
+    totals.done += chunk.end - chunk.begin;
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string game;
+  std::string format = "csv";
+  std::string output;
+  uint64_t start = 1;
+  uint64_t count = 10000;
+  unsigned threads = std::thread::hardware_concurrency();
+  rules::SolverLimits limits;
+  limits.max_nodes = 200000;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--game") && has_value) {
+      game = argv[++i];
+    } else if (!strcmp(argv[i], "--start") && has_value) {
+      start = strtoull(argv[++i], nullptr, 10);
+    } else if (!strcmp(argv[i], "--count") && has_value) {
+      count = strtoull(argv[++i], nullptr, 10);
+    } else if (!strcmp(argv[i], "--threads") && has_value) {
+      threads = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+    } else if (!strcmp(argv[i], "--nodes") && has_value) {
+      limits.max_nodes = strtoull(argv[++i], nullptr, 10);
+    } else if (!strcmp(argv[i], "--time") && has_value) {
+      limits.max_seconds = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--format") && has_value) {
+      format = argv[++i];
+    } else if (!strcmp(argv[i], "--output") && has_value) {
+      output = argv[++i];
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  rules::DealVariant variant;
+  if (!rules::parseDealVariant(game, variant) ||
+      (format != "csv" && format != "binary")) {
+    printUsage(argv[0]);
+    return 1;
+  }
+  // Seeds are unsigned int in the games
+  if (start > UINT32_MAX || count > UINT32_MAX - start + 1) {
+    std::cerr << "Seed range must lie within 0.." << UINT32_MAX << "\n";
+    return 1;
+  }
+  if (threads == 0)
+    threads = 1;
+
+  bool binary = format == "binary";
+  FILE *file = stdout;
+  if (!output.empty()) {
+    file = fopen(output.c_str(), binary ? "wb" : "w");
+    if (!file) {
+      std::cerr << "Cannot open " << output << ": " << strerror(errno) << "\n";
+      return 1;
+    }
+  }
+
+  ResultWriter writer(file, binary, variant);
+  analysis::Header header;
+  header.variant = variant;
+  header.max_nodes = limits.max_nodes;
+  header.max_micros = static_cast<uint64_t>(limits.max_seconds * 1e6);
+  if (!writer.begin(header)) {
+    std::cerr << "Write error\n";
+    return 1;
+  }
+
+  SeedPool pool(start, start + count, threads, CHUNK_SIZE);
+  Totals totals;
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threads; i++) {
+    workers.emplace_back(worker, i, variant, std::cref(limits), std::ref(pool),
+                         std::ref(writer), std::ref(totals));
+  }
+
+  auto elapsed = [&]() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         begin)
+        .count();
+  };
+  auto report = [&](const char *end) {
+    uint64_t done = totals.done;
+    double seconds = elapsed();
+    fprintf(stderr,
+            "%s: %" PRIu64 "/%" PRIu64 " seeds, %" PRIu64 " solved, %" PRIu64
+            " %s, %.0f seeds/sec%s",
+            rules::dealVariantName(variant), done, count,
+            static_cast<uint64_t>(totals.solved),
+            static_cast<uint64_t>(totals.exhausted),
+            rules::exhaustedIsProof(variant) ? "unwinnable" : "not proven",
+            seconds > 0 ? done / seconds : 0.0, end);
+  };
+
+  // Report progress until every seed is done
+  double next_report = PROGRESS_INTERVAL;
+  while (totals.done < count && !totals.write_failed) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (elapsed() >= next_report) {
+      report("\r");
+      next_report += PROGRESS_INTERVAL;
+    }
+  }
+  for (auto &thread : workers)
+    thread.join();
+  report("\n");
+
+  bool failed = totals.write_failed;
+  if (file != stdout)
+    failed |= fclose(file) != 0;
+  else
+    failed |= fflush(file) != 0;
+  if (failed) {
+    std::cerr << "Write error\n";
+    return 1;
+  }
+  return 0;
+}
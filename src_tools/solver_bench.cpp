@@ -0,0 +1,508 @@
+// Headless solver benchmark and batch solver.
+//
+//   solver_bench [--game klondike|freecell|double-freecell|spider|pyramid]
+//                [--draw 1|3] [--suits 1|2|4] [--seeds N] [--start SEED]
+//                [--nodes N] [--time SECONDS] [--threads N] [--verbose]
+//                [--undo-stress OPS [--autosave FILE]] [--check]
+//
+// Deals seeds start..start+N-1 exactly as the game would and runs the
+// matching solver on each, then reports the solve rate and throughput.
+// --verbose prints one line per seed, with the difficulty rating for
+// Pyramid.
+//
+// --undo-stress plays OPS random moves, undos and redos through the undo
+// journal instead, dealing seed after seed from start, and checks every
+// position against full copies of the board kept alongside. The journal
+// is kept small so it wraps and forgets moves all the time. Each game is
+// also recorded as a replay, which is encoded, decoded and played back to
+// every step. With --autosave the games are autosaved to FILE as they are
+// played, and the last one is restored from it at the end and compared.
+//
+// --check runs the solvers' regression checks instead. Klondike: boards
+// that differ only in which column a card sits on must hash apart, and
+// boards that differ only in the order of the columns must not. Pyramid:
+// the rating of each seed must follow the solver's winning line move for
+// move.
+
+#include "../src_rules/freecell_solver.h"
+#include "../src_rules/klondike_solver.h"
+#include "../src_rules/pyramid_solver.h"
+#include "../src_rules/spider_solver.h"
+#include "../src_rules/autosave.h"
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--game klondike|freecell|double-freecell|spider|pyramid]"
+               " [--draw 1|3] [--suits 1|2|4] [--seeds N] [--start SEED]"
+               " [--nodes N] [--time SECONDS] [--threads N] [--verbose]"
+               " [--undo-stress OPS [--autosave FILE]] [--check]\n";
+}
+
+constexpr size_t STRESS_JOURNAL_CAPACITY = 256;
+constexpr unsigned STRESS_MOVES_PER_DEAL = 400;
+
+// Checks a recorded game survives encoding and that playback reaches each
+// of timeline's positions. Returns the number that differ.
+template <typename State>
+unsigned checkReplay(const rules::Replay &recorded,
+                     const std::vector<State> &timeline) {
+  std::vector<uint8_t> data = recorded.encode();
+  rules::Replay replay;
+  rules::ReplayPlayer<State> player;
+  if (!replay.decode(data.data(), data.size()) || !player.load(replay) ||
+      player.length() + 1 != timeline.size())
+    return static_cast<unsigned>(timeline.size());
+  unsigned mismatches = 0;
+  State state;
+  for (size_t i = 0; i < timeline.size(); i++)
+    mismatches += !player.seek(i, state) || state != timeline[i];
+  return mismatches;
+}
+
+// Plays ops random operations on the deals header(seed) describes, seed =
+// start, start + 1, ...: mostly legal moves, with undos and redos mixed
+// in. Half the moves are the first one offered, which is usually
+// progress, so flips, completed runs and redeals come up; the rest are
+// random. One move in six goes through track() so the move search is
+// checked as well as record(). Returns the number of positions that
+// differed from the reference copies.
+template <typename State, typename Header>
+unsigned undoStress(Header header, unsigned start, unsigned ops,
+                    const std::string &autosave_path, unsigned &deals) {
+  std::mt19937 rng(start);
+  rules::UndoHistory<State> history(STRESS_JOURNAL_CAPACITY);
+  rules::Replay replay;
+  std::deque<State> undo_line; // positions that can be undone back to
+  std::vector<State> redo_line;
+  std::vector<State> timeline; // every position the replay passes through
+  State board;
+  unsigned seed = start;
+  unsigned mismatches = 0;
+  unsigned moves_played = 0;
+  rules::MoveList moves;
+
+  history.attachReplay(&replay);
+  std::unique_ptr<rules::AutosaveLog> autosave;
+  if (!autosave_path.empty())
+    autosave = std::make_unique<rules::AutosaveLog>(autosave_path);
+
+  auto newDeal = [&]() {
+    if (replay.recording())
+      mismatches += checkReplay(replay, timeline);
+    rules::ReplayHeader deal = header(seed++);
+    board = State();
+    rules::dealReplayStart(deal, board);
+    deals++;
+    history.clear();
+    history.track(board);
+    replay.start(deal);
+    timeline.assign(1, board);
+    moves_played = 0;
+    undo_line.clear();
+    redo_line.clear();
+  };
+  newDeal();
+
+  for (unsigned op = 0; op < ops; op++) {
+    if (autosave)
+      autosave->update(replay);
+    unsigned roll = rng() % 8;
+    State result;
+
+    if (roll == 0) {
+      bool done = history.undo(result);
+      if (done != !undo_line.empty()) {
+        mismatches++;
+      } else if (done) {
+        redo_line.push_back(board);
+        board = undo_line.back();
+        undo_line.pop_back();
+        mismatches += result != board;
+        timeline.push_back(board);
+      }
+      continue;
+    }
+    if (roll == 1) {
+      bool done = history.redo(result);
+      if (done != !redo_line.empty()) {
+        mismatches++;
+      } else if (done) {
+        undo_line.push_back(board);
+        board = redo_line.back();
+        redo_line.pop_back();
+        mismatches += result != board;
+        timeline.push_back(board);
+      }
+      continue;
+    }
+
+    board.legalMoves(moves);
+    if (moves.empty() || board.isWon() ||
+        moves_played++ == STRESS_MOVES_PER_DEAL) {
+      newDeal();
+      continue;
+    }
+    rules::Move move = rng() % 2 ? moves[0] : moves[rng() % moves.size()];
+    undo_line.push_back(board);
+    if (undo_line.size() > STRESS_JOURNAL_CAPACITY)
+      undo_line.pop_front();
+    redo_line.clear();
+    if (roll == 2) {
+      rules::Move played = move;
+      board.applyMove(played);
+      history.track(board);
+    } else {
+      history.record(move);
+      rules::Move played = move;
+      board.applyMove(played);
+    }
+    // A tracked move may be found as a different but equivalent one;
+    // undo must still land on the same boards
+    if (history.journal().undoCount() != undo_line.size())
+      mismatches++;
+    timeline.push_back(board);
+  }
+  mismatches += checkReplay(replay, timeline);
+
+  if (autosave) {
+    autosave->update(replay);
+    autosave.reset(); // flushes the log
+    rules::Replay saved, recording;
+    rules::UndoHistory<State> restored(STRESS_JOURNAL_CAPACITY);
+    restored.attachReplay(&recording);
+    State result;
+    if (!rules::loadAutosave(autosave_path, saved) ||
+        !rules::restoreAutosave(saved, restored, recording, result) ||
+        result != board ||
+        restored.journal().undoCount() != history.journal().undoCount() ||
+        restored.journal().redoCount() != history.journal().redoCount() ||
+        recording.encode() != replay.encode())
+      mismatches++;
+  }
+
+  // Unwind everything that is left and check each step on the way
+  State result;
+  while (history.undo(result)) {
+    if (undo_line.empty() || result != undo_line.back())
+      mismatches++;
+    if (!undo_line.empty())
+      undo_line.pop_back();
+  }
+  return mismatches + static_cast<unsigned>(undo_line.size());
+}
+
+// Builds a draw-one Klondike board from its columns, bottom card first
+rules::KlondikeState klondikeBoard(
+    std::initializer_list<std::initializer_list<rules::PackedCard>> columns) {
+  rules::KlondikeState state;
+  state.draw_three = false;
+  size_t t = 0;
+  for (const auto &column : columns) {
+    for (rules::PackedCard card : column)
+      state.tableau[t].push(card);
+    t++;
+  }
+  return state;
+}
+
+// Returns the number of hash checks that failed
+unsigned checkKlondikeHash() {
+  using rules::PackedCard;
+  using rules::Rank;
+  using rules::Suit;
+  const PackedCard ten_clubs(Suit::CLUBS, Rank::TEN);
+  const PackedCard ten_spades(Suit::SPADES, Rank::TEN);
+  const PackedCard nine_hearts(Suit::HEARTS, Rank::NINE);
+  const PackedCard down(Suit::DIAMONDS, Rank::KING, false);
+  rules::KlondikeSolver solver(1);
+  unsigned failures = 0;
+
+  // The 9 on either 10, at the same depth
+  rules::KlondikeState on_clubs =
+      klondikeBoard({{down, ten_clubs, nine_hearts}, {ten_spades}});
+  rules::KlondikeState on_spades =
+      klondikeBoard({{down, ten_clubs}, {ten_spades, nine_hearts}});
+  rules::KlondikeState on_clubs_level =
+      klondikeBoard({{ten_clubs, nine_hearts}, {ten_spades}});
+  rules::KlondikeState on_spades_level =
+      klondikeBoard({{ten_clubs}, {ten_spades, nine_hearts}});
+  if (solver.hash(on_clubs) == solver.hash(on_spades)) {
+    std::cout << "  9 on 10 of clubs or spades, different depths: same hash\n";
+    failures++;
+  }
+  if (solver.hash(on_clubs_level) == solver.hash(on_spades_level)) {
+    std::cout << "  9 on 10 of clubs or spades, same depth: same hash\n";
+    failures++;
+  }
+
+  // The same columns in another order are the same position
+  rules::KlondikeState swapped =
+      klondikeBoard({{}, {ten_spades}, {down, ten_clubs, nine_hearts}});
+  if (solver.hash(on_clubs) != solver.hash(swapped)) {
+    std::cout << "  columns in another order: different hash\n";
+    failures++;
+  }
+  return failures;
+}
+
+// Rates the solved seeds start..start+seeds-1 and returns the number whose
+// rating left the solver's winning line
+unsigned checkPyramidRating(unsigned start, unsigned seeds,
+                            const rules::SolverLimits &limits,
+                            unsigned &rated) {
+  rules::PyramidSolver solver(22);
+  std::vector<rules::Card> order = rules::zipDeckOrder();
+  unsigned failures = 0;
+  for (unsigned seed = start; seed < start + seeds; seed++) {
+    rules::PyramidState state;
+    state.deal(seed, order);
+    rules::SolveResult result = solver.solve(state, limits);
+    if (result.status != rules::SolveStatus::SOLVED)
+      continue;
+    rules::PyramidDifficulty difficulty = solver.rate(state, limits);
+    if (difficulty.status != rules::SolveStatus::SOLVED)
+      continue;
+    rated++;
+    if (difficulty.moves != result.moves) {
+      size_t step = 0;
+      while (step < difficulty.moves.size() && step < result.moves.size() &&
+             difficulty.moves[step] == result.moves[step])
+        step++;
+      std::cout << "  seed " << seed << ": rating left the line at step "
+                << step + 1 << "\n";
+      failures++;
+    }
+  }
+  return failures;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string game = "klondike";
+  bool draw_three = true;
+  int suits = 1;
+  unsigned seeds = 10000;
+  unsigned start = 1;
+  unsigned threads = 0;
+  bool verbose = false;
+  unsigned undo_stress = 0;
+  bool check = false;
+  std::string autosave_path;
+  rules::SolverLimits limits;
+  limits.max_nodes = 200000;
+
+  for (int i = 1; i < argc; i++) {
+    bool has_value = i + 1 < argc;
+    if (!strcmp(argv[i], "--game") && has_value) {
+      game = argv[++i];
+    } else if (!strcmp(argv[i], "--draw") && has_value) {
+      draw_three = atoi(argv[++i]) == 3;
+    } else if (!strcmp(argv[i], "--suits") && has_value) {
+      suits = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--seeds") && has_value) {
+      seeds = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+    } else if (!strcmp(argv[i], "--start") && has_value) {
+      start = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+    } else if (!strcmp(argv[i], "--nodes") && has_value) {
+      limits.max_nodes = strtoull(argv[++i], nullptr, 10);
+    } else if (!strcmp(argv[i], "--time") && has_value) {
+      limits.max_seconds = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--threads") && has_value) {
+      threads = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+    } else if (!strcmp(argv[i], "--verbose")) {
+      verbose = true;
+    } else if (!strcmp(argv[i], "--undo-stress") && has_value) {
+      undo_stress = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+    } else if (!strcmp(argv[i], "--autosave") && has_value) {
+      autosave_path = argv[++i];
+    } else if (!strcmp(argv[i], "--check")) {
+      check = true;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  bool klondike = game == "klondike";
+  bool double_freecell = game == "double-freecell";
+  bool spider = game == "spider";
+  bool pyramid = game == "pyramid";
+  bool freecell = game == "freecell" || double_freecell;
+  if ((!klondike && !freecell && !spider && !pyramid) ||
+      (spider && suits != 1 && suits != 2 && suits != 4)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (check) {
+    if (klondike) {
+      unsigned failures = checkKlondikeHash();
+      std::cout << "klondike hash check: " << failures << " failures\n";
+      return failures ? 1 : 0;
+    }
+    if (pyramid) {
+      unsigned rated = 0;
+      unsigned failures = checkPyramidRating(start, seeds, limits, rated);
+      std::cout << "pyramid rating check: " << rated << " deals rated, "
+                << failures << " off the winning line\n";
+      return failures ? 1 : 0;
+    }
+    std::cerr << "--check is for klondike and pyramid\n";
+    return 1;
+  }
+
+  if (undo_stress) {
+    unsigned deals = 0, mismatches;
+    rules::ReplayHeader header;
+    auto withSeed = [&](unsigned seed) {
+      header.seed = seed;
+      return header;
+    };
+    if (klondike) {
+      header.variant = draw_three ? rules::DealVariant::KLONDIKE_DRAW3
+                                  : rules::DealVariant::KLONDIKE_DRAW1;
+      mismatches = undoStress<rules::KlondikeState>(
+          withSeed, start, undo_stress, autosave_path, deals);
+    } else if (spider) {
+      header.variant = suits == 1   ? rules::DealVariant::SPIDER_1SUIT
+                       : suits == 2 ? rules::DealVariant::SPIDER_2SUIT
+                                    : rules::DealVariant::SPIDER_4SUIT;
+      mismatches = undoStress<rules::SpiderState>(
+          withSeed, start, undo_stress, autosave_path, deals);
+    } else if (pyramid) {
+      header.variant = rules::DealVariant::PYRAMID;
+      mismatches = undoStress<rules::PyramidState>(
+          withSeed, start, undo_stress, autosave_path, deals);
+    } else {
+      header.variant = double_freecell ? rules::DealVariant::DOUBLE_FREECELL
+                                       : rules::DealVariant::FREECELL;
+      mismatches = undoStress<rules::FreecellState>(
+          withSeed, start, undo_stress, autosave_path, deals);
+    }
+    std::cout << game << " undo stress: " << undo_stress << " operations over "
+              << deals << " deals, " << mismatches << " mismatches\n";
+    return mismatches ? 1 : 0;
+  }
+
+  // Only the solver in use gets a full-size transposition table
+  rules::KlondikeSolver klondike_solver(klondike ? 22 : 1);
+  rules::FreecellSolver freecell_solver(threads, freecell ? 22 : 1);
+  rules::SpiderSolver spider_solver(spider ? 64 : 1);
+  rules::PyramidSolver pyramid_solver(pyramid ? 22 : 1);
+  unsigned ratings[5] = {}; // by rules::PyramidRating
+  std::vector<rules::Card> order = rules::zipDeckOrder();
+
+  unsigned solved = 0, exhausted = 0, limited = 0;
+  uint64_t total_nodes = 0;
+  size_t total_moves = 0;
+  double total_seconds = 0.0;
+
+  for (unsigned n = 0; n < seeds; n++) {
+    unsigned seed = start + n;
+    rules::SolveResult result;
+    rules::PyramidDifficulty difficulty;
+    if (klondike) {
+      rules::KlondikeState state;
+      state.deal(seed, draw_three, order);
+      result = klondike_solver.solve(state, limits);
+    } else if (spider) {
+      rules::SpiderState state;
+      state.deal(seed, suits);
+      result = spider_solver.solve(state, limits);
+    } else if (pyramid) {
+      rules::PyramidState state;
+      state.deal(seed, order);
+      result = pyramid_solver.solve(state, limits);
+      difficulty.status = result.status;
+      if (result.status == rules::SolveStatus::SOLVED)
+        difficulty = pyramid_solver.rate(state, limits);
+      ratings[static_cast<int>(rules::pyramidRating(difficulty))]++;
+    } else {
+      rules::FreecellState state;
+      state.deal(seed, double_freecell);
+      result = freecell_solver.solve(state, limits);
+    }
+
+    total_nodes += result.nodes;
+    total_seconds += result.seconds;
+    switch (result.status) {
+    case rules::SolveStatus::SOLVED:
+      solved++;
+      total_moves += result.moves.size();
+      break;
+    case rules::SolveStatus::EXHAUSTED:
+      exhausted++;
+      break;
+    case rules::SolveStatus::LIMIT_REACHED:
+      limited++;
+      break;
+    }
+
+    if (verbose) {
+      std::cout << seed << " " << rules::solveStatusName(result.status) << " "
+                << result.moves.size() << " moves " << result.nodes
+                << " states " << std::fixed << std::setprecision(3)
+                << result.seconds << " s";
+      if (pyramid) {
+        std::cout << " " << rules::pyramidRatingName(rules::pyramidRating(difficulty))
+                  << " (score " << difficulty.score << ", "
+                  << difficulty.dead_ends << " dead ends in "
+                  << difficulty.decisions << " decisions, branching "
+                  << std::setprecision(2) << difficulty.branching << ")";
+      }
+      std::cout << "\n";
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  if (klondike) {
+    std::cout << "Klondike draw-" << (draw_three ? 3 : 1);
+  } else if (spider) {
+    std::cout << "Spider " << suits << " suit" << (suits > 1 ? "s" : "");
+  } else if (pyramid) {
+    std::cout << "Pyramid";
+  } else {
+    std::cout << (double_freecell ? "Double FreeCell" : "FreeCell") << ", "
+              << freecell_solver.threads() << " threads";
+  }
+  std::cout << ", seeds " << start << ".." << (start + seeds - 1)
+            << ", node limit " << limits.max_nodes << "\n";
+  std::cout << "  solved:     " << solved << " ("
+            << (seeds ? 100.0 * solved / seeds : 0.0) << "%)";
+  if (solved)
+    std::cout << ", " << total_moves / solved << " moves on average";
+  std::cout << "\n";
+  // Only the Pyramid search is exact; the others skip moves
+  std::cout << (pyramid ? "  unwinnable: " : "  not proven: ") << exhausted
+            << "\n";
+  std::cout << "  gave up:    " << limited << "\n";
+  if (pyramid) {
+    std::cout << "  difficulty: ";
+    for (int r = 0; r < 3; r++) {
+      rules::PyramidRating rating = static_cast<rules::PyramidRating>(r);
+      std::cout << (r ? ", " : "") << rules::pyramidRatingName(rating) << " "
+                << ratings[r];
+    }
+    std::cout << "\n";
+  }
+  std::cout << "  states:     " << total_nodes << " in " << total_seconds
+            << " s (" << std::setprecision(0)
+            << (total_seconds > 0 ? total_nodes / total_seconds : 0.0)
+            << " states/sec, " << std::setprecision(1)
+            << (total_seconds > 0 ? seeds / total_seconds : 0.0)
+            << " deals/sec)\n";
+  return 0;
+}